@@ -37,6 +37,9 @@ RETRO_BEGIN_DECLS
 consistent pitch when fast-forwarding. */
 #define AUDIO_FF_EXP_AVG_SAMPLES       16
 
+/* Number of flushes the adaptive latency is evaluated over */
+#define AUDIO_LATENCY_ADAPT_WINDOW     256
+
 /* do not define more than (MAX_SYSTEM_STREAMS - MAX_STREAMS) */
 enum audio_mixer_system_slot
 {
@@ -161,7 +164,30 @@ enum audio_driver_state_flags
     * @see audio_driver_t::write_avail
     * @see audio_driver_t::buffer_size
     */
-   AUDIO_FLAG_CONTROL      = (1 << 5)
+   AUDIO_FLAG_CONTROL      = (1 << 5),
+
+   /**
+    * Indicates that the audio latency is adjusted at runtime.
+    * Only the part of the driver buffer given by
+    * audio_driver_state_t::latency_size is kept filled, and that
+    * size grows on underruns and shrinks while playback is steady.
+    * This only holds while video sync paces emulation: when audio
+    * sync alone paces it, blocking writes return once the whole
+    * driver buffer is full, so the whole buffer is targeted.
+    * Requires \c AUDIO_FLAG_CONTROL.
+    *
+    * @see audio_driver_t::write_avail
+    * @see audio_driver_t::buffer_size
+    */
+   AUDIO_FLAG_LATENCY_ADAPTIVE = (1 << 6),
+
+   /**
+    * Set while adaptive latency targets the whole driver buffer
+    * because video sync is not pacing emulation.
+    *
+    * @see AUDIO_FLAG_LATENCY_ADAPTIVE
+    */
+   AUDIO_FLAG_LATENCY_UNPACED  = (1 << 7)
 };
 
 typedef struct audio_statistics
@@ -25,6 +25,7 @@
 #include <encodings/utf.h>
 #include <clamping.h>
 #include <memalign.h>
+#include <features/features_trace.h>
 #include <audio/conversion/float_to_s16.h>
 #include <audio/conversion/s16_to_float.h>
 #ifdef HAVE_AUDIOMIXER
@@ -389,6 +390,180 @@ bool audio_driver_find_driver(
    return true;
 }
 
+/**
+ * Computes buffer statistics over part of free_samples_buf.
+ *
+ * @param audio_st The overall state of the audio driver.
+ * @param stats Receives the statistics.
+ * @param start Index of the first sample, wrapped around the buffer.
+ * @param count Number of samples to evaluate, at least 2.
+ **/
+static void audio_driver_compute_statistics(
+      audio_driver_state_t *audio_st,
+      audio_statistics_t *stats,
+      uint64_t start, unsigned count)
+{
+   unsigned i, low_water_size, high_water_size, avg, stddev;
+   uint64_t accum                 = 0;
+   uint64_t accum_var             = 0;
+   unsigned low_water_count       = 0;
+   unsigned high_water_count      = 0;
+   unsigned latency_size          = (unsigned)audio_st->latency_size;
+
+#ifdef WARPUP
+   /* uint64 to double not implemented, fair chance
+    * signed int64 to double doesn't exist either */
+   /* https://forums.libretro.com/t/unsupported-platform-help/13903/ */
+   (void)stddev;
+#elif defined(_MSC_VER) && _MSC_VER <= 1200
+   /* FIXME: error C2520: conversion from unsigned __int64
+    * to double not implemented, use signed __int64 */
+   (void)stddev;
+#else
+   for (i = 0; i < count; i++)
+      accum += audio_st->free_samples_buf[
+         (start + i) & (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1)];
+
+   avg = (unsigned)accum / count;
+
+   for (i = 0; i < count; i++)
+   {
+      int diff     = avg - audio_st->free_samples_buf[
+         (start + i) & (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1)];
+      accum_var   += diff * diff;
+   }
+
+   stddev                                = (unsigned)
+      sqrt((double)accum_var / (count - 1));
+
+   stats->average_buffer_saturation      = (1.0f - (float)avg
+         / latency_size) * 100.0;
+   stats->std_deviation_percentage       = ((float)stddev
+         / latency_size)  * 100.0;
+#endif
+
+   low_water_size  = latency_size * 3 / 4;
+   high_water_size = latency_size     / 4;
+
+   for (i = 0; i < count; i++)
+   {
+      unsigned avail = audio_st->free_samples_buf[
+         (start + i) & (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1)];
+      if (avail >= low_water_size)
+         low_water_count++;
+      else if (avail <= high_water_size)
+         high_water_count++;
+   }
+
+   stats->close_to_underrun      = (100.0f * low_water_count)  / count;
+   stats->close_to_blocking      = (100.0f * high_water_count) / count;
+}
+
+/**
+ * Grows or shrinks the part of the driver buffer that is kept filled,
+ * without reinitializing the driver.
+ * Grows right away when the buffer ran dry since the previous flush,
+ * otherwise looks at the last AUDIO_LATENCY_ADAPT_WINDOW flushes:
+ * grows when many came close to underrunning,
+ * shrinks when none did and the fill level was steady.
+ *
+ * @param audio_st The overall state of the audio driver.
+ * @param avail Free space in the driver buffer, in bytes.
+ **/
+static void audio_driver_adapt_latency(
+      audio_driver_state_t *audio_st, size_t avail)
+{
+   size_t latency_size = audio_st->latency_size;
+   size_t min_size     = audio_st->latency_chunk_size * 2;
+
+   /* The buffer is empty after init and after a pause,
+    * so don't take the first flush as an underrun. */
+   if (audio_st->latency_window++ == 0)
+      return;
+
+   if (avail >= audio_st->buffer_size)
+      latency_size    += latency_size / 2;
+   else if (audio_st->latency_window < AUDIO_LATENCY_ADAPT_WINDOW)
+      return;
+   else
+   {
+      audio_statistics_t stats;
+
+      audio_driver_compute_statistics(audio_st, &stats,
+            audio_st->free_samples_count - (AUDIO_LATENCY_ADAPT_WINDOW - 1),
+            AUDIO_LATENCY_ADAPT_WINDOW - 1);
+
+      if (stats.close_to_underrun > 5.0f)
+         latency_size += latency_size / 8;
+      else if (stats.close_to_underrun == 0.0f
+            && stats.std_deviation_percentage < 12.5f)
+         latency_size -= latency_size / 16;
+   }
+
+   if (latency_size > audio_st->buffer_size)
+      latency_size     = audio_st->buffer_size;
+   if (latency_size < min_size)
+      latency_size     = MIN(min_size, audio_st->buffer_size);
+
+   audio_st->latency_window = 1;
+
+   if (latency_size != audio_st->latency_size)
+   {
+      RARCH_DBG("[Audio]: Latency target %u -> %u bytes (buffer %u).\n",
+            (unsigned)audio_st->latency_size, (unsigned)latency_size,
+            (unsigned)audio_st->buffer_size);
+      audio_st->latency_size   = latency_size;
+   }
+}
+
+/**
+ * Whether video sync paces emulation, which is what lets rate
+ * control hold the driver buffer below full. When audio sync
+ * alone paces it, blocking writes only return once the whole
+ * buffer is full, whatever latency_size is.
+ **/
+static bool audio_driver_latency_is_paced(void)
+{
+   settings_t *settings = config_get_ptr();
+#ifdef HAVE_MENU
+   /* The menu always runs with vsync on */
+   if (menu_state_get_ptr()->flags & MENU_ST_FLAG_ALIVE)
+      return true;
+#endif
+   return settings->bools.video_vsync
+      && !(runloop_state_get_ptr()->flags & RUNLOOP_FLAG_FORCE_NONBLOCK)
+      && !(input_state_get_ptr()->flags & INP_FLAG_NONBLOCKING);
+}
+
+/**
+ * Updates latency_size for the current pacing: the whole driver
+ * buffer while unpaced, and a fresh start from a quarter of it
+ * once video sync paces emulation again.
+ *
+ * @param audio_st The overall state of the audio driver.
+ * @return Whether latency_size should be adapted.
+ **/
+static bool audio_driver_latency_update_pacing(
+      audio_driver_state_t *audio_st)
+{
+   if (!audio_driver_latency_is_paced())
+   {
+      audio_st->latency_size   = audio_st->buffer_size;
+      audio_st->latency_window = 0;
+      audio_st->flags         |= AUDIO_FLAG_LATENCY_UNPACED;
+      return false;
+   }
+
+   if (audio_st->flags & AUDIO_FLAG_LATENCY_UNPACED)
+   {
+      audio_st->latency_size   = audio_st->buffer_size / 4;
+      audio_st->latency_window = 0;
+      audio_st->flags         &= ~AUDIO_FLAG_LATENCY_UNPACED;
+   }
+
+   return true;
+}
+
 /**
  * Writes audio samples to audio driver's output.
  * Will first perform DSP processing (if enabled) and resampling.
@@ -414,6 +589,7 @@ static void audio_driver_flush(
          (audio_fastforward_mute && is_fastforward))
                ? 0.0f
                : audio_st->volume_gain;
+   retro_time_t trace_start          = TRACE_EVENT_BEGIN();
 
    src_data.data_out                 = NULL;
    src_data.output_frames            = 0;
@@ -466,17 +642,33 @@ static void audio_driver_flush(
       if (audio_st->flags & AUDIO_FLAG_CONTROL)
       {
          /* Readjust the audio input rate. */
-         int avail                   = (int)audio_st->current_audio->write_avail(
+         size_t avail                = audio_st->current_audio->write_avail(
                audio_st->context_audio_data);
-         int half_size               = (int)(audio_st->buffer_size / 2);
-         int delta_mid               = avail - half_size;
-         double direction            = (double)delta_mid / half_size;
-         double adjust               = 1.0 + audio_st->rate_control_delta * direction;
+         bool adapt                  =
+                  (audio_st->flags & AUDIO_FLAG_LATENCY_ADAPTIVE)
+               && audio_driver_latency_update_pacing(audio_st);
+         /* Free space within the part of the buffer kept filled */
+         int avail_rel               = (int)avail - (int)(audio_st->buffer_size
+               - audio_st->latency_size);
+         int half_size               = (int)(audio_st->latency_size / 2);
+         int delta_mid;
+         double direction;
+         double adjust;
+
+         if (avail_rel < 0)
+            avail_rel                = 0;
+
+         delta_mid                   = avail_rel - half_size;
+         direction                   = (double)delta_mid / half_size;
+         adjust                      = 1.0 + audio_st->rate_control_delta * direction;
 
          audio_st->free_samples_buf[write_idx]
-                                     = avail;
+                                     = avail_rel;
          audio_st->source_ratio_current
                                      = audio_st->source_ratio_original * adjust;
+
+         if (adapt)
+            audio_driver_adapt_latency(audio_st, avail);
       }
 
 #if 0
@@ -567,9 +759,15 @@ static void audio_driver_flush(
          output_frames       *= sizeof(int16_t);  /* Unit: bytes */
       }
 
+      /* With adaptive latency and video sync pacing, rate control
+       * keeps the fill level within latency_size, so the blocking
+       * write rarely waits. */
       audio_st->current_audio->write(audio_st->context_audio_data,
             output_data, output_frames * 2);
+      audio_st->latency_chunk_size = output_frames * 2;
    }
+
+   TRACE_EVENT_END("audio_flush", trace_start);
 }
 
 #ifdef HAVE_AUDIOMIXER
@@ -789,6 +987,21 @@ bool audio_driver_init_internal(
          RARCH_WARN("[Audio]: Rate control was desired, but driver does not support needed features.\n");
    }
 
+   audio_driver_st.latency_size       = audio_driver_st.buffer_size;
+   audio_driver_st.latency_chunk_size = 0;
+   audio_driver_st.latency_window     = 0;
+   audio_driver_st.flags             &= ~(AUDIO_FLAG_LATENCY_ADAPTIVE
+                                        | AUDIO_FLAG_LATENCY_UNPACED);
+
+   /* Start out with a quarter of the configured latency
+    * and let underruns grow it from there. */
+   if (     (audio_driver_st.flags & AUDIO_FLAG_CONTROL)
+         && settings->bools.audio_latency_adaptive)
+   {
+      audio_driver_st.latency_size       = audio_driver_st.buffer_size / 4;
+      audio_driver_st.flags             |= AUDIO_FLAG_LATENCY_ADAPTIVE;
+   }
+
    command_event(CMD_EVENT_DSP_FILTER_INIT, NULL);
 
    audio_driver_st.free_samples_count = 0;
@@ -971,6 +1184,9 @@ bool audio_driver_dsp_filter_init(const char *device)
 void audio_driver_set_buffer_size(size_t bufsize)
 {
    audio_driver_st.buffer_size = bufsize;
+   if (     !(audio_driver_st.flags & AUDIO_FLAG_LATENCY_ADAPTIVE)
+         || (audio_driver_st.latency_size > bufsize))
+      audio_driver_st.latency_size = bufsize;
 }
 
 #ifdef HAVE_REWIND
@@ -1225,48 +1441,53 @@ bool audio_driver_mixer_add_stream(audio_mixer_stream_params_t *params)
    if (params->state == AUDIO_STREAM_STATE_NONE)
       return false;
 
-   if (!(buf = malloc(params->bufsize)))
-      return false;
+   if (params->handle)
+      handle = params->handle;
+   else
+   {
+      if (!(buf = malloc(params->bufsize)))
+         return false;
 
-   memcpy(buf, params->buf, params->bufsize);
+      memcpy(buf, params->buf, params->bufsize);
 
-   switch (params->type)
-   {
-      case AUDIO_MIXER_TYPE_WAV:
-         handle = audio_mixer_load_wav(buf, (int32_t)params->bufsize,
-               audio_driver_st.resampler_ident,
-               audio_driver_st.resampler_quality);
-         /* WAV is a special case - input buffer is not
-          * free()'d when sound playback is complete (it is
-          * converted to a PCM buffer, which is free()'d instead),
-          * so have to do it here */
-         free(buf);
-         buf = NULL;
-         break;
-      case AUDIO_MIXER_TYPE_OGG:
-         handle = audio_mixer_load_ogg(buf, (int32_t)params->bufsize);
-         break;
-      case AUDIO_MIXER_TYPE_MOD:
-         handle = audio_mixer_load_mod(buf, (int32_t)params->bufsize);
-         break;
-      case AUDIO_MIXER_TYPE_FLAC:
+      switch (params->type)
+      {
+         case AUDIO_MIXER_TYPE_WAV:
+            handle = audio_mixer_load_wav(buf, (int32_t)params->bufsize,
+                  audio_driver_st.resampler_ident,
+                  audio_driver_st.resampler_quality);
+            /* WAV is a special case - input buffer is not
+             * free()'d when sound playback is complete (it is
+             * converted to a PCM buffer, which is free()'d instead),
+             * so have to do it here */
+            free(buf);
+            buf = NULL;
+            break;
+         case AUDIO_MIXER_TYPE_OGG:
+            handle = audio_mixer_load_ogg(buf, (int32_t)params->bufsize);
+            break;
+         case AUDIO_MIXER_TYPE_MOD:
+            handle = audio_mixer_load_mod(buf, (int32_t)params->bufsize);
+            break;
+         case AUDIO_MIXER_TYPE_FLAC:
 #ifdef HAVE_DR_FLAC
-         handle = audio_mixer_load_flac(buf, (int32_t)params->bufsize);
+            handle = audio_mixer_load_flac(buf, (int32_t)params->bufsize);
 #endif
-         break;
-      case AUDIO_MIXER_TYPE_MP3:
+            break;
+         case AUDIO_MIXER_TYPE_MP3:
 #ifdef HAVE_DR_MP3
-         handle = audio_mixer_load_mp3(buf, (int32_t)params->bufsize);
+            handle = audio_mixer_load_mp3(buf, (int32_t)params->bufsize);
 #endif
-         break;
-      case AUDIO_MIXER_TYPE_NONE:
-         break;
-   }
+            break;
+         case AUDIO_MIXER_TYPE_NONE:
+            break;
+      }
 
-   if (!handle)
-   {
-      free(buf);
-      return false;
+      if (!handle)
+      {
+         free(buf);
+         return false;
+      }
    }
 
    switch (params->state)
@@ -1675,6 +1896,8 @@ bool audio_driver_start(bool is_shutdown)
             audio_st->context_audio_data, is_shutdown))
       goto error;
 
+   audio_st->latency_window = 0;
+
    RARCH_DBG("[Audio]: Started audio driver \"%s\" (is_shutdown=%s)\n",
          audio_st->current_audio->ident,
          is_shutdown ? "true" : "false");
@@ -1807,11 +2030,6 @@ bool *audio_get_bool_ptr(enum audio_action action)
 
 bool audio_compute_buffer_statistics(audio_statistics_t *stats)
 {
-   unsigned i, low_water_size, high_water_size, avg, stddev;
-   uint64_t accum                 = 0;
-   uint64_t accum_var             = 0;
-   unsigned low_water_count       = 0;
-   unsigned high_water_count      = 0;
    audio_driver_state_t *audio_st = &audio_driver_st;
    unsigned samples               = MIN(
          (unsigned)audio_st->free_samples_count,
@@ -1826,49 +2044,7 @@ bool audio_compute_buffer_statistics(audio_statistics_t *stats)
    if (!(audio_st->flags & AUDIO_FLAG_CONTROL))
       return false;
 
-#ifdef WARPUP
-   /* uint64 to double not implemented, fair chance
-    * signed int64 to double doesn't exist either */
-   /* https://forums.libretro.com/t/unsupported-platform-help/13903/ */
-   (void)stddev;
-#elif defined(_MSC_VER) && _MSC_VER <= 1200
-   /* FIXME: error C2520: conversion from unsigned __int64
-    * to double not implemented, use signed __int64 */
-   (void)stddev;
-#else
-   for (i = 1; i < samples; i++)
-      accum += audio_st->free_samples_buf[i];
-
-   avg = (unsigned)accum / (samples - 1);
-
-   for (i = 1; i < samples; i++)
-   {
-      int diff     = avg - audio_st->free_samples_buf[i];
-      accum_var   += diff * diff;
-   }
-
-   stddev                                = (unsigned)
-      sqrt((double)accum_var / (samples - 2));
-
-   stats->average_buffer_saturation      = (1.0f - (float)avg
-         / audio_st->buffer_size) * 100.0;
-   stats->std_deviation_percentage       = ((float)stddev
-         / audio_st->buffer_size)  * 100.0;
-#endif
-
-   low_water_size  = (unsigned)(audio_st->buffer_size * 3 / 4);
-   high_water_size = (unsigned)(audio_st->buffer_size     / 4);
-
-   for (i = 1; i < samples; i++)
-   {
-      if (audio_st->free_samples_buf[i] >= low_water_size)
-         low_water_count++;
-      else if (audio_st->free_samples_buf[i] <= high_water_size)
-         high_water_count++;
-   }
-
-   stats->close_to_underrun      = (100.0f * low_water_count)  / (samples - 1);
-   stats->close_to_blocking      = (100.0f * high_water_count) / (samples - 1);
+   audio_driver_compute_statistics(audio_st, stats, 1, samples - 1);
 
    return true;
 }
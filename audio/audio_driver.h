@@ -64,6 +64,9 @@ typedef struct audio_mixer_stream
 typedef struct audio_mixer_stream_params
 {
    void *buf;
+   /* Sound already loaded from buf, e.g. by a task worker,
+    * taken over when the stream is added. NULL to load it. */
+   audio_mixer_sound_t *handle;
    char *basename;
    audio_mixer_stop_cb_t cb;
    size_t bufsize;
@@ -226,9 +229,21 @@ typedef struct
    size_t rewind_size;
 #endif
    size_t buffer_size;
+   /**
+    * Part of buffer_size kept filled, same as buffer_size
+    * unless AUDIO_FLAG_LATENCY_ADAPTIVE is set and video
+    * sync paces emulation.
+    */
+   size_t latency_size;
+   /**
+    * Bytes written to the driver by the last flush.
+    */
+   size_t latency_chunk_size;
    size_t data_ptr;
 
    unsigned free_samples_buf[AUDIO_BUFFER_FREE_SAMPLES_COUNT];
+   /* Flushes since latency_size last changed */
+   unsigned latency_window;
 
 #ifdef HAVE_AUDIOMIXER
    float mixer_volume_gain;
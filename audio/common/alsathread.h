@@ -19,18 +19,17 @@
 
 #include <alsa/asoundlib.h>
 #include <boolean.h>
-#include "queues/fifo_queue.h"
+#include "queues/spsc_queue.h"
 #include "rthreads/rthreads.h"
 #include "./alsa.h"
 
 typedef struct alsa_thread_info
 {
    snd_pcm_t *pcm;
-   fifo_buffer_t *buffer;
+   spsc_queue_t *buffer;
    sthread_t *worker_thread;
-   slock_t *fifo_lock;
    scond_t *cond;
-   slock_t *cond_lock;
+   slock_t *cond_lock; /* Guards waiting on cond, not buffer */
    alsa_stream_info_t stream_info;
    volatile bool thread_dead;
 } alsa_thread_info_t;
@@ -83,24 +83,21 @@ static void alsa_microphone_worker_thread(void *microphone_context)
 
    while (!microphone->info.thread_dead)
    { /* Until we're told to stop... */
-      size_t avail;
       size_t fifo_size;
       snd_pcm_sframes_t frames;
       int errnum = 0;
 
-      /* Lock the incoming sample queue (the main thread may block) */
-      slock_lock(microphone->info.fifo_lock);
-
       /* Fill the incoming sample queue with whatever we recently read */
-      avail     = FIFO_WRITE_AVAIL(microphone->info.buffer);
-      fifo_size = MIN(microphone->info.stream_info.period_size, avail);
-      fifo_write(microphone->info.buffer, buf, fifo_size);
+      fifo_size = spsc_queue_write(microphone->info.buffer, buf,
+            microphone->info.stream_info.period_size);
 
       /* Tell the main thread that it's okay to query the mic again */
-      scond_signal(microphone->info.cond);
-
-      /* Unlock the incoming sample queue (the main thread may resume) */
-      slock_unlock(microphone->info.fifo_lock);
+      if (fifo_size)
+      {
+         slock_lock(microphone->info.cond_lock);
+         scond_signal(microphone->info.cond);
+         slock_unlock(microphone->info.cond_lock);
+      }
 
       /* If underrun, fill rest with silence. */
       memset(buf + fifo_size, 0, microphone->info.stream_info.period_size - fifo_size);
@@ -199,64 +196,38 @@ static int alsa_thread_microphone_read(void *driver_context, void *microphone_co
 
    if (alsa->nonblock)
    { /* If driver interactions shouldn't block... */
-      size_t avail;
-      size_t write_amt;
-
-      /* "Hey, I'm gonna borrow the queue." */
-      slock_lock(microphone->info.fifo_lock);
-
-      avail           = FIFO_READ_AVAIL(microphone->info.buffer);
-      write_amt       = MIN(avail, size);
-
       /* "It's okay if you don't have any new samples, I'll just check in on you later." */
-      fifo_read(microphone->info.buffer, buf, write_amt);
-
-      /* "Here, take this queue back." */
-      slock_unlock(microphone->info.fifo_lock);
-
-      return (int)write_amt;
+      return (int)spsc_queue_read(microphone->info.buffer, buf, size);
    }
    else
    {
       size_t read = 0;
       while (read < size && !microphone->info.thread_dead)
       { /* Until we've read all requested samples (or we're told to stop)... */
-         size_t avail;
-
-         /* "Hey, I'm gonna borrow the queue." */
-         slock_lock(microphone->info.fifo_lock);
 
-         avail = FIFO_READ_AVAIL(microphone->info.buffer);
+         /* "I'll just go ahead and consume all these samples..."
+          * (As many as will fit in buf, or as many as are available.) */
+         size_t read_amt = spsc_queue_read(microphone->info.buffer,
+               (uint8_t*)buf + read, size - read);
 
-         if (avail == 0)
+         if (read_amt)
+            read += read_amt;
+         else
          { /* "Oh, wait, it's empty." */
 
-            /* "Here, take it back..." */
-            slock_unlock(microphone->info.fifo_lock);
-
-            /* "...I'll just wait right here." */
+            /* "I'll just wait right here." */
             slock_lock(microphone->info.cond_lock);
 
-            /* "Unless we're closing up shop..." */
-            if (!microphone->info.thread_dead)
+            /* "Unless we're closing up shop, or you produced
+             * some samples while I wasn't looking..." */
+            if (     !microphone->info.thread_dead
+                  && !spsc_queue_read_avail(microphone->info.buffer))
                /* "...let me know when you've produced some samples." */
                scond_wait(microphone->info.cond, microphone->info.cond_lock);
 
             /* "Oh, you're ready? Okay, I'm gonna continue." */
             slock_unlock(microphone->info.cond_lock);
          }
-         else
-         {
-            size_t read_amt = MIN(size - read, avail);
-
-            /* "I'll just go ahead and consume all these samples..."
-             * (As many as will fit in buf, or as many as are available.) */
-            fifo_read(microphone->info.buffer,buf + read, read_amt);
-
-            /* "I'm done, you can take the queue back now." */
-            slock_unlock(microphone->info.fifo_lock);
-            read += read_amt;
-         }
 
          /* "I'll be right back..." */
       }
@@ -291,11 +262,10 @@ static void *alsa_thread_microphone_open_mic(void *driver_context,
       goto error;
    }
 
-   microphone->info.fifo_lock = slock_new();
    microphone->info.cond_lock = slock_new();
    microphone->info.cond = scond_new();
-   microphone->info.buffer = fifo_new(microphone->info.stream_info.buffer_size);
-   if (!microphone->info.fifo_lock || !microphone->info.cond_lock || !microphone->info.cond || !microphone->info.buffer || !microphone->info.pcm)
+   microphone->info.buffer = spsc_queue_new(microphone->info.stream_info.buffer_size);
+   if (!microphone->info.cond_lock || !microphone->info.cond || !microphone->info.buffer || !microphone->info.pcm)
       goto error;
 
    microphone->info.worker_thread = sthread_create(alsa_microphone_worker_thread, microphone);
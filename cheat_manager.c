@@ -326,6 +326,8 @@ static void cheat_manager_free(void)
    if (cheat_st->memory_size_list)
       free(cheat_st->memory_size_list);
 
+   core_memory_map_free(&cheat_st->memory_map);
+
    cheat_st->cheats                    = NULL;
    cheat_st->size                      = 0;
    cheat_st->buf_size                  = 0;
@@ -803,6 +805,8 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
       cheat_st->memory_size_list = NULL;
    }
 
+   core_memory_map_free(&cheat_st->memory_map);
+
    if (sys_info && sys_info->mmaps.num_descriptors > 0)
    {
       for (i = 0; i < sys_info->mmaps.num_descriptors; i++)
@@ -867,6 +871,22 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
 
    }
 
+   /* Search addresses run over all buffers back to back */
+   {
+      size_t *sizes = (size_t*)malloc(
+            cheat_st->num_memory_buffers * sizeof(size_t));
+
+      if (sizes)
+      {
+         for (i = 0; i < cheat_st->num_memory_buffers; i++)
+            sizes[i] = cheat_st->memory_size_list[i];
+         core_memory_map_init_regions(&cheat_st->memory_map,
+               cheat_st->memory_buf_list, sizes,
+               cheat_st->num_memory_buffers);
+         free(sizes);
+      }
+   }
+
    cheat_st->num_matches = (cheat_st->total_memory_size * 8) / (1 << cheat_st->search_bit_size);
 
 #if 0
@@ -939,22 +959,16 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
 
 static unsigned translate_address(unsigned address, unsigned char **curr)
 {
-   unsigned             offset = 0;
-   unsigned                  i = 0;
-   cheat_manager_t   *cheat_st = &cheat_manager_state;
+   size_t                         offset = 0;
+   cheat_manager_t             *cheat_st = &cheat_manager_state;
+   const rarch_memory_descriptor_t *desc = core_memory_map_find(
+         &cheat_st->memory_map, address, &offset);
 
-   for (i = 0; i < cheat_st->num_memory_buffers; i++)
-   {
-      if ((address >= offset) && (address < offset + cheat_st->memory_size_list[i]))
-      {
-         *curr = cheat_st->memory_buf_list[i];
-         break;
-      }
-      else
-         offset += cheat_st->memory_size_list[i];
-   }
+   if (!desc)
+      return cheat_st->total_memory_size;
 
-   return offset;
+   *curr = (unsigned char*)desc->core.ptr;
+   return address - (unsigned)offset;
 }
 
 static void cheat_manager_setup_search_meta(
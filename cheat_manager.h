@@ -21,6 +21,7 @@
 #include <retro_common_api.h>
 
 #include "../setting_list.h"
+#include "core_memory_map.h"
 
 RETRO_BEGIN_DECLS
 
@@ -158,6 +159,7 @@ struct item_cheat
 struct cheat_manager
 {
    struct item_cheat working_cheat; /* retro_time_t alignment */
+   core_memory_map_t memory_map;    /* Search addresses to memory buffers */
    struct item_cheat *cheats;
    uint8_t *curr_memory_buf;
    uint8_t *prev_memory_buf;
@@ -90,6 +90,7 @@ static rcheevos_locals_t rcheevos_locals =
    {0},  /* game */
 #endif
    {{0}},/* memory */
+   {0},  /* memory_map */
 #ifdef HAVE_THREADS
    CMD_EVENT_NONE, /* queued_command */
    false, /* game_placard_requested */
@@ -243,16 +244,27 @@ static int rcheevos_init_memory(rcheevos_locals_t* locals)
          rcheevos_get_core_memory_info, console_id);
 
    free(descriptors);
+
+   /* Achievement conditions read memory every frame,
+    * resolve their addresses through a page table
+    * instead of walking the regions */
+   core_memory_map_free(&locals->memory_map);
+   core_memory_map_init_regions(&locals->memory_map,
+         locals->memory.data, locals->memory.size,
+         locals->memory.count);
+
    return result;
 }
 
 uint8_t* rcheevos_patch_address(unsigned address)
 {
+   size_t avail;
    /* Memory map was not previously initialized
     * (no achievements for this game?), try now */
    if (rcheevos_locals.memory.count == 0)
       rcheevos_init_memory(&rcheevos_locals);
-   return rc_libretro_memory_find(&rcheevos_locals.memory, address);
+   return core_memory_map_get_pointer(&rcheevos_locals.memory_map,
+         address, &avail);
 }
 
 #ifndef HAVE_RC_CLIENT
@@ -260,9 +272,9 @@ uint8_t* rcheevos_patch_address(unsigned address)
 static uint32_t rcheevos_peek(uint32_t address,
       uint32_t num_bytes, void* ud)
 {
-   uint32_t avail;
-   uint8_t* data = rc_libretro_memory_find_avail(
-         &rcheevos_locals.memory, address, &avail);
+   size_t avail;
+   uint8_t* data = core_memory_map_get_pointer(
+         &rcheevos_locals.memory_map, address, &avail);
 
    if (data && avail >= num_bytes)
    {
@@ -1259,6 +1271,7 @@ bool rcheevos_unload(void)
 
    if (rcheevos_locals.memory.count > 0)
       rc_libretro_memory_destroy(&rcheevos_locals.memory);
+   core_memory_map_free(&rcheevos_locals.memory_map);
 
    if (was_loaded)
    {
@@ -1874,8 +1887,9 @@ static void rcheevos_runtime_event_handler(
 
 static int rcheevos_runtime_address_validator(uint32_t address)
 {
-   return rc_libretro_memory_find(
-            &rcheevos_locals.memory, address) != NULL;
+   size_t avail;
+   return core_memory_map_get_pointer(
+            &rcheevos_locals.memory_map, address, &avail) != NULL;
 }
 
 static void rcheevos_validate_memrefs(rcheevos_locals_t* locals)
@@ -1897,6 +1911,7 @@ static void rcheevos_validate_memrefs(rcheevos_locals_t* locals)
          if (locals->memory.total_size != 0)
          {
             locals->memory.count = 0;
+            core_memory_map_free(&locals->memory_map);
             return;
          }
       }
@@ -2328,6 +2343,17 @@ static void rcheevos_show_game_placard(void)
 static uint32_t rcheevos_client_read_memory(uint32_t address,
    uint8_t* buffer, uint32_t num_bytes, rc_client_t* client)
 {
+   size_t avail;
+   const uint8_t* data = core_memory_map_get_pointer(
+         &rcheevos_locals.memory_map, address, &avail);
+
+   if (data && avail >= num_bytes)
+   {
+      memcpy(buffer, data, num_bytes);
+      return num_bytes;
+   }
+
+   /* Reads spanning several regions */
    return rc_libretro_memory_read(&rcheevos_locals.memory, address, buffer, num_bytes);
 }
 
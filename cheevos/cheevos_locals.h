@@ -33,6 +33,7 @@
 #include <retro_common_api.h>
 
 #include "../command.h"
+#include "../core_memory_map.h"
 #include "../verbosity.h"
 
 RETRO_BEGIN_DECLS
@@ -198,6 +199,7 @@ typedef struct rcheevos_locals_t
    rcheevos_game_info_t game;         /* information about the current game */
 #endif
    rc_libretro_memory_regions_t memory;/* achievement addresses to core memory mappings */
+   core_memory_map_t memory_map;      /* page table over the memory regions */
 
 #ifdef HAVE_THREADS
    enum event_command queued_command; /* action queued by background thread to be run on main thread */
@@ -28,6 +28,7 @@
 #include <streams/stdin_stream.h>
 #include <streams/file_stream.h>
 #include <string/stdstring.h>
+#include <features/features_trace.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -56,6 +57,7 @@
 #include "autosave.h"
 #include "command.h"
 #include "core_info.h"
+#include "core_memory_map.h"
 #include "cheat_manager.h"
 #include "content.h"
 #include "dynamic.h"
@@ -127,7 +129,7 @@ static bool command_get_arg(const char *tok,
             return false;
 
          if (arg)
-            *arg = argument + 1;
+            *arg = (*argument == ' ') ? argument + 1 : argument;
 
          if (index)
             *index = i;
@@ -756,6 +758,21 @@ bool command_play_replay_slot(command_t *cmd, const char *arg)
 }
 
 
+bool command_seek_replay(command_t *cmd, const char *arg)
+{
+#ifdef HAVE_BSV_MOVIE
+   char reply[128]     = "";
+   uint64_t frame      = (uint64_t)strtoull(arg, NULL, 10);
+   bool ret            = bsv_movie_seek_to_frame(input_state_get_ptr(), frame);
+   snprintf(reply, sizeof(reply) - 1, "SEEK_REPLAY %llu%s",
+         (unsigned long long)frame, ret ? "" : " -1");
+   cmd->replier(cmd, reply, strlen(reply));
+   return ret;
+#else
+   return false;
+#endif
+}
+
 #if defined(HAVE_CHEEVOS)
 bool command_read_ram(command_t *cmd, const char *arg)
 {
@@ -828,56 +845,6 @@ bool command_version(command_t *cmd, const char* arg)
    return true;
 }
 
-static const rarch_memory_descriptor_t* command_memory_get_descriptor(const rarch_memory_map_t* mmap, unsigned address, size_t* offset)
-{
-   const rarch_memory_descriptor_t* desc = mmap->descriptors;
-   const rarch_memory_descriptor_t* end  = desc + mmap->num_descriptors;
-
-   for (; desc < end; desc++)
-   {
-      if (desc->core.select == 0)
-      {
-         /* if select is 0, attempt to explicitly match the address */
-         if (address >= desc->core.start && address < desc->core.start + desc->core.len)
-         {
-            *offset = address - desc->core.start;
-            return desc;
-         }
-      }
-      else
-      {
-         /* otherwise, attempt to match the address by matching the select bits */
-         if (((desc->core.start ^ address) & desc->core.select) == 0)
-         {
-            /* adjust the address to the start of the descriptor */
-            unsigned desc_offset = address - (unsigned)desc->core.start;
-
-            /* address is unsigned. we only need that much of the disconnect mask */
-            unsigned mask = (unsigned)desc->core.disconnect;
-
-            /* this magic logic is copied from mmap_reduce. it removes any bits from
-             * address that are non-zero in the disconnect field. bits above the
-             * removed bits are shifted down to fill the gap. */
-            while (mask)
-            {
-               const unsigned tmp = (mask - 1) & ~mask;
-               desc_offset = (desc_offset & tmp) | ((desc_offset >> 1) & ~tmp);
-               mask        = (mask & (mask - 1)) >> 1;
-            }
-
-            /* we've calculated the actual offset of the data within the descriptor */
-            *offset = desc_offset;
-
-            /* sanity check - make sure the descriptor is large enough to hold the target address */
-            if (desc_offset < desc->core.len)
-               return desc;
-         }
-      }
-   }
-
-   return NULL;
-}
-
 static uint8_t *command_memory_get_pointer(
       const rarch_system_info_t* sys_info,
       unsigned address,
@@ -886,12 +853,12 @@ static uint8_t *command_memory_get_pointer(
       char *reply_at,
       size_t len)
 {
-   if (!sys_info || sys_info->mmaps.num_descriptors == 0)
+   if (!sys_info || !sys_info->mmaps.pages)
       strlcpy(reply_at, " -1 no memory map defined\n", len);
    else
    {
       size_t offset;
-      const rarch_memory_descriptor_t* desc = command_memory_get_descriptor(&sys_info->mmaps, address, &offset);
+      const rarch_memory_descriptor_t* desc = core_memory_map_find(sys_info->mmaps.pages, address, &offset);
       if (!desc)
          strlcpy(reply_at, " -1 no descriptor for address\n", len);
       else if (!desc->core.ptr)
@@ -947,6 +914,80 @@ bool command_get_status(command_t *cmd, const char* arg)
    return true;
 }
 
+/* Replies with the frame limiter pacing error histogram:
+ * GET_FRAME_LIMIT_STATS frames=N avg_us=N max_us=N margin_us=N hist=<50:N,100:N,...,inf:N> */
+bool command_get_frame_limit_stats(command_t *cmd, const char* arg)
+{
+   unsigned i;
+   size_t _len;
+   char reply[512];
+   runloop_state_t *runloop_st              = runloop_state_get_ptr();
+   const runloop_frame_limit_stats_t *stats = &runloop_st->frame_limit_stats;
+
+   _len = snprintf(reply, sizeof(reply),
+         "GET_FRAME_LIMIT_STATS frames=%" PRIu64 " avg_us=%u max_us=%u margin_us=%u hist=",
+         stats->count,
+         stats->count ? (unsigned)(stats->total / stats->count) : 0,
+         (unsigned)stats->max,
+         (unsigned)runloop_st->frame_limit_margin);
+
+   for (i = 0; i < RUNLOOP_FRAME_LIMIT_HIST_SIZE && _len < sizeof(reply); i++)
+   {
+      if (i < RUNLOOP_FRAME_LIMIT_HIST_SIZE - 1)
+         _len += snprintf(reply + _len, sizeof(reply) - _len,
+               "%u:%" PRIu64 ",",
+               (unsigned)RUNLOOP_FRAME_LIMIT_HIST_BOUND(i), stats->hist[i]);
+      else
+         _len += snprintf(reply + _len, sizeof(reply) - _len,
+               "inf:%" PRIu64 "\n", stats->hist[i]);
+   }
+
+   if (_len >= sizeof(reply))
+      _len = sizeof(reply) - 1;
+
+   cmd->replier(cmd, reply, _len);
+
+   return true;
+}
+
+/* Records trace events, streaming them to the file given
+ * as argument if any. Reply: TRACE_START <0|1> */
+bool command_trace_start(command_t *cmd, const char* arg)
+{
+   char reply[32];
+   bool ret    = trace_event_start(arg);
+   size_t _len = snprintf(reply, sizeof(reply), "TRACE_START %d\n",
+         ret ? 1 : 0);
+
+   if (ret)
+      trace_event_set_thread_name("Main");
+   else
+      RARCH_ERR("[Trace] Could not open \"%s\".\n", arg);
+
+   cmd->replier(cmd, reply, _len);
+   return ret;
+}
+
+bool command_trace_stop(command_t *cmd, const char* arg)
+{
+   trace_event_stop();
+   cmd->replier(cmd, "TRACE_STOP 1\n", STRLEN_CONST("TRACE_STOP 1\n"));
+   return true;
+}
+
+/* Writes the events recorded so far to the file given
+ * as argument. Reply: TRACE_DUMP <0|1> */
+bool command_trace_dump(command_t *cmd, const char* arg)
+{
+   char reply[32];
+   bool ret    = !string_is_empty(arg) && trace_event_dump(arg);
+   size_t _len = snprintf(reply, sizeof(reply), "TRACE_DUMP %d\n",
+         ret ? 1 : 0);
+
+   cmd->replier(cmd, reply, _len);
+   return ret;
+}
+
 bool command_read_memory(command_t *cmd, const char *arg)
 {
    unsigned i;
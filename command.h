@@ -413,10 +413,15 @@ struct cmd_action_map
 
 bool command_version(command_t *cmd, const char* arg);
 bool command_get_status(command_t *cmd, const char* arg);
+bool command_get_frame_limit_stats(command_t *cmd, const char* arg);
+bool command_trace_start(command_t *cmd, const char* arg);
+bool command_trace_stop(command_t *cmd, const char* arg);
+bool command_trace_dump(command_t *cmd, const char* arg);
 bool command_get_config_param(command_t *cmd, const char* arg);
 bool command_show_osd_msg(command_t *cmd, const char* arg);
 bool command_load_state_slot(command_t *cmd, const char* arg);
 bool command_play_replay_slot(command_t *cmd, const char* arg);
+bool command_seek_replay(command_t *cmd, const char* arg);
 #ifdef HAVE_CHEEVOS
 bool command_read_ram(command_t *cmd, const char *arg);
 bool command_write_ram(command_t *cmd, const char *arg);
@@ -430,6 +435,10 @@ static const struct cmd_action_map action_map[] = {
 #endif
    { "VERSION",          command_version,          "No argument"},
    { "GET_STATUS",       command_get_status,       "No argument" },
+   { "GET_FRAME_LIMIT_STATS", command_get_frame_limit_stats, "No argument" },
+   { "TRACE_START",      command_trace_start,      "[trace file to stream to]" },
+   { "TRACE_STOP",       command_trace_stop,       "No argument" },
+   { "TRACE_DUMP",       command_trace_dump,       "<trace file>" },
    { "GET_CONFIG_PARAM", command_get_config_param, "<param name>" },
    { "SHOW_MSG",         command_show_osd_msg,     "No argument" },
 #if defined(HAVE_CHEEVOS)
@@ -443,6 +452,7 @@ static const struct cmd_action_map action_map[] = {
 
    { "LOAD_STATE_SLOT",command_load_state_slot, "<slot number>"},
    { "PLAY_REPLAY_SLOT",command_play_replay_slot, "<slot number>"},
+   { "SEEK_REPLAY",     command_seek_replay,      "<frame number>"},
 };
 
 static const struct cmd_map map[] = {
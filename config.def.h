@@ -870,6 +870,9 @@
 #define DEFAULT_SYSTEMFILES_IN_CONTENT_DIR false
 #define DEFAULT_SCREENSHOTS_IN_CONTENT_DIR false
 
+/* Trade PNG screenshot size for encoding speed */
+#define DEFAULT_SCREENSHOT_FAST_COMPRESSION false
+
 #if defined(RS90) || defined(RETROFW) || defined(MIYOO) || defined(SWITCH) || defined(ORBIS) || defined(__WINRT__)
 #define DEFAULT_MENU_TOGGLE_GAMEPAD_COMBO INPUT_COMBO_START_SELECT
 #elif defined(_XBOX1) || defined(__PS3__) || defined(_XBOX360) || defined(DINGUX)
@@ -1151,6 +1154,10 @@
  * is allowed to adjust input rate. */
 #define DEFAULT_RATE_CONTROL_DELTA  0.005f
 
+/* Adjust the audio latency at runtime, using
+ * audio_latency as the upper bound. */
+#define DEFAULT_AUDIO_LATENCY_ADAPTIVE false
+
 /* Maximum timing skew. Defines how much adjust_system_rates
  * is allowed to adjust input rate. */
 #define DEFAULT_MAX_TIMING_SKEW  0.05f
@@ -1383,6 +1390,11 @@
 /* Enable runloop for variable refresh rate screens. Force x1 speed while handling fast forward too. */
 #define DEFAULT_VRR_RUNLOOP_ENABLE false
 
+/* Pace frames when limiting the framerate by sleeping
+ * until shortly before the deadline and spinning the
+ * rest, instead of sleeping in whole milliseconds. */
+#define DEFAULT_FRAME_LIMIT_PRECISE false
+
 /* Run core logic one or more frames ahead then load the state back to reduce perceived input lag. */
 #define DEFAULT_RUN_AHEAD_FRAMES 1
 
@@ -1578,6 +1590,23 @@
 
 #define DEFAULT_GFX_THUMBNAIL_UPSCALE_THRESHOLD 0
 
+/* Thumbnails larger than this (in pixels, either
+ * dimension) are downscaled after decoding.
+ * 0 disables downscaling */
+#define DEFAULT_GFX_THUMBNAIL_DOWNSCALE_THRESHOLD 0
+
+/* Memory budget of the decoded thumbnail cache, in MB.
+ * 0 disables the cache */
+#if defined(HAVE_LIBNX) || defined(_3DS) || defined(GEKKO) || defined(PSP) || defined(VITA) || defined(PS2) || defined(WIIU)
+#define DEFAULT_GFX_THUMBNAIL_CACHE_SIZE 8
+#else
+#define DEFAULT_GFX_THUMBNAIL_CACHE_SIZE 64
+#endif
+
+/* Keep downscaled thumbnails in the cache directory,
+ * so they need not be downscaled again */
+#define DEFAULT_GFX_THUMBNAIL_DISK_CACHE false
+
 #ifdef HAVE_MENU
 #if defined(RS90) || defined(MIYOO)
 /* The RS-90 has a hardware clock that is neither
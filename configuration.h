@@ -271,6 +271,8 @@ typedef struct settings
       unsigned gfx_thumbnails;
       unsigned menu_left_thumbnails;
       unsigned gfx_thumbnail_upscale_threshold;
+      unsigned gfx_thumbnail_downscale_threshold;
+      unsigned gfx_thumbnail_cache_size;
       unsigned menu_rgui_thumbnail_downscaler;
       unsigned menu_rgui_thumbnail_delay;
       unsigned menu_rgui_color_theme;
@@ -632,6 +634,7 @@ typedef struct settings
       bool audio_enable_menu_scroll;
       bool audio_sync;
       bool audio_rate_control;
+      bool audio_latency_adaptive;
       bool audio_fastforward_mute;
       bool audio_fastforward_speedup;
 #ifdef TARGET_OS_IOS
@@ -722,6 +725,7 @@ typedef struct settings
       bool menu_battery_level_enable;
       bool menu_core_enable;
       bool menu_show_sublabels;
+      bool gfx_thumbnail_disk_cache;
       bool menu_dynamic_wallpaper_enable;
       bool menu_mouse_enable;
       bool menu_pointer_enable;
@@ -943,6 +947,7 @@ typedef struct settings
       bool rewind_enable;
       bool fastforward_frameskip;
       bool vrr_runloop_enable;
+      bool frame_limit_precise;
       bool menu_throttle_framerate;
       bool apply_cheats_after_toggle;
       bool apply_cheats_after_load;
@@ -995,6 +1000,7 @@ typedef struct settings
       bool savefiles_in_content_dir;
       bool savestates_in_content_dir;
       bool screenshots_in_content_dir;
+      bool screenshot_fast_compression;
       bool systemfiles_in_content_dir;
       bool ssh_enable;
 #ifdef HAVE_LAKKA_SWITCH
@@ -92,6 +92,13 @@ void content_set_does_not_need_content(void);
 
 void content_unset_does_not_need_content(void);
 
+/* Returns false while the CRC task started when the
+ * content was loaded is still running, otherwise sets
+ * 'crc' to the content CRC. Never blocks */
+bool content_poll_crc(uint32_t *crc);
+
+/* Returns the content CRC, running the task queue until
+ * the CRC task has finished if it has not yet */
 uint32_t content_get_crc(void);
 
 void content_deinit(void);
@@ -0,0 +1,298 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "core_memory_map.h"
+
+enum core_memory_page_match
+{
+   CORE_MEMORY_PAGE_NONE = 0,
+   CORE_MEMORY_PAGE_ALL,
+   CORE_MEMORY_PAGE_PARTIAL
+};
+
+/* Removes the bits set in 'mask' from 'addr', shifting
+ * the bits above each removed bit down to fill the gap
+ * (same as mmap_reduce() in runloop.c) */
+static size_t core_memory_map_reduce(size_t addr, size_t mask)
+{
+   while (mask)
+   {
+      size_t tmp = (mask - 1) & ~mask;
+      addr       = (addr & tmp) | ((addr >> 1) & ~tmp);
+      mask       = (mask & (mask - 1)) >> 1;
+   }
+
+   return addr;
+}
+
+static unsigned core_memory_map_num_bits(size_t n)
+{
+   unsigned bits = 0;
+   while (n)
+   {
+      bits++;
+      n >>= 1;
+   }
+   return bits;
+}
+
+const rarch_memory_descriptor_t *core_memory_map_find_slow(
+      const core_memory_map_t *map, size_t address, size_t *offset)
+{
+   const rarch_memory_descriptor_t *desc = map->descriptors;
+   const rarch_memory_descriptor_t *end  = desc + map->num_descriptors;
+
+   for (; desc < end; desc++)
+   {
+      if (desc->core.select == 0)
+      {
+         /* If select is 0, attempt to explicitly match the address */
+         if (     address >= desc->core.start
+               && address -  desc->core.start < desc->core.len)
+         {
+            *offset = address - desc->core.start;
+            return desc;
+         }
+      }
+      /* Otherwise, attempt to match the address
+       * by matching the select bits */
+      else if (((desc->core.start ^ address) & desc->core.select) == 0)
+      {
+         /* Remove the disconnected bits from the address
+          * relative to the start of the descriptor, which
+          * gives the offset of the data within it */
+         size_t desc_offset = core_memory_map_reduce(
+               address - desc->core.start, desc->core.disconnect);
+
+         /* Make sure the descriptor is large enough
+          * to hold the target address */
+         if (desc_offset < desc->core.len)
+         {
+            *offset = desc_offset;
+            return desc;
+         }
+      }
+   }
+
+   return NULL;
+}
+
+/* Tells whether all, none or only some of the addresses
+ * in [page, page + page_mask] resolve to 'desc'. When all
+ * of them do, the offset of 'page' within 'desc' is
+ * returned in 'offset' and the remaining addresses
+ * follow it without gaps. */
+static enum core_memory_page_match core_memory_map_match_page(
+      const rarch_memory_descriptor_t *desc,
+      size_t page, size_t page_mask, size_t *offset)
+{
+   size_t desc_offset;
+
+   if (desc->core.select == 0)
+   {
+      size_t start = desc->core.start;
+      size_t len   = desc->core.len;
+
+      if (page + page_mask < start)
+         return CORE_MEMORY_PAGE_NONE;
+      if (page >= start && page - start >= len)
+         return CORE_MEMORY_PAGE_NONE;
+      if (     page >= start
+            && len  -  (page - start) > page_mask)
+      {
+         *offset = page - start;
+         return CORE_MEMORY_PAGE_ALL;
+      }
+      return CORE_MEMORY_PAGE_PARTIAL;
+   }
+
+   if (((desc->core.start ^ page) & desc->core.select & ~page_mask) != 0)
+      return CORE_MEMORY_PAGE_NONE;
+
+   /* Select or disconnect bits inside the page mean the
+    * page is mirrored or interleaved at a finer grain */
+   if ((desc->core.select | desc->core.disconnect) & page_mask)
+      return CORE_MEMORY_PAGE_PARTIAL;
+
+   desc_offset = core_memory_map_reduce(
+         page - desc->core.start, desc->core.disconnect);
+
+   if (desc_offset >= desc->core.len)
+      return CORE_MEMORY_PAGE_NONE;
+   if (desc->core.len - desc_offset <= page_mask)
+      return CORE_MEMORY_PAGE_PARTIAL;
+
+   *offset = desc_offset;
+   return CORE_MEMORY_PAGE_ALL;
+}
+
+static void core_memory_map_build_page(core_memory_map_t *map,
+      core_memory_page_t *page, size_t address)
+{
+   unsigned i;
+
+   page->desc   = NULL;
+   page->ptr    = NULL;
+   page->offset = 0;
+
+   /* The first descriptor matching an address wins,
+    * so stop at the first one touching the page */
+   for (i = 0; i < map->num_descriptors; i++)
+   {
+      size_t offset                         = 0;
+      const rarch_memory_descriptor_t *desc = &map->descriptors[i];
+
+      switch (core_memory_map_match_page(desc, address, map->mask, &offset))
+      {
+         case CORE_MEMORY_PAGE_NONE:
+            continue;
+         case CORE_MEMORY_PAGE_ALL:
+            page->desc   = desc;
+            page->offset = offset;
+            if (desc->core.ptr)
+               page->ptr = (uint8_t*)desc->core.ptr
+                  + desc->core.offset + offset;
+            return;
+         case CORE_MEMORY_PAGE_PARTIAL:
+            page->desc   = &map->split;
+            return;
+      }
+   }
+}
+
+bool core_memory_map_init(core_memory_map_t *map,
+      const rarch_memory_descriptor_t *descriptors,
+      unsigned num_descriptors)
+{
+   unsigned i;
+   unsigned top_bits;
+   size_t top          = 0;
+   size_t grain        = 0;
+   size_t num_pages    = 0;
+   unsigned shift      = 0;
+
+   memset(map, 0, sizeof(*map));
+
+   if (num_descriptors == 0)
+      return true;
+
+   if (!(map->descriptors = (rarch_memory_descriptor_t*)malloc(
+               num_descriptors * sizeof(*descriptors))))
+      return false;
+
+   memcpy(map->descriptors, descriptors,
+         num_descriptors * sizeof(*descriptors));
+   map->num_descriptors = num_descriptors;
+
+   /* Size the table to the highest address any descriptor
+    * reaches directly; anything above that is a mirror and
+    * takes the slow path. Pages are as large as descriptor
+    * boundaries allow, so most pages map to one descriptor. */
+   for (i = 0; i < num_descriptors; i++)
+   {
+      const struct retro_memory_descriptor *core = &descriptors[i].core;
+      size_t select = core->select;
+
+      if (select != 0)
+      {
+         top   |= select | core->start;
+         grain |= select & (~select + 1);
+      }
+      else if (core->len > 0 && core->start + core->len - 1 > top)
+         top    = core->start + core->len - 1;
+
+      grain    |= core->start | core->len | core->disconnect;
+   }
+
+   top_bits = core_memory_map_num_bits(top);
+
+   if (grain)
+      while (!(grain & ((size_t)1 << shift)))
+         shift++;
+   if (!grain || shift > top_bits)
+      shift = top_bits;
+   if (shift >= sizeof(size_t) * 8)
+      shift = sizeof(size_t) * 8 - 1;
+
+   while ((top >> shift) >= CORE_MEMORY_MAP_MAX_PAGES)
+      shift++;
+
+   num_pages = (top >> shift) + 1;
+
+   if (!(map->pages = (core_memory_page_t*)malloc(
+               num_pages * sizeof(*map->pages))))
+   {
+      core_memory_map_free(map);
+      return false;
+   }
+
+   map->num_pages = num_pages;
+   map->shift     = shift;
+   map->mask      = ((size_t)1 << shift) - 1;
+
+   for (i = 0; i < num_pages; i++)
+      core_memory_map_build_page(map, &map->pages[i], (size_t)i << shift);
+
+   return true;
+}
+
+bool core_memory_map_init_regions(core_memory_map_t *map,
+      uint8_t * const *data, const size_t *sizes, unsigned count)
+{
+   unsigned i;
+   bool ret                               = false;
+   size_t start                           = 0;
+   unsigned num_descriptors               = 0;
+   rarch_memory_descriptor_t *descriptors = NULL;
+
+   memset(map, 0, sizeof(*map));
+
+   if (count == 0)
+      return true;
+
+   if (!(descriptors = (rarch_memory_descriptor_t*)calloc(
+               count, sizeof(*descriptors))))
+      return false;
+
+   for (i = 0; i < count; i++)
+   {
+      if (sizes[i] == 0)
+         continue;
+
+      descriptors[num_descriptors].core.ptr   = data[i];
+      descriptors[num_descriptors].core.start = start;
+      descriptors[num_descriptors].core.len   = sizes[i];
+      num_descriptors++;
+      start                                  += sizes[i];
+   }
+
+   ret = core_memory_map_init(map, descriptors, num_descriptors);
+   free(descriptors);
+   return ret;
+}
+
+void core_memory_map_free(core_memory_map_t *map)
+{
+   if (map->pages)
+      free(map->pages);
+   if (map->descriptors)
+      free(map->descriptors);
+
+   memset(map, 0, sizeof(*map));
+}
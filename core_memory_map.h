@@ -0,0 +1,176 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CORE_MEMORY_MAP_H
+#define __CORE_MEMORY_MAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+#include <retro_inline.h>
+
+#include "retroarch_types.h"
+
+RETRO_BEGIN_DECLS
+
+/* Upper bound on the number of pages in a table.
+ * Larger address spaces get larger pages instead */
+#define CORE_MEMORY_MAP_MAX_PAGES 16384
+
+/* One page of a translated address space. Every address
+ * in the page resolves to the same descriptor, at
+ * consecutive offsets starting from 'offset' */
+typedef struct core_memory_page
+{
+   const rarch_memory_descriptor_t *desc; /* NULL if unmapped */
+   uint8_t *ptr;                          /* Host address of the page start, NULL if desc has no data */
+   size_t offset;                         /* Offset of the page start within desc */
+} core_memory_page_t;
+
+/* Translates addresses of an emulated address space into
+ * host pointers with a single table lookup.
+ *
+ * The table is built once from a list of memory
+ * descriptors, using the same matching rules as
+ * RETRO_ENVIRONMENT_SET_MEMORY_MAPS (first matching
+ * descriptor wins, 'select' and 'disconnect' honoured).
+ * Pages that are not covered by a single descriptor
+ * (a region boundary that is not page aligned, or a
+ * mirror that is finer than a page) point to 'split'
+ * and are resolved by walking the descriptors, as are
+ * addresses past the end of the table. */
+typedef struct core_memory_map
+{
+   core_memory_page_t *pages;
+   rarch_memory_descriptor_t *descriptors;
+   rarch_memory_descriptor_t split;       /* Marker for pages that need the slow path */
+   size_t num_pages;
+   size_t mask;                           /* Page size - 1 */
+   unsigned num_descriptors;
+   unsigned shift;
+} core_memory_map_t;
+
+/**
+ * core_memory_map_init:
+ * @map                  : Table to initialize.
+ * @descriptors          : Memory descriptors, copied into the table.
+ * @num_descriptors      : Number of descriptors.
+ *
+ * Builds the page table for @descriptors. @map must not be
+ * initialized already; use core_memory_map_free() first.
+ *
+ * Returns: true on success, false on allocation failure.
+ **/
+bool core_memory_map_init(core_memory_map_t *map,
+      const rarch_memory_descriptor_t *descriptors,
+      unsigned num_descriptors);
+
+/**
+ * core_memory_map_init_regions:
+ * @map                  : Table to initialize.
+ * @data                 : Host buffers, NULL for holes without data.
+ * @sizes                : Size of each buffer.
+ * @count                : Number of buffers.
+ *
+ * Builds a page table for a flat address space in which
+ * the buffers follow each other in order, which is how the
+ * cheat search and the achievement runtime address memory.
+ *
+ * Returns: true on success, false on allocation failure.
+ **/
+bool core_memory_map_init_regions(core_memory_map_t *map,
+      uint8_t * const *data, const size_t *sizes, unsigned count);
+
+void core_memory_map_free(core_memory_map_t *map);
+
+/**
+ * core_memory_map_find_slow:
+ *
+ * Resolves @address by walking the descriptors. Used for
+ * split pages and addresses past the end of the table;
+ * call core_memory_map_find() instead.
+ **/
+const rarch_memory_descriptor_t *core_memory_map_find_slow(
+      const core_memory_map_t *map, size_t address, size_t *offset);
+
+/**
+ * core_memory_map_find:
+ * @map                  : Page table.
+ * @address              : Emulated address.
+ * @offset               : Offset of @address within the returned descriptor.
+ *
+ * Returns: the descriptor backing @address, or NULL if
+ * the address is unmapped.
+ **/
+static INLINE const rarch_memory_descriptor_t *core_memory_map_find(
+      const core_memory_map_t *map, size_t address, size_t *offset)
+{
+   const core_memory_page_t *page;
+
+   if ((address >> map->shift) >= map->num_pages)
+      return core_memory_map_find_slow(map, address, offset);
+
+   page = &map->pages[address >> map->shift];
+   if (page->desc == &map->split)
+      return core_memory_map_find_slow(map, address, offset);
+
+   *offset = page->offset + (address & map->mask);
+   return page->desc;
+}
+
+/**
+ * core_memory_map_get_pointer:
+ * @map                  : Page table.
+ * @address              : Emulated address.
+ * @avail                : Number of bytes readable from the returned
+ *                         pointer before the end of its descriptor.
+ *
+ * Returns: the host address of @address, or NULL if it is
+ * unmapped or has no data behind it.
+ **/
+static INLINE uint8_t *core_memory_map_get_pointer(
+      const core_memory_map_t *map, size_t address, size_t *avail)
+{
+   size_t offset;
+   const rarch_memory_descriptor_t *desc;
+   const core_memory_page_t *page;
+
+   if ((address >> map->shift) < map->num_pages)
+   {
+      page = &map->pages[address >> map->shift];
+      if (page->desc != &map->split)
+      {
+         if (!page->ptr)
+            return NULL;
+         offset = address & map->mask;
+         *avail = page->desc->core.len - page->offset - offset;
+         return page->ptr + offset;
+      }
+   }
+
+   if (     !(desc = core_memory_map_find_slow(map, address, &offset))
+         || !desc->core.ptr)
+      return NULL;
+
+   *avail = desc->core.len - offset;
+   return (uint8_t*)desc->core.ptr + desc->core.offset + offset;
+}
+
+RETRO_END_DECLS
+
+#endif
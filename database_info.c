@@ -473,14 +473,12 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
    struct rmsgpack_dom_value item;
    const char* str                = NULL;
 
-   if (libretrodb_cursor_read_item(cur, &item) != 0)
+   /* Backed by the cursor, values are copied out below */
+   if (libretrodb_cursor_read_item_view(cur, &item) != 0)
       return -1;
 
    if (item.type != RDT_MAP)
-   {
-      rmsgpack_dom_value_free(&item);
       return 1;
-   }
 
    db_info->analog_supported       = -1;
    db_info->rumble_supported       = -1;
@@ -685,16 +683,21 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
          db_info->size                    = (unsigned)val->val.uint_;
       else if (string_is_equal(str, "crc"))
       {
+         /* Binaries point into the mapped file, may be unaligned */
+         uint16_t crc16;
+         uint32_t crc32;
          switch (val->val.binary.len)
          {
             case 1:
                db_info->crc32 = *(uint8_t*)val->val.binary.buff;
                break;
             case 2:
-               db_info->crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
+               memcpy(&crc16, val->val.binary.buff, sizeof(crc16));
+               db_info->crc32 = swap_if_little16(crc16);
                break;
             case 4:
-               db_info->crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
+               memcpy(&crc32, val->val.binary.buff, sizeof(crc32));
+               db_info->crc32 = swap_if_little32(crc32);
                break;
             default:
                db_info->crc32 = 0;
@@ -709,8 +712,6 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
                (uint8_t*)val->val.binary.buff, val->val.binary.len);
    }
 
-   rmsgpack_dom_value_free(&item);
-
    return 0;
 }
 
@@ -118,6 +118,7 @@ RETRO_BEGIN_DECLS
 #endif
 #define FILE_PATH_CORE_INFO_CACHE "core_info.cache"
 #define FILE_PATH_CORE_INFO_CACHE_REFRESH "core_info.refresh"
+#define FILE_PATH_CORE_CRC_CACHE "core_crc.cache"
 
 enum application_special_type
 {
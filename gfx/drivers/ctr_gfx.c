@@ -222,7 +222,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_ctr = {
    "ctr",
    true,
    NULL,
-   NULL
+   NULL,
+   false
 };
 
 /*
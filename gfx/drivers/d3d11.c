@@ -613,7 +613,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_d3d11 = {
    "d3d11",
    true,
    gfx_display_d3d11_scissor_begin,
-   gfx_display_d3d11_scissor_end
+   gfx_display_d3d11_scissor_end,
+   false
 };
 
 /*
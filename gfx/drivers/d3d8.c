@@ -742,7 +742,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_d3d8 = {
    "d3d8",
    false,
    NULL,
-   NULL
+   NULL,
+   false
 };
 
 /*
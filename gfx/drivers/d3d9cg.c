@@ -389,7 +389,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_d3d9_cg = {
    "d3d9_cg",
    false,
    gfx_display_d3d9_cg_scissor_begin,
-   gfx_display_d3d9_cg_scissor_end
+   gfx_display_d3d9_cg_scissor_end,
+   false
 };
 
 /*
@@ -384,7 +384,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_d3d9_hlsl = {
    "d3d9_hlsl",
    false,
    gfx_display_d3d9_hlsl_scissor_begin,
-   gfx_display_d3d9_hlsl_scissor_end
+   gfx_display_d3d9_hlsl_scissor_end,
+   false
 };
 
 /*
@@ -159,7 +159,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_gdi = {
    "gdi",
    false,
    NULL,                                     /* scissor_begin */
-   NULL                                      /* scissor_end   */
+   NULL,                                     /* scissor_end   */
+   false                                     /* batching      */
 };
 
 /*
@@ -316,7 +316,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_gl1 = {
    "gl1",
    false,
    gfx_display_gl1_scissor_begin,
-   gfx_display_gl1_scissor_end
+   gfx_display_gl1_scissor_end,
+   true
 };
 
 /**
@@ -41,6 +41,7 @@
 
 #include <encodings/utf.h>
 #include <compat/strl.h>
+#include <features/features_cpu.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/math/matrix_4x4.h>
 #include <formats/image.h>
@@ -657,7 +658,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_gl = {
    "gl",
    false,
    gfx_display_gl2_scissor_begin,
-   gfx_display_gl2_scissor_end
+   gfx_display_gl2_scissor_end,
+   true
 };
 
 /**
@@ -4040,6 +4042,7 @@ static bool gl2_init_pbo_readback(gl2_t *gl)
       scaler->in_fmt            = SCALER_FMT_ARGB8888;
       scaler->out_fmt           = SCALER_FMT_BGR24;
       scaler->scaler_type       = SCALER_TYPE_POINT;
+      scaler->threads           = cpu_features_get_core_amount();
 
       if (!scaler_ctx_gen_filter(scaler))
       {
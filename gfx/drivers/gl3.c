@@ -30,6 +30,7 @@
 #include "../common/gl3_defines.h"
 
 #include <encodings/utf.h>
+#include <features/features_cpu.h>
 #include <gfx/gl_capabilities.h>
 #include <gfx/video_frame.h>
 #include <glsym/glsym.h>
@@ -385,7 +386,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_gl3 = {
    "glcore",
    false,
    gfx_display_gl3_scissor_begin,
-   gfx_display_gl3_scissor_end
+   gfx_display_gl3_scissor_end,
+   true
 };
 
 /**
@@ -908,6 +910,7 @@ static bool gl3_init_pbo_readback(gl3_t *gl)
    scaler->in_fmt            = SCALER_FMT_ABGR8888;
    scaler->out_fmt           = SCALER_FMT_BGR24;
    scaler->scaler_type       = SCALER_TYPE_POINT;
+   scaler->threads           = cpu_features_get_core_amount();
 
    if (!scaler_ctx_gen_filter(scaler))
    {
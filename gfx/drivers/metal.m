@@ -175,7 +175,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_metal = {
    "metal",
    false,
    gfx_display_metal_scissor_begin,
-   gfx_display_metal_scissor_end
+   gfx_display_metal_scissor_end,
+   false
 };
 
 /*
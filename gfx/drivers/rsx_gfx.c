@@ -326,7 +326,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_rsx = {
    "rsx",
    true,
    gfx_display_rsx_scissor_begin,
-   gfx_display_rsx_scissor_end
+   gfx_display_rsx_scissor_end,
+   false
 };
 
 /*
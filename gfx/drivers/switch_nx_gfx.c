@@ -87,7 +87,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_switch = {
    "switch",
    false,
    NULL,                                         /* scissor_begin */
-   NULL                                          /* scissor_end   */
+   NULL,                                         /* scissor_end   */
+   false                                         /* batching      */
 };
 
 /*
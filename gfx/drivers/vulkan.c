@@ -21,6 +21,7 @@
 #include <retro_assert.h>
 #include <encodings/utf.h>
 #include <compat/strl.h>
+#include <features/features_cpu.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <formats/image.h>
@@ -1329,7 +1330,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_vulkan = {
    "vulkan",
    false,
    gfx_display_vk_scissor_begin,
-   gfx_display_vk_scissor_end
+   gfx_display_vk_scissor_end,
+   true
 };
 
 /**
@@ -3191,6 +3193,7 @@ static void vulkan_init_readback(vk_t *vk, settings_t *settings)
    vk->readback.scaler_bgr.in_fmt      = SCALER_FMT_ARGB8888;
    vk->readback.scaler_bgr.out_fmt     = SCALER_FMT_BGR24;
    vk->readback.scaler_bgr.scaler_type = SCALER_TYPE_POINT;
+   vk->readback.scaler_bgr.threads     = cpu_features_get_core_amount();
 
    vk->readback.scaler_rgb.in_width    = vk->vp.width;
    vk->readback.scaler_rgb.in_height   = vk->vp.height;
@@ -3199,6 +3202,7 @@ static void vulkan_init_readback(vk_t *vk, settings_t *settings)
    vk->readback.scaler_rgb.in_fmt      = SCALER_FMT_ABGR8888;
    vk->readback.scaler_rgb.out_fmt     = SCALER_FMT_BGR24;
    vk->readback.scaler_rgb.scaler_type = SCALER_TYPE_POINT;
+   vk->readback.scaler_rgb.threads     = cpu_features_get_core_amount();
 
    if (!scaler_ctx_gen_filter(&vk->readback.scaler_bgr))
    {
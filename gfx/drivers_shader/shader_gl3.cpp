@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include <compat/strl.h>
+#include <features/features_trace.h>
 #include <formats/image.h>
 #include <retro_miscellaneous.h>
 
@@ -1968,8 +1969,14 @@ void gl3_filter_chain::build_offscreen_passes(const gl3_viewport &vp)
 
    for (i = 0; i < passes.size() - 1; i++)
    {
+      /* Times issuing the GL calls of the pass on the CPU,
+       * not its execution on the GPU */
+      retro_time_t trace_start = TRACE_EVENT_BEGIN();
+
       passes[i]->build_commands(original, source, vp, nullptr);
 
+      TRACE_EVENT_END_ARG("shader_pass_record", trace_start, (int32_t)i);
+
       const gl3_shader::Framebuffer &fb   = passes[i]->get_framebuffer();
 
       source.texture.image             = fb.get_image();
@@ -2058,7 +2065,10 @@ void gl3_filter_chain::build_viewport_pass(
       source.address                 = passes.back()->get_address_mode();
    }
 
+   retro_time_t trace_start = TRACE_EVENT_BEGIN();
    passes.back()->build_commands(original, source, vp, mvp);
+   TRACE_EVENT_END_ARG("shader_pass_record", trace_start,
+         (int32_t)(passes.size() - 1));
 
    /* For feedback FBOs, swap current and previous. */
    for (i = 0; i < passes.size(); i++)
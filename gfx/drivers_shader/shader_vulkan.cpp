@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include <compat/strl.h>
+#include <features/features_trace.h>
 #include <formats/image.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
@@ -1255,9 +1256,15 @@ void vulkan_filter_chain::build_offscreen_passes(VkCommandBuffer cmd,
 
    for (i = 0; i < passes.size() - 1; i++)
    {
+      /* Times recording of the pass into the command
+       * buffer on the CPU, not its execution on the GPU */
+      retro_time_t trace_start = TRACE_EVENT_BEGIN();
+
       passes[i]->build_commands(disposer, cmd,
             original, source, vp, nullptr);
 
+      TRACE_EVENT_END_ARG("shader_pass_record", trace_start, (int32_t)i);
+
       const Framebuffer &fb   = passes[i]->get_framebuffer();
 
       source.texture.view     = fb.get_view();
@@ -1383,8 +1390,11 @@ void vulkan_filter_chain::build_viewport_pass(
       source.address         = passes.back()->get_address_mode();
    }
 
+   retro_time_t trace_start = TRACE_EVENT_BEGIN();
    passes.back()->build_commands(disposer, cmd,
          original, source, vp, mvp);
+   TRACE_EVENT_END_ARG("shader_pass_record", trace_start,
+         (int32_t)(passes.size() - 1));
 
    /* For feedback FBOs, swap current and previous. */
    for (i = 0; i < passes.size(); i++)
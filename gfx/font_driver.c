@@ -22,6 +22,7 @@
 #endif
 
 #include "font_driver.h"
+#include "gfx_display.h"
 #include "video_thread_wrapper.h"
 
 /* TODO/FIXME - global */
@@ -776,6 +777,10 @@ void font_driver_render_msg(void *data, const char *msg,
 #else
       char *new_msg = (char*)msg;
 #endif
+      /* Without a block the text is drawn right away,
+       * on top of any quads still waiting to be merged */
+      if (!font->block)
+         gfx_display_batch_flush();
       font->renderer->render_msg(data,
             font->renderer_data, new_msg, params);
 #ifdef HAVE_LANGEXTRA
@@ -790,7 +795,10 @@ void font_driver_bind_block(void *font_data, void *block)
    font_data_t *font = (font_data_t*)(font_data ? font_data : video_font_driver);
 
    if (font && font->renderer && font->renderer->bind_block)
+   {
+      font->block = block;
       font->renderer->bind_block(font->renderer_data, block);
+   }
 }
 
 /* Flushing is slow - only do it if font has actually been used */
@@ -801,6 +809,7 @@ void font_flush(
 {
    if (font_data->raster_block.carr.coords.vertices == 0)
       return;
+   gfx_display_batch_flush();
    if (font_data->font && font_data->font->renderer && font_data->font->renderer->flush)
       font_data->font->renderer->flush(video_width, video_height, font_data->font->renderer_data);
    font_data->raster_block.carr.coords.vertices = 0;
@@ -919,6 +928,7 @@ font_data_t *font_driver_init_first(
       {
          font->renderer      = (const font_renderer_t*)font_driver;
          font->renderer_data = font_handle;
+         font->block         = NULL;
          font->size          = font_size;
          return font;
       }
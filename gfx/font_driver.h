@@ -71,6 +71,7 @@ typedef struct
 {
    const font_renderer_t *renderer;
    void *renderer_data;
+   void *block; /* Raster block text is collected in, if bound */
    float size;
 } font_data_t;
 
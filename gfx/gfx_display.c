@@ -99,6 +99,378 @@ static gfx_display_ctx_driver_t *gfx_display_ctx_drivers[] = {
    NULL,
 };
 
+/* Most quads a merged draw may hold */
+#define GFX_DISPLAY_BATCH_QUADS 1024
+
+typedef struct gfx_display_batch
+{
+   gfx_display_ctx_driver_t *backend;
+   float *vertex;      /* 6 vertices per quad */
+   float *tex_coord;
+   float *color;
+   void *userdata;
+   void *blend_userdata;
+   uintptr_t texture;
+   uint64_t frame_count;
+   unsigned video_width;
+   unsigned video_height;
+   unsigned quads;
+   unsigned draws;     /* Submitted during the current frame */
+   unsigned calls;     /* Performed by the backend */
+   unsigned last_draws;
+   unsigned last_calls;
+   bool active;
+   /* blend_end() is held back while batching, so that
+    * the blend_begin(), draw, blend_end() sequence of
+    * every gfx_display_draw_quad() does not split the
+    * batch */
+   bool blend_end_pending;
+} gfx_display_batch_t;
+
+static gfx_display_batch_t gfx_display_batch_st;
+
+/* Wraps the backend display driver when it supports
+ * batching, see gfx_display_init_first_driver() */
+static gfx_display_ctx_driver_t gfx_display_ctx_batch;
+
+static void gfx_display_batch_flush_quads(gfx_display_batch_t *batch)
+{
+   gfx_display_ctx_draw_t draw;
+   struct video_coords coords;
+
+   if (!batch->quads)
+      return;
+
+   coords.vertices        = batch->quads * 6;
+   coords.vertex          = batch->vertex;
+   coords.tex_coord       = batch->tex_coord;
+   coords.lut_tex_coord   = batch->tex_coord;
+   coords.color           = batch->color;
+
+   draw.color             = NULL;
+   draw.vertex            = NULL;
+   draw.tex_coord         = NULL;
+   draw.backend_data      = NULL;
+   draw.coords            = &coords;
+   draw.matrix_data       = NULL;
+   draw.texture           = batch->texture;
+   draw.vertex_count      = coords.vertices;
+   draw.backend_data_size = 0;
+   draw.width             = batch->video_width;
+   draw.height            = batch->video_height;
+   draw.pipeline_id       = 0;
+   draw.x                 = 0.0f;
+   draw.y                 = 0.0f;
+   draw.rotation          = 0.0f;
+   draw.scale_factor      = 1.0f;
+   draw.prim_type         = GFX_DISPLAY_PRIM_TRIANGLES;
+   draw.pipeline_active   = false;
+
+   batch->quads           = 0;
+   batch->calls++;
+   batch->backend->draw(&draw, batch->userdata,
+         batch->video_width, batch->video_height);
+}
+
+/* Brings the backend up to date before anything
+ * other than a mergeable quad reaches it */
+static void gfx_display_batch_sync(gfx_display_batch_t *batch)
+{
+   gfx_display_batch_flush_quads(batch);
+
+   if (batch->blend_end_pending)
+   {
+      batch->blend_end_pending = false;
+      if (batch->backend->blend_end)
+         batch->backend->blend_end(batch->blend_userdata);
+   }
+}
+
+/* Only plain quads drawn with the default MVP can be
+ * moved into screen space and merged */
+static bool gfx_display_batch_can_merge(gfx_display_batch_t *batch,
+      gfx_display_ctx_draw_t *draw, void *data,
+      unsigned video_width, unsigned video_height)
+{
+   if (     !batch->active
+         || !batch->vertex
+         || !draw->coords
+         || draw->coords->vertices != 4
+         || draw->prim_type        != GFX_DISPLAY_PRIM_TRIANGLESTRIP
+         || draw->pipeline_id      != 0
+         || video_width  == 0
+         || video_height == 0)
+      return false;
+
+   if (draw->matrix_data)
+   {
+      const void *mvp = batch->backend->get_default_mvp
+         ? batch->backend->get_default_mvp(data)
+         : NULL;
+      if (     !mvp
+            || (     draw->matrix_data != mvp
+                  && memcmp(draw->matrix_data, mvp,
+                        sizeof(math_matrix_4x4))))
+         return false;
+   }
+
+   return true;
+}
+
+static void gfx_display_batch_add_quad(gfx_display_batch_t *batch,
+      gfx_display_ctx_draw_t *draw)
+{
+   unsigned i;
+   /* Triangle strip BL, BR, TL, TR to two triangles */
+   static const unsigned order[6] = { 0, 1, 2, 2, 1, 3 };
+   const struct video_coords *coords = draw->coords;
+   const float *vertex    = coords->vertex
+      ? coords->vertex
+      : batch->backend->get_default_vertices();
+   const float *tex_coord = coords->tex_coord
+      ? coords->tex_coord
+      : batch->backend->get_default_tex_coords();
+   const float *color     = coords->color;
+   float scale_x          = (float)draw->width  / batch->video_width;
+   float scale_y          = (float)draw->height / batch->video_height;
+   float offset_x         = draw->x / batch->video_width;
+   float offset_y         = draw->y / batch->video_height;
+   float *out_vertex      = batch->vertex    + batch->quads * 12;
+   float *out_tex_coord   = batch->tex_coord + batch->quads * 12;
+   float *out_color       = batch->color     + batch->quads * 24;
+
+   for (i = 0; i < 6; i++)
+   {
+      unsigned k              = order[i];
+      out_vertex[i * 2 + 0]   = offset_x + vertex[k * 2 + 0] * scale_x;
+      out_vertex[i * 2 + 1]   = offset_y + vertex[k * 2 + 1] * scale_y;
+      out_tex_coord[i * 2 + 0]= tex_coord[k * 2 + 0];
+      out_tex_coord[i * 2 + 1]= tex_coord[k * 2 + 1];
+      if (color)
+         memcpy(out_color + i * 4, color + k * 4, 4 * sizeof(float));
+      else
+      {
+         out_color[i * 4 + 0] = 1.0f;
+         out_color[i * 4 + 1] = 1.0f;
+         out_color[i * 4 + 2] = 1.0f;
+         out_color[i * 4 + 3] = 1.0f;
+      }
+   }
+
+   batch->quads++;
+}
+
+static void gfx_display_batch_draw(gfx_display_ctx_draw_t *draw,
+      void *data, unsigned video_width, unsigned video_height)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+
+   if (!draw)
+      return;
+
+   batch->draws++;
+
+   if (gfx_display_batch_can_merge(batch, draw, data,
+            video_width, video_height))
+   {
+      /* A quad after blend_end() is drawn without blending */
+      if (batch->blend_end_pending)
+         gfx_display_batch_sync(batch);
+      else if (batch->quads
+            && (     batch->texture      != draw->texture
+                  || batch->userdata     != data
+                  || batch->video_width  != video_width
+                  || batch->video_height != video_height
+                  || batch->quads        >= GFX_DISPLAY_BATCH_QUADS))
+         gfx_display_batch_flush_quads(batch);
+
+      batch->texture      = draw->texture;
+      batch->userdata     = data;
+      batch->video_width  = video_width;
+      batch->video_height = video_height;
+      gfx_display_batch_add_quad(batch, draw);
+      return;
+   }
+
+   gfx_display_batch_sync(batch);
+   batch->calls++;
+   batch->backend->draw(draw, data, video_width, video_height);
+}
+
+static void gfx_display_batch_draw_pipeline(gfx_display_ctx_draw_t *draw,
+      gfx_display_t *p_disp, void *data,
+      unsigned video_width, unsigned video_height)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+   gfx_display_batch_sync(batch);
+   batch->backend->draw_pipeline(draw, p_disp, data,
+         video_width, video_height);
+}
+
+static void gfx_display_batch_blend_begin(void *data)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+
+   /* Blending was never switched off */
+   if (batch->blend_end_pending)
+   {
+      batch->blend_end_pending = false;
+      return;
+   }
+
+   gfx_display_batch_flush_quads(batch);
+   batch->backend->blend_begin(data);
+}
+
+static void gfx_display_batch_blend_end(void *data)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+
+   if (batch->active)
+   {
+      batch->blend_end_pending = true;
+      batch->blend_userdata    = data;
+      return;
+   }
+
+   batch->backend->blend_end(data);
+}
+
+static void gfx_display_batch_scissor_begin(void *data,
+      unsigned video_width, unsigned video_height,
+      int x, int y, unsigned width, unsigned height)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+   gfx_display_batch_sync(batch);
+   batch->backend->scissor_begin(data, video_width, video_height,
+         x, y, width, height);
+}
+
+static void gfx_display_batch_scissor_end(void *data,
+      unsigned video_width, unsigned video_height)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+   gfx_display_batch_sync(batch);
+   batch->backend->scissor_end(data, video_width, video_height);
+}
+
+static void gfx_display_batch_init(gfx_display_t *p_disp,
+      gfx_display_ctx_driver_t *backend)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+   gfx_display_ctx_driver_t *proxy = &gfx_display_ctx_batch;
+
+   if (     !backend->batching
+         || !backend->draw
+         || !backend->get_default_vertices
+         || !backend->get_default_tex_coords)
+      return;
+
+   if (!batch->vertex)
+   {
+      batch->vertex    = (float*)malloc(GFX_DISPLAY_BATCH_QUADS
+            * 12 * sizeof(float));
+      batch->tex_coord = (float*)malloc(GFX_DISPLAY_BATCH_QUADS
+            * 12 * sizeof(float));
+      batch->color     = (float*)malloc(GFX_DISPLAY_BATCH_QUADS
+            * 24 * sizeof(float));
+      if (!batch->vertex || !batch->tex_coord || !batch->color)
+      {
+         free(batch->vertex);
+         free(batch->tex_coord);
+         free(batch->color);
+         batch->vertex    = NULL;
+         batch->tex_coord = NULL;
+         batch->color     = NULL;
+         return;
+      }
+   }
+
+   batch->backend           = backend;
+   batch->quads             = 0;
+   batch->active            = false;
+   batch->blend_end_pending = false;
+
+   *proxy                   = *backend;
+   proxy->draw              = gfx_display_batch_draw;
+   if (backend->draw_pipeline)
+      proxy->draw_pipeline  = gfx_display_batch_draw_pipeline;
+   if (backend->blend_begin)
+      proxy->blend_begin    = gfx_display_batch_blend_begin;
+   if (backend->blend_end)
+      proxy->blend_end      = gfx_display_batch_blend_end;
+   if (backend->scissor_begin)
+      proxy->scissor_begin  = gfx_display_batch_scissor_begin;
+   if (backend->scissor_end)
+      proxy->scissor_end    = gfx_display_batch_scissor_end;
+
+   p_disp->dispctx          = proxy;
+}
+
+static void gfx_display_batch_deinit(void)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+
+   free(batch->vertex);
+   free(batch->tex_coord);
+   free(batch->color);
+   batch->vertex            = NULL;
+   batch->tex_coord         = NULL;
+   batch->color             = NULL;
+   batch->backend           = NULL;
+   batch->quads             = 0;
+   batch->active            = false;
+   batch->blend_end_pending = false;
+}
+
+void gfx_display_batch_begin(gfx_display_t *p_disp)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+   uint64_t frame_count       = video_state_get_ptr()->frame_count;
+
+   if (!batch->backend || p_disp->dispctx != &gfx_display_ctx_batch)
+      return;
+
+   if (batch->frame_count != frame_count)
+   {
+      batch->frame_count = frame_count;
+      batch->last_draws  = batch->draws;
+      batch->last_calls  = batch->calls;
+      batch->draws       = 0;
+      batch->calls       = 0;
+   }
+
+   gfx_display_batch_sync(batch);
+   batch->active = true;
+}
+
+void gfx_display_batch_end(gfx_display_t *p_disp)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+
+   if (!batch->backend || p_disp->dispctx != &gfx_display_ctx_batch)
+      return;
+
+   gfx_display_batch_sync(batch);
+   batch->active = false;
+}
+
+void gfx_display_batch_flush(void)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+   if (batch->active)
+      gfx_display_batch_sync(batch);
+}
+
+void gfx_display_get_draw_stats(unsigned *draws, unsigned *calls)
+{
+   gfx_display_batch_t *batch = &gfx_display_batch_st;
+   if (draws)
+      *draws = batch->last_draws;
+   if (calls)
+      *calls = batch->last_calls;
+}
+
 static float gfx_display_get_dpi_scale_internal(
       unsigned width, unsigned height)
 {
@@ -1160,6 +1532,8 @@ void gfx_display_free(void)
    p_disp->framebuf_height     = 0;
    p_disp->framebuf_pitch      = 0;
    p_disp->dispctx             = NULL;
+
+   gfx_display_batch_deinit();
 }
 
 void gfx_display_init(void)
@@ -1190,6 +1564,7 @@ bool gfx_display_init_first_driver(gfx_display_t *p_disp,
          continue;
       RARCH_LOG("[Display]: Found display driver: \"%s\".\n", ident);
       p_disp->dispctx = dispctx;
+      gfx_display_batch_init(p_disp, dispctx);
       return true;
    }
    return false;
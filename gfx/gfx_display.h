@@ -146,6 +146,9 @@ typedef struct gfx_display_ctx_driver
          int x, int y, unsigned width, unsigned height);
    void (*scissor_end)(void *data, unsigned video_width,
          unsigned video_height);
+   /* Quads may be merged into one screen-space
+    * triangle list, see gfx_display_batch_begin() */
+   bool batching;
 } gfx_display_ctx_driver_t;
 
 struct gfx_display_ctx_draw
@@ -230,6 +233,23 @@ void gfx_display_draw_text(
       float scale_factor, bool shadows_enable, float shadow_offset,
       bool draw_outside);
 
+/* Between these two calls, consecutive quads that share
+ * a texture and render state are merged into a single
+ * draw call. Anything else that changes state (scissor,
+ * pipelines, blending, text) flushes the pending quads
+ * first, so drawing order is preserved. */
+void gfx_display_batch_begin(gfx_display_t *p_disp);
+
+void gfx_display_batch_end(gfx_display_t *p_disp);
+
+/* Draws pending quads; must precede any rendering that
+ * bypasses the display driver */
+void gfx_display_batch_flush(void);
+
+/* Draws submitted by the menu and widgets during the last
+ * frame, and draw calls the backend actually performed */
+void gfx_display_get_draw_stats(unsigned *draws, unsigned *calls);
+
 void gfx_display_scissor_begin(
       gfx_display_t *p_disp,
       void *userdata,
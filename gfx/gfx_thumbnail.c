@@ -27,6 +27,11 @@
 #include <features/features_cpu.h>
 #include <file/file_path.h>
 #include <string/stdstring.h>
+#include <streams/file_stream.h>
+#include <lrc_hash.h>
+#ifdef HAVE_RPNG
+#include <formats/rpng.h>
+#endif
 
 #include "gfx_display.h"
 #include "gfx_animation.h"
@@ -44,8 +49,47 @@ typedef struct
 {
    uint64_t list_id;
    gfx_thumbnail_t *thumbnail;
+   char *path;            /* Cache key, NULL if not cacheable */
+   char *disk_cache_path; /* Where to save a downscaled copy */
+   unsigned upscale_threshold;
+   unsigned downscale_threshold;
 } gfx_thumbnail_tag_t;
 
+/* Decoded thumbnail, owned by the cache */
+struct gfx_thumbnail_cache_entry
+{
+   struct gfx_thumbnail_cache_entry *prev;
+   struct gfx_thumbnail_cache_entry *next;
+   struct gfx_thumbnail_cache_entry *hash_next;
+   char *path;
+   struct texture_image image;
+   size_t size;
+   uint32_t hash;
+   unsigned upscale_threshold;
+   unsigned downscale_threshold;
+};
+
+/* Pending write of a downscaled thumbnail to the
+ * disk cache */
+typedef struct
+{
+   char *path;
+   uint32_t *pixels;
+   unsigned width;
+   unsigned height;
+} gfx_thumbnail_disk_write_t;
+
+/* Pending load of a thumbnail that may have a
+ * downscaled copy in the disk cache */
+typedef struct
+{
+   gfx_thumbnail_tag_t *thumbnail_tag; /* NULL once handed over */
+   char *path;
+   char *disk_cache_dir;
+   unsigned upscale_threshold;
+   bool supports_rgba;
+} gfx_thumbnail_disk_read_t;
+
 static gfx_thumbnail_state_t gfx_thumb_st = {0}; /* uint64_t alignment */
 
 gfx_thumbnail_state_t *gfx_thumb_get_ptr(void)
@@ -89,6 +133,276 @@ void gfx_thumbnail_set_fade_missing(bool fade_missing)
    p_gfx_thumb->fade_missing = fade_missing;
 }
 
+static void gfx_thumbnail_cache_trim(
+      gfx_thumbnail_state_t *p_gfx_thumb, size_t limit);
+
+/* Sets the byte budget of the decoded thumbnail cache
+ * (0 disables it), the longest side that larger images
+ * are downscaled to when loaded (0 to keep their size),
+ * and the directory where downscaled copies are saved
+ * (NULL or empty to not save them) */
+void gfx_thumbnail_set_cache(size_t cache_size,
+      unsigned downscale_threshold, const char *disk_cache_dir)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
+
+   p_gfx_thumb->cache_size          = cache_size;
+   p_gfx_thumb->downscale_threshold = downscale_threshold;
+
+   if (p_gfx_thumb->disk_cache_dir)
+      free(p_gfx_thumb->disk_cache_dir);
+   p_gfx_thumb->disk_cache_dir      = NULL;
+   if (!string_is_empty(disk_cache_dir))
+      p_gfx_thumb->disk_cache_dir   = strdup(disk_cache_dir);
+
+   gfx_thumbnail_cache_trim(p_gfx_thumb, cache_size);
+}
+
+/* Decoded thumbnail cache */
+
+static void gfx_thumbnail_cache_unlink(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      struct gfx_thumbnail_cache_entry *entry)
+{
+   if (entry->prev)
+      entry->prev->next       = entry->next;
+   else
+      p_gfx_thumb->cache_head = entry->next;
+
+   if (entry->next)
+      entry->next->prev       = entry->prev;
+   else
+      p_gfx_thumb->cache_tail = entry->prev;
+
+   entry->prev                = NULL;
+   entry->next                = NULL;
+   p_gfx_thumb->cache_bytes  -= entry->size;
+   p_gfx_thumb->cache_count--;
+}
+
+static void gfx_thumbnail_cache_push_front(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      struct gfx_thumbnail_cache_entry *entry)
+{
+   entry->prev                = NULL;
+   entry->next                = p_gfx_thumb->cache_head;
+   if (p_gfx_thumb->cache_head)
+      p_gfx_thumb->cache_head->prev = entry;
+   else
+      p_gfx_thumb->cache_tail = entry;
+   p_gfx_thumb->cache_head    = entry;
+   p_gfx_thumb->cache_bytes  += entry->size;
+   p_gfx_thumb->cache_count++;
+}
+
+static void gfx_thumbnail_cache_bucket_add(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      struct gfx_thumbnail_cache_entry *entry)
+{
+   struct gfx_thumbnail_cache_entry **bucket = &p_gfx_thumb->cache_buckets[
+         entry->hash & (GFX_THUMBNAIL_CACHE_BUCKETS - 1)];
+
+   entry->hash_next = *bucket;
+   *bucket          = entry;
+}
+
+static void gfx_thumbnail_cache_bucket_remove(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      struct gfx_thumbnail_cache_entry *entry)
+{
+   struct gfx_thumbnail_cache_entry **link = &p_gfx_thumb->cache_buckets[
+         entry->hash & (GFX_THUMBNAIL_CACHE_BUCKETS - 1)];
+
+   while (*link && (*link != entry))
+      link = &(*link)->hash_next;
+
+   if (*link)
+      *link = entry->hash_next;
+   entry->hash_next = NULL;
+}
+
+static void gfx_thumbnail_cache_entry_free(
+      struct gfx_thumbnail_cache_entry *entry)
+{
+   image_texture_free(&entry->image);
+   free(entry->path);
+   free(entry);
+}
+
+/* Evicts least recently used images until the cache
+ * fits within 'limit' bytes */
+static void gfx_thumbnail_cache_trim(
+      gfx_thumbnail_state_t *p_gfx_thumb, size_t limit)
+{
+   while (p_gfx_thumb->cache_tail && (p_gfx_thumb->cache_bytes > limit))
+   {
+      struct gfx_thumbnail_cache_entry *entry = p_gfx_thumb->cache_tail;
+      gfx_thumbnail_cache_unlink(p_gfx_thumb, entry);
+      gfx_thumbnail_cache_bucket_remove(p_gfx_thumb, entry);
+      gfx_thumbnail_cache_entry_free(entry);
+   }
+}
+
+/* Returns cached image of 'path', moving it to the
+ * front of the cache, or NULL if it is not cached */
+static struct gfx_thumbnail_cache_entry *gfx_thumbnail_cache_find(
+      gfx_thumbnail_state_t *p_gfx_thumb, const char *path,
+      uint32_t hash, unsigned upscale_threshold,
+      unsigned downscale_threshold)
+{
+   struct gfx_thumbnail_cache_entry *entry;
+
+   for (entry = p_gfx_thumb->cache_buckets[
+            hash & (GFX_THUMBNAIL_CACHE_BUCKETS - 1)];
+         entry; entry = entry->hash_next)
+   {
+      if (     (entry->hash                == hash)
+            && (entry->upscale_threshold   == upscale_threshold)
+            && (entry->downscale_threshold == downscale_threshold)
+            && string_is_equal(entry->path, path))
+      {
+         if (entry != p_gfx_thumb->cache_head)
+         {
+            gfx_thumbnail_cache_unlink(p_gfx_thumb, entry);
+            gfx_thumbnail_cache_push_front(p_gfx_thumb, entry);
+         }
+         return entry;
+      }
+   }
+
+   return NULL;
+}
+
+/* Hands 'img' over to the cache. Returns false if
+ * the image was not taken (caller keeps ownership) */
+static bool gfx_thumbnail_cache_insert(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const gfx_thumbnail_tag_t *thumbnail_tag,
+      struct texture_image *img)
+{
+   struct gfx_thumbnail_cache_entry *entry = NULL;
+   uint32_t hash                           = djb2_calculate(thumbnail_tag->path);
+   size_t limit                            = p_gfx_thumb->cache_size;
+   size_t size                             = sizeof(*entry)
+         + (size_t)img->width * img->height * sizeof(uint32_t);
+
+   if (size > limit)
+      return false;
+
+   /* Both thumbnails of an entry may show the same
+    * image, in which case it is already cached */
+   if (gfx_thumbnail_cache_find(p_gfx_thumb, thumbnail_tag->path, hash,
+            thumbnail_tag->upscale_threshold,
+            thumbnail_tag->downscale_threshold))
+      return false;
+
+   if (!(entry = (struct gfx_thumbnail_cache_entry*)malloc(sizeof(*entry))))
+      return false;
+
+   if (!(entry->path = strdup(thumbnail_tag->path)))
+   {
+      free(entry);
+      return false;
+   }
+
+   entry->image               = *img;
+   entry->size                = size;
+   entry->hash                = hash;
+   entry->upscale_threshold   = thumbnail_tag->upscale_threshold;
+   entry->downscale_threshold = thumbnail_tag->downscale_threshold;
+
+   gfx_thumbnail_cache_trim(p_gfx_thumb, limit - size);
+   gfx_thumbnail_cache_push_front(p_gfx_thumb, entry);
+   gfx_thumbnail_cache_bucket_add(p_gfx_thumb, entry);
+   return true;
+}
+
+void gfx_thumbnail_cache_free(void)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
+
+   gfx_thumbnail_cache_trim(p_gfx_thumb, 0);
+
+   if (p_gfx_thumb->disk_cache_dir)
+      free(p_gfx_thumb->disk_cache_dir);
+   p_gfx_thumb->disk_cache_dir = NULL;
+}
+
+/* Disk cache of downscaled thumbnails */
+
+#ifdef HAVE_RPNG
+static void gfx_thumbnail_disk_cache_write_handler(retro_task_t *task)
+{
+   char dir[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   gfx_thumbnail_disk_write_t *state = (gfx_thumbnail_disk_write_t*)task->state;
+
+   fill_pathname_basedir(dir, state->path, sizeof(dir));
+   if (!path_is_directory(dir))
+      path_mkdir(dir);
+
+   /* Write to a temporary file first, so that a load
+    * never sees a partially written image */
+   snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", state->path);
+   if (rpng_save_image_argb(tmp_path, state->pixels,
+            state->width, state->height,
+            state->width * sizeof(uint32_t)))
+   {
+      if (filestream_rename(tmp_path, state->path) != 0)
+         filestream_delete(tmp_path);
+   }
+   else
+      filestream_delete(tmp_path);
+
+   free(state->pixels);
+   free(state->path);
+   free(state);
+   task->state = NULL;
+   task_set_finished(task, true);
+}
+
+static void gfx_thumbnail_disk_cache_write(
+      const char *path, const struct texture_image *img)
+{
+   size_t size                       = (size_t)img->width * img->height * sizeof(uint32_t);
+   retro_task_t *task                = NULL;
+   gfx_thumbnail_disk_write_t *state = (gfx_thumbnail_disk_write_t*)
+      malloc(sizeof(*state));
+
+   if (!state)
+      return;
+
+   state->path   = strdup(path);
+   state->pixels = (uint32_t*)malloc(size);
+   state->width  = img->width;
+   state->height = img->height;
+
+   if (!state->path || !state->pixels || !(task = task_init()))
+   {
+      free(state->path);
+      free(state->pixels);
+      free(state);
+      return;
+   }
+
+   memcpy(state->pixels, img->pixels, size);
+
+   task->state   = state;
+   task->handler = gfx_thumbnail_disk_cache_write_handler;
+   task->mute    = true;
+   task_queue_push(task);
+}
+#endif
+
+static void gfx_thumbnail_tag_free(gfx_thumbnail_tag_t *thumbnail_tag)
+{
+   if (thumbnail_tag->path)
+      free(thumbnail_tag->path);
+   if (thumbnail_tag->disk_cache_path)
+      free(thumbnail_tag->disk_cache_path);
+   free(thumbnail_tag);
+}
+
 /* Callbacks */
 
 /* Fade animation callback - simply resets thumbnail
@@ -195,6 +509,31 @@ static void gfx_thumbnail_handle_upload(
    thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
 
 end:
+   /* Keep the decoded image, even if the thumbnail has
+    * scrolled out of view in the meantime */
+   if (     thumbnail_tag
+         && img
+         && img->pixels
+         && (img->width  > 0)
+         && (img->height > 0))
+   {
+#ifdef HAVE_RPNG
+      /* Save the image if it was downscaled from the source */
+      if (     thumbnail_tag->disk_cache_path
+            && ((img->width  == thumbnail_tag->downscale_threshold) ||
+                (img->height == thumbnail_tag->downscale_threshold)))
+         gfx_thumbnail_disk_cache_write(thumbnail_tag->disk_cache_path, img);
+#endif
+
+      /* The cache now owns the pixels */
+      if (     thumbnail_tag->path
+            && gfx_thumbnail_cache_insert(p_gfx_thumb, thumbnail_tag, img))
+      {
+         free(img);
+         img = NULL;
+      }
+   }
+
    /* Clean up */
    if (img)
    {
@@ -209,8 +548,178 @@ end:
          gfx_thumbnail_init_fade(p_gfx_thumb,
                thumbnail_tag->thumbnail);
 
-      free(thumbnail_tag);
+      gfx_thumbnail_tag_free(thumbnail_tag);
+   }
+}
+
+/* Picks the file to load for a thumbnail: a downscaled
+ * copy from the disk cache if there is one, otherwise the
+ * source image, which gets a copy written once decoded.
+ * Runs on the task thread, since the cache file name
+ * needs the size of the source file */
+static void gfx_thumbnail_disk_cache_read_handler(retro_task_t *task)
+{
+   gfx_thumbnail_disk_read_t *state   = (gfx_thumbnail_disk_read_t*)task->state;
+   gfx_thumbnail_tag_t *thumbnail_tag = state->thumbnail_tag;
+   const char *load_path              = state->path;
+   unsigned upscale_threshold         = state->upscale_threshold;
+   char file_name[64];
+   char disk_cache_path[PATH_MAX_LENGTH];
+
+   /* The source file size is part of the name, so that
+    * a replaced thumbnail is not served stale */
+   snprintf(file_name, sizeof(file_name), "%08x_%x_%u.png",
+         djb2_calculate(state->path), (unsigned)path_get_size(state->path),
+         thumbnail_tag->downscale_threshold);
+   fill_pathname_join_special(disk_cache_path, state->disk_cache_dir,
+         file_name, sizeof(disk_cache_path));
+
+   if (path_is_valid(disk_cache_path))
+   {
+      load_path         = disk_cache_path;
+      upscale_threshold = 0;
+   }
+   else
+      thumbnail_tag->disk_cache_path = strdup(disk_cache_path);
+
+   if (task_push_image_load(
+            load_path, state->supports_rgba,
+            upscale_threshold, thumbnail_tag->downscale_threshold,
+            gfx_thumbnail_handle_upload, thumbnail_tag))
+      state->thumbnail_tag = NULL;
+
+   task_set_finished(task, true);
+}
+
+static void gfx_thumbnail_disk_cache_read_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *err)
+{
+   gfx_thumbnail_disk_read_t *state = (gfx_thumbnail_disk_read_t*)task->state;
+
+   /* Image load could not be started: mark the
+    * thumbnail as missing */
+   if (state->thumbnail_tag)
+   {
+      gfx_thumbnail_handle_upload(task, NULL, state->thumbnail_tag, NULL);
+      state->thumbnail_tag = NULL;
+   }
+}
+
+static void gfx_thumbnail_disk_cache_read_free(retro_task_t *task)
+{
+   gfx_thumbnail_disk_read_t *state = (gfx_thumbnail_disk_read_t*)task->state;
+
+   if (state->thumbnail_tag)
+      gfx_thumbnail_tag_free(state->thumbnail_tag);
+   free(state->path);
+   free(state->disk_cache_dir);
+   free(state);
+   task->state = NULL;
+}
+
+static bool gfx_thumbnail_disk_cache_read(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *path, gfx_thumbnail_tag_t *thumbnail_tag,
+      unsigned upscale_threshold)
+{
+   retro_task_t *task               = NULL;
+   gfx_thumbnail_disk_read_t *state = (gfx_thumbnail_disk_read_t*)
+      malloc(sizeof(*state));
+
+   if (!state)
+      return false;
+
+   state->thumbnail_tag     = thumbnail_tag;
+   state->path              = strdup(path);
+   state->disk_cache_dir    = strdup(p_gfx_thumb->disk_cache_dir);
+   state->upscale_threshold = upscale_threshold;
+   state->supports_rgba     = video_driver_supports_rgba();
+
+   if (!state->path || !state->disk_cache_dir || !(task = task_init()))
+   {
+      free(state->path);
+      free(state->disk_cache_dir);
+      free(state);
+      return false;
+   }
+
+   task->state    = state;
+   task->handler  = gfx_thumbnail_disk_cache_read_handler;
+   task->callback = gfx_thumbnail_disk_cache_read_cb;
+   task->cleanup  = gfx_thumbnail_disk_cache_read_free;
+   task->mute     = true;
+   task_queue_push(task);
+   return true;
+}
+
+/* Loads thumbnail image 'path', from the decoded image
+ * cache if possible (in which case the thumbnail becomes
+ * available immediately), otherwise via an image load task
+ * - Returns false if the load could not be started */
+static bool gfx_thumbnail_load(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *path, gfx_thumbnail_t *thumbnail,
+      unsigned upscale_threshold)
+{
+   struct gfx_thumbnail_cache_entry *entry = NULL;
+   gfx_thumbnail_tag_t *thumbnail_tag      = NULL;
+   unsigned downscale_threshold            = p_gfx_thumb->downscale_threshold;
+   bool started                            = false;
+
+   if (p_gfx_thumb->cache_size > 0)
+   {
+      if ((entry = gfx_thumbnail_cache_find(p_gfx_thumb, path,
+                  djb2_calculate(path), upscale_threshold,
+                  downscale_threshold)))
+      {
+         p_gfx_thumb->cache_hits++;
+
+         if (!video_driver_texture_load(
+                  &entry->image, TEXTURE_FILTER_MIPMAP_LINEAR,
+                  &thumbnail->texture))
+            return false;
+
+         thumbnail->width  = entry->image.width;
+         thumbnail->height = entry->image.height;
+         thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
+         return true;
+      }
+
+      p_gfx_thumb->cache_misses++;
+   }
+   else if (p_gfx_thumb->cache_head)
+      gfx_thumbnail_cache_trim(p_gfx_thumb, 0);
+
+   if (!(thumbnail_tag = (gfx_thumbnail_tag_t*)calloc(1, sizeof(gfx_thumbnail_tag_t))))
+      return false;
+
+   /* Configure user data */
+   thumbnail_tag->thumbnail           = thumbnail;
+   thumbnail_tag->list_id             = p_gfx_thumb->list_id;
+   thumbnail_tag->upscale_threshold   = upscale_threshold;
+   thumbnail_tag->downscale_threshold = downscale_threshold;
+   if (p_gfx_thumb->cache_size > 0)
+      thumbnail_tag->path             = strdup(path);
+
+   /* Would like to cancel any existing image load tasks
+    * here, but can't see how to do it... */
+   if (p_gfx_thumb->disk_cache_dir && (downscale_threshold > 0))
+      started = gfx_thumbnail_disk_cache_read(p_gfx_thumb, path,
+            thumbnail_tag, upscale_threshold);
+   else
+      started = task_push_image_load(
+            path, video_driver_supports_rgba(),
+            upscale_threshold, downscale_threshold,
+            gfx_thumbnail_handle_upload, thumbnail_tag);
+
+   if (!started)
+   {
+      gfx_thumbnail_tag_free(thumbnail_tag);
+      return false;
    }
+
+   thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+   return true;
 }
 
 /* Core interface */
@@ -266,25 +775,8 @@ void gfx_thumbnail_request(
          {
             /* Load thumbnail, if required */
             if (path_is_valid(thumbnail_path))
-            {
-               gfx_thumbnail_tag_t *thumbnail_tag =
-                  (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t));
-
-               if (!thumbnail_tag)
-                  goto end;
-
-               /* Configure user data */
-               thumbnail_tag->thumbnail = thumbnail;
-               thumbnail_tag->list_id   = p_gfx_thumb->list_id;
-
-               /* Would like to cancel any existing image load tasks
-                * here, but can't see how to do it... */
-               if (task_push_image_load(
-                        thumbnail_path, video_driver_supports_rgba(),
-                        gfx_thumbnail_upscale_threshold,
-                        gfx_thumbnail_handle_upload, thumbnail_tag))
-                  thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
-            }
+               gfx_thumbnail_load(p_gfx_thumb, thumbnail_path,
+                     thumbnail, gfx_thumbnail_upscale_threshold);
 #ifdef HAVE_NETWORKING
             /* Handle on demand thumbnail downloads */
             else if (network_on_demand_thumbnails)
@@ -380,8 +872,10 @@ void gfx_thumbnail_request_file(
        || !path_is_valid(file_path))
       return;
 
-   /* Load thumbnail */
-   if (!(thumbnail_tag = (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t))))
+   /* Load thumbnail
+    * > Not cached, since these files (e.g. savestate
+    *   images) are overwritten in place */
+   if (!(thumbnail_tag = (gfx_thumbnail_tag_t*)calloc(1, sizeof(gfx_thumbnail_tag_t))))
       return;
 
    /* Configure user data */
@@ -392,9 +886,11 @@ void gfx_thumbnail_request_file(
     * here, but can't see how to do it... */
    if (task_push_image_load(
          file_path, video_driver_supports_rgba(),
-         gfx_thumbnail_upscale_threshold,
+         gfx_thumbnail_upscale_threshold, 0,
          gfx_thumbnail_handle_upload, thumbnail_tag))
       thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+   else
+      gfx_thumbnail_tag_free(thumbnail_tag);
 }
 
 /* Resets (and free()s the current texture of) the
@@ -99,6 +99,10 @@ typedef struct
    enum gfx_thumbnail_shadow_type type;
 } gfx_thumbnail_shadow_t;
 
+/* Number of hash chains of the decoded thumbnail
+ * cache (must be a power of two) */
+#define GFX_THUMBNAIL_CACHE_BUCKETS 256
+
 /* Structure containing all gfx_thumbnail
  * variables */
 struct gfx_thumbnail_state
@@ -115,6 +119,29 @@ struct gfx_thumbnail_state
     * at the time when the load completes */
    uint64_t list_id;
 
+   /* Decoded thumbnails are kept in a byte budgeted
+    * LRU cache (most recently used first), so that
+    * scrolling back to an entry or returning to a
+    * playlist does not load the same image again */
+   struct gfx_thumbnail_cache_entry *cache_head;
+   struct gfx_thumbnail_cache_entry *cache_tail;
+   /* Entries chained by path hash, for lookup */
+   struct gfx_thumbnail_cache_entry *cache_buckets[GFX_THUMBNAIL_CACHE_BUCKETS];
+   uint64_t cache_hits;
+   uint64_t cache_misses;
+   size_t cache_bytes;
+   size_t cache_count;
+   /* Byte budget of the cache, 0 when disabled */
+   size_t cache_size;
+
+   /* Where downscaled copies of large thumbnails are
+    * saved, NULL when the disk cache is disabled */
+   char *disk_cache_dir;
+
+   /* Longest side that larger thumbnails are downscaled
+    * to when loaded, 0 to keep their size */
+   unsigned downscale_threshold;
+
    /* When streaming thumbnails, to minimise the processing
     * of unnecessary images (i.e. when scrolling rapidly through
     * playlists), we delay loading until an entry has been on screen
@@ -151,6 +178,14 @@ void gfx_thumbnail_set_fade_duration(float duration);
  *   any 'thumbnail unavailable' notifications */
 void gfx_thumbnail_set_fade_missing(bool fade_missing);
 
+/* Sets the byte budget of the decoded thumbnail cache
+ * (0 disables it), the longest side that larger images
+ * are downscaled to when loaded (0 to keep their size),
+ * and the directory where downscaled copies are saved
+ * (NULL or empty to not save them) */
+void gfx_thumbnail_set_cache(size_t cache_size,
+      unsigned downscale_threshold, const char *disk_cache_dir);
+
 /* Core interface */
 
 /* When called, prevents the handling of any pending
@@ -195,6 +230,12 @@ void gfx_thumbnail_request_file(
  * specified thumbnail */
 void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail);
 
+/* Frees all images held by the decoded thumbnail
+ * cache, and the disk cache directory set by
+ * gfx_thumbnail_set_cache(). Hit/miss counters are
+ * preserved */
+void gfx_thumbnail_cache_free(void);
+
 /* Stream processing */
 
 /* Requests loading of the specified thumbnail via
@@ -21,6 +21,7 @@
 #include <string/stdstring.h>
 #include <retro_math.h>
 #include <retro_timers.h>
+#include <features/features_trace.h>
 
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
@@ -35,6 +36,7 @@
 #include "video_display_server.h"
 
 #include "gfx_animation.h"
+#include "gfx_display.h"
 #ifdef HAVE_GFX_WIDGETS
 #include "gfx_widgets.h"
 #endif
@@ -45,6 +47,7 @@
 
 #ifdef HAVE_MENU
 #include "../menu/menu_driver.h"
+#include "gfx_thumbnail.h"
 #endif
 
 #ifdef _WIN32
@@ -2444,6 +2447,13 @@ bool video_driver_texture_unload(uintptr_t *id)
    if (     !video_st->poke
          || !video_st->poke->unload_texture)
       return false;
+   /* Pending display quads may still reference it. With
+    * threaded video the batch belongs to the video thread,
+    * which only runs the unload between frames, once the
+    * batch has been flushed - so flushing from here would
+    * race it and draw off the render thread */
+   if (!VIDEO_DRIVER_IS_THREADED_INTERNAL(video_st))
+      gfx_display_batch_flush();
    video_st->poke->unload_texture(
          video_st->data,
          VIDEO_DRIVER_IS_THREADED_INTERNAL(video_st),
@@ -2647,6 +2657,7 @@ void video_driver_build_info(video_frame_info_t *video_info)
    video_info->runloop_is_slowmotion       = (runloop_st->flags & RUNLOOP_FLAG_SLOWMOTION) ? true : false;
    video_info->fastforward_frameskip       = settings->bools.fastforward_frameskip;
    video_info->frame_rest                  = settings->bools.video_frame_rest;
+   video_info->frame_limit_precise         = settings->bools.frame_limit_precise;
 
 #ifdef _WIN32
 #ifdef HAVE_VULKAN
@@ -3755,9 +3766,11 @@ void video_driver_frame(const void *data, unsigned width,
    if (render_frame && video_info.statistics_show)
    {
       audio_statistics_t audio_stats;
-      char throttle_stats[128];
+      char throttle_stats[256];
       char latency_stats[128];
-      char tmp[128];
+      char thumbnail_stats[160];
+      char draw_stats[96];
+      char tmp[256];
       size_t len;
       double stddev                          = 0.0;
       float font_size_scale                  = video_info.font_size / 100;
@@ -3803,9 +3816,11 @@ void video_driver_frame(const void *data, unsigned width,
 
       audio_compute_buffer_statistics(&audio_stats);
 
-      throttle_stats[0] = '\0';
-      latency_stats[0]  = '\0';
-      tmp[0]            = '\0';
+      throttle_stats[0]  = '\0';
+      latency_stats[0]   = '\0';
+      thumbnail_stats[0] = '\0';
+      draw_stats[0]      = '\0';
+      tmp[0]             = '\0';
       len               = 0;
 
       if (video_info.frame_rest)
@@ -3815,6 +3830,25 @@ void video_driver_frame(const void *data, unsigned width,
                video_st->frame_rest,
                (float)video_st->frame_rest_time_count / runloop_st->core_runtime_usec * 100);
 
+      if (runloop_st->frame_limit_stats.count > 0)
+      {
+         const runloop_frame_limit_stats_t *stats = &runloop_st->frame_limit_stats;
+         uint64_t over                            = stats->hist[RUNLOOP_FRAME_LIMIT_HIST_SIZE - 1]
+               + stats->hist[RUNLOOP_FRAME_LIMIT_HIST_SIZE - 2];
+
+         /* TODO/FIXME - localize */
+         len += snprintf(tmp + len, sizeof(tmp) - len,
+               " Frame Limit: %s\n"
+               " - Avg Error: %5.2f ms\n"
+               " - Max Error: %5.2f ms\n"
+               " - >%.1f ms:   %5.2f %%\n",
+               video_info.frame_limit_precise ? "Precise" : "Sleep",
+               stats->total / (double)stats->count / 1000.0,
+               stats->max / 1000.0,
+               RUNLOOP_FRAME_LIMIT_HIST_BOUND(RUNLOOP_FRAME_LIMIT_HIST_SIZE - 3) / 1000.0,
+               100.0 * over / (double)stats->count);
+      }
+
       if (len)
       {
          /* TODO/FIXME - localize */
@@ -3856,6 +3890,44 @@ void video_driver_frame(const void *data, unsigned width,
          strlcpy(latency_stats + _len, tmp, sizeof(latency_stats) - _len);
       }
 
+#ifdef HAVE_MENU
+      {
+         gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+         uint64_t lookups                   = p_gfx_thumb->cache_hits
+               + p_gfx_thumb->cache_misses;
+
+         /* TODO/FIXME - localize */
+         if (lookups > 0)
+            snprintf(thumbnail_stats, sizeof(thumbnail_stats),
+                  "THUMBNAIL CACHE\n"
+                  " Images:      %5u\n"
+                  " Size:        %5u KB\n"
+                  " Hits:        %5" PRIu64 "\n"
+                  " Misses:      %5" PRIu64 "\n"
+                  " - Hit Rate:  %5.2f %%\n",
+                  (unsigned)p_gfx_thumb->cache_count,
+                  (unsigned)(p_gfx_thumb->cache_bytes / 1024),
+                  p_gfx_thumb->cache_hits,
+                  p_gfx_thumb->cache_misses,
+                  100.0f * (float)p_gfx_thumb->cache_hits / (float)lookups);
+      }
+#endif
+
+      {
+         unsigned draws = 0;
+         unsigned calls = 0;
+
+         gfx_display_get_draw_stats(&draws, &calls);
+
+         /* TODO/FIXME - localize */
+         if (draws > 0)
+            snprintf(draw_stats, sizeof(draw_stats),
+                  "DISPLAY DRAWS\n"
+                  " Submitted:   %5u\n"
+                  " Draw Calls:  %5u\n",
+                  draws, calls);
+      }
+
       /* TODO/FIXME - localize */
       snprintf(video_info.stat_text,
             sizeof(video_info.stat_text),
@@ -3879,6 +3951,8 @@ void video_driver_frame(const void *data, unsigned width,
             " Blocking:    %5.2f %%\n"
             " Samples:     %5d\n"
             "%s"
+            "%s"
+            "%s"
             "%s",
             av_info->geometry.base_width,
             av_info->geometry.base_height,
@@ -3902,7 +3976,9 @@ void video_driver_frame(const void *data, unsigned width,
             audio_stats.close_to_blocking,
             audio_stats.samples,
             throttle_stats,
-            latency_stats);
+            latency_stats,
+            thumbnail_stats,
+            draw_stats);
 
       /* TODO/FIXME - add OSD chat text here */
    }
@@ -3911,6 +3987,8 @@ void video_driver_frame(const void *data, unsigned width,
          && video_st->current_video
          && video_st->current_video->frame)
    {
+      retro_time_t trace_start = TRACE_EVENT_BEGIN();
+
       if (video_st->current_video->frame(
                video_st->data, data, width, height,
                video_st->frame_count, (unsigned)pitch,
@@ -3920,6 +3998,8 @@ void video_driver_frame(const void *data, unsigned width,
          video_st->flags |=  VIDEO_FLAG_ACTIVE;
       else
          video_st->flags &= ~VIDEO_FLAG_ACTIVE;
+
+      TRACE_EVENT_END("video_frame", trace_start);
    }
 
    video_st->frame_count++;
@@ -485,6 +485,7 @@ typedef struct video_frame_info
    bool runloop_is_paused;
    bool fastforward_frameskip;
    bool frame_rest;
+   bool frame_limit_precise;
    bool msg_bgcolor_enable;
    bool crt_switch_hires_menu;
    bool hdr_enable;
@@ -157,6 +157,7 @@ ENCODINGS
 PERFORMANCE
 ============================================================ */
 #include "../libretro-common/features/features_cpu.c"
+#include "../libretro-common/features/features_trace.c"
 
 /*============================================================
 CONFIG FILE
@@ -778,6 +779,7 @@ INPUT (HID)
 FIFO BUFFER
 ============================================================ */
 #include "../libretro-common/queues/fifo_queue.c"
+#include "../libretro-common/queues/spsc_queue.c"
 
 /*============================================================
 AUDIO RESAMPLER
@@ -1062,6 +1064,7 @@ FILE
 #include "../libretro-common/file/nbio/nbio_stdio.c"
 #if defined(__linux__)
 #include "../libretro-common/file/nbio/nbio_linux.c"
+#include "../libretro-common/file/nbio/nbio_uring.c"
 #endif
 #if defined(HAVE_MMAP) && defined(BSD)
 #include "../libretro-common/file/nbio/nbio_unixmmap.c"
@@ -1167,6 +1170,7 @@ RETROARCH
 ============================================================ */
 #include "../retroarch.c"
 #include "../runloop.c"
+#include "../core_memory_map.c"
 #ifdef HAVE_RUNAHEAD
 #include "../runahead.c"
 #endif
@@ -1220,6 +1224,7 @@ THREAD
 #endif
 
 #include "../libretro-common/rthreads/rthreads.c"
+#include "../libretro-common/rthreads/tpool.c"
 #include "../gfx/video_thread_wrapper.c"
 #include "../audio/audio_thread_wrapper.c"
 #endif
@@ -24,6 +24,7 @@
 #include <encodings/utf.h>
 #include <clamping.h>
 #include <retro_endianness.h>
+#include <features/features_trace.h>
 
 #include "input_driver.h"
 #include "input_keymaps.h"
@@ -54,6 +55,8 @@
 #include "../list_special.h"
 #include "../performance_counters.h"
 #ifdef HAVE_BSV_MOVIE
+#include <streams/trans_stream.h>
+#include "../audio/audio_driver.h"
 #include "../tasks/task_content.h"
 #endif
 #include "../tasks/tasks_internal.h"
@@ -5087,7 +5090,10 @@ void bsv_movie_enqueue(input_driver_state_t *input_st, bsv_movie_t * state, enum
    if (input_st->bsv_movie_state_next_handle)
       bsv_movie_free(input_st->bsv_movie_state_next_handle);
    input_st->bsv_movie_state_next_handle    = state;
-   input_st->bsv_movie_state.flags          = flags;
+   /* Command line modes outlive the replay being (re)started */
+   input_st->bsv_movie_state.flags          = flags
+      | (input_st->bsv_movie_state.flags
+         & (BSV_FLAG_MOVIE_EOF_EXIT | BSV_FLAG_MOVIE_BENCHMARK));
 }
 
 void bsv_movie_deinit(input_driver_state_t *input_st)
@@ -5105,6 +5111,254 @@ void bsv_movie_deinit_full(input_driver_state_t *input_st)
    input_st->bsv_movie_state_next_handle = NULL;
 }
 
+static void bsv_movie_push_checkpoint(bsv_movie_t *handle,
+      uint64_t frame, uint64_t offset)
+{
+   if (handle->checkpoint_count >= handle->checkpoint_capacity)
+   {
+      size_t new_cap                  = handle->checkpoint_capacity
+         ? handle->checkpoint_capacity * 2 : 64;
+      bsv_checkpoint_entry_t *entries = (bsv_checkpoint_entry_t*)
+         realloc(handle->checkpoints, new_cap * sizeof(*entries));
+      if (!entries)
+         return;
+      handle->checkpoints         = entries;
+      handle->checkpoint_capacity = new_cap;
+   }
+   handle->checkpoints[handle->checkpoint_count].frame  = frame;
+   handle->checkpoints[handle->checkpoint_count].offset = offset;
+   handle->checkpoint_count++;
+}
+
+/* Drops index entries at or past @offset and the delta base,
+ * so the next checkpoint written is a keyframe. */
+static void bsv_movie_truncate_checkpoints(bsv_movie_t *handle,
+      uint64_t offset)
+{
+   while (     handle->checkpoint_count > 0
+         &&    handle->checkpoints[handle->checkpoint_count - 1].offset
+            >= offset)
+      handle->checkpoint_count--;
+   free(handle->last_checkpoint);
+   handle->last_checkpoint            = NULL;
+   handle->last_checkpoint_size       = 0;
+   handle->last_checkpoint_frame      = 0;
+   handle->checkpoints_since_keyframe = 0;
+}
+
+static bool bsv_movie_write_checkpoint(bsv_movie_t *handle)
+{
+   retro_ctx_serialize_info_t serial_info;
+   uint64_t frame, base_frame, raw_size, stored_size;
+   uint8_t frame_tok                = REPLAY_TOKEN_DELTA_CHECKPOINT_FRAME;
+   uint8_t encoding                 = REPLAY_CHECKPOINT_KEYFRAME;
+   uint8_t compression              = REPLAY_CHECKPOINT_COMPRESSION_NONE;
+   size_t info_size                 = core_serialize_size();
+   int64_t offset                   = intfstream_tell(handle->file);
+   uint8_t *st                      = NULL;
+   uint8_t *data                    = NULL;
+   uint8_t *zbuf                    = NULL;
+   size_t data_size                 = info_size;
+#ifdef HAVE_ZLIB
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_deflate_backend();
+#endif
+
+   if (!info_size || !(st = (uint8_t*)malloc(info_size)))
+      return false;
+
+   serial_info.data = st;
+   serial_info.size = info_size;
+   core_serialize(&serial_info);
+
+   /* Consecutive states of most cores differ only in a small
+    * fraction of bytes, so XOR against the previous checkpoint
+    * leaves mostly zeros for the compressor. */
+   if (     handle->last_checkpoint
+         && handle->last_checkpoint_size == info_size
+         && handle->checkpoints_since_keyframe
+            < REPLAY_CHECKPOINT_KEYFRAME_INTERVAL)
+   {
+      size_t i;
+      uint8_t *base = handle->last_checkpoint;
+      for (i = 0; i < info_size; i++)
+         base[i] ^= st[i];
+      data      = base;
+      encoding  = REPLAY_CHECKPOINT_DELTA;
+      handle->checkpoints_since_keyframe++;
+   }
+   else
+   {
+      data      = st;
+      handle->checkpoints_since_keyframe = 1;
+   }
+
+#ifdef HAVE_ZLIB
+   if (backend)
+   {
+      /* zlib's compressBound() */
+      size_t zbuf_size = info_size + (info_size >> 12)
+         + (info_size >> 14) + (info_size >> 25) + 13;
+      void *stream     = NULL;
+
+      if (     (zbuf   = (uint8_t*)malloc(zbuf_size))
+            && (stream = backend->stream_new()))
+      {
+         uint32_t rd = 0, wn = 0;
+         backend->set_in(stream, data, (uint32_t)info_size);
+         backend->set_out(stream, zbuf, (uint32_t)zbuf_size);
+         if (     backend->trans(stream, true, &rd, &wn, NULL)
+               && rd == info_size
+               && wn <  info_size)
+         {
+            data        = zbuf;
+            data_size   = wn;
+            compression = REPLAY_CHECKPOINT_COMPRESSION_ZLIB;
+         }
+      }
+      if (stream)
+         backend->stream_free(stream);
+   }
+#endif
+
+   frame       = swap_if_big64(handle->frame_counter);
+   base_frame  = swap_if_big64(handle->last_checkpoint_frame);
+   raw_size    = swap_if_big64((uint64_t)info_size);
+   stored_size = swap_if_big64((uint64_t)data_size);
+
+   /* "next frame is a checkpoint" */
+   intfstream_write(handle->file, &frame_tok,   sizeof(uint8_t));
+   intfstream_write(handle->file, &encoding,    sizeof(uint8_t));
+   intfstream_write(handle->file, &compression, sizeof(uint8_t));
+   intfstream_write(handle->file, &frame,       sizeof(uint64_t));
+   intfstream_write(handle->file, &base_frame,  sizeof(uint64_t));
+   intfstream_write(handle->file, &raw_size,    sizeof(uint64_t));
+   intfstream_write(handle->file, &stored_size, sizeof(uint64_t));
+   intfstream_write(handle->file, data,         data_size);
+
+   bsv_movie_push_checkpoint(handle, handle->frame_counter, (uint64_t)offset);
+
+   free(zbuf);
+   free(handle->last_checkpoint);
+   handle->last_checkpoint       = st;
+   handle->last_checkpoint_size  = info_size;
+   handle->last_checkpoint_frame = handle->frame_counter;
+   return true;
+}
+
+/* Reads a delta checkpoint record following its token into
+ * handle->last_checkpoint. @applied is false if the record is
+ * a delta with no base to apply it to (e.g. right after a
+ * state load); the stream is still advanced past it. */
+static bool bsv_movie_read_checkpoint(bsv_movie_t *handle, bool *applied)
+{
+   uint8_t encoding, compression;
+   uint64_t frame, base_frame, raw_size, stored_size;
+   uint8_t *stored = NULL;
+   uint8_t *raw    = NULL;
+
+   *applied        = false;
+
+   if (     intfstream_read(handle->file, &encoding,    sizeof(uint8_t))  != sizeof(uint8_t)
+         || intfstream_read(handle->file, &compression, sizeof(uint8_t))  != sizeof(uint8_t)
+         || intfstream_read(handle->file, &frame,       sizeof(uint64_t)) != sizeof(uint64_t)
+         || intfstream_read(handle->file, &base_frame,  sizeof(uint64_t)) != sizeof(uint64_t)
+         || intfstream_read(handle->file, &raw_size,    sizeof(uint64_t)) != sizeof(uint64_t)
+         || intfstream_read(handle->file, &stored_size, sizeof(uint64_t)) != sizeof(uint64_t))
+      return false;
+
+   frame       = swap_if_big64(frame);
+   base_frame  = swap_if_big64(base_frame);
+   raw_size    = swap_if_big64(raw_size);
+   stored_size = swap_if_big64(stored_size);
+
+   if (!(stored = (uint8_t*)malloc((size_t)stored_size)))
+      return false;
+   if (intfstream_read(handle->file, stored,
+            (int64_t)stored_size) != (int64_t)stored_size)
+   {
+      free(stored);
+      return false;
+   }
+
+   handle->frame_counter = frame;
+
+   /* The base may be stale after a rewind or state load */
+   if (     encoding == REPLAY_CHECKPOINT_DELTA
+         && (  !handle->last_checkpoint
+             || handle->last_checkpoint_size  != raw_size
+             || handle->last_checkpoint_frame != base_frame))
+   {
+      RARCH_WARN("[Replay] Skipping checkpoint delta without a base at frame %llu\n",
+            (unsigned long long)frame);
+      free(stored);
+      return true;
+   }
+
+   if (compression == REPLAY_CHECKPOINT_COMPRESSION_NONE)
+   {
+      if (stored_size != raw_size)
+      {
+         free(stored);
+         return false;
+      }
+      raw    = stored;
+      stored = NULL;
+   }
+   else
+   {
+#ifdef HAVE_ZLIB
+      const struct trans_stream_backend *backend =
+         trans_stream_get_zlib_inflate_backend();
+      void *stream = NULL;
+      uint32_t rd  = 0, wn = 0;
+      bool ok      = false;
+
+      if (     backend
+            && (raw    = (uint8_t*)malloc((size_t)raw_size))
+            && (stream = backend->stream_new()))
+      {
+         backend->set_in(stream, stored, (uint32_t)stored_size);
+         backend->set_out(stream, raw, (uint32_t)raw_size);
+         ok = backend->trans(stream, true, &rd, &wn, NULL)
+            && wn == raw_size;
+      }
+      if (stream)
+         backend->stream_free(stream);
+      free(stored);
+      stored = NULL;
+      if (!ok)
+      {
+         free(raw);
+         return false;
+      }
+#else
+      RARCH_ERR("[Replay] Compressed checkpoints need zlib support\n");
+      free(stored);
+      return false;
+#endif
+   }
+
+   if (encoding == REPLAY_CHECKPOINT_DELTA)
+   {
+      size_t i;
+      uint8_t *base = handle->last_checkpoint;
+      for (i = 0; i < raw_size; i++)
+         base[i] ^= raw[i];
+      free(raw);
+   }
+   else
+   {
+      free(handle->last_checkpoint);
+      handle->last_checkpoint      = raw;
+      handle->last_checkpoint_size = (size_t)raw_size;
+   }
+
+   handle->last_checkpoint_frame = frame;
+   *applied                      = true;
+   return true;
+}
+
 void bsv_movie_frame_rewind(void)
 {
    input_driver_state_t *input_st = &input_driver_st;
@@ -5119,7 +5373,8 @@ void bsv_movie_frame_rewind(void)
          && (handle->frame_pos[0] == handle->min_file_pos))
    {
       /* If we're at the beginning... */
-      handle->frame_ptr = 0;
+      handle->frame_ptr     = 0;
+      handle->frame_counter = 0;
       intfstream_seek(handle->file, (int)handle->min_file_pos, SEEK_SET);
    }
    else
@@ -5130,12 +5385,19 @@ void bsv_movie_frame_rewind(void)
        *
        * Sucessively rewinding frames, we need to rewind past the read data,
        * plus another. */
-      handle->frame_ptr = (handle->frame_ptr -
-            (handle->first_rewind ? 1 : 2)) & handle->frame_mask;
+      unsigned frames   = handle->first_rewind ? 1 : 2;
+      handle->frame_ptr = (handle->frame_ptr - frames) & handle->frame_mask;
+      if (handle->frame_counter >= frames)
+         handle->frame_counter -= frames;
       intfstream_seek(handle->file,
             (int)handle->frame_pos[handle->frame_ptr], SEEK_SET);
    }
 
+   /* Checkpoints past this point are about to be overwritten */
+   if (!handle->playback)
+      bsv_movie_truncate_checkpoints(handle,
+            (uint64_t)intfstream_tell(handle->file));
+
    if (intfstream_tell(handle->file) <= (long)handle->min_file_pos)
    {
       /* We rewound past the beginning. */
@@ -5223,23 +5485,10 @@ void bsv_movie_next_frame(input_driver_state_t *input_st)
       bsv_movie_handle_clear_key_events(handle);
 
       /* Maybe record checkpoint */
-      if (checkpoint_interval != 0 && handle->frame_ptr > 0 && (handle->frame_ptr % (checkpoint_interval*60) == 0))
-      {
-         retro_ctx_serialize_info_t serial_info;
-         uint8_t frame_tok = REPLAY_TOKEN_CHECKPOINT_FRAME;
-         size_t info_size  = core_serialize_size();
-         uint64_t size     = swap_if_big64(info_size);
-         uint8_t *st       = (uint8_t*)malloc(info_size);
-         serial_info.data  = st;
-         serial_info.size  = info_size;
-         core_serialize(&serial_info);
-         /* "next frame is a checkpoint" */
-         intfstream_write(handle->file, (uint8_t *)(&frame_tok), sizeof(uint8_t));
-         intfstream_write(handle->file, &size, sizeof(uint64_t));
-         intfstream_write(handle->file, st, info_size);
-         free(st);
-      }
-      else
+      if (!(      checkpoint_interval != 0
+               && handle->frame_ptr > 0
+               && (handle->frame_ptr % (checkpoint_interval*60) == 0)
+               && bsv_movie_write_checkpoint(handle)))
       {
          uint8_t frame_tok = REPLAY_TOKEN_REGULAR_FRAME;
          /* write "next frame is not a checkpoint" */
@@ -5249,6 +5498,14 @@ void bsv_movie_next_frame(input_driver_state_t *input_st)
 
    if (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_PLAYBACK)
    {
+      /* Don't read the seek index footer as frame data */
+      if (     handle->end_file_pos
+            && intfstream_tell(handle->file) >= (int64_t)handle->end_file_pos)
+      {
+         RARCH_LOG("[Replay] Reached checkpoint index, end of replay\n");
+         input_st->bsv_movie_state.flags |= BSV_FLAG_MOVIE_END;
+         return;
+      }
       /* read next key events, a frame happened for sure? but don't apply them yet */
       if (handle->key_event_count != 0)
       {
@@ -5317,16 +5574,169 @@ void bsv_movie_next_frame(input_driver_state_t *input_st)
            core_unserialize(&serial_info);
            free(st);
         }
+        else if (next_frame_type == REPLAY_TOKEN_DELTA_CHECKPOINT_FRAME)
+        {
+           int64_t offset = intfstream_tell(handle->file) - 1;
+           bool applied   = false;
+
+           if (!bsv_movie_read_checkpoint(handle, &applied))
+           {
+              RARCH_ERR("[Replay] Replay checkpoint truncated\n");
+              input_st->bsv_movie_state.flags |= BSV_FLAG_MOVIE_END;
+              return;
+           }
+
+           /* Replays without an index footer get their
+            * index built up as they are played back */
+           if (     handle->checkpoint_count == 0
+                 || handle->checkpoints[handle->checkpoint_count - 1].offset
+                  < (uint64_t)offset)
+              bsv_movie_push_checkpoint(handle,
+                    handle->frame_counter, (uint64_t)offset);
+
+           if (applied)
+           {
+              retro_ctx_serialize_info_t serial_info;
+              serial_info.data_const = handle->last_checkpoint;
+              serial_info.size       = handle->last_checkpoint_size;
+              core_unserialize(&serial_info);
+           }
+        }
       }
    }
    handle->frame_pos[handle->frame_ptr] = intfstream_tell(handle->file);
+   handle->frame_counter++;
+}
+
+bool bsv_movie_seek_to_frame(input_driver_state_t *input_st, uint64_t frame)
+{
+   retro_ctx_serialize_info_t serial_info;
+   size_t i, first;
+   size_t last                    = 0;
+   size_t lo                      = 0;
+   bsv_movie_t *handle            = input_st->bsv_movie_state_handle;
+   video_driver_state_t *video_st = video_state_get_ptr();
+   audio_driver_state_t *audio_st = audio_state_get_ptr();
+   bool found                     = false;
+   bool video_active              = false;
+
+   if (     !handle
+         || !(input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_PLAYBACK))
+      return false;
+
+   /* Binary search for the last checkpoint taken before
+    * the target frame; checkpoints are sorted by frame. */
+   {
+      size_t hi = handle->checkpoint_count;
+      while (lo < hi)
+      {
+         size_t mid = lo + ((hi - lo) >> 1);
+         if (handle->checkpoints[mid].frame < frame)
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+   }
+
+   if (lo > 0)
+   {
+      uint8_t encoding = REPLAY_CHECKPOINT_DELTA;
+      last             = lo - 1;
+
+      /* Walk back to the keyframe the delta chain starts from */
+      for (first = last; ; first--)
+      {
+         intfstream_seek(handle->file,
+               (int64_t)handle->checkpoints[first].offset + 1, SEEK_SET);
+         if (intfstream_read(handle->file, &encoding,
+                  sizeof(uint8_t)) != sizeof(uint8_t))
+            return false;
+         if (encoding == REPLAY_CHECKPOINT_KEYFRAME || first == 0)
+            break;
+      }
+
+      for (i = first; i <= last; i++)
+      {
+         uint8_t tok  = REPLAY_TOKEN_INVALID;
+         bool applied = false;
+         intfstream_seek(handle->file,
+               (int64_t)handle->checkpoints[i].offset, SEEK_SET);
+         if (     intfstream_read(handle->file, &tok,
+                     sizeof(uint8_t)) != sizeof(uint8_t)
+               || tok != REPLAY_TOKEN_DELTA_CHECKPOINT_FRAME
+               || !bsv_movie_read_checkpoint(handle, &applied))
+         {
+            RARCH_ERR("[Replay] Invalid checkpoint index entry at frame %llu\n",
+                  (unsigned long long)handle->checkpoints[i].frame);
+            return false;
+         }
+         found = applied;
+      }
+   }
+
+   if (found)
+   {
+      serial_info.data_const = handle->last_checkpoint;
+      serial_info.size       = handle->last_checkpoint_size;
+      handle->frame_counter  = handle->checkpoints[last].frame + 1;
+   }
+   else
+   {
+      /* No usable checkpoint, start over from the initial state,
+       * which for replays recorded from power-on is a reset */
+      handle->frame_counter  = 0;
+      intfstream_seek(handle->file, (int64_t)handle->min_file_pos, SEEK_SET);
+   }
+
+   if (found)
+      core_unserialize(&serial_info);
+   else if (handle->state)
+   {
+      serial_info.data_const = handle->state;
+      serial_info.size       = handle->state_size;
+      core_unserialize(&serial_info);
+   }
+   else
+      core_reset();
+   bsv_movie_handle_clear_key_events(handle);
+   input_st->bsv_movie_state.flags &= ~BSV_FLAG_MOVIE_END;
+
+   /* Replay the input frames between the checkpoint
+    * and the target without presenting them */
+   video_active     = (video_st->flags & VIDEO_FLAG_ACTIVE) ? true : false;
+   video_st->flags &= ~VIDEO_FLAG_ACTIVE;
+   audio_st->flags |=  AUDIO_FLAG_SUSPENDED;
+
+   if (found)
+      core_run();
+   while (     handle->frame_counter < frame
+         && !(input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_END))
+   {
+      bsv_movie_next_frame(input_st);
+      if (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_END)
+         break;
+      core_run();
+   }
+
+   if (video_active)
+      video_st->flags |=  VIDEO_FLAG_ACTIVE;
+   audio_st->flags    &= ~AUDIO_FLAG_SUSPENDED;
+
+   handle->frame_ptr                    = (size_t)handle->frame_counter
+      & handle->frame_mask;
+   handle->frame_pos[handle->frame_ptr] = intfstream_tell(handle->file);
+   handle->first_rewind                 = true;
+
+   return handle->frame_counter == frame;
 }
 
 size_t replay_get_serialize_size(void)
 {
    input_driver_state_t *input_st = &input_driver_st;
+   /* Replay data length, replay data, frame counter */
    if (input_st->bsv_movie_state.flags & (BSV_FLAG_MOVIE_RECORDING | BSV_FLAG_MOVIE_PLAYBACK))
-      return sizeof(int32_t)+intfstream_tell(input_st->bsv_movie_state_handle->file);
+      return sizeof(int32_t)+intfstream_tell(input_st->bsv_movie_state_handle->file)
+         + sizeof(uint64_t);
    return 0;
 }
 
@@ -5351,11 +5761,26 @@ bool replay_get_serialized_data(void* buffer)
       read_amt                = intfstream_read(handle->file, (void *)buf, file_end);
       if (read_amt != file_end)
          RARCH_ERR("[Replay] Failed to write correct number of replay bytes into state file: %d / %d\n", read_amt, file_end);
+      else
+      {
+         uint64_t frame       = swap_if_big64(handle->frame_counter);
+         memcpy(buf + file_end, &frame, sizeof(uint64_t));
+      }
    }
    return true;
 }
 
-bool replay_set_serialized_data(void* buf)
+/* Frame starting at @offset of a state saved without its frame
+ * counter: the last checkpoint before it is the best guess */
+static uint64_t bsv_movie_guess_frame(bsv_movie_t *handle, uint64_t offset)
+{
+   size_t i = handle->checkpoint_count;
+   while (i > 0 && handle->checkpoints[i - 1].offset >= offset)
+      i--;
+   return i > 0 ? handle->checkpoints[i - 1].frame : 0;
+}
+
+bool replay_set_serialized_data(void* buf, size_t size)
 {
    uint8_t *buffer                = buf;
    input_driver_state_t *input_st = &input_driver_st;
@@ -5427,6 +5852,37 @@ bool replay_set_serialized_data(void* buf)
          }
          else
             intfstream_seek(input_st->bsv_movie_state_handle->file, loaded_len, SEEK_SET);
+
+         /* Move the frame counter, the rewind ring and the
+            checkpoint state to the loaded point together, so
+            that later checkpoints and seeks line up with it */
+         {
+            bsv_movie_t *handle = input_st->bsv_movie_state_handle;
+            uint64_t frame;
+
+            if (size >= sizeof(int32_t) + (size_t)loaded_len + sizeof(uint64_t))
+            {
+               memcpy(&frame, buffer + sizeof(int32_t) + loaded_len,
+                     sizeof(uint64_t));
+               frame = swap_if_big64(frame);
+            }
+            else
+            {
+               frame = bsv_movie_guess_frame(handle, (uint64_t)loaded_len);
+               RARCH_WARN("[Replay] State has no replay frame counter, assuming frame %llu.\n",
+                     (unsigned long long)frame);
+            }
+
+            if (recording)
+               bsv_movie_truncate_checkpoints(handle,
+                     (uint64_t)(handle_idx < loaded_len ? handle_idx : loaded_len));
+
+            handle->frame_counter                = frame;
+            handle->frame_ptr                    = (size_t)frame
+               & handle->frame_mask;
+            handle->frame_pos[handle->frame_ptr] = loaded_len;
+            handle->first_rewind                 = true;
+         }
       }
       else
       {
@@ -5472,6 +5928,7 @@ void input_driver_poll(void)
 #endif
    bool input_remap_binds_enable  = settings->bools.input_remap_binds_enable;
    uint8_t max_users              = (uint8_t)settings->uints.input_max_users;
+   retro_time_t trace_start       = TRACE_EVENT_BEGIN();
 
    if (     joypad && joypad->poll)
       joypad->poll();
@@ -5481,6 +5938,8 @@ void input_driver_poll(void)
          && input_st->current_driver->poll)
       input_st->current_driver->poll(input_st->current_data);
 
+   TRACE_EVENT_END("input_poll", trace_start);
+
    input_st->turbo_btns.count++;
 
    if (input_st->flags & INP_FLAG_BLOCK_LIBRETRO_INPUT)
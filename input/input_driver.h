@@ -105,6 +105,23 @@
 #define REPLAY_TOKEN_INVALID          '\0'
 #define REPLAY_TOKEN_REGULAR_FRAME    'f'
 #define REPLAY_TOKEN_CHECKPOINT_FRAME 'c'
+/* Checkpoint stored as a (possibly compressed) XOR delta
+ * against the previous checkpoint */
+#define REPLAY_TOKEN_DELTA_CHECKPOINT_FRAME 'd'
+
+#define REPLAY_CHECKPOINT_KEYFRAME          0
+#define REPLAY_CHECKPOINT_DELTA             1
+
+#define REPLAY_CHECKPOINT_COMPRESSION_NONE  0
+#define REPLAY_CHECKPOINT_COMPRESSION_ZLIB  1
+
+/* Every Nth checkpoint is stored in full, which bounds
+ * the number of deltas a seek has to decode */
+#define REPLAY_CHECKPOINT_KEYFRAME_INTERVAL 16
+
+/* Trailer of the checkpoint seek index appended to
+ * finished recordings: <entries> <count:u32> <magic:u32> */
+#define REPLAY_INDEX_MAGIC                  0x42535649
 
 /**
  * Takes as input analog key identifiers and converts them to corresponding
@@ -168,7 +185,9 @@ enum bsv_flags
    BSV_FLAG_MOVIE_PLAYBACK           = (1 << 2),
    BSV_FLAG_MOVIE_RECORDING          = (1 << 3),
    BSV_FLAG_MOVIE_END                = (1 << 4),
-   BSV_FLAG_MOVIE_EOF_EXIT           = (1 << 5)
+   BSV_FLAG_MOVIE_EOF_EXIT           = (1 << 5),
+   /* Headless, unpaced playback with per-frame timing */
+   BSV_FLAG_MOVIE_BENCHMARK          = (1 << 6)
 };
 
 struct bsv_state
@@ -192,18 +211,42 @@ struct bsv_key_data
 
 typedef struct bsv_key_data bsv_key_data_t;
 
+/* Seek index entry, one per checkpoint.
+ * Stored little-endian in the index footer. */
+struct bsv_checkpoint_entry
+{
+   uint64_t frame;
+   /* File offset of the checkpoint token */
+   uint64_t offset;
+};
+
+typedef struct bsv_checkpoint_entry bsv_checkpoint_entry_t;
+
 struct bsv_movie
 {
    intfstream_t *file;
    uint8_t *state;
+   /* Uncompressed copy of the last checkpoint
+    * written or read, used as the delta base. */
+   uint8_t *last_checkpoint;
    /* A ring buffer keeping track of positions
     * in the file for each frame. */
    size_t *frame_pos;
+   bsv_checkpoint_entry_t *checkpoints;
    int64_t identifier;
+   uint64_t frame_counter;
+   uint64_t last_checkpoint_frame;
    size_t frame_mask;
    size_t frame_ptr;
    size_t min_file_pos;
+   /* Start of the index footer, or 0 if the
+    * replay has none */
+   size_t end_file_pos;
    size_t state_size;
+   size_t last_checkpoint_size;
+   size_t checkpoint_count;
+   size_t checkpoint_capacity;
+   unsigned checkpoints_since_keyframe;
    bsv_key_data_t key_events[255]; /* uint32_t alignment */
 
    /* Staging variables for keyboard events */
@@ -216,6 +259,30 @@ struct bsv_movie
 };
 
 typedef struct bsv_movie bsv_movie_t;
+
+/* Statistics gathered while playing back a
+ * replay with --replay-benchmark. */
+struct bsv_benchmark
+{
+   uint8_t *state;
+   /* Per-frame state hashes to compare against */
+   uint32_t *reference;
+   intfstream_t *hash_file;
+   retro_time_t start_time;
+   retro_time_t core_time;
+   retro_time_t core_time_max;
+   retro_time_t serialize_time;
+   retro_time_t serialize_time_max;
+   uint64_t frames;
+   uint64_t first_divergence;
+   uint64_t divergences;
+   size_t state_size;
+   size_t reference_count;
+   char hash_path[PATH_MAX_LENGTH];
+   char reference_path[PATH_MAX_LENGTH];
+};
+
+typedef struct bsv_benchmark bsv_benchmark_t;
 #endif
 
 /**
@@ -513,6 +580,7 @@ typedef struct
 #ifdef HAVE_BSV_MOVIE
    bsv_movie_t     *bsv_movie_state_handle;              /* ptr alignment */
    bsv_movie_t     *bsv_movie_state_next_handle;         /* ptr alignment */
+   bsv_benchmark_t *bsv_movie_benchmark;                 /* ptr alignment */
 #endif
 #ifdef HAVE_OVERLAY
    input_overlay_t *overlay_ptr;
@@ -1006,16 +1074,22 @@ void bsv_movie_finish_rewind(input_driver_state_t *input_st);
 void bsv_movie_deinit(input_driver_state_t *input_st);
 void bsv_movie_deinit_full(input_driver_state_t *input_st);
 void bsv_movie_enqueue(input_driver_state_t *input_st, bsv_movie_t *state, enum bsv_flags flags);
+bool bsv_movie_seek_to_frame(input_driver_state_t *input_st, uint64_t frame);
 
 bool movie_start_playback(input_driver_state_t *input_st, char *path);
 bool movie_start_record(input_driver_state_t *input_st, char *path);
 bool movie_stop_playback(input_driver_state_t *input_st);
 bool movie_stop_record(input_driver_state_t *input_st);
 bool movie_stop(input_driver_state_t *input_st);
+bool movie_benchmark_init(input_driver_state_t *input_st);
+void movie_benchmark_frame(input_driver_state_t *input_st,
+      retro_time_t core_time);
+void movie_benchmark_deinit(input_driver_state_t *input_st);
 
 size_t replay_get_serialize_size(void);
 bool replay_get_serialized_data(void* buffer);
-bool replay_set_serialized_data(void* buffer);
+/* @size is the size of the replay block, 0 with a NULL @buffer */
+bool replay_set_serialized_data(void* buffer, size_t size);
 #endif
 
 /**
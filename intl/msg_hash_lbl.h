@@ -295,6 +295,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA,
    "audio_rate_control_delta"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_LATENCY_ADAPTIVE,
+   "audio_latency_adaptive"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER,
    "audio_resampler_driver"
@@ -3345,6 +3349,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_VRR_RUNLOOP_ENABLE,
    "vrr_runloop_enable"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_FRAME_LIMIT_PRECISE,
+   "frame_limit_precise"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_THROTTLE_FRAMERATE,
    "menu_throttle_framerate"
@@ -3699,6 +3707,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_SCREENSHOTS_IN_CONTENT_DIR_ENABLE,
    "screenshots_in_content_dir_enable"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_SCREENSHOT_FAST_COMPRESSION,
+   "screenshot_fast_compression"
+   )
 #ifdef HAVE_LAKKA
 MSG_HASH(
    MENU_ENUM_LABEL_SSH_ENABLE,
@@ -3816,6 +3828,18 @@ MSG_HASH(
    MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "menu_thumbnail_upscale_threshold"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_THUMBNAIL_DOWNSCALE_THRESHOLD,
+   "menu_thumbnail_downscale_threshold"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,
+   "menu_thumbnail_cache_size"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_THUMBNAIL_DISK_CACHE,
+   "menu_thumbnail_disk_cache"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DOWNSCALER,
    "rgui_thumbnail_downscaler"
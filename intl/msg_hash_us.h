@@ -2749,6 +2749,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_HELP_VRR_RUNLOOP_ENABLE,
    "Sync to Exact Content Framerate. This option is the equivalent of forcing x1 speed while still allowing fast forward. No deviation from the core requested refresh rate, no sound Dynamic Rate Control."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_FRAME_LIMIT_PRECISE,
+   "Precise Frame Limiter"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_FRAME_LIMIT_PRECISE,
+   "When the framerate is limited without vsync, sleep until just before each frame is due and wait out the rest, reducing frame pacing jitter at the cost of some CPU usage."
+   )
 
 /* Settings > Audio */
 
@@ -3083,6 +3091,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_HELP_AUDIO_RATE_CONTROL_DELTA,
    "Setting this to 0 disables rate control. Any other value controls audio rate control delta.\nDefines how much input rate can be adjusted dynamically. Input rate is defined as:\ninput rate * (1.0 +/- (rate control delta))"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_LATENCY_ADAPTIVE,
+   "Adaptive Audio Latency"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_LATENCY_ADAPTIVE,
+   "Start with a low audio latency, raise it when the audio buffer runs dry and lower it again while playback is steady. 'Audio Latency' is the upper bound. Requires Dynamic Audio Rate Control and only takes effect with Vertical Sync on, since Audio Sync alone fills the whole buffer."
+   )
 
 /* Settings > Audio > MIDI */
 
@@ -4731,6 +4747,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_SCREENSHOTS_IN_CONTENT_DIR_ENABLE,
    "Use content directory as screenshot directory."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SCREENSHOT_FAST_COMPRESSION,
+   "Fast Screenshot Compression"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_SCREENSHOT_FAST_COMPRESSION,
+   "Save PNG screenshots and save state thumbnails several times faster, at the cost of larger files."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_CONTENT_RUNTIME_LOG,
    "Save Runtime Log (Per Core)"
@@ -6747,6 +6771,30 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "Automatically upscale thumbnail images with a width/height smaller than the specified value. Improves picture quality. Has a moderate performance impact."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_DOWNSCALE_THRESHOLD,
+   "Thumbnail Downscaling Threshold"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_DOWNSCALE_THRESHOLD,
+   "Automatically downscale thumbnail images with a width/height larger than the specified value. Reduces memory usage and texture uploads."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_SIZE,
+   "Thumbnail Cache Size (MB)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_CACHE_SIZE,
+   "Keep up to this much recently viewed thumbnail data in memory, so scrolling back through a playlist does not load the same images again. 0 disables the cache."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_DISK_CACHE,
+   "Cache Downscaled Thumbnails"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_DISK_CACHE,
+   "Save downscaled thumbnails to the cache directory and load those instead of the full size images."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_MENU_TICKER_TYPE,
    "Ticker Text Animation"
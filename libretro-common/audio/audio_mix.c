@@ -28,6 +28,8 @@
 
 #if defined(__SSE2__)
 #include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
 #elif defined(__ALTIVEC__)
 #include <altivec.h>
 #endif
@@ -78,6 +80,33 @@ void audio_mix_volume_SSE2(float *out, const float *in, float vol, size_t sample
 }
 #endif
 
+#if !defined(__SSE2__) && (defined(__ARM_NEON__) || defined(__ARM_NEON))
+void audio_mix_volume_NEON(float *out, const float *in, float vol, size_t samples)
+{
+   size_t i, remaining_samples;
+
+   for (i = 0; i + 16 <= samples; i += 16, out += 16, in += 16)
+   {
+      float32x4_t output[4];
+
+      output[0] = vmlaq_n_f32(vld1q_f32(out +  0), vld1q_f32(in +  0), vol);
+      output[1] = vmlaq_n_f32(vld1q_f32(out +  4), vld1q_f32(in +  4), vol);
+      output[2] = vmlaq_n_f32(vld1q_f32(out +  8), vld1q_f32(in +  8), vol);
+      output[3] = vmlaq_n_f32(vld1q_f32(out + 12), vld1q_f32(in + 12), vol);
+
+      vst1q_f32(out +  0, output[0]);
+      vst1q_f32(out +  4, output[1]);
+      vst1q_f32(out +  8, output[2]);
+      vst1q_f32(out + 12, output[3]);
+   }
+
+   remaining_samples = samples - i;
+
+   for (i = 0; i < remaining_samples; i++)
+      out[i] += in[i] * vol;
+}
+#endif
+
 void audio_mix_free_chunk(audio_chunk_t *chunk)
 {
    if (!chunk)
@@ -25,12 +25,15 @@
 #endif
 
 #include <audio/audio_mixer.h>
+#include <audio/audio_mix.h>
 #include <audio/audio_resampler.h>
+#include <queues/spsc_queue.h>
 
 #ifdef HAVE_RWAV
 #include <formats/rwav.h>
 #endif
 #include <memalign.h>
+#include <retro_miscellaneous.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -63,143 +66,133 @@
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
-#define AUDIO_MIXER_LOCK(voice)   slock_lock(voice->lock)
-#define AUDIO_MIXER_UNLOCK(voice) slock_unlock(voice->lock)
+#include <retro_atomic.h>
+#define AUDIO_MIXER_LOCK(voice)          slock_lock(voice->lock)
+#define AUDIO_MIXER_UNLOCK(voice)        slock_unlock(voice->lock)
+#define AUDIO_MIXER_STREAM_LOCK(voice)   slock_lock(voice->stream_lock)
+#define AUDIO_MIXER_STREAM_UNLOCK(voice) slock_unlock(voice->stream_lock)
 #else
-#define AUDIO_MIXER_LOCK(voice)   do {} while(0)
-#define AUDIO_MIXER_UNLOCK(voice) do {} while(0)
+#define AUDIO_MIXER_LOCK(voice)          do {} while(0)
+#define AUDIO_MIXER_UNLOCK(voice)        do {} while(0)
+#define AUDIO_MIXER_STREAM_LOCK(voice)   do {} while(0)
+#define AUDIO_MIXER_STREAM_UNLOCK(voice) do {} while(0)
 #endif
 
 #define AUDIO_MIXER_MAX_VOICES      8
 #define AUDIO_MIXER_TEMP_BUFFER 8192
 
+/* Compressed sounds no longer than this can be decoded and
+ * resampled once by audio_mixer_predecode(), and then mixed
+ * straight from memory like WAV sounds. Longer ones are
+ * streamed. */
+#define AUDIO_MIXER_PREDECODE_SECONDS 10
+/* No MP3 stream exceeds 320 kbit/s, so a larger file cannot
+ * be short enough to predecode */
+#define AUDIO_MIXER_MP3_MAX_BYTES_PER_SECOND 40000
+
+/* Stereo frames of output buffered ahead of a streamed voice,
+ * and source frames decoded at a time to refill it */
+#define AUDIO_MIXER_STREAM_FRAMES  16384
+#define AUDIO_MIXER_STREAM_CHUNK   1024
+/* Chunks decoded while starting a streamed voice */
+#define AUDIO_MIXER_STREAM_PREFILL 4
+
 struct audio_mixer_sound
 {
+   /* Stereo samples at the output rate, for WAV sounds and
+    * compressed sounds decoded at load */
+   float *pcm;
+   /* Compressed data of streamed sounds */
+   const void *data;
+   unsigned frames;
+   unsigned size;
    enum audio_mixer_type type;
+};
 
-   union
-   {
-      struct
-      {
-         /* wav */
-         const float* pcm;
-         unsigned frames;
-      } wav;
-
+/* Compressed sound being decoded to stereo float frames
+ * at its own sample rate */
+struct audio_mixer_decoder
+{
 #ifdef HAVE_STB_VORBIS
-      struct
-      {
-         /* ogg */
-         const void* data;
-         unsigned size;
-      } ogg;
+   stb_vorbis *ogg;
 #endif
-
 #ifdef HAVE_DR_FLAC
-      struct
-      {
-          /* flac */
-         const void* data;
-         unsigned size;
-      } flac;
+   drflac *flac;
 #endif
-
 #ifdef HAVE_DR_MP3
-      struct
-      {
-          /* mp */
-         const void* data;
-         unsigned size;
-      } mp3;
+   drmp3 mp3;
+   bool mp3_open;
 #endif
-
 #ifdef HAVE_IBXM
-      struct
-      {
-         /* mod/s3m/xm */
-         const void* data;
-         unsigned size;
-      } mod;
-#endif
-   } types;
-};
-
-struct audio_mixer_voice
-{
    struct
    {
-      struct
-      {
-         unsigned position;
-      } wav;
-
-#ifdef HAVE_STB_VORBIS
-      struct
-      {
-         stb_vorbis *stream;
-         void       *resampler_data;
-         const retro_resampler_t *resampler;
-         float      *buffer;
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float       ratio;
-      } ogg;
-#endif
-
-#ifdef HAVE_DR_FLAC
-      struct
-      {
-         float*      buffer;
-         drflac      *stream;
-         void        *resampler_data;
-         const retro_resampler_t *resampler;
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float       ratio;
-      } flac;
+      int*              buffer;
+      struct replay*    stream;
+      struct module*    module;
+      unsigned          position;
+      unsigned          samples;
+   } mod;
 #endif
+   /* Source frames for more than two channels */
+   float *scratch;
+   enum audio_mixer_type type;
+   unsigned rate;
+   unsigned channels;
+};
 
-#ifdef HAVE_DR_MP3
-      struct
-      {
-         drmp3       stream;
-         void        *resampler_data;
-         const retro_resampler_t *resampler;
-         float*      buffer;
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float       ratio;
-      } mp3;
-#endif
+/* Streamed voice. The decoder thread fills the ring with
+ * resampled frames, and audio_mixer_mix() drains it. All but
+ * the ring contents and loops are guarded by the stream lock
+ * of the voice. */
+struct audio_mixer_stream
+{
+   struct audio_mixer_decoder decoder;
+   spsc_queue_t *ring;
+   void        *resampler_data;
+   const retro_resampler_t *resampler;
+   float       *decoded;
+   float       *resampled;
+   unsigned     chunk_frames;
+   size_t       chunk_bytes;
+   /* Times the decoder went back to the start, and how many
+    * of those audio_mixer_mix() reported */
+   volatile unsigned loops;
+   unsigned     loops_seen;
+   float        ratio;
+   bool         repeat;
+   bool         active;
+   bool         ended;
+};
 
-#ifdef HAVE_IBXM
-      struct
-      {
-         int*              buffer;
-         struct replay*    stream;
-         struct module*    module;
-         unsigned          position;
-         unsigned          samples;
-         unsigned          buf_samples;
-      } mod;
-#endif
-   } types;
+struct audio_mixer_voice
+{
+   struct audio_mixer_stream stream;
    audio_mixer_sound_t *sound;
    audio_mixer_stop_cb_t stop_cb;
+   /* Next sample of sound->pcm */
+   unsigned position;
    unsigned type;
    float    volume;
    bool     repeat;
+   bool     streamed;
 #ifdef HAVE_THREADS
    slock_t *lock;
+   slock_t *stream_lock;
 #endif
 };
 
 /* TODO/FIXME - static globals */
 static struct audio_mixer_voice s_voices[AUDIO_MIXER_MAX_VOICES] = {0};
 static unsigned s_rate = 0;
+#ifdef HAVE_THREADS
+static sthread_t *s_stream_thread = NULL;
+static slock_t *s_stream_lock     = NULL;
+static scond_t *s_stream_cond     = NULL;
+/* Set when the rings need filling, cleared by the decoder
+ * thread before each pass over the voices */
+static volatile unsigned s_stream_wake = 0;
+static bool s_stream_quit         = false;
+#endif
 
 static void audio_mixer_release(audio_mixer_voice_t* voice);
 
@@ -279,6 +272,8 @@ static bool wav_to_float(const rwav_t* wav, float** pcm, size_t samples_out)
    return true;
 }
 
+#endif
+
 static bool one_shot_resample(const float* in, size_t samples_in,
       unsigned rate, const char *resampler_ident, enum resampler_quality quality,
       float** out, size_t* samples_out)
@@ -287,6 +282,7 @@ static bool one_shot_resample(const float* in, size_t samples_in,
    void* data                         = NULL;
    const retro_resampler_t* resampler = NULL;
    float ratio                        = (double)s_rate / (double)rate;
+   size_t max_samples                 = (size_t)(samples_in * ratio);
 
    if (!retro_resampler_realloc(&data, &resampler,
          resampler_ident, quality, ratio))
@@ -298,12 +294,14 @@ static bool one_shot_resample(const float* in, size_t samples_in,
     * formula below calculates. Ideally, audio resamplers should have a
     * function to return the number of samples they will output given a
     * count of input samples. */
-   *samples_out                       = (size_t)(samples_in * ratio);
    *out                               = (float*)memalign_alloc(16,
-         (((*samples_out + 16) + 15) & ~15) * sizeof(float));
+         (((max_samples + 16) + 15) & ~15) * sizeof(float));
 
    if (*out == NULL)
+   {
+      resampler->free(data);
       return false;
+   }
 
    info.data_in                       = in;
    info.data_out                      = *out;
@@ -313,542 +311,881 @@ static bool one_shot_resample(const float* in, size_t samples_in,
 
    resampler->process(data, &info);
    resampler->free(data);
+
+   *samples_out                       = MIN(info.output_frames * 2,
+         max_samples + 16);
    return true;
 }
-#endif
 
-void audio_mixer_init(unsigned rate)
+/* Picks the first two channels of @in, or duplicates a mono
+ * one. Mono frames may be expanded in place. */
+static void audio_mixer_to_stereo(float *out, const float *in,
+      unsigned frames, unsigned channels)
 {
    unsigned i;
 
-   s_rate = rate;
-
-   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+   if (channels == 1)
    {
-      audio_mixer_voice_t *voice = &s_voices[i];
-
-      voice->type = AUDIO_MIXER_TYPE_NONE;
-#ifdef HAVE_THREADS
-      if (!voice->lock)
-         voice->lock = slock_new();
-#endif
+      for (i = frames; i-- != 0; )
+      {
+         float sample  = in[i];
+         out[i * 2 + 1] = sample;
+         out[i * 2]     = sample;
+      }
+   }
+   else
+   {
+      for (i = 0; i < frames; i++)
+      {
+         out[i * 2]     = in[i * channels];
+         out[i * 2 + 1] = in[i * channels + 1];
+      }
    }
 }
 
-void audio_mixer_done(void)
+static void audio_mixer_decoder_close(struct audio_mixer_decoder *decoder)
 {
-   unsigned i;
-
-   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-   {
-      audio_mixer_voice_t *voice = &s_voices[i];
-
-      AUDIO_MIXER_LOCK(voice);
-      audio_mixer_release(voice);
-      AUDIO_MIXER_UNLOCK(voice);
-#ifdef HAVE_THREADS
-      slock_free(voice->lock);
-      voice->lock = NULL;
+#ifdef HAVE_STB_VORBIS
+   if (decoder->ogg)
+      stb_vorbis_close(decoder->ogg);
 #endif
-   }
+#ifdef HAVE_DR_FLAC
+   if (decoder->flac)
+      drflac_close(decoder->flac);
+#endif
+#ifdef HAVE_DR_MP3
+   if (decoder->mp3_open)
+      drmp3_uninit(&decoder->mp3);
+#endif
+#ifdef HAVE_IBXM
+   if (decoder->mod.stream)
+      dispose_replay(decoder->mod.stream);
+   if (decoder->mod.module)
+      dispose_module(decoder->mod.module);
+   if (decoder->mod.buffer)
+      memalign_free(decoder->mod.buffer);
+#endif
+   if (decoder->scratch)
+      memalign_free(decoder->scratch);
+
+   memset(decoder, 0, sizeof(*decoder));
 }
 
-audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size,
-      const char *resampler_ident, enum resampler_quality quality)
+static bool audio_mixer_decoder_open(struct audio_mixer_decoder *decoder,
+      const audio_mixer_sound_t *sound)
 {
-#ifdef HAVE_RWAV
-   /* WAV data */
-   rwav_t wav;
-   /* WAV samples converted to float */
-   float* pcm                 = NULL;
-   size_t samples             = 0;
-   /* Result */
-   audio_mixer_sound_t* sound = NULL;
-
-   wav.bitspersample          = 0;
-   wav.numchannels            = 0;
-   wav.samplerate             = 0;
-   wav.numsamples             = 0;
-   wav.subchunk2size          = 0;
-   wav.samples                = NULL;
+   memset(decoder, 0, sizeof(*decoder));
 
-   if ((rwav_load(&wav, buffer, size)) != RWAV_ITERATE_DONE)
-      return NULL;
+   decoder->type     = sound->type;
+   decoder->channels = 2;
 
-   samples       = wav.numsamples * 2;
+   switch (sound->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         {
+            stb_vorbis_info info;
+            int res      = 0;
 
-   if (!wav_to_float(&wav, &pcm, samples))
-      return NULL;
+            if (!(decoder->ogg = stb_vorbis_open_memory(
+                        (const unsigned char*)sound->data,
+                        sound->size, &res, NULL)))
+               return false;
 
-   if (wav.samplerate != s_rate)
-   {
-      float* resampled           = NULL;
+            /* Downmixed to stereo when read */
+            info           = stb_vorbis_get_info(decoder->ogg);
+            decoder->rate  = info.sample_rate;
+         }
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         if (!(decoder->flac = drflac_open_memory(
+                     (const unsigned char*)sound->data, sound->size)))
+            return false;
 
-      if (!one_shot_resample(pcm, samples, wav.samplerate,
-            resampler_ident, quality,
-            &resampled, &samples))
-         return NULL;
+         decoder->rate     = decoder->flac->sampleRate;
+         decoder->channels = decoder->flac->channels;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         if (!drmp3_init_memory(&decoder->mp3,
+                  (const unsigned char*)sound->data, sound->size, NULL))
+            return false;
 
-      memalign_free((void*)pcm);
-      pcm = resampled;
+         decoder->mp3_open = true;
+         decoder->rate     = decoder->mp3.sampleRate;
+         decoder->channels = decoder->mp3.channels;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         {
+            struct data data;
+            char message[64];
+            int buf_samples       = calculate_mix_buf_len(s_rate);
+
+            data.buffer           = (char*)sound->data;
+            data.length           = sound->size;
+
+            if (!(decoder->mod.module = module_load(&data, message)))
+            {
+               printf("audio_mixer_play_mod module_load() failed with error: %s\n", message);
+               return false;
+            }
+
+            if (!(decoder->mod.stream = new_replay(
+                        decoder->mod.module, s_rate, 1)))
+            {
+               printf("audio_mixer_play_mod new_replay() failed\n");
+               goto error;
+            }
+
+            if (!(decoder->mod.buffer = (int*)memalign_alloc(16,
+                        ((buf_samples + 15) & ~15) * sizeof(int))))
+            {
+               printf("audio_mixer_play_mod cannot allocate mod_buffer !\n");
+               goto error;
+            }
+
+            decoder->rate         = s_rate;
+         }
+#endif
+         break;
+      default:
+         break;
    }
 
-   sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
+   if (!decoder->rate || !decoder->channels)
+      goto error;
 
-   if (!sound)
+   if (decoder->channels > 2)
    {
-      memalign_free((void*)pcm);
-      return NULL;
+      if (!(decoder->scratch = (float*)memalign_alloc(16,
+                  AUDIO_MIXER_TEMP_BUFFER * sizeof(float))))
+         goto error;
    }
 
-   sound->type             = AUDIO_MIXER_TYPE_WAV;
-   sound->types.wav.frames = (unsigned)(samples / 2);
-   sound->types.wav.pcm    = pcm;
-
-   rwav_free(&wav);
+   return true;
 
-   return sound;
-#else
-   return NULL;
-#endif
+error:
+   audio_mixer_decoder_close(decoder);
+   return false;
 }
 
-audio_mixer_sound_t* audio_mixer_load_ogg(void *buffer, int32_t size)
+/* Frames of the sound at its own rate, or 0 if not known
+ * without decoding all of it */
+static unsigned audio_mixer_decoder_length(
+      struct audio_mixer_decoder *decoder)
 {
+   switch (decoder->type)
+   {
 #ifdef HAVE_STB_VORBIS
-   audio_mixer_sound_t* sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
-
-   if (!sound)
-      return NULL;
-
-   sound->type           = AUDIO_MIXER_TYPE_OGG;
-   sound->types.ogg.size = size;
-   sound->types.ogg.data = buffer;
-
-   return sound;
-#else
-   return NULL;
+      case AUDIO_MIXER_TYPE_OGG:
+         return stb_vorbis_stream_length_in_samples(decoder->ogg);
 #endif
+#ifdef HAVE_DR_FLAC
+      case AUDIO_MIXER_TYPE_FLAC:
+         return (unsigned)(decoder->flac->totalSampleCount
+               / decoder->channels);
+#endif
+      default:
+         break;
+   }
+
+   return 0;
 }
 
-audio_mixer_sound_t* audio_mixer_load_flac(void *buffer, int32_t size)
+/* Reads up to @frames frames in the native channel layout */
+static unsigned audio_mixer_decoder_read_raw(
+      struct audio_mixer_decoder *decoder, float *out, unsigned frames)
 {
+   switch (decoder->type)
+   {
+#ifdef HAVE_STB_VORBIS
+      case AUDIO_MIXER_TYPE_OGG:
+         return stb_vorbis_get_samples_float_interleaved(
+               decoder->ogg, 2, out, frames * 2);
+#endif
 #ifdef HAVE_DR_FLAC
-   audio_mixer_sound_t* sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
+      case AUDIO_MIXER_TYPE_FLAC:
+         return (unsigned)(drflac_read_f32(decoder->flac,
+                  frames * decoder->channels, out) / decoder->channels);
+#endif
+#ifdef HAVE_DR_MP3
+      case AUDIO_MIXER_TYPE_MP3:
+         return (unsigned)drmp3_read_f32(&decoder->mp3, frames, out);
+#endif
+#ifdef HAVE_IBXM
+      case AUDIO_MIXER_TYPE_MOD:
+         {
+            unsigned read = 0;
 
-   if (!sound)
-      return NULL;
+            while (read < frames)
+            {
+               unsigned i, count;
+               const int *pcm;
 
-   sound->type           = AUDIO_MIXER_TYPE_FLAC;
-   sound->types.flac.size = size;
-   sound->types.flac.data = buffer;
+               if (decoder->mod.position == decoder->mod.samples)
+               {
+                  unsigned samples = replay_get_audio(
+                        decoder->mod.stream, decoder->mod.buffer, 0) * 2;
 
-   return sound;
-#else
-   return NULL;
-#endif
-}
+                  if (samples == 0)
+                     break;
 
-audio_mixer_sound_t* audio_mixer_load_mp3(void *buffer, int32_t size)
-{
-#ifdef HAVE_DR_MP3
-   audio_mixer_sound_t* sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
+                  decoder->mod.position = 0;
+                  decoder->mod.samples  = samples;
+               }
 
-   if (!sound)
-      return NULL;
+               count = MIN((frames - read) * 2,
+                     decoder->mod.samples - decoder->mod.position);
+               pcm   = decoder->mod.buffer + decoder->mod.position;
 
-   sound->type           = AUDIO_MIXER_TYPE_MP3;
-   sound->types.mp3.size = size;
-   sound->types.mp3.data = buffer;
+               for (i = 0; i < count; i++)
+               {
+                  float samplef = ((float)pcm[i] + 32768.0f) / 65535.0f;
+                  *out++        = samplef * 2.0f - 1.0f;
+               }
 
-   return sound;
-#else
-   return NULL;
+               decoder->mod.position += count;
+               read                  += count / 2;
+            }
+
+            return read;
+         }
 #endif
+      default:
+         break;
+   }
+
+   return 0;
 }
 
-audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size)
+/* Reads up to @frames stereo frames; 0 at the end of the sound */
+static unsigned audio_mixer_decoder_read(
+      struct audio_mixer_decoder *decoder, float *out, unsigned frames)
 {
-#ifdef HAVE_IBXM
-   audio_mixer_sound_t* sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
+   unsigned read = 0;
 
-   if (!sound)
-      return NULL;
+   if (decoder->channels <= 2)
+   {
+      read = audio_mixer_decoder_read_raw(decoder, out, frames);
+      if (decoder->channels == 1)
+         audio_mixer_to_stereo(out, out, read, 1);
+      return read;
+   }
 
-   sound->type           = AUDIO_MIXER_TYPE_MOD;
-   sound->types.mod.size = size;
-   sound->types.mod.data = buffer;
+   while (read < frames)
+   {
+      unsigned count = audio_mixer_decoder_read_raw(decoder,
+            decoder->scratch, MIN(frames - read,
+               AUDIO_MIXER_TEMP_BUFFER / decoder->channels));
 
-   return sound;
-#else
-   return NULL;
-#endif
+      if (count == 0)
+         break;
+
+      audio_mixer_to_stereo(out + read * 2, decoder->scratch,
+            count, decoder->channels);
+      read += count;
+   }
+
+   return read;
 }
 
-void audio_mixer_destroy(audio_mixer_sound_t* sound)
+static void audio_mixer_decoder_rewind(
+      struct audio_mixer_decoder *decoder)
 {
-   void *handle = NULL;
-   if (!sound)
-      return;
-
-   switch (sound->type)
+   switch (decoder->type)
    {
-      case AUDIO_MIXER_TYPE_WAV:
-         handle = (void*)sound->types.wav.pcm;
-         if (handle)
-            memalign_free(handle);
-         break;
-      case AUDIO_MIXER_TYPE_OGG:
 #ifdef HAVE_STB_VORBIS
-         handle = (void*)sound->types.ogg.data;
-         if (handle)
-            free(handle);
-#endif
+      case AUDIO_MIXER_TYPE_OGG:
+         stb_vorbis_seek_start(decoder->ogg);
          break;
-      case AUDIO_MIXER_TYPE_MOD:
-#ifdef HAVE_IBXM
-         handle = (void*)sound->types.mod.data;
-         if (handle)
-            free(handle);
 #endif
-         break;
-      case AUDIO_MIXER_TYPE_FLAC:
 #ifdef HAVE_DR_FLAC
-         handle = (void*)sound->types.flac.data;
-         if (handle)
-            free(handle);
-#endif
+      case AUDIO_MIXER_TYPE_FLAC:
+         drflac_seek_to_sample(decoder->flac, 0);
          break;
-      case AUDIO_MIXER_TYPE_MP3:
+#endif
 #ifdef HAVE_DR_MP3
-         handle = (void*)sound->types.mp3.data;
-         if (handle)
-            free(handle);
+      case AUDIO_MIXER_TYPE_MP3:
+         drmp3_seek_to_frame(&decoder->mp3, 0);
+         break;
 #endif
+#ifdef HAVE_IBXM
+      case AUDIO_MIXER_TYPE_MOD:
+         replay_seek(decoder->mod.stream, 0);
+         decoder->mod.position = 0;
+         decoder->mod.samples  = 0;
          break;
-      case AUDIO_MIXER_TYPE_NONE:
+#endif
+      default:
          break;
    }
-
-   free(sound);
 }
 
-static bool audio_mixer_play_wav(audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice, bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
+#ifdef HAVE_DR_MP3
+/* Frames of an MP3 sound, counted from its frame headers
+ * without decoding any audio */
+static unsigned audio_mixer_mp3_length(const uint8_t *data, int size)
 {
-   voice->types.wav.position = 0;
-   return true;
-}
+   int free_format_bytes = 0;
+   unsigned frames       = 0;
 
-#ifdef HAVE_STB_VORBIS
-static bool audio_mixer_play_ogg(
-      audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      const char *resampler_ident,
-      enum resampler_quality quality,
-      audio_mixer_stop_cb_t stop_cb)
+   while (size > DRMP3_HDR_SIZE)
+   {
+      int frame_bytes = 0;
+      int skip        = drmp3d_find_frame(data, size,
+            &free_format_bytes, &frame_bytes);
+
+      if (!frame_bytes)
+         break;
+
+      frames += drmp3_hdr_frame_samples(data + skip);
+      data   += skip + frame_bytes;
+      size   -= skip + frame_bytes;
+   }
+
+   return frames;
+}
+#endif
+
+bool audio_mixer_predecode(audio_mixer_sound_t *sound)
 {
-   stb_vorbis_info info;
-   int res                         = 0;
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *ogg_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
-   stb_vorbis *stb_vorbis          = stb_vorbis_open_memory(
-         (const unsigned char*)sound->types.ogg.data,
-         sound->types.ogg.size, &res, NULL);
-
-   if (!stb_vorbis)
+   struct audio_mixer_decoder decoder;
+   unsigned max_frames, length;
+   unsigned frames = 0;
+   size_t samples  = 0;
+   float *pcm      = NULL;
+
+   if (!sound || !sound->data || !s_rate)
+      return false;
+
+   switch (sound->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+      case AUDIO_MIXER_TYPE_FLAC:
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+         if (sound->size > AUDIO_MIXER_PREDECODE_SECONDS
+               * AUDIO_MIXER_MP3_MAX_BYTES_PER_SECOND)
+            return false;
+         break;
+      default:
+         return false;
+   }
+
+   if (!audio_mixer_decoder_open(&decoder, sound))
       return false;
 
-   info                    = stb_vorbis_get_info(stb_vorbis);
+   max_frames = decoder.rate * AUDIO_MIXER_PREDECODE_SECONDS;
+   length     = audio_mixer_decoder_length(&decoder);
 
-   if (info.sample_rate != s_rate)
+#ifdef HAVE_DR_MP3
+   /* Only an estimate, the check below still catches
+    * sounds going on past it */
+   if (sound->type == AUDIO_MIXER_TYPE_MP3)
+      length  = audio_mixer_mp3_length(
+            (const uint8_t*)sound->data, (int)sound->size);
+#endif
+
+   if (length > max_frames)
+      goto error;
+   if (length)
+      max_frames = length;
+
+   /* Allocate on a 16-byte boundary, and pad to a multiple of 16 bytes */
+   if (!(pcm = (float*)memalign_alloc(16,
+               ((max_frames * 2 + 15) & ~15) * sizeof(float))))
+      goto error;
+
+   while (frames < max_frames)
    {
-      ratio = (double)s_rate / (double)info.sample_rate;
+      unsigned count = audio_mixer_decoder_read(&decoder,
+            pcm + frames * 2, MIN(max_frames - frames,
+               AUDIO_MIXER_TEMP_BUFFER / 2));
+
+      if (count == 0)
+         break;
 
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, resampler_ident, quality,
-               ratio))
+      frames += count;
+   }
+
+   /* Make sure the sound ended where it was expected to */
+   if (frames == max_frames)
+   {
+      float probe[2 * 16];
+      if (audio_mixer_decoder_read(&decoder, probe, 16))
          goto error;
    }
 
-   /* Allocate on a 16-byte boundary, and pad to a multiple of 16 bytes. We
-    * add 16 more samples in the formula below just as safeguard, because
-    * resampler->process sometimes reports more output samples than the
-    * formula below calculates. Ideally, audio resamplers should have a
-    * function to return the number of samples they will output given a
-    * count of input samples. */
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   ogg_buffer                      = (float*)memalign_alloc(16,
-         (((samples + 16) + 15) & ~15) * sizeof(float));
+   if (frames == 0)
+      goto error;
+
+   samples = frames * 2;
 
-   if (!ogg_buffer)
+   if (decoder.rate != s_rate)
    {
-      if (resamp && resampler_data)
-         resamp->free(resampler_data);
-      goto error;
+      float* resampled = NULL;
+
+      if (!one_shot_resample(pcm, samples, decoder.rate,
+            NULL, RESAMPLER_QUALITY_DONTCARE,
+            &resampled, &samples))
+         goto error;
+
+      memalign_free(pcm);
+      pcm = resampled;
    }
 
-   voice->types.ogg.resampler      = resamp;
-   voice->types.ogg.resampler_data = resampler_data;
-   voice->types.ogg.buffer         = (float*)ogg_buffer;
-   voice->types.ogg.buf_samples    = samples;
-   voice->types.ogg.ratio          = ratio;
-   voice->types.ogg.stream         = stb_vorbis;
-   voice->types.ogg.position       = 0;
-   voice->types.ogg.samples        = 0;
+   audio_mixer_decoder_close(&decoder);
+
+   free((void*)sound->data);
+   sound->data   = NULL;
+   sound->size   = 0;
+   sound->pcm    = pcm;
+   sound->frames = (unsigned)(samples / 2);
 
    return true;
 
 error:
-   stb_vorbis_close(stb_vorbis);
+   if (pcm)
+      memalign_free(pcm);
+   audio_mixer_decoder_close(&decoder);
    return false;
 }
 
-static void audio_mixer_release_ogg(audio_mixer_voice_t* voice)
+/* Needs to hold the stream lock of the voice */
+static void audio_mixer_stream_close(struct audio_mixer_stream *stream)
 {
-   if (voice->types.ogg.stream)
-      stb_vorbis_close(voice->types.ogg.stream);
-   if (voice->types.ogg.resampler && voice->types.ogg.resampler_data)
-      voice->types.ogg.resampler->free(voice->types.ogg.resampler_data);
-   if (voice->types.ogg.buffer)
-      memalign_free(voice->types.ogg.buffer);
+   spsc_queue_t *ring = stream->ring;
+
+   audio_mixer_decoder_close(&stream->decoder);
+   if (stream->resampler && stream->resampler_data)
+      stream->resampler->free(stream->resampler_data);
+   if (stream->decoded)
+      memalign_free(stream->decoded);
+   if (stream->resampled)
+      memalign_free(stream->resampled);
+
+   /* The ring is kept for the next streamed sound */
+   memset(stream, 0, sizeof(*stream));
+   stream->ring = ring;
+   if (ring)
+      spsc_queue_clear(ring);
 }
 
-#endif
-
-#ifdef HAVE_IBXM
-static bool audio_mixer_play_mod(
-      audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
+/* Decodes and resamples up to @max_chunks chunks into the
+ * ring, as far as it has room. Needs to hold the stream lock
+ * of the voice.
+ *
+ * @return true if anything was decoded. */
+static bool audio_mixer_stream_fill(struct audio_mixer_stream *stream,
+      unsigned max_chunks)
 {
-   struct data data;
-   char message[64];
-   int buf_samples               = 0;
-   int samples                   = 0;
-   void *mod_buffer              = NULL;
-   struct module* module         = NULL;
-   struct replay* replay         = NULL;
-
-   data.buffer                   = (char*)sound->types.mod.data;
-   data.length                   = sound->types.mod.size;
-   module                        = module_load(&data, message);
-
-   if (!module)
+   bool rewound = false;
+   bool filled  = false;
+
+   while (     stream->active
+         &&   !stream->ended
+         &&    max_chunks
+         &&    spsc_queue_write_avail(stream->ring) >= stream->chunk_bytes)
    {
-      printf("audio_mixer_play_mod module_load() failed with error: %s\n", message);
-      goto error;
+      const float *out;
+      unsigned out_frames;
+      unsigned frames = audio_mixer_decoder_read(&stream->decoder,
+            stream->decoded, stream->chunk_frames);
+
+      if (frames == 0)
+      {
+         /* A sound which does not play at all ends even
+          * when repeating */
+         if (stream->repeat && !rewound)
+         {
+            audio_mixer_decoder_rewind(&stream->decoder);
+            stream->loops++;
+            rewound = true;
+            continue;
+         }
+
+         stream->ended = true;
+         break;
+      }
+
+      if (stream->resampler)
+      {
+         struct resampler_data info;
+
+         info.data_in       = stream->decoded;
+         info.data_out      = stream->resampled;
+         info.input_frames  = frames;
+         info.output_frames = 0;
+         info.ratio         = stream->ratio;
+
+         stream->resampler->process(stream->resampler_data, &info);
+
+         out                = stream->resampled;
+         out_frames         = (unsigned)info.output_frames;
+      }
+      else
+      {
+         out                = stream->decoded;
+         out_frames         = frames;
+      }
+
+      spsc_queue_write(stream->ring, out,
+            out_frames * 2 * sizeof(float));
+
+      rewound = false;
+      filled  = true;
+      max_chunks--;
    }
 
-   if (voice->types.mod.module)
-      dispose_module(voice->types.mod.module);
+   return filled;
+}
 
-   voice->types.mod.module = module;
+#ifdef HAVE_THREADS
+/* Wakes the decoder thread. Setting the flag under the lock
+ * means the decoder either sees it before waiting or is
+ * already waiting when signalled. While a wakeup is pending
+ * the lock is not taken again, since the decoder is bound to
+ * make another pass. */
+static void audio_mixer_stream_wake(void)
+{
+   if (retro_atomic_load_acquire_uint(&s_stream_wake))
+      return;
+
+   slock_lock(s_stream_lock);
+   retro_atomic_store_release_uint(&s_stream_wake, 1);
+   scond_signal(s_stream_cond);
+   slock_unlock(s_stream_lock);
+}
 
-   replay = new_replay(module, s_rate, 1);
+/* Keeps the rings of all streamed voices filled, one chunk
+ * per voice at a time, so that audio_mixer_mix() never has
+ * to decode. Sleeps while every ring is full, until
+ * audio_mixer_mix() drains one below half */
+static void audio_mixer_stream_thread(void *data)
+{
+   slock_lock(s_stream_lock);
 
-   if (!replay)
+   while (!s_stream_quit)
    {
-      printf("audio_mixer_play_mod new_replay() failed\n");
-      goto error;
+      unsigned i;
+      bool filled = false;
+
+      retro_atomic_store_release_uint(&s_stream_wake, 0);
+      slock_unlock(s_stream_lock);
+
+      for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+      {
+         audio_mixer_voice_t *voice = &s_voices[i];
+
+         AUDIO_MIXER_STREAM_LOCK(voice);
+         if (     voice->stream.active
+               && audio_mixer_stream_fill(&voice->stream, 1))
+            filled = true;
+         AUDIO_MIXER_STREAM_UNLOCK(voice);
+      }
+
+      slock_lock(s_stream_lock);
+
+      if (     !filled
+            && !retro_atomic_load_acquire_uint(&s_stream_wake)
+            && !s_stream_quit)
+         scond_wait(s_stream_cond, s_stream_lock);
    }
 
-   buf_samples = calculate_mix_buf_len(s_rate);
-   mod_buffer  = memalign_alloc(16, ((buf_samples + 15) & ~15) * sizeof(int));
+   slock_unlock(s_stream_lock);
+}
+#endif
+
+void audio_mixer_init(unsigned rate)
+{
+   unsigned i;
+
+   s_rate = rate;
 
-   if (!mod_buffer)
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
    {
-      printf("audio_mixer_play_mod cannot allocate mod_buffer !\n");
-      goto error;
-   }
+      audio_mixer_voice_t *voice = &s_voices[i];
 
-   samples = replay_calculate_duration(replay);
+      voice->type = AUDIO_MIXER_TYPE_NONE;
+#ifdef HAVE_THREADS
+      if (!voice->lock)
+         voice->lock = slock_new();
+      if (!voice->stream_lock)
+         voice->stream_lock = slock_new();
+#endif
+   }
 
-   if (!samples)
+#ifdef HAVE_THREADS
+   if (!s_stream_thread)
    {
-      printf("audio_mixer_play_mod cannot retrieve duration !\n");
-      goto error;
+      s_stream_lock   = slock_new();
+      s_stream_cond   = scond_new();
+      s_stream_wake   = 0;
+      s_stream_quit   = false;
+      s_stream_thread = sthread_create(audio_mixer_stream_thread, NULL);
    }
+#endif
+}
 
-   voice->types.mod.buffer         = (int*)mod_buffer;
-   voice->types.mod.buf_samples    = buf_samples;
-   voice->types.mod.stream         = replay;
-   voice->types.mod.position       = 0;
-   voice->types.mod.samples        = 0; /* samples; */
+void audio_mixer_done(void)
+{
+   unsigned i;
 
-   return true;
+#ifdef HAVE_THREADS
+   if (s_stream_thread)
+   {
+      slock_lock(s_stream_lock);
+      s_stream_quit = true;
+      scond_signal(s_stream_cond);
+      slock_unlock(s_stream_lock);
 
-error:
-   if (mod_buffer)
-      memalign_free(mod_buffer);
-   if (module)
-      dispose_module(module);
-   return false;
+      sthread_join(s_stream_thread);
+      s_stream_thread = NULL;
+   }
+   if (s_stream_cond)
+      scond_free(s_stream_cond);
+   if (s_stream_lock)
+      slock_free(s_stream_lock);
+   s_stream_cond = NULL;
+   s_stream_lock = NULL;
+#endif
 
-}
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+   {
+      audio_mixer_voice_t *voice = &s_voices[i];
 
-static void audio_mixer_release_mod(audio_mixer_voice_t* voice)
-{
-   if (voice->types.mod.stream)
-      dispose_replay(voice->types.mod.stream);
-   if (voice->types.mod.buffer)
-      memalign_free(voice->types.mod.buffer);
-}
+      AUDIO_MIXER_LOCK(voice);
+      audio_mixer_release(voice);
+      AUDIO_MIXER_UNLOCK(voice);
+
+      if (voice->stream.ring)
+         spsc_queue_free(voice->stream.ring);
+      voice->stream.ring = NULL;
+#ifdef HAVE_THREADS
+      slock_free(voice->lock);
+      slock_free(voice->stream_lock);
+      voice->lock        = NULL;
+      voice->stream_lock = NULL;
 #endif
+   }
+}
 
-#ifdef HAVE_DR_FLAC
-static bool audio_mixer_play_flac(
-      audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      const char *resampler_ident,
-      enum resampler_quality quality,
-      audio_mixer_stop_cb_t stop_cb)
+audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size,
+      const char *resampler_ident, enum resampler_quality quality)
 {
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *flac_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
-   drflac *dr_flac          = drflac_open_memory((const unsigned char*)sound->types.flac.data,sound->types.flac.size);
-
-   if (!dr_flac)
-      return false;
-   if (dr_flac->sampleRate != s_rate)
+#ifdef HAVE_RWAV
+   /* WAV data */
+   rwav_t wav;
+   /* WAV samples converted to float */
+   float* pcm                 = NULL;
+   size_t samples             = 0;
+   /* Result */
+   audio_mixer_sound_t* sound = NULL;
+
+   wav.bitspersample          = 0;
+   wav.numchannels            = 0;
+   wav.samplerate             = 0;
+   wav.numsamples             = 0;
+   wav.subchunk2size          = 0;
+   wav.samples                = NULL;
+
+   if ((rwav_load(&wav, buffer, size)) != RWAV_ITERATE_DONE)
+      return NULL;
+
+   samples       = wav.numsamples * 2;
+
+   if (!wav_to_float(&wav, &pcm, samples))
+      return NULL;
+
+   if (wav.samplerate != s_rate)
    {
-      ratio = (double)s_rate / (double)(dr_flac->sampleRate);
+      float* resampled           = NULL;
 
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, resampler_ident, quality,
-               ratio))
-         goto error;
+      if (!one_shot_resample(pcm, samples, wav.samplerate,
+            resampler_ident, quality,
+            &resampled, &samples))
+         return NULL;
+
+      memalign_free((void*)pcm);
+      pcm = resampled;
    }
 
-   /* Allocate on a 16-byte boundary, and pad to a multiple of 16 bytes. We
-    * add 16 more samples in the formula below just as safeguard, because
-    * resampler->process sometimes reports more output samples than the
-    * formula below calculates. Ideally, audio resamplers should have a
-    * function to return the number of samples they will output given a
-    * count of input samples. */
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   flac_buffer                     = (float*)memalign_alloc(16,
-         (((samples + 16) + 15) & ~15) * sizeof(float));
+   sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
 
-   if (!flac_buffer)
+   if (!sound)
    {
-      if (resamp && resamp->free)
-         resamp->free(resampler_data);
-      goto error;
+      memalign_free((void*)pcm);
+      return NULL;
    }
 
-   voice->types.flac.resampler      = resamp;
-   voice->types.flac.resampler_data = resampler_data;
-   voice->types.flac.buffer         = (float*)flac_buffer;
-   voice->types.flac.buf_samples    = samples;
-   voice->types.flac.ratio          = ratio;
-   voice->types.flac.stream         = dr_flac;
-   voice->types.flac.position       = 0;
-   voice->types.flac.samples        = 0;
+   sound->type             = AUDIO_MIXER_TYPE_WAV;
+   sound->frames           = (unsigned)(samples / 2);
+   sound->pcm              = pcm;
 
-   return true;
+   rwav_free(&wav);
 
-error:
-   drflac_close(dr_flac);
-   return false;
+   return sound;
+#else
+   return NULL;
+#endif
+}
+
+static audio_mixer_sound_t* audio_mixer_load_compressed(
+      enum audio_mixer_type type, void *buffer, int32_t size)
+{
+   audio_mixer_sound_t* sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
+
+   if (!sound)
+      return NULL;
+
+   sound->type = type;
+   sound->size = size;
+   sound->data = buffer;
+
+   return sound;
 }
 
-static void audio_mixer_release_flac(audio_mixer_voice_t* voice)
+audio_mixer_sound_t* audio_mixer_load_ogg(void *buffer, int32_t size)
 {
-   if (voice->types.flac.stream)
-      drflac_close(voice->types.flac.stream);
-   if (voice->types.flac.resampler && voice->types.flac.resampler_data)
-      voice->types.flac.resampler->free(voice->types.flac.resampler_data);
-   if (voice->types.flac.buffer)
-      memalign_free(voice->types.flac.buffer);
+#ifdef HAVE_STB_VORBIS
+   return audio_mixer_load_compressed(AUDIO_MIXER_TYPE_OGG, buffer, size);
+#else
+   return NULL;
+#endif
 }
+
+audio_mixer_sound_t* audio_mixer_load_flac(void *buffer, int32_t size)
+{
+#ifdef HAVE_DR_FLAC
+   return audio_mixer_load_compressed(AUDIO_MIXER_TYPE_FLAC, buffer, size);
+#else
+   return NULL;
 #endif
+}
 
+audio_mixer_sound_t* audio_mixer_load_mp3(void *buffer, int32_t size)
+{
 #ifdef HAVE_DR_MP3
-static bool audio_mixer_play_mp3(
-      audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
+   return audio_mixer_load_compressed(AUDIO_MIXER_TYPE_MP3, buffer, size);
+#else
+   return NULL;
+#endif
+}
+
+audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size)
+{
+#ifdef HAVE_IBXM
+   audio_mixer_sound_t* sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
+
+   if (!sound)
+      return NULL;
+
+   /* Modules usually loop for minutes, so always streamed */
+   sound->type = AUDIO_MIXER_TYPE_MOD;
+   sound->size = size;
+   sound->data = buffer;
+
+   return sound;
+#else
+   return NULL;
+#endif
+}
+
+void audio_mixer_destroy(audio_mixer_sound_t* sound)
+{
+   if (!sound)
+      return;
+
+   if (sound->pcm)
+      memalign_free(sound->pcm);
+   if (sound->data)
+      free((void*)sound->data);
+
+   free(sound);
+}
+
+/* Needs to hold the lock for the voice */
+static bool audio_mixer_play_stream(audio_mixer_sound_t* sound,
+      audio_mixer_voice_t* voice, bool repeat,
       const char *resampler_ident,
-      enum resampler_quality quality,
-      audio_mixer_stop_cb_t stop_cb)
+      enum resampler_quality quality)
 {
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *mp3_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
-   bool res;
+   struct audio_mixer_stream *stream = &voice->stream;
+   unsigned max_out_frames           = 0;
 
-   res = drmp3_init_memory(&voice->types.mp3.stream, (const unsigned char*)sound->types.mp3.data, sound->types.mp3.size, NULL);
+   AUDIO_MIXER_STREAM_LOCK(voice);
 
-   if (!res)
-      return false;
+   if (!stream->ring && !(stream->ring = spsc_queue_new(
+               AUDIO_MIXER_STREAM_FRAMES * 2 * sizeof(float))))
+      goto error;
+
+   if (!audio_mixer_decoder_open(&stream->decoder, sound))
+      goto error;
 
-   if (voice->types.mp3.stream.sampleRate != s_rate)
+   stream->ratio        = 1.0f;
+   stream->chunk_frames = AUDIO_MIXER_STREAM_CHUNK;
+
+   if (stream->decoder.rate != s_rate)
    {
-      ratio = (double)s_rate / (double)(voice->types.mp3.stream.sampleRate);
+      stream->ratio = (double)s_rate / (double)stream->decoder.rate;
 
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, resampler_ident, quality,
-               ratio))
+      if (!retro_resampler_realloc(&stream->resampler_data,
+               &stream->resampler, resampler_ident, quality,
+               stream->ratio))
          goto error;
    }
 
-   /* Allocate on a 16-byte boundary, and pad to a multiple of 16 bytes. We
-    * add 16 more samples in the formula below just as safeguard, because
-    * resampler->process sometimes reports more output samples than the
-    * formula below calculates. Ideally, audio resamplers should have a
-    * function to return the number of samples they will output given a
-    * count of input samples. */
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   mp3_buffer                      = (float*)memalign_alloc(16,
-         (((samples + 16) + 15) & ~15) * sizeof(float));
-
-   if (!mp3_buffer)
+   /* Keep a chunk well within the ring for large ratios. We
+    * add 16 more frames just as safeguard, because
+    * resampler->process sometimes reports more output frames
+    * than the ratio gives. */
+   for (;;)
    {
-      if (resamp && resampler_data)
-         resamp->free(resampler_data);
+      max_out_frames = (unsigned)(stream->chunk_frames * stream->ratio) + 16;
+      if (     stream->chunk_frames <= 16
+            || max_out_frames <= AUDIO_MIXER_STREAM_FRAMES / 2)
+         break;
+      stream->chunk_frames /= 2;
+   }
+
+   if (!(stream->decoded = (float*)memalign_alloc(16,
+               stream->chunk_frames * 2 * sizeof(float))))
       goto error;
+
+   if (stream->resampler)
+   {
+      if (!(stream->resampled = (float*)memalign_alloc(16,
+                  max_out_frames * 2 * sizeof(float))))
+         goto error;
+      stream->chunk_bytes = max_out_frames * 2 * sizeof(float);
    }
+   else
+      stream->chunk_bytes = stream->chunk_frames * 2 * sizeof(float);
+
+   stream->repeat = repeat;
+   stream->active = true;
+
+   audio_mixer_stream_fill(stream, AUDIO_MIXER_STREAM_PREFILL);
 
-   voice->types.mp3.resampler      = resamp;
-   voice->types.mp3.resampler_data = resampler_data;
-   voice->types.mp3.buffer         = (float*)mp3_buffer;
-   voice->types.mp3.buf_samples    = samples;
-   voice->types.mp3.ratio          = ratio;
-   voice->types.mp3.position       = 0;
-   voice->types.mp3.samples        = 0;
+   AUDIO_MIXER_STREAM_UNLOCK(voice);
+
+#ifdef HAVE_THREADS
+   audio_mixer_stream_wake();
+#endif
 
    return true;
 
 error:
-   drmp3_uninit(&voice->types.mp3.stream);
+   audio_mixer_stream_close(stream);
+   AUDIO_MIXER_STREAM_UNLOCK(voice);
    return false;
 }
 
-static void audio_mixer_release_mp3(audio_mixer_voice_t* voice)
-{
-   if (voice->types.mp3.resampler && voice->types.mp3.resampler_data)
-      voice->types.mp3.resampler->free(voice->types.mp3.resampler_data);
-   if (voice->types.mp3.buffer)
-      memalign_free(voice->types.mp3.buffer);
-   if (voice->types.mp3.stream.pData)
-      drmp3_uninit(&voice->types.mp3.stream);
-}
-
-#endif
-
 audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound,
       bool repeat, float volume,
       const char *resampler_ident,
@@ -878,36 +1215,17 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound,
       /* claim the voice, also helps with cleanup on error */
       voice->type = sound->type;
 
-      switch (sound->type)
+      if (sound->pcm)
       {
-         case AUDIO_MIXER_TYPE_WAV:
-            res = audio_mixer_play_wav(sound, voice, repeat, volume, stop_cb);
-            break;
-         case AUDIO_MIXER_TYPE_OGG:
-#ifdef HAVE_STB_VORBIS
-            res = audio_mixer_play_ogg(sound, voice, repeat, volume,
-                  resampler_ident, quality, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_MOD:
-#ifdef HAVE_IBXM
-            res = audio_mixer_play_mod(sound, voice, repeat, volume, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_FLAC:
-#ifdef HAVE_DR_FLAC
-            res = audio_mixer_play_flac(sound, voice, repeat, volume,
-                  resampler_ident, quality, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_MP3:
-#ifdef HAVE_DR_MP3
-            res = audio_mixer_play_mp3(sound, voice, repeat, volume,
-                  resampler_ident, quality, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_NONE:
-            break;
+         voice->position = 0;
+         voice->streamed = false;
+         res             = true;
+      }
+      else if (sound->data)
+      {
+         voice->streamed = true;
+         res             = audio_mixer_play_stream(sound, voice, repeat,
+               resampler_ident, quality);
       }
 
       break;
@@ -940,34 +1258,16 @@ static void audio_mixer_release(audio_mixer_voice_t* voice)
    if (!voice)
       return;
 
-   switch (voice->type)
+   if (voice->streamed)
    {
-#ifdef HAVE_STB_VORBIS
-      case AUDIO_MIXER_TYPE_OGG:
-         audio_mixer_release_ogg(voice);
-         break;
-#endif
-#ifdef HAVE_IBXM
-      case AUDIO_MIXER_TYPE_MOD:
-         audio_mixer_release_mod(voice);
-         break;
-#endif
-#ifdef HAVE_DR_FLAC
-      case AUDIO_MIXER_TYPE_FLAC:
-         audio_mixer_release_flac(voice);
-         break;
-#endif
-#ifdef HAVE_DR_MP3
-      case AUDIO_MIXER_TYPE_MP3:
-         audio_mixer_release_mp3(voice);
-         break;
-#endif
-      default:
-         break;
+      AUDIO_MIXER_STREAM_LOCK(voice);
+      audio_mixer_stream_close(&voice->stream);
+      AUDIO_MIXER_STREAM_UNLOCK(voice);
    }
 
-   memset(&voice->types, 0, sizeof(voice->types));
-   voice->type = AUDIO_MIXER_TYPE_NONE;
+   voice->position = 0;
+   voice->streamed = false;
+   voice->type     = AUDIO_MIXER_TYPE_NONE;
 }
 
 void audio_mixer_stop(audio_mixer_voice_t* voice)
@@ -990,23 +1290,21 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
    }
 }
 
-static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
+static void audio_mixer_mix_pcm(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
    unsigned buf_free                = (unsigned)(num_frames * 2);
    const audio_mixer_sound_t* sound = voice->sound;
-   unsigned pcm_available           = sound->types.wav.frames
-      * 2 - voice->types.wav.position;
-   const float* pcm                 = sound->types.wav.pcm +
-      voice->types.wav.position;
+   unsigned pcm_available           = sound->frames
+      * 2 - voice->position;
+   const float* pcm                 = sound->pcm + voice->position;
 
 again:
    if (pcm_available < buf_free)
    {
-      for (i = pcm_available; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, pcm_available);
+      buffer += pcm_available;
 
       if (voice->repeat)
       {
@@ -1014,9 +1312,9 @@ again:
             voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
 
          buf_free                  -= pcm_available;
-         pcm_available              = sound->types.wav.frames * 2;
-         pcm                        = sound->types.wav.pcm;
-         voice->types.wav.position  = 0;
+         pcm_available              = sound->frames * 2;
+         pcm                        = sound->pcm;
+         voice->position            = 0;
          goto again;
       }
 
@@ -1027,302 +1325,81 @@ again:
    }
    else
    {
-      for (i = buf_free; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, buf_free);
 
-      voice->types.wav.position += buf_free;
+      voice->position += buf_free;
    }
 }
 
-#ifdef HAVE_STB_VORBIS
-static void audio_mixer_mix_ogg(float* buffer, size_t num_frames,
+static void audio_mixer_mix_stream(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
-   float* temp_buffer = NULL;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (!voice->types.ogg.stream)
-      return;
-
-   if (voice->types.ogg.position == voice->types.ogg.samples)
-   {
-again:
-      if (temp_buffer == NULL)
-         temp_buffer = (float*)malloc(AUDIO_MIXER_TEMP_BUFFER * sizeof(float));
-
-      temp_samples = stb_vorbis_get_samples_float_interleaved(
-            voice->types.ogg.stream, 2, temp_buffer,
-            AUDIO_MIXER_TEMP_BUFFER) * 2;
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            stb_vorbis_seek_start(voice->types.ogg.stream);
-            goto again;
-         }
+   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER];
+   struct audio_mixer_stream *stream = &voice->stream;
+   size_t samples                    = num_frames * 2;
 
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         audio_mixer_release(voice);
-         goto cleanup;
-      }
-
-      if (voice->types.ogg.resampler)
-      {
-         struct resampler_data info;
-         info.data_in = temp_buffer;
-         info.data_out = voice->types.ogg.buffer;
-         info.input_frames = temp_samples / 2;
-         info.output_frames = 0;
-         info.ratio = voice->types.ogg.ratio;
-
-         voice->types.ogg.resampler->process(
-               voice->types.ogg.resampler_data, &info);
-      }
-      else
-         memcpy(voice->types.ogg.buffer, temp_buffer,
-               temp_samples * sizeof(float));
-
-      voice->types.ogg.position = 0;
-      voice->types.ogg.samples  = voice->types.ogg.buf_samples;
-   }
-
-   pcm = voice->types.ogg.buffer + voice->types.ogg.position;
-
-   if (voice->types.ogg.samples < buf_free)
+   while (samples)
    {
-      for (i = voice->types.ogg.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.ogg.samples;
-      goto again;
-   }
+      size_t read;
 
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.ogg.position += buf_free;
-   voice->types.ogg.samples  -= buf_free;
-
-cleanup:
-   if (temp_buffer != NULL)
-      free(temp_buffer);
-}
+#ifdef HAVE_THREADS
+      /* Decoded here only without a decoder thread */
+      if (!s_stream_thread)
 #endif
-
-#ifdef HAVE_IBXM
-static void audio_mixer_mix_mod(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   float samplef                    = 0.0f;
-   unsigned temp_samples            = 0;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   int* pcm                         = NULL;
-
-   if (voice->types.mod.samples == 0)
-   {
-again:
-      temp_samples = replay_get_audio(
-            voice->types.mod.stream, voice->types.mod.buffer, 0 ) * 2;
-
-      if (temp_samples == 0)
+      if (spsc_queue_read_avail(stream->ring) < samples * sizeof(float))
       {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            replay_seek( voice->types.mod.stream, 0);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         audio_mixer_release(voice);
-         return;
+         AUDIO_MIXER_STREAM_LOCK(voice);
+         audio_mixer_stream_fill(stream, 1);
+         AUDIO_MIXER_STREAM_UNLOCK(voice);
       }
 
-      voice->types.mod.position = 0;
-      voice->types.mod.samples  = temp_samples;
-   }
-   pcm = voice->types.mod.buffer + voice->types.mod.position;
+      read = spsc_queue_read(stream->ring, temp_buffer,
+            MIN(samples, AUDIO_MIXER_TEMP_BUFFER) * sizeof(float))
+         / sizeof(float);
 
-   if (voice->types.mod.samples < buf_free)
-   {
-      for (i = voice->types.mod.samples; i != 0; i--)
-      {
-         samplef     = ((float)(*pcm++) + 32768.0f) / 65535.0f;
-         samplef     = samplef * 2.0f - 1.0f;
-         *buffer++  += samplef * volume;
-      }
+      if (read == 0)
+         break;
 
-      buf_free -= voice->types.mod.samples;
-      goto again;
+      audio_mix_volume(buffer, temp_buffer, volume, read);
+      buffer  += read;
+      samples -= read;
    }
 
-   for (i = buf_free; i != 0; --i )
+   /* Reported once the decoder went back to the start, which
+    * is ahead of playback by up to the length of the ring */
+   while (stream->loops_seen != stream->loops)
    {
-      samplef     = ((float)(*pcm++) + 32768.0f) / 65535.0f;
-      samplef     = samplef * 2.0f - 1.0f;
-      *buffer++  += samplef * volume;
+      stream->loops_seen++;
+      if (voice->stop_cb)
+         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
    }
 
-   voice->types.mod.position += buf_free;
-   voice->types.mod.samples  -= buf_free;
-}
+#ifdef HAVE_THREADS
+   /* Decoding falls behind on underruns only */
+   if (samples || spsc_queue_read_avail(stream->ring)
+         < AUDIO_MIXER_STREAM_FRAMES * sizeof(float))
+      audio_mixer_stream_wake();
 #endif
 
-#ifdef HAVE_DR_FLAC
-static void audio_mixer_mix_flac(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info;
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float *pcm                       = NULL;
-
-   if (voice->types.flac.position == voice->types.flac.samples)
-   {
-again:
-      temp_samples = (unsigned)drflac_read_f32( voice->types.flac.stream, AUDIO_MIXER_TEMP_BUFFER, temp_buffer);
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drflac_seek_to_sample(voice->types.flac.stream,0);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         audio_mixer_release(voice);
-         return;
-      }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.flac.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.flac.ratio;
-
-      if (voice->types.flac.resampler)
-         voice->types.flac.resampler->process(
-               voice->types.flac.resampler_data, &info);
-      else
-         memcpy(voice->types.flac.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.flac.position = 0;
-      voice->types.flac.samples  = voice->types.flac.buf_samples;
-   }
-
-   pcm = voice->types.flac.buffer + voice->types.flac.position;
-
-   if (voice->types.flac.samples < buf_free)
+   if (samples)
    {
-      for (i = voice->types.flac.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.flac.samples;
-      goto again;
-   }
-
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.flac.position += buf_free;
-   voice->types.flac.samples  -= buf_free;
-}
-#endif
-
-#ifdef HAVE_DR_MP3
-static void audio_mixer_mix_mp3(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info;
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
+      bool ended;
 
-   if (voice->types.mp3.position == voice->types.mp3.samples)
-   {
-again:
-      temp_samples = (unsigned)drmp3_read_f32(
-            &voice->types.mp3.stream,
-            AUDIO_MIXER_TEMP_BUFFER / 2, temp_buffer) * 2;
+      AUDIO_MIXER_STREAM_LOCK(voice);
+      ended = stream->ended
+         && spsc_queue_read_avail(stream->ring) == 0;
+      AUDIO_MIXER_STREAM_UNLOCK(voice);
 
-      if (temp_samples == 0)
+      if (ended)
       {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drmp3_seek_to_frame(&voice->types.mp3.stream,0);
-            goto again;
-         }
-
          if (voice->stop_cb)
             voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
 
          audio_mixer_release(voice);
-         return;
       }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.mp3.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.mp3.ratio;
-
-      if (voice->types.mp3.resampler)
-         voice->types.mp3.resampler->process(
-               voice->types.mp3.resampler_data, &info);
-      else
-         memcpy(voice->types.mp3.buffer, temp_buffer,
-               temp_samples * sizeof(float));
-      voice->types.mp3.position = 0;
-      voice->types.mp3.samples  = voice->types.mp3.buf_samples;
-   }
-
-   pcm = voice->types.mp3.buffer + voice->types.mp3.position;
-
-   if (voice->types.mp3.samples < buf_free)
-   {
-      for (i = voice->types.mp3.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.mp3.samples;
-      goto again;
    }
-
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.mp3.position += buf_free;
-   voice->types.mp3.samples  -= buf_free;
 }
-#endif
 
 void audio_mixer_mix(float* buffer, size_t num_frames,
       float volume_override, bool override)
@@ -1340,33 +1417,12 @@ void audio_mixer_mix(float* buffer, size_t num_frames,
 
       volume = (override) ? volume_override : voice->volume;
 
-      switch (voice->type)
+      if (voice->type != AUDIO_MIXER_TYPE_NONE)
       {
-         case AUDIO_MIXER_TYPE_WAV:
-            audio_mixer_mix_wav(buffer, num_frames, voice, volume);
-            break;
-         case AUDIO_MIXER_TYPE_OGG:
-#ifdef HAVE_STB_VORBIS
-            audio_mixer_mix_ogg(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_MOD:
-#ifdef HAVE_IBXM
-            audio_mixer_mix_mod(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_FLAC:
-#ifdef HAVE_DR_FLAC
-            audio_mixer_mix_flac(buffer, num_frames, voice, volume);
-#endif
-            break;
-            case AUDIO_MIXER_TYPE_MP3:
-#ifdef HAVE_DR_MP3
-            audio_mixer_mix_mp3(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_NONE:
-            break;
+         if (voice->streamed)
+            audio_mixer_mix_stream(buffer, num_frames, voice, volume);
+         else
+            audio_mixer_mix_pcm(buffer, num_frames, voice, volume);
       }
 
       AUDIO_MIXER_UNLOCK(voice);
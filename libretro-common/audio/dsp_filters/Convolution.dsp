@@ -0,0 +1,27 @@
+filters = 1
+filter0 = convolve
+
+# Convolves the audio with a recorded impulse response,
+# e.g. of a CRT TV speaker or an arcade cabinet.
+# The filter is not loaded unless an impulse response is set.
+
+# WAV file holding the impulse response, preferably as an absolute path.
+# 16/24/32-bit integer or 32-bit float, mono or stereo.
+# It is resampled to the output rate if needed.
+# convolve_impulse_response = "/path/to/impulse.wav"
+
+# The impulse response is processed in blocks of 2^block_size_log2 frames.
+# Latency is one block, whatever the length of the impulse response.
+# Smaller blocks lower the latency but cost more CPU time.
+# convolve_block_size_log2 = 8
+
+# Amount of unprocessed and convolved signal in the output.
+# convolve_dry = 0.0
+# convolve_wet = 1.0
+
+# Scales the impulse response to unit energy, so that
+# the convolved signal is about as loud as the input.
+# convolve_normalize = 1
+
+# Longest part of the impulse response used, in seconds.
+# convolve_max_length = 4.0
@@ -0,0 +1,343 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (dsp_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Runs DSP filter plugins over stereo noise and reports the
+ * CPU time each takes per channel of real-time audio:
+ *
+ *    dsp_bench [-r rate] [-s seconds] [-o key=value]... eq.so iir.so
+ *
+ * Options given with -o are what the plugins read from their
+ * config, without the filter prefix. Plugins which choose an
+ * implementation by SIMD support are run both with and
+ * without it.
+ *
+ *    dsp_bench -g ir.wav seconds
+ *
+ * writes a decaying noise impulse response for the
+ * convolution filter. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <dlfcn.h>
+
+#include <libretro_dspfilter.h>
+#include <features/features_cpu.h>
+
+#define BENCH_MAX_OPTIONS 32
+#define BENCH_CHUNK_FRAMES 1024
+
+static const char *bench_keys[BENCH_MAX_OPTIONS];
+static const char *bench_values[BENCH_MAX_OPTIONS];
+static unsigned bench_num_options;
+
+static uint32_t bench_rand_state = 1;
+
+static float bench_rand(void)
+{
+   bench_rand_state = bench_rand_state * 1103515245 + 12345;
+   return (float)(bench_rand_state >> 8) / (float)(1 << 23) - 1.0f;
+}
+
+static const char *bench_lookup(const char *key)
+{
+   unsigned i;
+   for (i = 0; i < bench_num_options; i++)
+      if (!strcmp(bench_keys[i], key))
+         return bench_values[i];
+   return NULL;
+}
+
+static int bench_get_float(void *userdata, const char *key,
+      float *value, float default_value)
+{
+   const char *str = bench_lookup(key);
+   *value          = str ? (float)strtod(str, NULL) : default_value;
+   return str != NULL;
+}
+
+static int bench_get_int(void *userdata, const char *key,
+      int *value, int default_value)
+{
+   const char *str = bench_lookup(key);
+   *value          = str ? (int)strtol(str, NULL, 0) : default_value;
+   return str != NULL;
+}
+
+static int bench_get_float_array(void *userdata, const char *key,
+      float **values, unsigned *out_num_values,
+      const float *default_values, unsigned num_default_values)
+{
+   unsigned num   = 0;
+   const char *str = bench_lookup(key);
+
+   if (!str)
+   {
+      *values = (float*)malloc((num_default_values + 1) * sizeof(float));
+      if (*values)
+         memcpy(*values, default_values, num_default_values * sizeof(float));
+      *out_num_values = num_default_values;
+      return 0;
+   }
+
+   *values = (float*)malloc((strlen(str) / 2 + 1) * sizeof(float));
+   while (*values && *str)
+   {
+      char *end;
+      float v = (float)strtod(str, &end);
+      if (end == str)
+         break;
+      (*values)[num++] = v;
+      str              = end;
+   }
+   *out_num_values = num;
+   return 1;
+}
+
+static int bench_get_int_array(void *userdata, const char *key,
+      int **values, unsigned *out_num_values,
+      const int *default_values, unsigned num_default_values)
+{
+   unsigned num    = 0;
+   const char *str = bench_lookup(key);
+
+   if (!str)
+   {
+      *values = (int*)malloc((num_default_values + 1) * sizeof(int));
+      if (*values)
+         memcpy(*values, default_values, num_default_values * sizeof(int));
+      *out_num_values = num_default_values;
+      return 0;
+   }
+
+   *values = (int*)malloc((strlen(str) / 2 + 1) * sizeof(int));
+   while (*values && *str)
+   {
+      char *end;
+      int v = (int)strtol(str, &end, 0);
+      if (end == str)
+         break;
+      (*values)[num++] = v;
+      str              = end;
+   }
+   *out_num_values = num;
+   return 1;
+}
+
+static int bench_get_string(void *userdata, const char *key,
+      char **output, const char *default_output)
+{
+   const char *str = bench_lookup(key);
+   *output         = strdup(str ? str : default_output);
+   return str != NULL;
+}
+
+static void bench_free(void *ptr)
+{
+   free(ptr);
+}
+
+static const struct dspfilter_config bench_config = {
+   bench_get_float,
+   bench_get_int,
+   bench_get_float_array,
+   bench_get_int_array,
+   bench_get_string,
+   bench_free,
+};
+
+static void bench_write_le(FILE *file, uint32_t value, unsigned bytes)
+{
+   unsigned i;
+   for (i = 0; i < bytes; i++)
+      fputc((value >> (8 * i)) & 0xff, file);
+}
+
+/* Stereo 32-bit float noise with an exponential decay of 60 dB */
+static int bench_write_ir(const char *path, unsigned rate, float seconds)
+{
+   unsigned i;
+   unsigned frames = (unsigned)(seconds * rate);
+   FILE *file      = fopen(path, "wb");
+
+   if (!file || !frames)
+   {
+      if (file)
+         fclose(file);
+      return 1;
+   }
+
+   fwrite("RIFF", 1, 4, file);
+   bench_write_le(file, 36 + frames * 8, 4);
+   fwrite("WAVEfmt ", 1, 8, file);
+   bench_write_le(file, 16, 4);
+   bench_write_le(file, 3, 2);
+   bench_write_le(file, 2, 2);
+   bench_write_le(file, rate, 4);
+   bench_write_le(file, rate * 8, 4);
+   bench_write_le(file, 8, 2);
+   bench_write_le(file, 32, 2);
+   fwrite("data", 1, 4, file);
+   bench_write_le(file, frames * 8, 4);
+
+   for (i = 0; i < frames * 2; i++)
+   {
+      union { float f; uint32_t u; } sample;
+      float decay = 1.0f - (float)(i / 2) / frames;
+      sample.f    = bench_rand() * decay * decay * decay;
+      bench_write_le(file, sample.u, 4);
+   }
+
+   fclose(file);
+   return 0;
+}
+
+static int bench_run(const struct dspfilter_implementation *impl,
+      const char *simd, float rate, const float *input, unsigned frames)
+{
+   unsigned pos;
+   retro_time_t start, elapsed;
+   struct dspfilter_info info;
+   float *scratch = (float*)malloc(BENCH_CHUNK_FRAMES * 2 * sizeof(float));
+   unsigned out   = 0;
+   void *data;
+
+   info.input_rate = rate;
+   if (!scratch || !(data = impl->init(&info, &bench_config, NULL)))
+   {
+      printf("%-12s %-8s init failed\n", impl->short_ident, simd);
+      free(scratch);
+      return 1;
+   }
+
+   start = cpu_features_get_time_usec();
+   for (pos = 0; pos < frames; pos += BENCH_CHUNK_FRAMES)
+   {
+      struct dspfilter_input in;
+      struct dspfilter_output output;
+
+      /* Filters may process in place */
+      memcpy(scratch, input + pos * 2,
+            BENCH_CHUNK_FRAMES * 2 * sizeof(float));
+      in.samples     = scratch;
+      in.frames      = BENCH_CHUNK_FRAMES;
+      output.samples = scratch;
+      output.frames  = 0;
+
+      impl->process(data, &output, &in);
+      out           += output.frames;
+   }
+   elapsed = cpu_features_get_time_usec() - start;
+
+   impl->free(data);
+   free(scratch);
+
+   if (elapsed < 1)
+      elapsed = 1;
+
+   /* Per channel of one second of real-time audio */
+   printf("%-12s %-8s %7.3f %% CPU per channel %8.1fx realtime %8u frames out\n",
+         impl->short_ident, simd,
+         100.0 * elapsed / (frames / rate * 1000000.0) / 2.0,
+         (frames / rate * 1000000.0) / elapsed, out);
+
+   return 0;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned j, frames;
+   float *input;
+   float rate                 = 48000.0f;
+   float seconds              = 10.0f;
+   int errors                 = 0;
+   dspfilter_simd_mask_t mask = (dspfilter_simd_mask_t)cpu_features_get();
+
+   for (i = 1; i < argc && argv[i][0] == '-'; i++)
+   {
+      if (!strcmp(argv[i], "-r") && i + 1 < argc)
+         rate = (float)atof(argv[++i]);
+      else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+         seconds = (float)atof(argv[++i]);
+      else if (!strcmp(argv[i], "-g") && i + 2 < argc)
+         return bench_write_ir(argv[i + 1], (unsigned)rate,
+               (float)atof(argv[i + 2]));
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc
+            && bench_num_options < BENCH_MAX_OPTIONS
+            && strchr(argv[i + 1], '='))
+      {
+         char *eq                              = strchr(argv[++i], '=');
+         *eq                                   = '\0';
+         bench_keys[bench_num_options]         = argv[i];
+         bench_values[bench_num_options++]     = eq + 1;
+      }
+      else
+         break;
+   }
+
+   if (i >= argc || rate <= 0.0f || seconds <= 0.0f)
+   {
+      fprintf(stderr, "Usage: %s [-r rate] [-s seconds] [-o key=value]... plugin...\n"
+            "       %s [-r rate] -g ir.wav seconds\n", argv[0], argv[0]);
+      return 1;
+   }
+
+   frames = ((unsigned)(seconds * rate) / BENCH_CHUNK_FRAMES + 1)
+      * BENCH_CHUNK_FRAMES;
+   if (!(input = (float*)malloc(frames * 2 * sizeof(float))))
+      return 1;
+   for (j = 0; j < frames * 2; j++)
+      input[j] = 0.5f * bench_rand();
+
+   for (; i < argc; i++)
+   {
+      const struct dspfilter_implementation *impl, *impl_simd;
+      dspfilter_get_implementation_t get_impl;
+      void *lib = dlopen(argv[i], RTLD_NOW | RTLD_LOCAL);
+
+      if (!lib || !(get_impl = (dspfilter_get_implementation_t)
+               dlsym(lib, "dspfilter_get_implementation")))
+      {
+         fprintf(stderr, "Cannot load %s: %s\n", argv[i], dlerror());
+         errors++;
+         continue;
+      }
+
+      impl      = get_impl(0);
+      impl_simd = get_impl(mask);
+
+      if (impl && impl->api_version == DSPFILTER_API_VERSION)
+      {
+         errors += bench_run(impl, "baseline", rate, input, frames);
+         if (impl_simd && impl_simd != impl)
+            errors += bench_run(impl_simd, "simd", rate, input, frames);
+      }
+
+      dlclose(lib);
+   }
+
+   free(input);
+   return errors ? 1 : 0;
+}
@@ -0,0 +1,571 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (convolve.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_miscellaneous.h>
+#include <libretro_dspfilter.h>
+
+#include "fft/fft.c"
+
+/* Convolves the audio with an impulse response loaded from
+ * a WAV file, e.g. one recorded from a TV speaker or a
+ * cabinet.
+ *
+ * The impulse response is cut into partitions of one block
+ * each (uniformly-partitioned overlap-save convolution).
+ * Every block of input is transformed once and its spectrum
+ * kept in a delay line, so the output of a block is the sum
+ * of each past spectrum times the matching partition.
+ * Latency is one block, however long the impulse response. */
+
+struct convolve_data
+{
+   fft_t *fft;
+   /* Complex input, left as real and right as imaginary part,
+    * holding the previous and the current block. */
+   fft_complex_t *block;
+   fft_complex_t *spectrum;
+   /* Per channel, block_size + 1 bins for each partition */
+   fft_complex_t *filter[2];
+   fft_complex_t *history[2];
+   fft_complex_t *accum[2];
+   fft_complex_block_t complex_mac;
+   float *buffer;
+   unsigned buffer_frames;
+   unsigned block_size;
+   unsigned block_ptr;
+   unsigned partitions;
+   unsigned history_ptr;
+   float dry;
+   float wet;
+};
+
+struct convolve_ir
+{
+   float *samples[2];
+   unsigned frames;
+   unsigned rate;
+};
+
+static void convolve_free(void *data)
+{
+   unsigned c;
+   struct convolve_data *conv = (struct convolve_data*)data;
+   if (!conv)
+      return;
+
+   fft_free(conv->fft);
+   free(conv->block);
+   free(conv->spectrum);
+   for (c = 0; c < 2; c++)
+   {
+      free(conv->filter[c]);
+      free(conv->history[c]);
+      free(conv->accum[c]);
+   }
+   free(conv->buffer);
+   free(conv);
+}
+
+static void convolve_block(struct convolve_data *conv, float *out)
+{
+   unsigned i, c, p;
+   unsigned block_size = conv->block_size;
+   unsigned fft_size   = block_size * 2;
+   unsigned bins       = block_size + 1;
+   fft_complex_t *x    = conv->spectrum;
+
+   fft_process_forward_complex(conv->fft, x, conv->block, 1);
+
+   /* Both channels are real, so their spectra can be told
+    * apart through the symmetry X[N - k] = conj(X[k]). */
+   {
+      fft_complex_t *xl = conv->history[0] + conv->history_ptr * bins;
+      fft_complex_t *xr = conv->history[1] + conv->history_ptr * bins;
+
+      for (i = 0; i < bins; i++)
+      {
+         fft_complex_t a = x[i];
+         fft_complex_t b = fft_complex_conj(x[(fft_size - i) & (fft_size - 1)]);
+
+         xl[i].real      = 0.5f * (a.real + b.real);
+         xl[i].imag      = 0.5f * (a.imag + b.imag);
+         xr[i].real      = 0.5f * (a.imag - b.imag);
+         xr[i].imag      = 0.5f * (b.real - a.real);
+      }
+   }
+
+   for (c = 0; c < 2; c++)
+   {
+      unsigned slot = conv->history_ptr;
+
+      memset(conv->accum[c], 0, bins * sizeof(*conv->accum[c]));
+
+      for (p = 0; p < conv->partitions; p++)
+      {
+         conv->complex_mac(conv->accum[c],
+               conv->history[c] + slot * bins,
+               conv->filter[c]  + p    * bins, bins);
+         slot = slot ? slot - 1 : conv->partitions - 1;
+      }
+   }
+
+   if (++conv->history_ptr == conv->partitions)
+      conv->history_ptr = 0;
+
+   /* Put both real results back into one complex spectrum,
+    * left + i * right, for a single inverse transform. */
+   for (i = 0; i < bins; i++)
+   {
+      fft_complex_t a = conv->accum[0][i];
+      fft_complex_t b = conv->accum[1][i];
+
+      x[i].real       = a.real - b.imag;
+      x[i].imag       = a.imag + b.real;
+
+      if (i && i < block_size)
+      {
+         x[fft_size - i].real = a.real + b.imag;
+         x[fft_size - i].imag = b.real - a.imag;
+      }
+   }
+
+   fft_process_inverse_complex(conv->fft, x, x, 1);
+
+   /* Overlap-save: only the second half is free of wrap-around. */
+   for (i = 0; i < block_size; i++)
+   {
+      const fft_complex_t *dry = &conv->block[block_size + i];
+      const fft_complex_t *wet = &x[block_size + i];
+
+      out[2 * i + 0] = conv->dry * dry->real + conv->wet * wet->real;
+      out[2 * i + 1] = conv->dry * dry->imag + conv->wet * wet->imag;
+   }
+
+   memcpy(conv->block, conv->block + block_size,
+         block_size * sizeof(*conv->block));
+}
+
+static void convolve_process(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   float *out;
+   const float *in;
+   unsigned input_frames;
+   struct convolve_data *conv = (struct convolve_data*)data;
+   unsigned max_frames        = input->frames + conv->block_size;
+
+   output->samples            = conv->buffer;
+   output->frames             = 0;
+
+   if (max_frames > conv->buffer_frames)
+   {
+      float *buffer = (float*)realloc(conv->buffer,
+            max_frames * 2 * sizeof(float));
+      if (!buffer)
+         return;
+      conv->buffer        = buffer;
+      conv->buffer_frames = max_frames;
+      output->samples     = buffer;
+   }
+
+   out                        = conv->buffer;
+   in                         = input->samples;
+   input_frames               = input->frames;
+
+   while (input_frames)
+   {
+      unsigned write_avail = conv->block_size - conv->block_ptr;
+
+      if (input_frames < write_avail)
+         write_avail = input_frames;
+
+      /* Interleaved stereo is already laid out as complex values */
+      memcpy(conv->block + conv->block_size + conv->block_ptr, in,
+            write_avail * 2 * sizeof(float));
+
+      in              += write_avail * 2;
+      input_frames    -= write_avail;
+      conv->block_ptr += write_avail;
+
+      if (conv->block_ptr == conv->block_size)
+      {
+         convolve_block(conv, out);
+
+         out             += conv->block_size * 2;
+         output->frames  += conv->block_size;
+         conv->block_ptr  = 0;
+      }
+   }
+}
+
+static uint32_t convolve_read_le(const uint8_t *data, unsigned bytes)
+{
+   unsigned i;
+   uint32_t value = 0;
+   for (i = 0; i < bytes; i++)
+      value |= (uint32_t)data[i] << (8 * i);
+   return value;
+}
+
+/* Reads 16/24/32-bit integer or 32-bit float PCM, mono or
+ * stereo. Further channels are ignored. */
+static bool convolve_load_wav(struct convolve_ir *ir, const char *path)
+{
+   unsigned i, c;
+   long size;
+   uint8_t *data          = NULL;
+   const uint8_t *pcm     = NULL;
+   const uint8_t *ptr     = NULL;
+   uint32_t pcm_size      = 0;
+   unsigned format        = 0;
+   unsigned channels      = 0;
+   unsigned bits          = 0;
+   FILE *file             = fopen(path, "rb");
+
+   if (!file)
+      return false;
+
+   if (     fseek(file, 0, SEEK_END) != 0
+         || (size = ftell(file)) < 12
+         || fseek(file, 0, SEEK_SET) != 0
+         || !(data = (uint8_t*)malloc(size))
+         || fread(data, 1, size, file) != (size_t)size)
+      goto error;
+
+   fclose(file);
+   file = NULL;
+
+   if (memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4))
+      goto error;
+
+   for (ptr = data + 12; ptr + 8 <= data + size; )
+   {
+      uint32_t chunk_size = convolve_read_le(ptr + 4, 4);
+      const uint8_t *body = ptr + 8;
+
+      if (chunk_size > (uint32_t)(data + size - body))
+         chunk_size = (uint32_t)(data + size - body);
+
+      if (!memcmp(ptr, "fmt ", 4) && chunk_size >= 16)
+      {
+         format    = convolve_read_le(body, 2);
+         channels  = convolve_read_le(body + 2, 2);
+         ir->rate  = convolve_read_le(body + 4, 4);
+         bits      = convolve_read_le(body + 14, 2);
+         /* WAVE_FORMAT_EXTENSIBLE keeps the format in the sub-format GUID */
+         if (format == 0xfffe && chunk_size >= 26)
+            format = convolve_read_le(body + 24, 2);
+      }
+      else if (!memcmp(ptr, "data", 4))
+      {
+         pcm      = body;
+         pcm_size = chunk_size;
+      }
+
+      ptr = body + chunk_size + (chunk_size & 1);
+   }
+
+   if (     !pcm || !channels || !ir->rate
+         || !((format == 1 && (bits == 16 || bits == 24 || bits == 32))
+            || (format == 3 && bits == 32)))
+      goto error;
+
+   ir->frames = pcm_size / (channels * (bits / 8));
+   if (!ir->frames)
+      goto error;
+
+   for (c = 0; c < 2; c++)
+      if (!(ir->samples[c] = (float*)malloc(ir->frames * sizeof(float))))
+         goto error;
+
+   for (i = 0; i < ir->frames; i++)
+   {
+      for (c = 0; c < 2; c++)
+      {
+         const uint8_t *s = pcm + (i * channels + MIN(c, channels - 1)) * (bits / 8);
+         float value;
+
+         if (format == 3)
+         {
+            union { uint32_t u; float f; } conv;
+            conv.u = convolve_read_le(s, 4);
+            value  = conv.f;
+         }
+         else
+         {
+            /* Sign-extend from the top of a 32-bit word */
+            int32_t v = (int32_t)(convolve_read_le(s, bits / 8) << (32 - bits));
+            value     = (float)v / 2147483648.0f;
+         }
+
+         ir->samples[c][i] = value;
+      }
+   }
+
+   free(data);
+   return true;
+
+error:
+   if (file)
+      fclose(file);
+   free(data);
+   for (c = 0; c < 2; c++)
+   {
+      free(ir->samples[c]);
+      ir->samples[c] = NULL;
+   }
+   return false;
+}
+
+/* Linear interpolation is enough here, the response is
+ * smoothed by the convolution itself. */
+static bool convolve_resample_ir(struct convolve_ir *ir, float rate)
+{
+   unsigned i, c;
+   double ratio      = (double)ir->rate / rate;
+   unsigned frames   = (unsigned)((ir->frames - 1) / ratio) + 1;
+
+   if ((unsigned)rate == ir->rate)
+      return true;
+
+   for (c = 0; c < 2; c++)
+   {
+      float *samples = (float*)malloc(frames * sizeof(float));
+      if (!samples)
+         return false;
+
+      for (i = 0; i < frames; i++)
+      {
+         double pos     = i * ratio;
+         unsigned index = (unsigned)pos;
+         float frac     = (float)(pos - index);
+         float next     = (index + 1 < ir->frames)
+            ? ir->samples[c][index + 1] : ir->samples[c][index];
+
+         /* Keep the overall gain when changing the sample rate */
+         samples[i]     = (float)((1.0 - frac) * ir->samples[c][index]
+               + frac * next) * ratio;
+      }
+
+      free(ir->samples[c]);
+      ir->samples[c] = samples;
+   }
+
+   ir->frames = frames;
+   ir->rate   = (unsigned)rate;
+   return true;
+}
+
+static bool convolve_create_filter(struct convolve_data *conv,
+      const struct convolve_ir *ir, bool normalize)
+{
+   unsigned c, p;
+   unsigned block_size = conv->block_size;
+   unsigned bins       = block_size + 1;
+   float gain          = 1.0f;
+   float *time_filter  = (float*)calloc(block_size * 2, sizeof(float));
+   fft_complex_t *freq = (fft_complex_t*)calloc(block_size * 2, sizeof(fft_complex_t));
+
+   if (!time_filter || !freq)
+   {
+      free(time_filter);
+      free(freq);
+      return false;
+   }
+
+   /* Scale to unit energy on the louder channel, so the wet
+    * signal is about as loud as the input. */
+   if (normalize)
+   {
+      double energy = 0.0;
+      for (c = 0; c < 2; c++)
+      {
+         unsigned i;
+         double sum = 0.0;
+         for (i = 0; i < ir->frames; i++)
+            sum += (double)ir->samples[c][i] * ir->samples[c][i];
+         if (sum > energy)
+            energy = sum;
+      }
+      if (energy > 0.0)
+         gain = (float)(1.0 / sqrt(energy));
+   }
+
+   for (c = 0; c < 2; c++)
+   {
+      for (p = 0; p < conv->partitions; p++)
+      {
+         unsigned i;
+         unsigned start  = p * block_size;
+         unsigned frames = MIN(block_size, ir->frames - start);
+
+         for (i = 0; i < frames; i++)
+            time_filter[i] = gain * ir->samples[c][start + i];
+         memset(time_filter + frames, 0,
+               (block_size * 2 - frames) * sizeof(float));
+
+         fft_process_forward(conv->fft, freq, time_filter, 1);
+         memcpy(conv->filter[c] + p * bins, freq, bins * sizeof(*freq));
+      }
+   }
+
+   free(time_filter);
+   free(freq);
+   return true;
+}
+
+static void *convolve_init_simd(const struct dspfilter_info *info,
+      const struct dspfilter_config *config, void *userdata,
+      dspfilter_simd_mask_t mask)
+{
+   unsigned c, bins;
+   int size_log2, normalize;
+   float max_length;
+   struct convolve_ir ir;
+   char *path                 = NULL;
+   struct convolve_data *conv = (struct convolve_data*)
+      calloc(1, sizeof(*conv));
+   if (!conv)
+      return NULL;
+
+   memset(&ir, 0, sizeof(ir));
+
+   config->get_int(userdata, "block_size_log2", &size_log2, 8);
+   config->get_float(userdata, "dry", &conv->dry, 0.0f);
+   config->get_float(userdata, "wet", &conv->wet, 1.0f);
+   config->get_int(userdata, "normalize", &normalize, 1);
+   config->get_float(userdata, "max_length", &max_length, 4.0f);
+   config->get_string(userdata, "impulse_response", &path, "");
+
+   if (size_log2 < 4)
+      size_log2 = 4;
+   else if (size_log2 > 14)
+      size_log2 = 14;
+
+   if (!path || !*path || !convolve_load_wav(&ir, path))
+   {
+      fprintf(stderr, "[Convolve]: Cannot load impulse response \"%s\".\n",
+            path ? path : "");
+      goto error;
+   }
+   config->free(path);
+   path = NULL;
+
+   if (!convolve_resample_ir(&ir, info->input_rate))
+      goto error;
+
+   if (max_length > 0.0f && ir.frames > max_length * info->input_rate)
+      ir.frames = (unsigned)(max_length * info->input_rate);
+
+   if (!ir.frames)
+      goto error;
+
+   conv->block_size  = 1 << size_log2;
+   conv->partitions  = (ir.frames + conv->block_size - 1) / conv->block_size;
+   conv->complex_mac = fft_get_complex_mac(mask);
+   bins              = conv->block_size + 1;
+
+   /* An FFT of twice the block size turns circular
+    * convolution into linear convolution. */
+   conv->fft         = fft_new(size_log2 + 1);
+   conv->block       = (fft_complex_t*)calloc(conv->block_size * 2, sizeof(*conv->block));
+   conv->spectrum    = (fft_complex_t*)calloc(conv->block_size * 2, sizeof(*conv->spectrum));
+
+   if (!conv->fft || !conv->block || !conv->spectrum)
+      goto error;
+
+   for (c = 0; c < 2; c++)
+   {
+      conv->filter[c]  = (fft_complex_t*)calloc(conv->partitions * bins, sizeof(fft_complex_t));
+      conv->history[c] = (fft_complex_t*)calloc(conv->partitions * bins, sizeof(fft_complex_t));
+      conv->accum[c]   = (fft_complex_t*)calloc(bins, sizeof(fft_complex_t));
+      if (!conv->filter[c] || !conv->history[c] || !conv->accum[c])
+         goto error;
+   }
+
+   if (!convolve_create_filter(conv, &ir, normalize != 0))
+      goto error;
+
+   for (c = 0; c < 2; c++)
+      free(ir.samples[c]);
+
+   return conv;
+
+error:
+   config->free(path);
+   for (c = 0; c < 2; c++)
+      free(ir.samples[c]);
+   convolve_free(conv);
+   return NULL;
+}
+
+static void *convolve_init(const struct dspfilter_info *info,
+      const struct dspfilter_config *config, void *userdata)
+{
+   return convolve_init_simd(info, config, userdata, 0);
+}
+
+static void *convolve_init_avx(const struct dspfilter_info *info,
+      const struct dspfilter_config *config, void *userdata)
+{
+   return convolve_init_simd(info, config, userdata, DSPFILTER_SIMD_AVX);
+}
+
+static const struct dspfilter_implementation convolve_plug = {
+   convolve_init,
+   convolve_process,
+   convolve_free,
+
+   DSPFILTER_API_VERSION,
+   "Partitioned Convolution",
+   "convolve",
+};
+
+static const struct dspfilter_implementation convolve_plug_avx = {
+   convolve_init_avx,
+   convolve_process,
+   convolve_free,
+
+   DSPFILTER_API_VERSION,
+   "Partitioned Convolution",
+   "convolve",
+};
+
+#ifdef HAVE_FILTERS_BUILTIN
+#define dspfilter_get_implementation convolve_dspfilter_get_implementation
+#endif
+
+const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
+{
+   if (mask & DSPFILTER_SIMD_AVX)
+      return &convolve_plug_avx;
+   return &convolve_plug;
+}
+
+#undef dspfilter_get_implementation
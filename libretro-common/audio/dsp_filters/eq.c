@@ -38,6 +38,7 @@ struct eq_data
    float *block;
    fft_complex_t *filter;
    fft_complex_t *fftblock;
+   fft_complex_block_t complex_mul;
    float buffer[8 * 1024];
    unsigned block_size;
    unsigned block_ptr;
@@ -94,15 +95,17 @@ static void eq_process(void *data, struct dspfilter_output *output,
       /* Convolve a new block. */
       if (eq->block_ptr == eq->block_size)
       {
-         unsigned i, c;
-
-         for (c = 0; c < 2; c++)
-         {
-            fft_process_forward(eq->fft, eq->fftblock, eq->block + c, 2);
-            for (i = 0; i < 2 * eq->block_size; i++)
-               eq->fftblock[i] = fft_complex_mul(eq->fftblock[i], eq->filter[i]);
-            fft_process_inverse(eq->fft, out + c, eq->fftblock, 2);
-         }
+         unsigned i;
+
+         /* The filter is real, so both channels go through one
+          * complex FFT, left as the real and right as the imaginary
+          * part, and come out of the inverse FFT the same way. */
+         fft_process_forward_complex(eq->fft, eq->fftblock,
+               (const fft_complex_t*)eq->block, 1);
+         eq->complex_mul(eq->fftblock, eq->fftblock, eq->filter,
+               2 * eq->block_size);
+         fft_process_inverse_complex(eq->fft, (fft_complex_t*)out,
+               eq->fftblock, 1);
 
          /* Overlap add method, so add in saved block now. */
          for (i = 0; i < 2 * eq->block_size; i++)
@@ -256,8 +259,9 @@ end:
    free(time_filter);
 }
 
-static void *eq_init(const struct dspfilter_info *info,
-      const struct dspfilter_config *config, void *userdata)
+static void *eq_init_simd(const struct dspfilter_info *info,
+      const struct dspfilter_config *config, void *userdata,
+      dspfilter_simd_mask_t mask)
 {
    int size_log2;
    float beta;
@@ -298,7 +302,8 @@ static void *eq_init(const struct dspfilter_info *info,
    config->free(frequencies);
    config->free(gain);
 
-   eq->block_size = size;
+   eq->block_size  = size;
+   eq->complex_mul = fft_get_complex_mul(mask);
 
    eq->save       = (float*)calloc(    size, 2 * sizeof(*eq->save));
    eq->block      = (float*)calloc(2 * size, 2 * sizeof(*eq->block));
@@ -326,6 +331,18 @@ error:
    return NULL;
 }
 
+static void *eq_init(const struct dspfilter_info *info,
+      const struct dspfilter_config *config, void *userdata)
+{
+   return eq_init_simd(info, config, userdata, 0);
+}
+
+static void *eq_init_avx(const struct dspfilter_info *info,
+      const struct dspfilter_config *config, void *userdata)
+{
+   return eq_init_simd(info, config, userdata, DSPFILTER_SIMD_AVX);
+}
+
 static const struct dspfilter_implementation eq_plug = {
    eq_init,
    eq_process,
@@ -336,12 +353,24 @@ static const struct dspfilter_implementation eq_plug = {
    "eq",
 };
 
+static const struct dspfilter_implementation eq_plug_avx = {
+   eq_init_avx,
+   eq_process,
+   eq_free,
+
+   DSPFILTER_API_VERSION,
+   "Linear-Phase FFT Equalizer",
+   "eq",
+};
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation eq_dspfilter_get_implementation
 #endif
 
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
+   if (mask & DSPFILTER_SIMD_AVX)
+      return &eq_plug_avx;
    return &eq_plug;
 }
 
@@ -26,6 +26,27 @@
 #include "fft.h"
 
 #include <retro_miscellaneous.h>
+#include <libretro_dspfilter.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define FFT_HAVE_SSE
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FFT_HAVE_NEON
+#endif
+
+/* AVX kernels are built regardless of compiler flags
+ * and only picked when the CPU reports AVX. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FFT_HAVE_AVX
+#define FFT_AVX_TARGET __attribute__((target("avx")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1700 && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#define FFT_HAVE_AVX
+#define FFT_AVX_TARGET
+#endif
 
 struct fft
 {
@@ -96,6 +117,17 @@ static void resolve_float(float *out, const fft_complex_t *in, unsigned samples,
       *out = gain * in->real;
 }
 
+static void resolve_complex(fft_complex_t *out, const fft_complex_t *in,
+      unsigned samples, float gain, unsigned step)
+{
+   unsigned i;
+   for (i = 0; i < samples; i++, in++, out += step)
+   {
+      out->real = gain * in->real;
+      out->imag = gain * in->imag;
+   }
+}
+
 fft_t *fft_new(unsigned block_size_log2)
 {
    unsigned size;
@@ -202,3 +234,145 @@ void fft_process_inverse(fft_t *fft,
 
    resolve_float(out, fft->interleave_buffer, samples, 1.0f / samples, step);
 }
+
+void fft_process_inverse_complex(fft_t *fft,
+      fft_complex_t *out, const fft_complex_t *in, unsigned step)
+{
+   unsigned step_size;
+   unsigned samples = fft->size;
+
+   interleave_complex(fft->bitinverse_buffer, fft->interleave_buffer,
+         in, samples, 1);
+
+   for (step_size = 1; step_size < samples; step_size <<= 1)
+   {
+      butterflies(fft->interleave_buffer,
+            fft->phase_lut + samples,
+            1, step_size, samples);
+   }
+
+   resolve_complex(out, fft->interleave_buffer, samples, 1.0f / samples, step);
+}
+
+static void fft_complex_mul_block(fft_complex_t *out,
+      const fft_complex_t *a, const fft_complex_t *b, unsigned samples)
+{
+   unsigned i = 0;
+#if defined(FFT_HAVE_SSE)
+   const __m128 sign = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+
+   for (; i + 2 <= samples; i += 2)
+   {
+      __m128 va = _mm_loadu_ps(&a[i].real);
+      __m128 vb = _mm_loadu_ps(&b[i].real);
+      __m128 br = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 2, 0, 0));
+      __m128 bi = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 3, 1, 1));
+      __m128 as = _mm_shuffle_ps(va, va, _MM_SHUFFLE(2, 3, 0, 1));
+      _mm_storeu_ps(&out[i].real, _mm_add_ps(_mm_mul_ps(va, br),
+               _mm_xor_ps(_mm_mul_ps(as, bi), sign)));
+   }
+#elif defined(FFT_HAVE_NEON)
+   for (; i + 4 <= samples; i += 4)
+   {
+      float32x4x2_t va = vld2q_f32(&a[i].real);
+      float32x4x2_t vb = vld2q_f32(&b[i].real);
+      float32x4x2_t vo;
+      vo.val[0] = vmlsq_f32(vmulq_f32(va.val[0], vb.val[0]), va.val[1], vb.val[1]);
+      vo.val[1] = vmlaq_f32(vmulq_f32(va.val[0], vb.val[1]), va.val[1], vb.val[0]);
+      vst2q_f32(&out[i].real, vo);
+   }
+#endif
+   for (; i < samples; i++)
+      out[i] = fft_complex_mul(a[i], b[i]);
+}
+
+static void fft_complex_mac_block(fft_complex_t *out,
+      const fft_complex_t *a, const fft_complex_t *b, unsigned samples)
+{
+   unsigned i = 0;
+#if defined(FFT_HAVE_SSE)
+   const __m128 sign = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+
+   for (; i + 2 <= samples; i += 2)
+   {
+      __m128 va = _mm_loadu_ps(&a[i].real);
+      __m128 vb = _mm_loadu_ps(&b[i].real);
+      __m128 br = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 2, 0, 0));
+      __m128 bi = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 3, 1, 1));
+      __m128 as = _mm_shuffle_ps(va, va, _MM_SHUFFLE(2, 3, 0, 1));
+      __m128 vo = _mm_add_ps(_mm_mul_ps(va, br),
+               _mm_xor_ps(_mm_mul_ps(as, bi), sign));
+      _mm_storeu_ps(&out[i].real, _mm_add_ps(_mm_loadu_ps(&out[i].real), vo));
+   }
+#elif defined(FFT_HAVE_NEON)
+   for (; i + 4 <= samples; i += 4)
+   {
+      float32x4x2_t va = vld2q_f32(&a[i].real);
+      float32x4x2_t vb = vld2q_f32(&b[i].real);
+      float32x4x2_t vo = vld2q_f32(&out[i].real);
+      vo.val[0] = vmlaq_f32(vo.val[0], va.val[0], vb.val[0]);
+      vo.val[0] = vmlsq_f32(vo.val[0], va.val[1], vb.val[1]);
+      vo.val[1] = vmlaq_f32(vo.val[1], va.val[0], vb.val[1]);
+      vo.val[1] = vmlaq_f32(vo.val[1], va.val[1], vb.val[0]);
+      vst2q_f32(&out[i].real, vo);
+   }
+#endif
+   for (; i < samples; i++)
+      out[i] = fft_complex_add(out[i], fft_complex_mul(a[i], b[i]));
+}
+
+#ifdef FFT_HAVE_AVX
+static FFT_AVX_TARGET __m256 fft_complex_mul_avx_4(__m256 va, __m256 vb)
+{
+   __m256 br = _mm256_moveldup_ps(vb);
+   __m256 bi = _mm256_movehdup_ps(vb);
+   __m256 as = _mm256_permute_ps(va, _MM_SHUFFLE(2, 3, 0, 1));
+   return _mm256_addsub_ps(_mm256_mul_ps(va, br), _mm256_mul_ps(as, bi));
+}
+
+static FFT_AVX_TARGET void fft_complex_mul_block_avx(fft_complex_t *out,
+      const fft_complex_t *a, const fft_complex_t *b, unsigned samples)
+{
+   unsigned i = 0;
+
+   for (; i + 4 <= samples; i += 4)
+      _mm256_storeu_ps(&out[i].real, fft_complex_mul_avx_4(
+               _mm256_loadu_ps(&a[i].real), _mm256_loadu_ps(&b[i].real)));
+
+   for (; i < samples; i++)
+      out[i] = fft_complex_mul(a[i], b[i]);
+}
+
+static FFT_AVX_TARGET void fft_complex_mac_block_avx(fft_complex_t *out,
+      const fft_complex_t *a, const fft_complex_t *b, unsigned samples)
+{
+   unsigned i = 0;
+
+   for (; i + 4 <= samples; i += 4)
+      _mm256_storeu_ps(&out[i].real, _mm256_add_ps(
+               _mm256_loadu_ps(&out[i].real),
+               fft_complex_mul_avx_4(
+                  _mm256_loadu_ps(&a[i].real), _mm256_loadu_ps(&b[i].real))));
+
+   for (; i < samples; i++)
+      out[i] = fft_complex_add(out[i], fft_complex_mul(a[i], b[i]));
+}
+#endif
+
+fft_complex_block_t fft_get_complex_mul(unsigned simd_mask)
+{
+#ifdef FFT_HAVE_AVX
+   if (simd_mask & DSPFILTER_SIMD_AVX)
+      return fft_complex_mul_block_avx;
+#endif
+   return fft_complex_mul_block;
+}
+
+fft_complex_block_t fft_get_complex_mac(unsigned simd_mask)
+{
+#ifdef FFT_HAVE_AVX
+   if (simd_mask & DSPFILTER_SIMD_AVX)
+      return fft_complex_mac_block_avx;
+#endif
+   return fft_complex_mac_block;
+}
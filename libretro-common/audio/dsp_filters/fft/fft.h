@@ -41,4 +41,19 @@ void fft_process_forward(fft_t *fft,
 void fft_process_inverse(fft_t *fft,
       float *out, const fft_complex_t *in, unsigned step);
 
+void fft_process_inverse_complex(fft_t *fft,
+      fft_complex_t *out, const fft_complex_t *in, unsigned step);
+
+/* Element-wise kernels over @samples values:
+ * out[i] = a[i] * b[i] for the multiply kernel,
+ * out[i] += a[i] * b[i] for the multiply-accumulate kernel.
+ * @out may be the same array as @a. */
+typedef void (*fft_complex_block_t)(fft_complex_t *out,
+      const fft_complex_t *a, const fft_complex_t *b, unsigned samples);
+
+/* Picks the fastest kernels for a DSPFILTER_SIMD_* mask. */
+fft_complex_block_t fft_get_complex_mul(unsigned simd_mask);
+
+fft_complex_block_t fft_get_complex_mac(unsigned simd_mask);
+
 #endif
@@ -28,6 +28,12 @@
 #include <libretro_dspfilter.h>
 #include <string/stdstring.h>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #define sqr(a) ((a) * (a))
 
 /* filter types */
@@ -49,8 +55,9 @@ enum IIRFilter
 
 struct iir_data
 {
+   /* Normalized so that a0 is 1 */
    float b0, b1, b2;
-   float a0, a1, a2;
+   float a1, a2;
 
    struct
    {
@@ -71,10 +78,95 @@ static void iir_process(void *data, struct dspfilter_output *output,
    struct iir_data *iir = (struct iir_data*)data;
    float *out           = output->samples;
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+   /* Both channels in the low half of one vector */
+   __m128 b0            = _mm_set1_ps(iir->b0);
+   __m128 b1            = _mm_set1_ps(iir->b1);
+   __m128 b2            = _mm_set1_ps(iir->b2);
+   __m128 a1            = _mm_set1_ps(iir->a1);
+   __m128 a2            = _mm_set1_ps(iir->a2);
+
+   __m128 xn1           = _mm_setr_ps(iir->l.xn1, iir->r.xn1, 0.0f, 0.0f);
+   __m128 xn2           = _mm_setr_ps(iir->l.xn2, iir->r.xn2, 0.0f, 0.0f);
+   __m128 yn1           = _mm_setr_ps(iir->l.yn1, iir->r.yn1, 0.0f, 0.0f);
+   __m128 yn2           = _mm_setr_ps(iir->l.yn2, iir->r.yn2, 0.0f, 0.0f);
+   float state[4];
+
+   output->samples      = input->samples;
+   output->frames       = input->frames;
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      __m128 in = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)out);
+      __m128 y  = _mm_sub_ps(
+            _mm_add_ps(
+               _mm_add_ps(_mm_mul_ps(b0, in), _mm_mul_ps(b1, xn1)),
+               _mm_mul_ps(b2, xn2)),
+            _mm_add_ps(_mm_mul_ps(a1, yn1), _mm_mul_ps(a2, yn2)));
+
+      xn2       = xn1;
+      xn1       = in;
+      yn2       = yn1;
+      yn1       = y;
+
+      _mm_storel_pi((__m64*)out, y);
+   }
+
+   _mm_storeu_ps(state, _mm_unpacklo_ps(xn1, xn2));
+   iir->l.xn1 = state[0];
+   iir->l.xn2 = state[1];
+   iir->r.xn1 = state[2];
+   iir->r.xn2 = state[3];
+   _mm_storeu_ps(state, _mm_unpacklo_ps(yn1, yn2));
+   iir->l.yn1 = state[0];
+   iir->l.yn2 = state[1];
+   iir->r.yn1 = state[2];
+   iir->r.yn2 = state[3];
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+   /* Both channels in one vector */
+   float b0             = iir->b0;
+   float b1             = iir->b1;
+   float b2             = iir->b2;
+   float a1             = iir->a1;
+   float a2             = iir->a2;
+
+   float32x2_t xn1      = { iir->l.xn1, iir->r.xn1 };
+   float32x2_t xn2      = { iir->l.xn2, iir->r.xn2 };
+   float32x2_t yn1      = { iir->l.yn1, iir->r.yn1 };
+   float32x2_t yn2      = { iir->l.yn2, iir->r.yn2 };
+
+   output->samples      = input->samples;
+   output->frames       = input->frames;
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      float32x2_t in = vld1_f32(out);
+      float32x2_t y  = vmul_n_f32(in, b0);
+      y              = vmla_n_f32(y, xn1, b1);
+      y              = vmla_n_f32(y, xn2, b2);
+      y              = vmls_n_f32(y, yn1, a1);
+      y              = vmls_n_f32(y, yn2, a2);
+
+      xn2            = xn1;
+      xn1            = in;
+      yn2            = yn1;
+      yn1            = y;
+
+      vst1_f32(out, y);
+   }
+
+   iir->l.xn1 = vget_lane_f32(xn1, 0);
+   iir->l.xn2 = vget_lane_f32(xn2, 0);
+   iir->l.yn1 = vget_lane_f32(yn1, 0);
+   iir->l.yn2 = vget_lane_f32(yn2, 0);
+   iir->r.xn1 = vget_lane_f32(xn1, 1);
+   iir->r.xn2 = vget_lane_f32(xn2, 1);
+   iir->r.yn1 = vget_lane_f32(yn1, 1);
+   iir->r.yn2 = vget_lane_f32(yn2, 1);
+#else
    float b0             = iir->b0;
    float b1             = iir->b1;
    float b2             = iir->b2;
-   float a0             = iir->a0;
    float a1             = iir->a1;
    float a2             = iir->a2;
 
@@ -96,8 +188,8 @@ static void iir_process(void *data, struct dspfilter_output *output,
       float in_l = out[0];
       float in_r = out[1];
 
-      float l    = (b0 * in_l + b1 * xn1_l + b2 * xn2_l - a1 * yn1_l - a2 * yn2_l) / a0;
-      float r    = (b0 * in_r + b1 * xn1_r + b2 * xn2_r - a1 * yn1_r - a2 * yn2_r) / a0;
+      float l    = b0 * in_l + b1 * xn1_l + b2 * xn2_l - a1 * yn1_l - a2 * yn2_l;
+      float r    = b0 * in_r + b1 * xn1_r + b2 * xn2_r - a1 * yn1_r - a2 * yn2_r;
 
       xn2_l      = xn1_l;
       xn1_l      = in_l;
@@ -122,6 +214,7 @@ static void iir_process(void *data, struct dspfilter_output *output,
    iir->r.xn2 = xn2_r;
    iir->r.yn1 = yn1_r;
    iir->r.yn2 = yn2_r;
+#endif
 }
 
 #define CHECK(x) if (string_is_equal(str, #x)) return x
@@ -318,12 +411,12 @@ static void iir_filter_init(struct iir_data *iir,
          break;
    }
 
-   iir->b0 = b0;
-   iir->b1 = b1;
-   iir->b2 = b2;
-   iir->a0 = a0;
-   iir->a1 = a1;
-   iir->a2 = a2;
+   /* Divide by a0 once here rather than on every sample. */
+   iir->b0 = b0 / a0;
+   iir->b1 = b1 / a0;
+   iir->b2 = b2 / a0;
+   iir->a1 = a1 / a0;
+   iir->a2 = a2 / a0;
 }
 
 static void *iir_init(const struct dspfilter_info *info,
@@ -0,0 +1,389 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (features_trace.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_atomic.h>
+#include <features/features_trace.h>
+#include <streams/file_stream.h>
+#include <compat/strl.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Events kept per thread; must be a power of two */
+#define TRACE_EVENT_RING_SIZE   8192
+#define TRACE_EVENT_RING_MASK   (TRACE_EVENT_RING_SIZE - 1)
+#define TRACE_EVENT_MAX_THREADS 64
+
+/* Events copied out of a ring at a time while writing */
+#define TRACE_EVENT_BATCH       256
+
+/* Each ring has a single writer (its thread) and a single
+ * reader (the thread writing the trace out). The writer
+ * publishes an event by advancing 'head' after filling it
+ * in, so the reader needs 'head' loaded with acquire and
+ * stored with release ordering. */
+#define TRACE_EVENT_LOAD(p)     retro_atomic_load_acquire_uint(p)
+#define TRACE_EVENT_STORE(p, v) retro_atomic_store_release_uint(p, v)
+
+struct trace_event
+{
+   const char *name;
+   retro_time_t start;
+   uint32_t dur;
+   int32_t arg;
+};
+
+struct trace_ring
+{
+   struct trace_event events[TRACE_EVENT_RING_SIZE];
+   uintptr_t thread_id;
+   unsigned head;       /* Events ever recorded, owner thread only */
+   unsigned begin;      /* Value of 'head' at trace_event_start() */
+   unsigned tail;       /* Next event to stream to trace_file */
+   unsigned index;      /* Thread ID in the written trace */
+   char name[32];
+};
+
+volatile bool trace_event_enabled = false;
+
+static struct trace_ring *trace_rings[TRACE_EVENT_MAX_THREADS];
+static unsigned trace_num_rings   = 0;
+static retro_time_t trace_epoch   = 0;
+static RFILE *trace_file          = NULL;
+static bool trace_file_empty      = true;
+
+#ifdef HAVE_THREADS
+/* Guards adding rings to trace_rings */
+static slock_t *trace_lock        = NULL;
+#ifdef HAVE_THREAD_STORAGE
+static sthread_tls_t trace_tls;
+static bool trace_tls_valid       = false;
+#endif
+#endif
+
+static struct trace_ring *trace_event_get_ring(void)
+{
+   struct trace_ring *ring = NULL;
+#ifdef HAVE_THREADS
+   uintptr_t thread_id     = sthread_get_current_thread_id();
+#ifdef HAVE_THREAD_STORAGE
+   if (trace_tls_valid)
+   {
+      if ((ring = (struct trace_ring*)sthread_tls_get(&trace_tls)))
+         return ring;
+   }
+   else
+#endif
+   {
+      unsigned i;
+      unsigned num_rings = TRACE_EVENT_LOAD(&trace_num_rings);
+
+      for (i = 0; i < num_rings; i++)
+         if (trace_rings[i]->thread_id == thread_id)
+            return trace_rings[i];
+   }
+
+   if (!trace_lock)
+      return NULL;
+
+   /* First event on this thread */
+   slock_lock(trace_lock);
+#else
+   if (trace_num_rings)
+      return trace_rings[0];
+#endif
+
+   if (     trace_num_rings < TRACE_EVENT_MAX_THREADS
+         && (ring = (struct trace_ring*)calloc(1, sizeof(*ring))))
+   {
+      ring->index     = trace_num_rings;
+#ifdef HAVE_THREADS
+      ring->thread_id = thread_id;
+#endif
+      snprintf(ring->name, sizeof(ring->name), "Thread %u", ring->index);
+      trace_rings[trace_num_rings] = ring;
+      TRACE_EVENT_STORE(&trace_num_rings, trace_num_rings + 1);
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(trace_lock);
+#ifdef HAVE_THREAD_STORAGE
+   if (ring && trace_tls_valid)
+      sthread_tls_set(&trace_tls, ring);
+#endif
+#endif
+
+   return ring;
+}
+
+void trace_event_add(const char *name, retro_time_t start, int32_t arg)
+{
+   unsigned head;
+   struct trace_event *event;
+   retro_time_t now        = cpu_features_get_time_usec();
+   struct trace_ring *ring = trace_event_get_ring();
+
+   if (!ring)
+      return;
+
+   head         = ring->head;
+   event        = &ring->events[head & TRACE_EVENT_RING_MASK];
+   event->name  = name;
+   event->start = start;
+   event->dur   = (uint32_t)(now - start);
+   event->arg   = arg;
+
+   TRACE_EVENT_STORE(&ring->head, head + 1);
+}
+
+void trace_event_set_thread_name(const char *name)
+{
+   char *s;
+   struct trace_ring *ring = NULL;
+
+   if (!trace_event_enabled || !(ring = trace_event_get_ring()))
+      return;
+
+   strlcpy(ring->name, name, sizeof(ring->name));
+
+   /* Keep the name a valid JSON string */
+   for (s = ring->name; *s; s++)
+      if (*s == '"' || *s == '\\' || (unsigned char)*s < ' ')
+         *s = '_';
+}
+
+static void trace_event_write_buf(RFILE *file,
+      char *buf, size_t *_len, bool force)
+{
+   if (*_len && (force || *_len > 3072))
+   {
+      filestream_write(file, buf, *_len);
+      *_len = 0;
+   }
+}
+
+/* Writes the events [from, to) of 'ring' to 'file', skipping
+ * those overwritten before they could be copied out.
+ * Returns the index following the last event written. */
+static unsigned trace_event_write_ring(RFILE *file,
+      const struct trace_ring *ring, unsigned from, unsigned to,
+      bool *empty)
+{
+   size_t _len = 0;
+   char buf[4096];
+   struct trace_event batch[TRACE_EVENT_BATCH];
+
+   if (to - from > TRACE_EVENT_RING_SIZE)
+      from = to - TRACE_EVENT_RING_SIZE;
+
+   while (from != to)
+   {
+      unsigned i;
+      unsigned head;
+      unsigned count = to - from;
+
+      if (count > TRACE_EVENT_BATCH)
+         count = TRACE_EVENT_BATCH;
+
+      for (i = 0; i < count; i++)
+         batch[i] = ring->events[(from + i) & TRACE_EVENT_RING_MASK];
+
+      /* Anything the writer got to while copying is torn */
+      head = TRACE_EVENT_LOAD(&ring->head);
+      i    = 0;
+      if (head - from > TRACE_EVENT_RING_SIZE)
+         i = head - from - TRACE_EVENT_RING_SIZE;
+
+      for (; i < count; i++)
+      {
+         const struct trace_event *event = &batch[i];
+         retro_time_t ts = event->start - trace_epoch;
+
+         if (ts < 0)
+            ts = 0;
+
+         _len += snprintf(buf + _len, sizeof(buf) - _len,
+               "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+               "\"ts\":%lld,\"dur\":%u",
+               *empty ? "" : ",\n",
+               event->name, ring->index,
+               (long long)ts, (unsigned)event->dur);
+         if (event->arg >= 0)
+            _len += snprintf(buf + _len, sizeof(buf) - _len,
+                  ",\"args\":{\"arg\":%d}", (int)event->arg);
+         buf[_len++] = '}';
+         *empty      = false;
+
+         trace_event_write_buf(file, buf, &_len, false);
+      }
+
+      from += count;
+   }
+
+   trace_event_write_buf(file, buf, &_len, true);
+
+   return to;
+}
+
+static void trace_event_write_footer(RFILE *file, bool empty)
+{
+   unsigned i;
+   unsigned num_rings = TRACE_EVENT_LOAD(&trace_num_rings);
+
+   for (i = 0; i < num_rings; i++)
+   {
+      char buf[128];
+      int _len = snprintf(buf, sizeof(buf),
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+            "\"args\":{\"name\":\"%s\"}}",
+            empty ? "" : ",\n",
+            trace_rings[i]->index, trace_rings[i]->name);
+      filestream_write(file, buf, _len);
+      empty = false;
+   }
+
+   filestream_write(file, "\n]\n", 3);
+}
+
+bool trace_event_start(const char *path)
+{
+   unsigned i;
+
+   trace_event_stop();
+
+#ifdef HAVE_THREADS
+   if (!trace_lock && !(trace_lock = slock_new()))
+      return false;
+#ifdef HAVE_THREAD_STORAGE
+   if (!trace_tls_valid)
+      trace_tls_valid = sthread_tls_create(&trace_tls);
+#endif
+#endif
+
+   if (path && *path)
+   {
+      if (!(trace_file = filestream_open(path,
+                  RETRO_VFS_FILE_ACCESS_WRITE,
+                  RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+         return false;
+
+      /* JSON array format, so the file stays loadable
+       * even if it never gets completed */
+      filestream_write(trace_file, "[\n", 2);
+      trace_file_empty = true;
+   }
+
+   for (i = 0; i < TRACE_EVENT_LOAD(&trace_num_rings); i++)
+   {
+      struct trace_ring *ring = trace_rings[i];
+      ring->begin             = TRACE_EVENT_LOAD(&ring->head);
+      ring->tail              = ring->begin;
+   }
+
+   trace_epoch         = cpu_features_get_time_usec();
+   trace_event_enabled = true;
+
+   return true;
+}
+
+void trace_event_flush(void)
+{
+   unsigned i;
+
+   if (!trace_file)
+      return;
+
+   for (i = 0; i < TRACE_EVENT_LOAD(&trace_num_rings); i++)
+   {
+      struct trace_ring *ring = trace_rings[i];
+      ring->tail = trace_event_write_ring(trace_file, ring, ring->tail,
+            TRACE_EVENT_LOAD(&ring->head), &trace_file_empty);
+   }
+}
+
+void trace_event_stop(void)
+{
+   trace_event_enabled = false;
+
+   if (!trace_file)
+      return;
+
+   trace_event_flush();
+   trace_event_write_footer(trace_file, trace_file_empty);
+   filestream_close(trace_file);
+   trace_file = NULL;
+}
+
+bool trace_event_dump(const char *path)
+{
+   unsigned i;
+   bool empty = true;
+   RFILE *file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   filestream_write(file, "[\n", 2);
+
+   for (i = 0; i < TRACE_EVENT_LOAD(&trace_num_rings); i++)
+   {
+      const struct trace_ring *ring = trace_rings[i];
+      trace_event_write_ring(file, ring, ring->begin,
+            TRACE_EVENT_LOAD(&ring->head), &empty);
+   }
+
+   trace_event_write_footer(file, empty);
+
+   return filestream_close(file) == 0;
+}
+
+void trace_event_deinit(void)
+{
+   unsigned i;
+
+   trace_event_stop();
+
+   for (i = 0; i < trace_num_rings; i++)
+   {
+      free(trace_rings[i]);
+      trace_rings[i] = NULL;
+   }
+   trace_num_rings = 0;
+
+#ifdef HAVE_THREADS
+#ifdef HAVE_THREAD_STORAGE
+   if (trace_tls_valid)
+      sthread_tls_delete(&trace_tls);
+   trace_tls_valid = false;
+#endif
+   if (trace_lock)
+      slock_free(trace_lock);
+   trace_lock = NULL;
+#endif
+}
@@ -24,7 +24,9 @@
 #include <string.h>
 
 #include <file/archive_file.h>
+#include <file/file_path.h>
 #include <streams/file_stream.h>
+#include <compat/strl.h>
 #include <retro_inline.h>
 #include <retro_miscellaneous.h>
 #include <encodings/crc32.h>
@@ -561,3 +563,431 @@ const struct file_archive_file_backend zlib_backend = {
    zip_file_read,
    "zlib"
 };
+
+#ifndef LOCAL_FILE_HEADER_SIGNATURE
+#define LOCAL_FILE_HEADER_SIGNATURE 0x04034b50
+#endif
+
+#define ZIP_LOCAL_HEADER_SIZE 30
+#define ZIP_STREAM_OUT_SIZE   (64*1024)
+
+enum zip_stream_part
+{
+   ZIP_STREAM_HEADER = 0,
+   ZIP_STREAM_DATA,
+   ZIP_STREAM_DONE,
+   ZIP_STREAM_ERROR
+};
+
+struct zip_stream_entry
+{
+   char *path;
+   char *tmp_path;
+};
+
+struct file_archive_stream
+{
+   char *target_dir;
+   uint8_t *header;
+   uint8_t *out;
+   RFILE *file;
+   struct zip_stream_entry *entries;
+   z_stream zstream;
+   size_t header_len;
+   size_t header_cap;
+   size_t num_entries;
+   uint32_t remaining;
+   uint32_t usize;
+   uint32_t crc;
+   uint32_t crc_expected;
+   unsigned cmode;
+   enum zip_stream_part part;
+   bool zstream_active;
+};
+
+/* Rejects absolute paths and parent directory components,
+ * an archive must not write outside of the target directory */
+static bool zip_stream_name_is_safe(const char *name)
+{
+   const char *s = name;
+
+   if (!*name || *name == '/' || *name == '\\' || strchr(name, ':'))
+      return false;
+
+   while (*s)
+   {
+      size_t len = strcspn(s, "/\\");
+      if (len == 2 && s[0] == '.' && s[1] == '.')
+         return false;
+      s += len;
+      if (*s)
+         s++;
+   }
+
+   return true;
+}
+
+static void zip_stream_end_entry(struct file_archive_stream *stream)
+{
+   if (stream->zstream_active)
+   {
+      inflateEnd(&stream->zstream);
+      stream->zstream_active = false;
+   }
+   if (stream->file)
+   {
+      filestream_close(stream->file);
+      stream->file = NULL;
+   }
+}
+
+/* Parses the local header in stream->header. Returns
+ * false if the entry cannot be extracted sequentially. */
+static bool zip_stream_begin_entry(struct file_archive_stream *stream)
+{
+   char name[PATH_MAX_LENGTH];
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   struct zip_stream_entry *entries;
+   const uint8_t *header = stream->header;
+   unsigned flags        = read_le(header + 6,  2);
+   unsigned name_len     = read_le(header + 26, 2);
+   size_t _len;
+
+   stream->cmode         = read_le(header + 8,  2);
+   stream->crc_expected  = read_le(header + 14, 4);
+   stream->remaining     = read_le(header + 18, 4);
+   stream->usize         = read_le(header + 22, 4);
+   stream->crc           = 0;
+
+   /* Encrypted entries, entries with the sizes in a data
+    * descriptor after the data, and ZIP64 entries need the
+    * central directory */
+   if (     (flags & (1 << 0))
+         || (flags & (1 << 3))
+         || stream->remaining == 0xFFFFFFFF
+         || stream->usize     == 0xFFFFFFFF
+         || name_len >= sizeof(name))
+      return false;
+
+   if (     stream->cmode != ZIP_MODE_STORED
+         && stream->cmode != ZIP_MODE_DEFLATED)
+      return false;
+
+   memcpy(name, header + ZIP_LOCAL_HEADER_SIZE, name_len);
+   name[name_len] = '\0';
+
+   if (!zip_stream_name_is_safe(name))
+      return false;
+
+   fill_pathname_join_special(path, stream->target_dir, name, sizeof(path));
+
+   /* Directory entry */
+   if (name[name_len - 1] == '/' || name[name_len - 1] == '\\')
+      return stream->remaining == 0 && path_mkdir(path);
+
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   path_basedir(tmp_path);
+   if (!path_mkdir(tmp_path))
+      return false;
+
+   _len = strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcpy(tmp_path + _len, ".tmp", sizeof(tmp_path) - _len);
+
+   if (!(entries = (struct zip_stream_entry*)realloc(stream->entries,
+               (stream->num_entries + 1) * sizeof(*entries))))
+      return false;
+   stream->entries = entries;
+
+   entries[stream->num_entries].path     = strdup(path);
+   entries[stream->num_entries].tmp_path = strdup(tmp_path);
+   if (     !entries[stream->num_entries].path
+         || !entries[stream->num_entries].tmp_path)
+   {
+      free(entries[stream->num_entries].path);
+      free(entries[stream->num_entries].tmp_path);
+      return false;
+   }
+   stream->num_entries++;
+
+   if (!(stream->file = filestream_open(tmp_path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   if (stream->cmode == ZIP_MODE_DEFLATED)
+   {
+      memset(&stream->zstream, 0, sizeof(stream->zstream));
+      if (inflateInit2(&stream->zstream, -MAX_WBITS) != Z_OK)
+         return false;
+      stream->zstream_active = true;
+   }
+
+   return true;
+}
+
+static bool zip_stream_write_data(struct file_archive_stream *stream,
+      const uint8_t *data, size_t len)
+{
+   if (stream->cmode == ZIP_MODE_STORED)
+   {
+      stream->crc = encoding_crc32(stream->crc, data, len);
+      return filestream_write(stream->file, data, len) == (int64_t)len;
+   }
+
+   stream->zstream.next_in  = (Bytef*)data;
+   stream->zstream.avail_in = (uInt)len;
+
+   do
+   {
+      int ret;
+      size_t out_len;
+
+      stream->zstream.next_out  = stream->out;
+      stream->zstream.avail_out = ZIP_STREAM_OUT_SIZE;
+
+      ret     = inflate(&stream->zstream, Z_NO_FLUSH);
+      if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+         return false;
+
+      out_len = ZIP_STREAM_OUT_SIZE - stream->zstream.avail_out;
+      if (out_len)
+      {
+         stream->crc = encoding_crc32(stream->crc, stream->out, out_len);
+         if (filestream_write(stream->file, stream->out, out_len)
+               != (int64_t)out_len)
+            return false;
+      }
+
+      if (ret == Z_STREAM_END)
+         return stream->zstream.avail_in == 0;
+   } while (stream->zstream.avail_in || !stream->zstream.avail_out);
+
+   return true;
+}
+
+static bool zip_stream_header_append(struct file_archive_stream *stream,
+      const uint8_t **data, size_t *len, size_t needed)
+{
+   size_t take;
+
+   if (stream->header_len >= needed)
+      return true;
+
+   if (needed > stream->header_cap)
+   {
+      uint8_t *header = (uint8_t*)realloc(stream->header, needed);
+      if (!header)
+      {
+         stream->part = ZIP_STREAM_ERROR;
+         return false;
+      }
+      stream->header     = header;
+      stream->header_cap = needed;
+   }
+
+   take = MIN(needed - stream->header_len, *len);
+   memcpy(stream->header + stream->header_len, *data, take);
+   stream->header_len += take;
+   *data              += take;
+   *len               -= take;
+
+   return stream->header_len >= needed;
+}
+
+/**
+ * file_archive_stream_new:
+ * @target_dir                   : Directory to extract to.
+ *
+ * Creates a ZIP extractor that is fed the archive front to back,
+ * e.g. while it is being downloaded.
+ *
+ * Returns: the extractor, or NULL on allocation failure.
+ **/
+struct file_archive_stream *file_archive_stream_new(const char *target_dir)
+{
+   struct file_archive_stream *stream = (struct file_archive_stream*)
+      calloc(1, sizeof(*stream));
+
+   if (!stream)
+      return NULL;
+
+   stream->target_dir = strdup(target_dir);
+   stream->out        = (uint8_t*)malloc(ZIP_STREAM_OUT_SIZE);
+   stream->part       = ZIP_STREAM_HEADER;
+
+   if (!stream->target_dir || !stream->out)
+   {
+      file_archive_stream_free(stream);
+      return NULL;
+   }
+
+   return stream;
+}
+
+/**
+ * file_archive_stream_write:
+ * @stream                       : Extractor.
+ * @data                         : Next part of the archive.
+ * @len                          : Size of @data.
+ *
+ * Extracts what @data completes. Entries are written next to their
+ * final path until file_archive_stream_finish() moves them in place.
+ *
+ * Returns: false if the archive cannot be extracted sequentially
+ * (encrypted or ZIP64 entries, sizes stored after the data,
+ * unsupported compression) or is corrupt. The caller should then
+ * stop feeding it and extract the complete file instead.
+ **/
+bool file_archive_stream_write(struct file_archive_stream *stream,
+      const void *data, size_t len)
+{
+   const uint8_t *in = (const uint8_t*)data;
+
+   while (len && stream->part != ZIP_STREAM_ERROR)
+   {
+      switch (stream->part)
+      {
+         case ZIP_STREAM_HEADER:
+            {
+               uint32_t signature;
+
+               if (!zip_stream_header_append(stream, &in, &len, 4))
+                  break;
+
+               signature = read_le(stream->header, 4);
+
+               /* The central directory follows the last entry */
+               if (     signature == CENTRAL_FILE_HEADER_SIGNATURE
+                     || signature == END_OF_CENTRAL_DIR_SIGNATURE)
+               {
+                  stream->part = ZIP_STREAM_DONE;
+                  break;
+               }
+
+               if (signature != LOCAL_FILE_HEADER_SIGNATURE)
+               {
+                  stream->part = ZIP_STREAM_ERROR;
+                  break;
+               }
+
+               if (!zip_stream_header_append(stream, &in, &len,
+                        ZIP_LOCAL_HEADER_SIZE))
+                  break;
+
+               if (!zip_stream_header_append(stream, &in, &len,
+                        ZIP_LOCAL_HEADER_SIZE
+                        + read_le(stream->header + 26, 2)
+                        + read_le(stream->header + 28, 2)))
+                  break;
+
+               stream->header_len = 0;
+
+               if (!zip_stream_begin_entry(stream))
+                  stream->part = ZIP_STREAM_ERROR;
+               else if (stream->file)
+                  stream->part = ZIP_STREAM_DATA;
+            }
+            break;
+         case ZIP_STREAM_DATA:
+            {
+               size_t take = MIN(stream->remaining, len);
+
+               if (take && !zip_stream_write_data(stream, in, take))
+               {
+                  stream->part = ZIP_STREAM_ERROR;
+                  break;
+               }
+
+               in                += take;
+               len               -= take;
+               stream->remaining -= (uint32_t)take;
+            }
+            break;
+         case ZIP_STREAM_DONE:
+            /* Ignore the central directory */
+            len = 0;
+            break;
+         default:
+            break;
+      }
+
+      /* Entry complete, also reached for empty files */
+      if (     stream->part == ZIP_STREAM_DATA
+            && stream->remaining == 0)
+      {
+         bool ok = stream->crc == stream->crc_expected
+            && (!stream->zstream_active
+                  || stream->zstream.total_out == stream->usize);
+
+         zip_stream_end_entry(stream);
+         stream->part = ok ? ZIP_STREAM_HEADER : ZIP_STREAM_ERROR;
+      }
+   }
+
+   return stream->part != ZIP_STREAM_ERROR;
+}
+
+/**
+ * file_archive_stream_finish:
+ * @stream                       : Extractor.
+ *
+ * Moves the extracted files in place, replacing existing ones,
+ * provided the whole archive was extracted.
+ *
+ * Returns: true on success.
+ **/
+bool file_archive_stream_finish(struct file_archive_stream *stream)
+{
+   size_t i;
+
+   if (stream->part != ZIP_STREAM_DONE)
+      return false;
+
+   for (i = 0; i < stream->num_entries; i++)
+   {
+      struct zip_stream_entry *entry = &stream->entries[i];
+
+      filestream_delete(entry->path);
+      if (filestream_rename(entry->tmp_path, entry->path) != 0)
+         return false;
+
+      free(entry->tmp_path);
+      entry->tmp_path = NULL;
+   }
+
+   return true;
+}
+
+/**
+ * file_archive_stream_free:
+ * @stream                       : Extractor.
+ *
+ * Frees @stream, deleting files extracted but not moved in place
+ * by file_archive_stream_finish().
+ **/
+void file_archive_stream_free(struct file_archive_stream *stream)
+{
+   size_t i;
+
+   if (!stream)
+      return;
+
+   zip_stream_end_entry(stream);
+
+   for (i = 0; i < stream->num_entries; i++)
+   {
+      if (stream->entries[i].tmp_path)
+      {
+         filestream_delete(stream->entries[i].tmp_path);
+         free(stream->entries[i].tmp_path);
+      }
+      free(stream->entries[i].path);
+   }
+
+   free(stream->entries);
+   free(stream->header);
+   free(stream->out);
+   free(stream->target_dir);
+   free(stream);
+}
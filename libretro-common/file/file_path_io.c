@@ -38,6 +38,7 @@
 
 #ifdef _WIN32
 #include <direct.h>
+#include <encodings/utf.h>
 #else
 #include <unistd.h> /* stat() is defined here */
 #endif
@@ -98,6 +99,48 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * Fetches the last modification time of a file.
+ * Unlike path_stat(), this always queries the
+ * platform directly instead of going through VFS.
+ *
+ * @return modification time in seconds since the
+ * epoch, or 0 if it is unavailable.
+ */
+int64_t path_get_mtime(const char *path)
+{
+#if defined(_WIN32)
+   struct __stat64 buf;
+   int ret;
+#if defined(LEGACY_WIN32)
+   char *path_local    = utf8_to_local_string_alloc(path);
+   if (!path_local)
+      return 0;
+   ret                 = _stat64(path_local, &buf);
+   free(path_local);
+#else
+   wchar_t *path_wide  = utf8_to_utf16_string_alloc(path);
+   if (!path_wide)
+      return 0;
+   ret                 = _wstat64(path_wide, &buf);
+   free(path_wide);
+#endif
+   if (ret != 0)
+      return 0;
+   return (int64_t)buf.st_mtime;
+#elif defined(VITA) || defined(__PSL1GHT__) || defined(__PS3__) || defined(ORBIS)
+   return 0;
+#else
+   struct stat buf;
+   if (!path || !*path || stat(path, &buf) != 0)
+      return 0;
+   return (int64_t)buf.st_mtime;
+#endif
+}
+
 /**
  * path_mkdir:
  * @dir                : directory
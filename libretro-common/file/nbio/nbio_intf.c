@@ -30,6 +30,7 @@
 #include <file/nbio.h>
 
 extern nbio_intf_t nbio_linux;
+extern nbio_intf_t nbio_uring;
 extern nbio_intf_t nbio_mmap_unix;
 extern nbio_intf_t nbio_mmap_win32;
 extern nbio_intf_t nbio_stdio;
@@ -52,8 +53,13 @@ extern nbio_intf_t nbio_stdio;
 
 #endif
 
-#if defined(_linux__)
-static nbio_intf_t *internal_nbio = &nbio_linux;
+#if defined(__linux__)
+bool nbio_uring_available(void);
+bool nbio_linux_available(void);
+
+/* Picked on first use: io_uring if the kernel allows
+ * it, else the older AIO interface, else stdio */
+static nbio_intf_t *internal_nbio = NULL;
 #elif defined(HAVE_MMAP) && defined(BSD)
 static nbio_intf_t *internal_nbio = &nbio_mmap_unix;
 #elif defined(HAVE_MMAP_WIN32)
@@ -64,6 +70,17 @@ static nbio_intf_t *internal_nbio = &nbio_stdio;
 
 void *nbio_open(const char * filename, unsigned mode)
 {
+#if defined(__linux__)
+   if (!internal_nbio)
+   {
+      if (nbio_uring_available())
+         internal_nbio = &nbio_uring;
+      else if (nbio_linux_available())
+         internal_nbio = &nbio_linux;
+      else
+         internal_nbio = &nbio_stdio;
+   }
+#endif
    return internal_nbio->open(filename, mode);
 }
 
@@ -77,6 +77,15 @@ static int io_getevents(aio_context_t ctx, long min_nr, long nr,
    return syscall(__NR_io_getevents, ctx, min_nr, nr, events, timeout);
 }
 
+bool nbio_linux_available(void)
+{
+   aio_context_t ctx = 0;
+   if (io_setup(1, &ctx) < 0)
+      return false;
+   io_destroy(ctx);
+   return true;
+}
+
 static void nbio_begin_op(struct nbio_linux_t* handle, uint16_t op)
 {
    struct iocb * cbp         = &handle->cb;
@@ -220,6 +229,11 @@ nbio_intf_t nbio_linux = {
    "nbio_linux",
 };
 #else
+bool nbio_linux_available(void)
+{
+   return false;
+}
+
 nbio_intf_t nbio_linux = {
    NULL,
    NULL,
@@ -0,0 +1,574 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (nbio_uring.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <file/nbio.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+/* __NR_io_uring_setup is only known to libc headers
+ * recent enough to also ship linux/io_uring.h */
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include <retro_atomic.h>
+
+#ifdef HAVE_THREADS
+#include <pthread.h>
+#endif
+
+/* All handles share one ring, so concurrent loads
+ * (thumbnail bursts, overlay image sets, ...) keep
+ * several reads in flight at once instead of each
+ * handle waiting on its own context. Every transfer
+ * is split into chunks, and chunks that do not fit
+ * in the ring yet are queued and submitted as
+ * earlier ones complete. */
+#define NBIO_URING_ENTRIES 256
+#define NBIO_URING_CHUNK   (256 * 1024)
+
+struct nbio_uring_t;
+
+struct nbio_uring_op
+{
+   struct iovec iov;
+   struct nbio_uring_t *handle;
+   uint64_t offset;
+   int next_free;
+};
+
+struct nbio_uring_t
+{
+   void *ptr;
+   struct nbio_uring_t *next; /* Next handle waiting for ring space */
+   size_t len;
+   size_t queued;             /* Bytes handed to the ring so far */
+   unsigned inflight;
+   unsigned mode;
+   int fd;
+   uint8_t opcode;
+   bool busy;
+   bool pending;
+   bool error;
+};
+
+struct nbio_uring_ring
+{
+   struct nbio_uring_op ops[NBIO_URING_ENTRIES];
+   struct io_uring_sqe *sqes;
+   struct io_uring_cqe *cqes;
+   struct nbio_uring_t *pending_head;
+   struct nbio_uring_t *pending_tail;
+   unsigned *sq_head;
+   unsigned *sq_tail;
+   unsigned *sq_array;
+   unsigned *cq_head;
+   unsigned *cq_tail;
+   void *sq_map;
+   void *cq_map;
+   size_t sq_map_size;
+   size_t cq_map_size;
+   size_t sqes_size;
+   unsigned sq_mask;
+   unsigned sq_entries;
+   unsigned cq_mask;
+   unsigned to_submit;
+   int free_op;
+   int fd;
+   bool initialized;
+};
+
+static struct nbio_uring_ring nbio_uring_st;
+
+#ifdef HAVE_THREADS
+static pthread_mutex_t nbio_uring_lock = PTHREAD_MUTEX_INITIALIZER;
+#define NBIO_URING_LOCK()   pthread_mutex_lock(&nbio_uring_lock)
+#define NBIO_URING_UNLOCK() pthread_mutex_unlock(&nbio_uring_lock)
+#else
+#define NBIO_URING_LOCK()
+#define NBIO_URING_UNLOCK()
+#endif
+
+/* Like nbio_linux, talk to the kernel directly
+ * rather than depending on liburing */
+static int io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+   return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int io_uring_enter(int fd, unsigned to_submit,
+      unsigned min_complete, unsigned flags)
+{
+   return (int)syscall(__NR_io_uring_enter, fd, to_submit,
+         min_complete, flags, NULL, 0);
+}
+
+static bool nbio_uring_ring_init(struct nbio_uring_ring *ring)
+{
+   int i;
+   struct io_uring_params p;
+
+   memset(&p, 0, sizeof(p));
+
+   ring->fd = io_uring_setup(NBIO_URING_ENTRIES, &p);
+   /* Fails on kernels older than 5.1 and wherever
+    * io_uring is disabled (sysctl, seccomp filters) */
+   if (ring->fd < 0)
+      return false;
+
+   ring->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+   ring->cq_map_size = p.cq_off.cqes
+      + p.cq_entries * sizeof(struct io_uring_cqe);
+   ring->sqes_size   = p.sq_entries * sizeof(struct io_uring_sqe);
+
+   ring->sq_map      = mmap(NULL, ring->sq_map_size,
+         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+         ring->fd, IORING_OFF_SQ_RING);
+   ring->cq_map      = mmap(NULL, ring->cq_map_size,
+         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+         ring->fd, IORING_OFF_CQ_RING);
+   ring->sqes        = (struct io_uring_sqe*)mmap(NULL, ring->sqes_size,
+         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+         ring->fd, IORING_OFF_SQES);
+
+   if (     ring->sq_map == MAP_FAILED
+         || ring->cq_map == MAP_FAILED
+         || ring->sqes   == MAP_FAILED)
+   {
+      if (ring->sq_map != MAP_FAILED)
+         munmap(ring->sq_map, ring->sq_map_size);
+      if (ring->cq_map != MAP_FAILED)
+         munmap(ring->cq_map, ring->cq_map_size);
+      if (ring->sqes != MAP_FAILED)
+         munmap(ring->sqes, ring->sqes_size);
+      close(ring->fd);
+      ring->fd = -1;
+      return false;
+   }
+
+   ring->sq_head    = (unsigned*)((uint8_t*)ring->sq_map + p.sq_off.head);
+   ring->sq_tail    = (unsigned*)((uint8_t*)ring->sq_map + p.sq_off.tail);
+   ring->sq_array   = (unsigned*)((uint8_t*)ring->sq_map + p.sq_off.array);
+   ring->sq_mask    = *(unsigned*)((uint8_t*)ring->sq_map
+         + p.sq_off.ring_mask);
+   ring->sq_entries = p.sq_entries;
+   ring->cq_head    = (unsigned*)((uint8_t*)ring->cq_map + p.cq_off.head);
+   ring->cq_tail    = (unsigned*)((uint8_t*)ring->cq_map + p.cq_off.tail);
+   ring->cq_mask    = *(unsigned*)((uint8_t*)ring->cq_map
+         + p.cq_off.ring_mask);
+   ring->cqes       = (struct io_uring_cqe*)((uint8_t*)ring->cq_map
+         + p.cq_off.cqes);
+
+   /* Never keep more operations in flight than the
+    * submission queue holds, so requeueing a short
+    * read always finds a free slot */
+   for (i = 0; i < NBIO_URING_ENTRIES; i++)
+      ring->ops[i].next_free = (i + 1 < NBIO_URING_ENTRIES
+            && (unsigned)(i + 1) < ring->sq_entries) ? i + 1 : -1;
+   ring->free_op    = 0;
+
+   return true;
+}
+
+static void nbio_uring_push_sqe(struct nbio_uring_ring *ring,
+      int op_index)
+{
+   struct nbio_uring_op *op = &ring->ops[op_index];
+   unsigned tail            = *ring->sq_tail;
+   unsigned index           = tail & ring->sq_mask;
+   struct io_uring_sqe *sqe = &ring->sqes[index];
+
+   memset(sqe, 0, sizeof(*sqe));
+   sqe->opcode              = op->handle->opcode;
+   sqe->fd                  = op->handle->fd;
+   sqe->addr                = (uint64_t)(uintptr_t)&op->iov;
+   sqe->len                 = 1;
+   sqe->off                 = op->offset;
+   sqe->user_data           = (uint64_t)op_index;
+
+   ring->sq_array[index]    = index;
+   retro_atomic_store_release_uint(ring->sq_tail, tail + 1);
+   ring->to_submit++;
+}
+
+static void nbio_uring_unlink_pending(struct nbio_uring_ring *ring,
+      struct nbio_uring_t *handle)
+{
+   struct nbio_uring_t *prev = NULL;
+   struct nbio_uring_t *cur  = ring->pending_head;
+
+   while (cur && cur != handle)
+   {
+      prev = cur;
+      cur  = cur->next;
+   }
+
+   if (!cur)
+      return;
+
+   if (prev)
+      prev->next         = cur->next;
+   else
+      ring->pending_head = cur->next;
+   if (ring->pending_tail == cur)
+      ring->pending_tail = prev;
+
+   handle->next    = NULL;
+   handle->pending = false;
+}
+
+/* Hands out chunks to the ring in the order the
+ * transfers were started, so the oldest load
+ * finishes first, then submits them in one call */
+static void nbio_uring_submit(struct nbio_uring_ring *ring)
+{
+   while (ring->pending_head && ring->free_op >= 0)
+   {
+      struct nbio_uring_t *handle = ring->pending_head;
+      int op_index                = ring->free_op;
+      struct nbio_uring_op *op    = &ring->ops[op_index];
+      size_t chunk                = handle->len - handle->queued;
+
+      if (chunk > NBIO_URING_CHUNK)
+         chunk = NBIO_URING_CHUNK;
+
+      ring->free_op     = op->next_free;
+      op->handle        = handle;
+      op->iov.iov_base  = (uint8_t*)handle->ptr + handle->queued;
+      op->iov.iov_len   = chunk;
+      op->offset        = handle->queued;
+
+      nbio_uring_push_sqe(ring, op_index);
+
+      handle->queued   += chunk;
+      handle->inflight++;
+
+      if (handle->queued >= handle->len)
+         nbio_uring_unlink_pending(ring, handle);
+   }
+
+   if (ring->to_submit)
+   {
+      int ret = io_uring_enter(ring->fd, ring->to_submit, 0, 0);
+      /* Entries the kernel did not take stay in the
+       * queue and go out with the next call */
+      if (ret > 0)
+         ring->to_submit -= (unsigned)ret;
+   }
+}
+
+static void nbio_uring_complete(struct nbio_uring_ring *ring,
+      int op_index, int res)
+{
+   struct nbio_uring_op *op    = &ring->ops[op_index];
+   struct nbio_uring_t *handle = op->handle;
+
+   if (res == -EINTR || res == -EAGAIN)
+   {
+      nbio_uring_push_sqe(ring, op_index);
+      return;
+   }
+
+   /* Short transfer, continue where it stopped */
+   if (res > 0 && (size_t)res < op->iov.iov_len)
+   {
+      op->iov.iov_base = (uint8_t*)op->iov.iov_base + res;
+      op->iov.iov_len -= res;
+      op->offset      += res;
+      nbio_uring_push_sqe(ring, op_index);
+      return;
+   }
+
+   if (res < 0 || (res == 0 && op->iov.iov_len))
+      handle->error = true;
+
+   op->handle    = NULL;
+   op->next_free = ring->free_op;
+   ring->free_op = op_index;
+
+   handle->inflight--;
+   if (!handle->inflight && !handle->pending)
+      handle->busy = false;
+}
+
+/* Dispatches every completion in the ring, whichever
+ * handle it belongs to, and refills the ring */
+static void nbio_uring_poll(struct nbio_uring_ring *ring)
+{
+   unsigned head = *ring->cq_head;
+   unsigned tail = retro_atomic_load_acquire_uint(ring->cq_tail);
+
+   while (head != tail)
+   {
+      struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+      int op_index             = (int)cqe->user_data;
+      int res                  = cqe->res;
+
+      head++;
+      nbio_uring_complete(ring, op_index, res);
+   }
+
+   retro_atomic_store_release_uint(ring->cq_head, head);
+
+   nbio_uring_submit(ring);
+}
+
+static void nbio_uring_wait(struct nbio_uring_ring *ring,
+      struct nbio_uring_t *handle)
+{
+   for (;;)
+   {
+      nbio_uring_poll(ring);
+      if (!handle->busy)
+         break;
+      if (     io_uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0
+            && errno != EINTR)
+         break;
+   }
+}
+
+bool nbio_uring_available(void)
+{
+   bool ret;
+
+   NBIO_URING_LOCK();
+   if (!nbio_uring_st.initialized)
+   {
+      nbio_uring_st.initialized = true;
+      if (!nbio_uring_ring_init(&nbio_uring_st))
+         nbio_uring_st.fd       = -1;
+   }
+   ret = (nbio_uring_st.fd >= 0);
+   NBIO_URING_UNLOCK();
+
+   return ret;
+}
+
+static void *nbio_uring_open(const char * filename, unsigned mode)
+{
+   static const int o_flags[]  =   { O_RDONLY, O_RDWR|O_CREAT|O_TRUNC, O_RDWR, O_RDONLY, O_RDWR|O_CREAT|O_TRUNC };
+
+   off_t len;
+   struct nbio_uring_t *handle = NULL;
+   int fd                      = -1;
+
+   if (mode > BIO_WRITE || !nbio_uring_available())
+      return NULL;
+
+   if ((fd = open(filename, o_flags[mode]|O_CLOEXEC, 0644)) < 0)
+      return NULL;
+
+   if ((len = lseek(fd, 0, SEEK_END)) < 0)
+      goto error;
+
+   if (!(handle = (struct nbio_uring_t*)
+            calloc(1, sizeof(struct nbio_uring_t))))
+      goto error;
+
+   handle->fd   = fd;
+   handle->mode = mode;
+   handle->len  = (size_t)len;
+
+   if (handle->len && !(handle->ptr = malloc(handle->len)))
+   {
+      free(handle);
+      goto error;
+   }
+
+   return handle;
+
+error:
+   close(fd);
+   return NULL;
+}
+
+static void nbio_uring_begin_op(struct nbio_uring_t *handle,
+      uint8_t opcode)
+{
+   struct nbio_uring_ring *ring = &nbio_uring_st;
+
+   NBIO_URING_LOCK();
+   if (!handle->busy)
+   {
+      handle->opcode = opcode;
+      handle->queued = 0;
+      handle->error  = false;
+
+      if (handle->len)
+      {
+         handle->busy    = true;
+         handle->pending = true;
+         handle->next    = NULL;
+         if (ring->pending_tail)
+            ring->pending_tail->next = handle;
+         else
+            ring->pending_head       = handle;
+         ring->pending_tail          = handle;
+
+         nbio_uring_submit(ring);
+      }
+   }
+   NBIO_URING_UNLOCK();
+}
+
+static void nbio_uring_begin_read(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (handle)
+      nbio_uring_begin_op(handle, IORING_OP_READV);
+}
+
+static void nbio_uring_begin_write(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (handle)
+      nbio_uring_begin_op(handle, IORING_OP_WRITEV);
+}
+
+static bool nbio_uring_iterate(void *data)
+{
+   bool busy;
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return false;
+
+   NBIO_URING_LOCK();
+   if (handle->busy)
+   {
+      if (handle->mode == BIO_READ || handle->mode == BIO_WRITE)
+         nbio_uring_wait(&nbio_uring_st, handle);
+      else
+         nbio_uring_poll(&nbio_uring_st);
+   }
+   busy = handle->busy;
+   NBIO_URING_UNLOCK();
+
+   return !busy;
+}
+
+static void nbio_uring_resize(void *data, size_t len)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   /* Same restrictions as nbio_linux, see there */
+   if (len < handle->len || handle->busy)
+      abort();
+
+   if (ftruncate(handle->fd, len) != 0)
+      abort();
+
+   handle->ptr = realloc(handle->ptr, len);
+   handle->len = len;
+}
+
+static void *nbio_uring_get_ptr(void *data, size_t* len)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return NULL;
+   if (len)
+      *len = handle->len;
+   if (!handle->busy && !handle->error)
+      return handle->ptr;
+   return NULL;
+}
+
+/* Chunks still queued are dropped, those the kernel
+ * already has are waited for since they point into
+ * the handle's buffer */
+static void nbio_uring_cancel(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   NBIO_URING_LOCK();
+   if (handle->busy)
+   {
+      nbio_uring_unlink_pending(&nbio_uring_st, handle);
+      if (handle->inflight)
+         nbio_uring_wait(&nbio_uring_st, handle);
+      handle->busy = false;
+   }
+   NBIO_URING_UNLOCK();
+}
+
+static void nbio_uring_free(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   nbio_uring_cancel(handle);
+
+   close(handle->fd);
+   free(handle->ptr);
+   free(handle);
+}
+
+nbio_intf_t nbio_uring = {
+   nbio_uring_open,
+   nbio_uring_begin_read,
+   nbio_uring_begin_write,
+   nbio_uring_iterate,
+   nbio_uring_resize,
+   nbio_uring_get_ptr,
+   nbio_uring_cancel,
+   nbio_uring_free,
+   "nbio_uring",
+};
+#else
+bool nbio_uring_available(void)
+{
+   return false;
+}
+
+nbio_intf_t nbio_uring = {
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   "nbio_uring",
+};
+
+#endif
@@ -20,7 +20,7 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifdef DEBUG
+#if defined(DEBUG) || defined(RPNG_TEST)
 #include <stdio.h>
 #endif
 #include <stdint.h>
@@ -39,6 +39,27 @@
 
 #include "rpng_internal.h"
 
+#if _MSC_VER && _MSC_VER <= 1800
+#define RPNG_NO_SIMD
+#endif
+
+#ifdef RPNG_NO_SIMD
+#undef __SSE2__
+#undef __SSSE3__
+#undef __AVX2__
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(MSB_FIRST) && !defined(RPNG_NO_SIMD)
+#include <arm_neon.h>
+#define RPNG_NEON
+#endif
+
 enum png_ihdr_color_type
 {
    PNG_IHDR_COLOR_GRAY       = 0,
@@ -80,6 +101,7 @@ struct idat_buffer
 {
    uint8_t *data;
    size_t size;
+   size_t capacity;
 };
 
 enum rpng_process_flags
@@ -233,11 +255,44 @@ static bool rpng_process_ihdr(struct png_ihdr *ihdr)
 static void rpng_reverse_filter_copy_line_rgb(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   int i;
+   int i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < (int)width; i++)
+#if defined(__SSSE3__)
+   if (bpp == 1)
+   {
+      /* Four pixels per iteration; the 16-byte load reads
+       * 4 bytes past the last pixel used, hence 6 pixels
+       * of headroom. */
+      const __m128i shuf  = _mm_setr_epi8(
+            2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+      const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+
+      for (; i + 6 <= (int)width; i += 4, decoded += 12)
+      {
+         __m128i px = _mm_loadu_si128((const __m128i*)decoded);
+         _mm_storeu_si128((__m128i*)(data + i),
+               _mm_or_si128(_mm_shuffle_epi8(px, shuf), alpha));
+      }
+   }
+#elif defined(RPNG_NEON)
+   if (bpp == 1)
+   {
+      for (; i + 8 <= (int)width; i += 8, decoded += 24)
+      {
+         uint8x8x3_t rgb = vld3_u8(decoded);
+         uint8x8x4_t argb;
+         argb.val[0]     = rgb.val[2];
+         argb.val[1]     = rgb.val[1];
+         argb.val[2]     = rgb.val[0];
+         argb.val[3]     = vdup_n_u8(0xff);
+         vst4_u8((uint8_t*)(data + i), argb);
+      }
+   }
+#endif
+
+   for (; i < (int)width; i++)
    {
       uint32_t r, g, b;
 
@@ -254,11 +309,60 @@ static void rpng_reverse_filter_copy_line_rgb(uint32_t *data,
 static void rpng_reverse_filter_copy_line_rgba(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   int i;
+   int i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < (int)width; i++)
+   /* For 8-bit channels RGBA -> ARGB is a swap of the
+    * R and B bytes within each little-endian word. */
+#if defined(__AVX2__)
+   if (bpp == 1)
+   {
+      const __m256i ag_mask = _mm256_set1_epi32((int)0xff00ff00);
+      const __m256i rb_mask = _mm256_set1_epi32(0x00ff00ff);
+
+      for (; i + 8 <= (int)width; i += 8, decoded += 32)
+      {
+         __m256i px = _mm256_loadu_si256((const __m256i*)decoded);
+         __m256i ag = _mm256_and_si256(px, ag_mask);
+         __m256i rb = _mm256_and_si256(px, rb_mask);
+         rb         = _mm256_or_si256(_mm256_slli_epi32(rb, 16),
+               _mm256_srli_epi32(rb, 16));
+         _mm256_storeu_si256((__m256i*)(data + i), _mm256_or_si256(ag, rb));
+      }
+   }
+#endif
+#if defined(__SSE2__)
+   if (bpp == 1)
+   {
+      const __m128i ag_mask = _mm_set1_epi32((int)0xff00ff00);
+      const __m128i rb_mask = _mm_set1_epi32(0x00ff00ff);
+
+      for (; i + 4 <= (int)width; i += 4, decoded += 16)
+      {
+         __m128i px = _mm_loadu_si128((const __m128i*)decoded);
+         __m128i ag = _mm_and_si128(px, ag_mask);
+         __m128i rb = _mm_and_si128(px, rb_mask);
+         rb         = _mm_or_si128(_mm_slli_epi32(rb, 16),
+               _mm_srli_epi32(rb, 16));
+         _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(ag, rb));
+      }
+   }
+#elif defined(RPNG_NEON)
+   if (bpp == 1)
+   {
+      for (; i + 16 <= (int)width; i += 16, decoded += 64)
+      {
+         uint8x16x4_t rgba = vld4q_u8(decoded);
+         uint8x16_t   r    = rgba.val[0];
+         rgba.val[0]       = rgba.val[2];
+         rgba.val[2]       = r;
+         vst4q_u8((uint8_t*)(data + i), rgba);
+      }
+   }
+#endif
+
+   for (; i < (int)width; i++)
    {
       uint32_t r, g, b, a;
       r        = *decoded;
@@ -562,47 +666,285 @@ error:
    return -1;
 }
 
+#if defined(__SSE2__)
+static INLINE __m128i rpng_simd_load_px(const uint8_t *p, unsigned bpp)
+{
+   int v = 0;
+   memcpy(&v, p, bpp);
+   return _mm_cvtsi32_si128(v);
+}
+
+static INLINE void rpng_simd_store_px(uint8_t *p, __m128i v, unsigned bpp)
+{
+   int tmp = _mm_cvtsi128_si32(v);
+   memcpy(p, &tmp, bpp);
+}
+
+static INLINE __m128i rpng_simd_select(__m128i c, __m128i t, __m128i e)
+{
+   return _mm_or_si128(_mm_and_si128(c, t), _mm_andnot_si128(c, e));
+}
+
+static INLINE __m128i rpng_simd_abs_i16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+#elif defined(RPNG_NEON)
+static INLINE uint8x8_t rpng_simd_load_px(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = 0;
+   memcpy(&v, p, bpp);
+   return vreinterpret_u8_u32(vdup_n_u32(v));
+}
+
+static INLINE void rpng_simd_store_px(uint8_t *p, uint8x8_t v, unsigned bpp)
+{
+   uint32_t tmp = vget_lane_u32(vreinterpret_u32_u8(v), 0);
+   memcpy(p, &tmp, bpp);
+}
+#endif
+
+/* The Sub, Average and Paeth filters carry a dependency from
+ * one pixel to the next, so the SIMD versions work one pixel
+ * (3 or 4 bytes) at a time rather than across the row. They
+ * are only used for 8-bit RGB and RGBA, which covers nearly
+ * every thumbnail and texture we load, and produce the same
+ * bytes as the scalar loops. The *_px workers are always
+ * called with a constant bpp so the loads fold into single
+ * 32-bit moves. */
+#if defined(__SSE2__) || defined(RPNG_NEON)
+#define RPNG_SIMD_UNFILTER
+
+static INLINE void rpng_unfilter_sub_px(uint8_t *line,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+#if defined(__SSE2__)
+   __m128i d   = _mm_setzero_si128();
+#else
+   uint8x8_t d = vdup_n_u8(0);
+#endif
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+#if defined(__SSE2__)
+      d = _mm_add_epi8(rpng_simd_load_px(line + i, bpp), d);
+#else
+      d = vadd_u8(rpng_simd_load_px(line + i, bpp), d);
+#endif
+      rpng_simd_store_px(line + i, d, bpp);
+   }
+}
+
+static INLINE void rpng_unfilter_avg_px(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+#if defined(__SSE2__)
+   const __m128i one = _mm_set1_epi8(1);
+   __m128i d         = _mm_setzero_si128();
+#else
+   uint8x8_t d       = vdup_n_u8(0);
+#endif
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+#if defined(__SSE2__)
+      __m128i a   = d;
+      __m128i b   = rpng_simd_load_px(prev + i, bpp);
+      /* _mm_avg_epu8 rounds up, PNG rounds down */
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+            _mm_and_si128(_mm_xor_si128(a, b), one));
+      d           = _mm_add_epi8(rpng_simd_load_px(line + i, bpp), avg);
+#else
+      d           = vadd_u8(rpng_simd_load_px(line + i, bpp),
+            vhadd_u8(d, rpng_simd_load_px(prev + i, bpp)));
+#endif
+      rpng_simd_store_px(line + i, d, bpp);
+   }
+}
+
+static INLINE void rpng_unfilter_paeth_px(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+#if defined(__SSE2__)
+   const __m128i zero = _mm_setzero_si128();
+   __m128i a          = zero;
+   __m128i b          = zero;
+   __m128i c          = zero;
+   __m128i d          = zero;
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i pa, pb, pc, smallest, nearest;
+
+      c  = b;
+      b  = _mm_unpacklo_epi8(rpng_simd_load_px(prev + i, bpp), zero);
+      a  = d;
+      d  = _mm_unpacklo_epi8(rpng_simd_load_px(line + i, bpp), zero);
+
+      /* p = a + b - c, so p - a = b - c and p - b = a - c */
+      pa = _mm_sub_epi16(b, c);
+      pb = _mm_sub_epi16(a, c);
+      pc = _mm_add_epi16(pa, pb);
+
+      pa = rpng_simd_abs_i16(pa);
+      pb = rpng_simd_abs_i16(pb);
+      pc = rpng_simd_abs_i16(pc);
+
+      smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+      nearest  = rpng_simd_select(_mm_cmpeq_epi16(smallest, pa), a,
+            rpng_simd_select(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+      /* Bytes wrap independently, so the high halves stay zero */
+      d        = _mm_add_epi8(d, nearest);
+      rpng_simd_store_px(line + i, _mm_packus_epi16(d, d), bpp);
+   }
+#else
+   uint8x8_t a = vdup_n_u8(0);
+   uint8x8_t c = a;
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      uint8x8_t b     = rpng_simd_load_px(prev + i, bpp);
+      uint16x8_t pa   = vabdl_u8(b, c);
+      uint16x8_t pb   = vabdl_u8(a, c);
+      uint16x8_t pc   = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+      uint8x8_t use_a = vmovn_u16(
+            vandq_u16(vcleq_u16(pa, pb), vcleq_u16(pa, pc)));
+      uint8x8_t use_b = vmovn_u16(vcleq_u16(pb, pc));
+      uint8x8_t pred  = vbsl_u8(use_a, a, vbsl_u8(use_b, b, c));
+
+      a = vadd_u8(rpng_simd_load_px(line + i, bpp), pred);
+      c = b;
+      rpng_simd_store_px(line + i, a, bpp);
+   }
+#endif
+}
+#endif
+
+static void rpng_unfilter_sub(uint8_t *line,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+#ifdef RPNG_SIMD_UNFILTER
+   if (bpp == 4)
+   {
+      rpng_unfilter_sub_px(line, pitch, 4);
+      return;
+   }
+   else if (bpp == 3)
+   {
+      rpng_unfilter_sub_px(line, pitch, 3);
+      return;
+   }
+#endif
+
+   for (i = bpp; i < pitch; i++)
+      line[i] += line[i - bpp];
+}
+
+static void rpng_unfilter_up(uint8_t *line,
+      const uint8_t *prev, unsigned pitch)
+{
+   unsigned i = 0;
+
+#if defined(__AVX2__)
+   for (; i + 32 <= pitch; i += 32)
+      _mm256_storeu_si256((__m256i*)(line + i), _mm256_add_epi8(
+               _mm256_loadu_si256((const __m256i*)(line + i)),
+               _mm256_loadu_si256((const __m256i*)(prev + i))));
+#endif
+#if defined(__SSE2__)
+   for (; i + 16 <= pitch; i += 16)
+      _mm_storeu_si128((__m128i*)(line + i), _mm_add_epi8(
+               _mm_loadu_si128((const __m128i*)(line + i)),
+               _mm_loadu_si128((const __m128i*)(prev + i))));
+#elif defined(RPNG_NEON)
+   for (; i + 16 <= pitch; i += 16)
+      vst1q_u8(line + i, vaddq_u8(vld1q_u8(line + i), vld1q_u8(prev + i)));
+#endif
+
+   for (; i < pitch; i++)
+      line[i] += prev[i];
+}
+
+static void rpng_unfilter_avg(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+#ifdef RPNG_SIMD_UNFILTER
+   if (bpp == 4)
+   {
+      rpng_unfilter_avg_px(line, prev, pitch, 4);
+      return;
+   }
+   else if (bpp == 3)
+   {
+      rpng_unfilter_avg_px(line, prev, pitch, 3);
+      return;
+   }
+#endif
+
+   for (i = 0; i < bpp; i++)
+      line[i] += prev[i] >> 1;
+   for (i = bpp; i < pitch; i++)
+      line[i] += (line[i - bpp] + prev[i]) >> 1;
+}
+
+static void rpng_unfilter_paeth(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+#ifdef RPNG_SIMD_UNFILTER
+   if (bpp == 4)
+   {
+      rpng_unfilter_paeth_px(line, prev, pitch, 4);
+      return;
+   }
+   else if (bpp == 3)
+   {
+      rpng_unfilter_paeth_px(line, prev, pitch, 3);
+      return;
+   }
+#endif
+
+   for (i = 0; i < bpp; i++)
+      line[i] += prev[i];
+   for (i = bpp; i < pitch; i++)
+      line[i] += paeth(line[i - bpp], prev[i], prev[i - bpp]);
+}
+
 static int rpng_reverse_filter_copy_line(uint32_t *data,
       const struct png_ihdr *ihdr,
       struct rpng_process *pngp, unsigned filter)
 {
-   unsigned i;
+   uint8_t *tmp;
+
+   memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
 
    switch (filter)
    {
       case PNG_FILTER_NONE:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
          break;
       case PNG_FILTER_SUB:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] += pngp->decoded_scanline[i - pngp->bpp];
+         rpng_unfilter_sub(pngp->decoded_scanline, pngp->pitch, pngp->bpp);
          break;
       case PNG_FILTER_UP:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = 0; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] += pngp->prev_scanline[i];
+         rpng_unfilter_up(pngp->decoded_scanline,
+               pngp->prev_scanline, pngp->pitch);
          break;
       case PNG_FILTER_AVERAGE:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = 0; i < pngp->bpp; i++)
-         {
-            uint8_t avg = pngp->prev_scanline[i] >> 1;
-            pngp->decoded_scanline[i] += avg;
-         }
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-         {
-            uint8_t avg = (pngp->decoded_scanline[i - pngp->bpp] + pngp->prev_scanline[i]) >> 1;
-            pngp->decoded_scanline[i] += avg;
-         }
+         rpng_unfilter_avg(pngp->decoded_scanline,
+               pngp->prev_scanline, pngp->pitch, pngp->bpp);
          break;
       case PNG_FILTER_PAETH:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] += pngp->prev_scanline[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] += paeth(pngp->decoded_scanline[i - pngp->bpp],
-                  pngp->prev_scanline[i], pngp->prev_scanline[i - pngp->bpp]);
+         rpng_unfilter_paeth(pngp->decoded_scanline,
+               pngp->prev_scanline, pngp->pitch, pngp->bpp);
          break;
       default:
          return IMAGE_PROCESS_ERROR_END;
@@ -630,7 +972,11 @@ static int rpng_reverse_filter_copy_line(uint32_t *data,
          break;
    }
 
-   memcpy(pngp->prev_scanline, pngp->decoded_scanline, pngp->pitch);
+   /* The decoded line becomes the previous line; the next
+    * call overwrites the other buffer in full. */
+   tmp                    = pngp->prev_scanline;
+   pngp->prev_scanline    = pngp->decoded_scanline;
+   pngp->decoded_scanline = tmp;
 
    return IMAGE_PROCESS_NEXT;
 }
@@ -808,12 +1154,24 @@ false_end:
 
 static bool rpng_realloc_idat(struct idat_buffer *buf, uint32_t chunk_size)
 {
-   uint8_t *new_buffer = (uint8_t*)realloc(buf->data, buf->size + chunk_size);
+   uint8_t *new_buffer;
+   size_t capacity = buf->capacity;
+
+   if (buf->size + chunk_size <= capacity)
+      return true;
 
-   if (!new_buffer)
+   /* Encoders typically emit many small IDAT chunks;
+    * grow geometrically so concatenating them stays linear. */
+   if (capacity < 4096)
+      capacity = 4096;
+   while (capacity < buf->size + chunk_size)
+      capacity *= 2;
+
+   if (!(new_buffer = (uint8_t*)realloc(buf->data, capacity)))
       return false;
 
-   buf->data  = new_buffer;
+   buf->data     = new_buffer;
+   buf->capacity = capacity;
    return true;
 }
 
@@ -969,7 +1327,6 @@ static enum png_chunk_type rpng_read_chunk_header(
 
 bool rpng_iterate_image(rpng_t *rpng)
 {
-   unsigned i;
    uint8_t *buf             = (uint8_t*)rpng->buff_data;
    uint32_t chunk_size      = 0;
 
@@ -1103,8 +1460,7 @@ bool rpng_iterate_image(rpng_t *rpng)
 
          buf += 8;
 
-         for (i = 0; i < chunk_size; i++)
-            rpng->idat_buf.data[i + rpng->idat_buf.size] = buf[i];
+         memcpy(rpng->idat_buf.data + rpng->idat_buf.size, buf, chunk_size);
 
          rpng->idat_buf.size += chunk_size;
 
@@ -35,9 +35,12 @@
 
 #ifdef SCALER_NO_SIMD
 #undef __SSE2__
+#undef __AVX2__
 #endif
 
-#if defined(__SSE2__)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
 #include <emmintrin.h>
 #elif defined(__MMX__)
 #include <mmintrin.h>
@@ -45,6 +48,77 @@
 #include <arm_neon.h>
 #endif
 
+#if defined(__AVX2__)
+/* Interleaves 16 pixels worth of 8-bit R, G and B (one per
+ * 16-bit lane) into two vectors of ARGB8888 with opaque alpha.
+ * The unpacks work within 128-bit lanes, so the halves are
+ * swapped back into pixel order at the end. */
+static INLINE void pack_argb8888_avx2(__m256i r, __m256i g, __m256i b,
+      __m256i *px0_7, __m256i *px8_15)
+{
+   const __m256i a = _mm256_set1_epi16(0x00ff);
+   __m256i lo      = _mm256_or_si256(_mm256_unpacklo_epi8(b, g),
+         _mm256_slli_si256(_mm256_unpacklo_epi8(r, a), 2));
+   __m256i hi      = _mm256_or_si256(_mm256_unpackhi_epi8(b, g),
+         _mm256_slli_si256(_mm256_unpackhi_epi8(r, a), 2));
+   *px0_7          = _mm256_permute2x128_si256(lo, hi, 0x20);
+   *px8_15         = _mm256_permute2x128_si256(lo, hi, 0x31);
+}
+
+/* Writes 8 pixels (24 bytes) of BGR24. 'shuf' picks the three
+ * color bytes of each 32-bit pixel, in output order. */
+static INLINE void store_bgr24_avx2(uint8_t *out, __m256i px,
+      __m256i shuf)
+{
+   const __m256i perm = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+   __m256i packed     = _mm256_permutevar8x32_epi32(
+         _mm256_shuffle_epi8(px, shuf), perm);
+   _mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(packed));
+   _mm_storel_epi64((__m128i*)(out + 16),
+         _mm256_extracti128_si256(packed, 1));
+}
+
+/* Expand 16 pixels of 0RGB1555 / RGB565 into 8-bit channels,
+ * one per 16-bit lane, the same way the SSE2 code does. */
+static INLINE void unpack_0rgb1555_avx2(__m256i in,
+      __m256i *r, __m256i *g, __m256i *b)
+{
+   const __m256i pix_mask_r  = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_gb = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul15_mid   = _mm256_set1_epi16(0x4200);
+   const __m256i mul15_hi    = _mm256_set1_epi16(0x0210);
+
+   *r = _mm256_mulhi_epi16(_mm256_and_si256(in, pix_mask_r), mul15_hi);
+   *g = _mm256_mulhi_epi16(_mm256_and_si256(in, pix_mask_gb), mul15_mid);
+   *b = _mm256_mulhi_epi16(_mm256_and_si256(
+            _mm256_slli_epi16(in, 5), pix_mask_gb), mul15_mid);
+}
+
+static INLINE void unpack_rgb565_avx2(__m256i in,
+      __m256i *r, __m256i *g, __m256i *b)
+{
+   const __m256i pix_mask_r = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_g = _mm256_set1_epi16(0x3f <<  5);
+   const __m256i pix_mask_b = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul16_r    = _mm256_set1_epi16(0x0210);
+   const __m256i mul16_g    = _mm256_set1_epi16(0x2080);
+   const __m256i mul16_b    = _mm256_set1_epi16(0x4200);
+
+   *r = _mm256_mulhi_epi16(_mm256_and_si256(
+            _mm256_srli_epi16(in, 1), pix_mask_r), mul16_r);
+   *g = _mm256_mulhi_epi16(_mm256_and_si256(in, pix_mask_g), mul16_g);
+   *b = _mm256_mulhi_epi16(_mm256_and_si256(
+            _mm256_slli_epi16(in, 5), pix_mask_b), mul16_b);
+}
+
+#define BGR24_SHUF_ARGB8888 _mm256_setr_epi8( \
+      0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, \
+      0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1)
+#define BGR24_SHUF_ABGR8888 _mm256_setr_epi8( \
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, \
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+#endif
+
 void conv_rgb565_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -67,7 +141,7 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
       for (; w < max_width; w += 8)
       {
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i hi = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
+         __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 1), hi_mask);
          __m128i lo = _mm_and_si128(in, lo_mask);
          _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(hi, lo));
       }
@@ -149,6 +223,17 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
+#if defined(__AVX2__)
+      for (; w + 16 <= width; w += 16)
+      {
+         __m256i r, g, b, px0_7, px8_15;
+         unpack_0rgb1555_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+         pack_argb8888_avx2(r, g, b, &px0_7, &px8_15);
+         _mm256_storeu_si256((__m256i*)(output + w + 0), px0_7);
+         _mm256_storeu_si256((__m256i*)(output + w + 8), px8_15);
+      }
+#endif
 #ifdef __SSE2__
       for (; w < max_width; w += 8)
       {
@@ -230,6 +315,17 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
+#if defined(__AVX2__)
+      for (; w + 16 <= width; w += 16)
+      {
+         __m256i r, g, b, px0_7, px8_15;
+         unpack_rgb565_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+         pack_argb8888_avx2(r, g, b, &px0_7, &px8_15);
+         _mm256_storeu_si256((__m256i*)(output + w + 0), px0_7);
+         _mm256_storeu_si256((__m256i*)(output + w + 8), px8_15);
+      }
+#endif
 #if defined(__SSE2__)
       for (; w < max_width; w += 8)
       {
@@ -343,11 +439,22 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
+#if defined(__AVX2__)
+      for (; w + 16 <= width; w += 16)
+      {
+         __m256i r, g, b, px0_7, px8_15;
+         unpack_rgb565_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+         pack_argb8888_avx2(b, g, r, &px0_7, &px8_15);
+         _mm256_storeu_si256((__m256i*)(output + w + 0), px0_7);
+         _mm256_storeu_si256((__m256i*)(output + w + 8), px8_15);
+      }
+#endif
 #if defined(__SSE2__)
       for (; w < max_width; w += 8)
       {
          __m128i res_lo, res_hi;
-         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+         __m128i res_lo_rg, res_hi_rg, res_lo_ba, res_hi_ba;
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
          __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 1), pix_mask_r);
          __m128i        g = _mm_and_si128(in, pix_mask_g);
@@ -355,14 +462,14 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
          r                = _mm_mulhi_epi16(r, mul16_r);
          g                = _mm_mulhi_epi16(g, mul16_g);
          b                = _mm_mulhi_epi16(b, mul16_b);
-         res_lo_bg        = _mm_unpacklo_epi8(b, g);
-         res_hi_bg        = _mm_unpackhi_epi8(b, g);
-         res_lo_ra        = _mm_unpacklo_epi8(r, a);
-         res_hi_ra        = _mm_unpackhi_epi8(r, a);
-         res_lo           = _mm_or_si128(res_lo_bg,
-               _mm_slli_si128(res_lo_ra, 2));
-         res_hi           = _mm_or_si128(res_hi_bg,
-               _mm_slli_si128(res_hi_ra, 2));
+         res_lo_rg        = _mm_unpacklo_epi8(r, g);
+         res_hi_rg        = _mm_unpackhi_epi8(r, g);
+         res_lo_ba        = _mm_unpacklo_epi8(b, a);
+         res_hi_ba        = _mm_unpackhi_epi8(b, a);
+         res_lo           = _mm_or_si128(res_lo_rg,
+               _mm_slli_si128(res_lo_ba, 2));
+         res_hi           = _mm_or_si128(res_hi_rg,
+               _mm_slli_si128(res_hi_ba, 2));
          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
@@ -407,19 +514,15 @@ void conv_argb8888_rgba4444(void *output_, const void *input_,
    uint16_t *output      = (uint16_t*)output_;
 
    for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+         h++, output += out_stride >> 1, input += in_stride >> 2)
    {
       for (w = 0; w < width; w++)
       {
          uint32_t col = input[w];
-         uint32_t r   = (col >> 16) & 0xf;
-         uint32_t g   = (col >>  8) & 0xf;
-         uint32_t b   = (col) & 0xf;
-         uint32_t a   = (col >>  24) & 0xf;
-         r            = (r >> 4) | r;
-         g            = (g >> 4) | g;
-         b            = (b >> 4) | b;
-         a            = (a >> 4) | a;
+         uint32_t r   = (col >> 20) & 0xf;
+         uint32_t g   = (col >> 12) & 0xf;
+         uint32_t b   = (col >>  4) & 0xf;
+         uint32_t a   = (col >> 28) & 0xf;
 
          output[w]    = (r << 12) | (g << 8) | (b << 4) | a;
       }
@@ -592,6 +695,17 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
       uint8_t *out = output;
       int   w = 0;
 
+#if defined(__AVX2__)
+      for (; w + 16 <= width; w += 16, out += 48)
+      {
+         __m256i r, g, b, px0_7, px8_15;
+         unpack_0rgb1555_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+         pack_argb8888_avx2(r, g, b, &px0_7, &px8_15);
+         store_bgr24_avx2(out,      px0_7,  BGR24_SHUF_ARGB8888);
+         store_bgr24_avx2(out + 24, px8_15, BGR24_SHUF_ARGB8888);
+      }
+#endif
 #if defined(__SSE2__)
       for (; w < max_width; w += 16, out += 48)
       {
@@ -678,6 +792,17 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
    {
       uint8_t *out = output;
       int        w = 0;
+#if defined(__AVX2__)
+      for (; w + 16 <= width; w += 16, out += 48)
+      {
+         __m256i r, g, b, px0_7, px8_15;
+         unpack_rgb565_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+         pack_argb8888_avx2(r, g, b, &px0_7, &px8_15);
+         store_bgr24_avx2(out,      px0_7,  BGR24_SHUF_ARGB8888);
+         store_bgr24_avx2(out + 24, px8_15, BGR24_SHUF_ARGB8888);
+      }
+#endif
 #if defined(__SSE2__)
       for (; w < max_width; w += 16, out += 48)
       {
@@ -746,12 +871,31 @@ void conv_bgr24_argb8888(void *output_, const void *input_,
    int h, w;
    const uint8_t *input = (const uint8_t*)input_;
    uint32_t *output     = (uint32_t*)output_;
+#if defined(__AVX2__)
+   const __m256i shuf   = _mm256_setr_epi8(
+         0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+         0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+   const __m256i alpha  = _mm256_set1_epi32((int)0xff000000u);
+#endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride)
    {
       const uint8_t *inp = input;
-      for (w = 0; w < width; w++)
+      w                  = 0;
+#if defined(__AVX2__)
+      /* Each half loads 16 bytes for 4 pixels, so stop
+       * while the last load still ends inside the row. */
+      for (; w + 10 <= width; w += 8, inp += 24)
+      {
+         __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                  _mm_loadu_si128((const __m128i*)inp)),
+               _mm_loadu_si128((const __m128i*)(inp + 12)), 1);
+         _mm256_storeu_si256((__m256i*)(output + w),
+               _mm256_or_si256(_mm256_shuffle_epi8(in, shuf), alpha));
+      }
+#endif
+      for (; w < width; w++)
       {
          uint32_t b = *inp++;
          uint32_t g = *inp++;
@@ -791,10 +935,39 @@ void conv_argb8888_0rgb1555(void *output_, const void *input_,
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__AVX2__)
+   const __m256i mask_r = _mm256_set1_epi32(0x1f << 10);
+   const __m256i mask_g = _mm256_set1_epi32(0x1f <<  5);
+   const __m256i mask_b = _mm256_set1_epi32(0x1f <<  0);
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      w = 0;
+#if defined(__AVX2__)
+      for (; w + 16 <= width; w += 16)
+      {
+         __m256i px[2];
+         int i;
+
+         for (i = 0; i < 2; i++)
+         {
+            __m256i in = _mm256_loadu_si256(
+                  (const __m256i*)(input + w + i * 8));
+            px[i]      = _mm256_or_si256(_mm256_or_si256(
+                     _mm256_and_si256(_mm256_srli_epi32(in, 9), mask_r),
+                     _mm256_and_si256(_mm256_srli_epi32(in, 6), mask_g)),
+                  _mm256_and_si256(_mm256_srli_epi32(in, 3), mask_b));
+         }
+
+         /* packus interleaves the 128-bit lanes, undo that. */
+         _mm256_storeu_si256((__m256i*)(output + w),
+               _mm256_permute4x64_epi64(
+                  _mm256_packus_epi32(px[0], px[1]), 0xd8));
+      }
+#endif
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint16_t r   = (col >> 19) & 0x1f;
@@ -822,6 +995,12 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
    {
       uint8_t *out = output;
       int        w = 0;
+#if defined(__AVX2__)
+      for (; w + 8 <= width; w += 8, out += 24)
+         store_bgr24_avx2(out,
+               _mm256_loadu_si256((const __m256i*)(input + w)),
+               BGR24_SHUF_ARGB8888);
+#endif
 #if defined(__SSE2__)
       for (; w < max_width; w += 16, out += 48)
       {
@@ -875,6 +1054,12 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
    {
       uint8_t *out = output;
       int        w = 0;
+#if defined(__AVX2__)
+      for (; w + 8 <= width; w += 8, out += 24)
+         store_bgr24_avx2(out,
+               _mm256_loadu_si256((const __m256i*)(input + w)),
+               BGR24_SHUF_ABGR8888);
+#endif
 #if defined(__SSE2__)
       for (; w < max_width; w += 16, out += 48)
       {
@@ -908,10 +1093,22 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
    const uint32_t *input = (const uint32_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
 
+#if defined(__AVX2__)
+   const __m256i shuf    = _mm256_setr_epi8(
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      w = 0;
+#if defined(__AVX2__)
+      for (; w + 8 <= width; w += 8)
+         _mm256_storeu_si256((__m256i*)(output + w), _mm256_shuffle_epi8(
+                  _mm256_loadu_si256((const __m256i*)(input + w)), shuf));
+#endif
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          output[w]    = ((col << 16) & 0xff0000) |
@@ -30,6 +30,51 @@
 #include <gfx/scaler/filter.h>
 #include <gfx/scaler/pixconv.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+
+/* Thinner bands cost more to hand off than they save. */
+#define SCALER_BAND_MIN_ROWS 32
+#define SCALER_MAX_BANDS     16
+
+static tpool_t *scaler_pool         = NULL;
+static unsigned scaler_pool_threads = 0;
+#endif
+
+enum scaler_pass
+{
+   SCALER_PASS_DIRECT = 0,
+   /* Input conversion and horizontal filter, over input rows */
+   SCALER_PASS_HORIZ,
+   /* Vertical filter and output conversion, over output rows */
+   SCALER_PASS_VERT
+};
+
+#ifdef HAVE_THREADS
+struct scaler_thread_data;
+
+struct scaler_band
+{
+   struct scaler_thread_data *data;
+   int first;
+   int last;
+};
+
+struct scaler_thread_data
+{
+   struct scaler_band band[SCALER_MAX_BANDS];
+   const struct scaler_ctx *ctx;
+   const void *input;
+   void *output;
+   slock_t *lock;
+   scond_t *cond;
+   enum scaler_pass pass;
+   unsigned bands;
+   unsigned pending;
+};
+#endif
+
 static bool allocate_frames(struct scaler_ctx *ctx)
 {
    uint64_t *scaled_frame = NULL;
@@ -263,6 +308,29 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
          return false;
    }
 
+#ifdef HAVE_THREADS
+   if (ctx->threads > 1 && scaler_pool)
+   {
+      struct scaler_thread_data *data = (struct scaler_thread_data*)
+         calloc(1, sizeof(*data));
+
+      if (!data)
+         return false;
+
+      ctx->thread_data = data;
+
+      if (     !(data->lock = slock_new())
+            || !(data->cond = scond_new()))
+         return false;
+
+      data->bands      = ctx->threads;
+      if (data->bands > scaler_pool_threads + 1)
+         data->bands   = scaler_pool_threads + 1;
+      if (data->bands > SCALER_MAX_BANDS)
+         data->bands   = SCALER_MAX_BANDS;
+   }
+#endif
+
    return true;
 }
 
@@ -282,6 +350,18 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
       free(ctx->input.frame);
    if (ctx->output.frame)
       free(ctx->output.frame);
+#ifdef HAVE_THREADS
+   if (ctx->thread_data)
+   {
+      struct scaler_thread_data *data = (struct scaler_thread_data*)
+         ctx->thread_data;
+      if (data->lock)
+         slock_free(data->lock);
+      if (data->cond)
+         scond_free(data->cond);
+      free(data);
+   }
+#endif
 
    ctx->horiz.filter        = NULL;
    ctx->horiz.filter_len    = 0;
@@ -303,6 +383,183 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 
    ctx->output.frame        = NULL;
    ctx->output.stride       = 0;
+
+   ctx->thread_data         = NULL;
+}
+
+/* Runs one pass of the scaler over rows [first, last).
+ * Different row ranges of the same pass touch disjoint
+ * memory, so they can run concurrently. */
+static void scaler_ctx_scale_rows(const struct scaler_ctx *ctx,
+      enum scaler_pass pass, void *output, const void *input,
+      int first, int last)
+{
+   int rows = last - first;
+
+   switch (pass)
+   {
+      case SCALER_PASS_DIRECT:
+         ctx->direct_pixconv(
+               (uint8_t*)output + first * ctx->out_stride,
+               (const uint8_t*)input + first * ctx->in_stride,
+               ctx->out_width, rows,
+               ctx->out_stride, ctx->in_stride);
+         break;
+
+      case SCALER_PASS_HORIZ:
+         {
+            const uint8_t *frame = (const uint8_t*)input
+               + first * ctx->in_stride;
+            int stride           = ctx->in_stride;
+
+            if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+            {
+               uint8_t *conv     = (uint8_t*)ctx->input.frame
+                  + first * ctx->input.stride;
+
+               ctx->in_pixconv(conv, frame,
+                     ctx->in_width, rows,
+                     ctx->input.stride, ctx->in_stride);
+
+               frame             = conv;
+               stride            = ctx->input.stride;
+            }
+
+            if (!ctx->scaler_special && ctx->scaler_horiz)
+            {
+               struct scaler_ctx band = *ctx;
+               band.scaled.frame      = ctx->scaled.frame
+                  + first * (ctx->scaled.stride >> 3);
+               band.scaled.height     = rows;
+
+               ctx->scaler_horiz(&band, frame, stride);
+            }
+         }
+         break;
+
+      case SCALER_PASS_VERT:
+         {
+            uint8_t *frame = (uint8_t*)output;
+            int stride     = ctx->out_stride;
+
+            if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+            {
+               frame       = (uint8_t*)ctx->output.frame;
+               stride      = ctx->output.stride;
+            }
+
+            if (!ctx->scaler_special && ctx->scaler_vert)
+            {
+               struct scaler_ctx band = *ctx;
+               band.out_height        = rows;
+               band.vert.filter       = ctx->vert.filter
+                  + first * ctx->vert.filter_stride;
+               band.vert.filter_pos   = ctx->vert.filter_pos + first;
+
+               ctx->scaler_vert(&band, frame + first * stride, stride);
+            }
+
+            if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+               ctx->out_pixconv(
+                     (uint8_t*)output + first * ctx->out_stride,
+                     frame + first * stride,
+                     ctx->out_width, rows,
+                     ctx->out_stride, stride);
+         }
+         break;
+   }
+}
+
+#ifdef HAVE_THREADS
+static void scaler_band_work(void *arg)
+{
+   struct scaler_band *band        = (struct scaler_band*)arg;
+   struct scaler_thread_data *data = band->data;
+
+   scaler_ctx_scale_rows(data->ctx, data->pass,
+         data->output, data->input, band->first, band->last);
+
+   slock_lock(data->lock);
+   if (--data->pending == 0)
+      scond_signal(data->cond);
+   slock_unlock(data->lock);
+}
+#endif
+
+static void scaler_ctx_run_pass(const struct scaler_ctx *ctx,
+      enum scaler_pass pass, void *output, const void *input, int rows)
+{
+#ifdef HAVE_THREADS
+   struct scaler_thread_data *data = (struct scaler_thread_data*)
+      ctx->thread_data;
+
+   if (data && scaler_pool)
+   {
+      unsigned i;
+      unsigned bands = data->bands;
+
+      if ((unsigned)(rows / SCALER_BAND_MIN_ROWS) < bands)
+         bands = rows / SCALER_BAND_MIN_ROWS;
+
+      if (bands > 1)
+      {
+         data->ctx     = ctx;
+         data->pass    = pass;
+         data->output  = output;
+         data->input   = input;
+         data->pending = bands - 1;
+
+         for (i = 0; i < bands; i++)
+         {
+            data->band[i].data  = data;
+            data->band[i].first = rows * i / bands;
+            data->band[i].last  = rows * (i + 1) / bands;
+         }
+
+         /* The calling thread takes the first band itself */
+         for (i = 1; i < bands; i++)
+            if (!tpool_add_work(scaler_pool,
+                     scaler_band_work, &data->band[i]))
+               scaler_band_work(&data->band[i]);
+
+         scaler_ctx_scale_rows(ctx, pass, output, input,
+               data->band[0].first, data->band[0].last);
+
+         slock_lock(data->lock);
+         while (data->pending)
+            scond_wait(data->cond, data->lock);
+         slock_unlock(data->lock);
+         return;
+      }
+   }
+#endif
+
+   scaler_ctx_scale_rows(ctx, pass, output, input, 0, rows);
+}
+
+bool scaler_thread_pool_init(unsigned threads)
+{
+#ifdef HAVE_THREADS
+   if (!scaler_pool && threads)
+   {
+      if ((scaler_pool = tpool_create(threads)))
+         scaler_pool_threads = threads;
+   }
+
+   return scaler_pool != NULL;
+#else
+   return false;
+#endif
+}
+
+void scaler_thread_pool_deinit(void)
+{
+#ifdef HAVE_THREADS
+   if (scaler_pool)
+      tpool_destroy(scaler_pool);
+   scaler_pool         = NULL;
+   scaler_pool_threads = 0;
+#endif
 }
 
 /**
@@ -316,44 +573,44 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 void scaler_ctx_scale(struct scaler_ctx *ctx,
       void *output, const void *input)
 {
-   const void *input_frame = input;
-   void *output_frame      = output;
-   int input_stride        = ctx->in_stride;
-   int output_stride       = ctx->out_stride;
-
-   if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+   if (ctx->unscaled)
    {
-      ctx->in_pixconv(ctx->input.frame, input,
-            ctx->in_width, ctx->in_height,
-            ctx->input.stride, ctx->in_stride);
-
-      input_frame       = ctx->input.frame;
-      input_stride      = ctx->input.stride;
+      scaler_ctx_run_pass(ctx, SCALER_PASS_DIRECT,
+            output, input, ctx->out_height);
+      return;
    }
 
-   if (ctx->out_fmt != SCALER_FMT_ARGB8888)
-   {
-      output_frame  = ctx->output.frame;
-      output_stride = ctx->output.stride;
-   }
+   scaler_ctx_run_pass(ctx, SCALER_PASS_HORIZ,
+         output, input, ctx->in_height);
 
    /* Take some special, and (hopefully) more optimized path. */
    if (ctx->scaler_special)
+   {
+      const void *input_frame = input;
+      void *output_frame      = output;
+      int input_stride        = ctx->in_stride;
+      int output_stride       = ctx->out_stride;
+
+      if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+      {
+         input_frame          = ctx->input.frame;
+         input_stride         = ctx->input.stride;
+      }
+
+      if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+      {
+         output_frame         = ctx->output.frame;
+         output_stride        = ctx->output.stride;
+      }
+
       ctx->scaler_special(ctx, output_frame, input_frame,
             ctx->out_width, ctx->out_height,
             ctx->in_width, ctx->in_height,
             output_stride, input_stride);
-   else
-   {
-      /* Take generic filter path. */
-      if (ctx->scaler_horiz)
-         ctx->scaler_horiz(ctx, input_frame, input_stride);
-      if (ctx->scaler_vert)
-         ctx->scaler_vert (ctx, output, output_stride);
    }
 
-   if (ctx->out_fmt != SCALER_FMT_ARGB8888)
-      ctx->out_pixconv(output, ctx->output.frame,
-            ctx->out_width, ctx->out_height,
-            ctx->out_stride, ctx->output.stride);
+   /* Generic filter path, or just the output conversion
+    * after the special path. */
+   scaler_ctx_run_pass(ctx, SCALER_PASS_VERT,
+         output, input, ctx->out_height);
 }
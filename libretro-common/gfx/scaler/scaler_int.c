@@ -20,21 +20,30 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <string.h>
+
 #include <gfx/scaler/scaler_int.h>
 
 #include <retro_inline.h>
 
 #ifdef SCALER_NO_SIMD
 #undef __SSE2__
+#undef __AVX2__
 #endif
 
-#if defined(__SSE2__)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
 #include <emmintrin.h>
 #ifdef _WIN32
 #include <intrin.h>
 #endif
 #endif
 
+/* Replicates a filter coefficient into all four 16-bit
+ * lanes of a 64-bit value. */
+#define SCALER_SPLAT_COEFF(c) ((long long)((uint16_t)(c) * 0x0001000100010001ull))
+
 /* ARGB8888 scaler is split in two:
  *
  * First, horizontal scaler is applied.
@@ -60,6 +69,10 @@
  *
  * The C version of scalers perform the exact same operations as the
  * SIMD code for testing purposes.
+ *
+ * The AVX2 paths run the SSE2 algorithm on two (horizontal) or four
+ * (vertical) output pixels at once, accumulating the taps in the same
+ * order so the saturating adds give identical results.
  */
 
 void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int stride)
@@ -76,7 +89,56 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
       const uint64_t *input_base = input + ctx->vert.filter_pos[h]
          * (ctx->scaled.stride >> 3);
 
-      for (w = 0; w < ctx->out_width; w++)
+      w = 0;
+#if defined(__AVX2__)
+      /* Rows of the scaled frame are padded to 8 pixels, so the
+       * loads may run past out_width, the stores may not. */
+      for (; w + 4 <= ctx->out_width; w += 4)
+      {
+         __m256i final;
+         const uint64_t *input_base_y = input_base + w;
+         __m256i res_even             = _mm256_setzero_si256();
+         __m256i res_odd              = _mm256_setzero_si256();
+
+         for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2,
+               input_base_y += (ctx->scaled.stride >> 2))
+         {
+            __m256i coeff_even = _mm256_set1_epi64x(
+                  SCALER_SPLAT_COEFF(filter_vert[y + 0]));
+            __m256i coeff_odd  = _mm256_set1_epi64x(
+                  SCALER_SPLAT_COEFF(filter_vert[y + 1]));
+            __m256i col_even   = _mm256_loadu_si256(
+                  (const __m256i*)input_base_y);
+            __m256i col_odd    = _mm256_loadu_si256(
+                  (const __m256i*)(input_base_y + (ctx->scaled.stride >> 3)));
+
+            res_even = _mm256_adds_epi16(
+                  _mm256_mulhi_epi16(col_even, coeff_even), res_even);
+            res_odd  = _mm256_adds_epi16(
+                  _mm256_mulhi_epi16(col_odd, coeff_odd), res_odd);
+         }
+
+         for (; y < ctx->vert.filter_len; y++,
+               input_base_y += (ctx->scaled.stride >> 3))
+         {
+            __m256i coeff = _mm256_set1_epi64x(
+                  SCALER_SPLAT_COEFF(filter_vert[y]));
+            __m256i col   = _mm256_loadu_si256((const __m256i*)input_base_y);
+
+            res_even      = _mm256_adds_epi16(
+                  _mm256_mulhi_epi16(col, coeff), res_even);
+         }
+
+         res_even = _mm256_adds_epi16(res_odd, res_even);
+         res_even = _mm256_srai_epi16(res_even, (7 - 2 - 2));
+         final    = _mm256_packus_epi16(res_even, res_even);
+
+         _mm_storeu_si128((__m128i*)(output + w), _mm256_castsi256_si128(
+                  _mm256_permute4x64_epi64(final, 0x08)));
+      }
+#endif
+
+      for (; w < ctx->out_width; w++)
       {
          const uint64_t *input_base_y = input_base + w;
 #if defined(__SSE2__)
@@ -86,7 +148,7 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
          for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2,
                input_base_y += (ctx->scaled.stride >> 2))
          {
-            __m128i coeff = _mm_set_epi64x(filter_vert[y + 1] * 0x0001000100010001ll, filter_vert[y + 0] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set_epi64x(SCALER_SPLAT_COEFF(filter_vert[y + 1]), SCALER_SPLAT_COEFF(filter_vert[y + 0]));
             __m128i col   = _mm_set_epi64x(input_base_y[ctx->scaled.stride >> 3], input_base_y[0]);
 
             res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
@@ -94,7 +156,7 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
 
          for (; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_vert[y] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set_epi64x(0, SCALER_SPLAT_COEFF(filter_vert[y]));
             __m128i col   = _mm_set_epi64x(0, input_base_y[0]);
 
             res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
@@ -156,7 +218,59 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
    {
       const int16_t *filter_horiz = ctx->horiz.filter;
 
-      for (w = 0; w < ctx->scaled.width; w++,
+      w = 0;
+#if defined(__AVX2__)
+      for (; w + 2 <= ctx->scaled.width; w += 2,
+            filter_horiz += ctx->horiz.filter_stride * 2)
+      {
+         const uint32_t *input_base_x0 = input + ctx->horiz.filter_pos[w + 0];
+         const uint32_t *input_base_x1 = input + ctx->horiz.filter_pos[w + 1];
+         const int16_t *filter_horiz1  = filter_horiz + ctx->horiz.filter_stride;
+         __m256i res                   = _mm256_setzero_si256();
+
+         for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
+         {
+            uint64_t px0, px1;
+            __m256i coeff = _mm256_set_epi64x(
+                  SCALER_SPLAT_COEFF(filter_horiz1[x + 1]),
+                  SCALER_SPLAT_COEFF(filter_horiz1[x + 0]),
+                  SCALER_SPLAT_COEFF(filter_horiz[x + 1]),
+                  SCALER_SPLAT_COEFF(filter_horiz[x + 0]));
+            __m256i col;
+
+            memcpy(&px0, input_base_x0 + x, sizeof(px0));
+            memcpy(&px1, input_base_x1 + x, sizeof(px1));
+
+            col = _mm256_unpacklo_epi8(_mm256_set_epi64x(
+                     0, (long long)px1, 0, (long long)px0),
+                  _mm256_setzero_si256());
+            col = _mm256_slli_epi16(col, 7);
+            res = _mm256_adds_epi16(_mm256_mulhi_epi16(col, coeff), res);
+         }
+
+         for (; x < ctx->horiz.filter_len; x++)
+         {
+            __m256i coeff = _mm256_set_epi64x(
+                  0, SCALER_SPLAT_COEFF(filter_horiz1[x]),
+                  0, SCALER_SPLAT_COEFF(filter_horiz[x]));
+            __m256i col   = _mm256_unpacklo_epi8(_mm256_set_epi64x(
+                     0, input_base_x1[x], 0, input_base_x0[x]),
+                  _mm256_setzero_si256());
+
+            col           = _mm256_slli_epi16(col, 7);
+            res           = _mm256_adds_epi16(
+                  _mm256_mulhi_epi16(col, coeff), res);
+         }
+
+         /* Fold the odd taps onto the even ones, per pixel. */
+         res = _mm256_adds_epi16(_mm256_srli_si256(res, 8), res);
+
+         _mm_storeu_si128((__m128i*)(output + w), _mm256_castsi256_si128(
+                  _mm256_permute4x64_epi64(res, 0x08)));
+      }
+#endif
+
+      for (; w < ctx->scaled.width; w++,
             filter_horiz += ctx->horiz.filter_stride)
       {
          const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
@@ -171,7 +285,7 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
 #endif
          for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
          {
-            __m128i coeff = _mm_set_epi64x(filter_horiz[x + 1] * 0x0001000100010001ll, filter_horiz[x + 0] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set_epi64x(SCALER_SPLAT_COEFF(filter_horiz[x + 1]), SCALER_SPLAT_COEFF(filter_horiz[x + 0]));
 
             __m128i col   = _mm_unpacklo_epi8(_mm_set_epi64x(0,
                      ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
@@ -182,7 +296,7 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
 
          for (; x < ctx->horiz.filter_len; x++)
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_horiz[x] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set_epi64x(0, SCALER_SPLAT_COEFF(filter_horiz[x]));
             __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
 
             col           = _mm_slli_epi16(col, 7);
@@ -55,11 +55,18 @@ typedef struct
    bool resample;
 } audio_chunk_t;
 
+/* Adds @samples samples of @in scaled by @vol to @out. This
+ * is the kernel all voices of the audio mixer go through. */
 #if defined(__SSE2__)
 #define audio_mix_volume           audio_mix_volume_SSE2
 
 void audio_mix_volume_SSE2(float *out,
       const float *in, float vol, size_t samples);
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define audio_mix_volume           audio_mix_volume_NEON
+
+void audio_mix_volume_NEON(float *out,
+      const float *in, float vol, size_t samples);
 #else
 #define audio_mix_volume           audio_mix_volume_C
 #endif
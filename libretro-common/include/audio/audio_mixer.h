@@ -64,11 +64,22 @@ void audio_mixer_done(void);
 
 audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size,
       const char *resampler_ident, enum resampler_quality quality);
+/* The compressed loaders take ownership of @buffer. The
+ * sounds are decoded ahead of playback by a background thread
+ * when threads are available. */
 audio_mixer_sound_t* audio_mixer_load_ogg(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_flac(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_mp3(void *buffer, int32_t size);
 
+/* Decodes an OGG, FLAC or MP3 sound of up to ten seconds
+ * completely and resamples it to the output rate, so that
+ * playing it costs no decoding. This takes milliseconds, so
+ * call it from a worker thread before the sound is played.
+ * Returns false, leaving the sound to be streamed, if it is
+ * too long or cannot be decoded. */
+bool audio_mixer_predecode(audio_mixer_sound_t *sound);
+
 void audio_mixer_destroy(audio_mixer_sound_t* sound);
 
 audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound,
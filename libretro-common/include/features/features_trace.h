@@ -0,0 +1,143 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (features_trace.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIBRETRO_SDK_FEATURES_TRACE_H
+#define _LIBRETRO_SDK_FEATURES_TRACE_H
+
+#include <retro_common_api.h>
+
+#include <stdint.h>
+
+#include <boolean.h>
+#include <libretro.h>
+#include <features/features_cpu.h>
+
+RETRO_BEGIN_DECLS
+
+/* Timed spans ("trace events") recorded into one ring per
+ * thread and written out in the Chrome trace event JSON
+ * format, which chrome://tracing and ui.perfetto.dev load.
+ *
+ * A span is measured with:
+ *
+ *    retro_time_t t = TRACE_EVENT_BEGIN();
+ *    ...
+ *    TRACE_EVENT_END("name", t);
+ *
+ * While tracing is disabled this costs one load and branch
+ * of trace_event_enabled. Names are stored by pointer and
+ * must remain valid until the trace is written out, so use
+ * string literals. */
+
+/* Read without locking by TRACE_EVENT_BEGIN() */
+extern volatile bool trace_event_enabled;
+
+#define TRACE_EVENT_BEGIN() \
+   (trace_event_enabled ? cpu_features_get_time_usec() : 0)
+
+#define TRACE_EVENT_END(name, start) \
+   TRACE_EVENT_END_ARG(name, start, -1)
+
+/* Same as TRACE_EVENT_END(), also recording an integer
+ * argument such as a shader pass index; -1 records none */
+#define TRACE_EVENT_END_ARG(name, start, arg) \
+   do \
+   { \
+      if (start) \
+         trace_event_add(name, start, arg); \
+   } while (0)
+
+/**
+ * trace_event_add:
+ * @name  : Name of the span.
+ * @start : Start time from TRACE_EVENT_BEGIN().
+ * @arg   : Integer argument, or -1 for none.
+ *
+ * Records a span lasting from @start until now into the
+ * ring of the calling thread. Once the ring is full, the
+ * oldest events are overwritten.
+ **/
+void trace_event_add(const char *name, retro_time_t start, int32_t arg);
+
+/**
+ * trace_event_set_thread_name:
+ * @name  : Name shown for the calling thread.
+ *
+ * Names the timeline of the calling thread in the written
+ * trace. The string is copied.
+ **/
+void trace_event_set_thread_name(const char *name);
+
+/**
+ * trace_event_start:
+ * @path  : File to stream events to, or NULL.
+ *
+ * Clears all recorded events and starts recording. With a
+ * @path, trace_event_flush() writes new events to that file
+ * as they come in, until trace_event_stop() completes it.
+ * Must be called from the thread calling trace_event_flush().
+ *
+ * @return true on success, false if @path cannot be opened.
+ **/
+bool trace_event_start(const char *path);
+
+/**
+ * trace_event_stop:
+ *
+ * Stops recording and, when streaming, writes out the
+ * remaining events and closes the file. Events recorded
+ * so far stay available to trace_event_dump().
+ **/
+void trace_event_stop(void);
+
+/**
+ * trace_event_flush:
+ *
+ * Writes the events recorded since the last call to the
+ * file given to trace_event_start(). Events overwritten in
+ * the meantime are lost, so call this regularly (once per
+ * frame) while streaming.
+ **/
+void trace_event_flush(void);
+
+/**
+ * trace_event_dump:
+ * @path  : File to write.
+ *
+ * Writes the events currently held in all rings to @path
+ * as a complete trace, whether or not recording is on.
+ *
+ * @return true on success, false if @path cannot be written.
+ **/
+bool trace_event_dump(const char *path);
+
+/**
+ * trace_event_deinit:
+ *
+ * Stops recording and frees all rings. No other thread
+ * may be recording events at this point.
+ **/
+void trace_event_deinit(void);
+
+RETRO_END_DECLS
+
+#endif
@@ -202,6 +202,60 @@ const struct file_archive_file_backend* file_archive_get_file_backend(const char
  **/
 uint32_t file_archive_get_file_crc32(const char *path);
 
+/* Sequential ZIP extraction, needs HAVE_ZLIB.
+ * 7z archives cannot be extracted sequentially. */
+struct file_archive_stream;
+
+/**
+ * file_archive_stream_new:
+ * @target_dir                   : Directory to extract to.
+ *
+ * Creates a ZIP extractor that is fed the archive front to back,
+ * e.g. while it is being downloaded, so that extraction overlaps
+ * the transfer and the archive never has to be read back.
+ *
+ * Returns: the extractor, or NULL on allocation failure.
+ **/
+struct file_archive_stream *file_archive_stream_new(const char *target_dir);
+
+/**
+ * file_archive_stream_write:
+ * @stream                       : Extractor.
+ * @data                         : Next part of the archive.
+ * @len                          : Size of @data.
+ *
+ * Extracts what @data completes. Entries are written next to their
+ * final path until file_archive_stream_finish() moves them in place,
+ * so an interrupted transfer leaves existing files untouched.
+ *
+ * Returns: false if the archive cannot be extracted sequentially
+ * (encrypted or ZIP64 entries, sizes stored after the data,
+ * unsupported compression) or is corrupt. The caller should then
+ * stop feeding it and extract the complete file instead.
+ **/
+bool file_archive_stream_write(struct file_archive_stream *stream,
+      const void *data, size_t len);
+
+/**
+ * file_archive_stream_finish:
+ * @stream                       : Extractor.
+ *
+ * Moves the extracted files in place, replacing existing ones,
+ * provided the whole archive was extracted.
+ *
+ * Returns: true on success.
+ **/
+bool file_archive_stream_finish(struct file_archive_stream *stream);
+
+/**
+ * file_archive_stream_free:
+ * @stream                       : Extractor.
+ *
+ * Frees @stream, deleting files extracted but not moved in place
+ * by file_archive_stream_finish().
+ **/
+void file_archive_stream_free(struct file_archive_stream *stream);
+
 extern const struct file_archive_file_backend zlib_backend;
 extern const struct file_archive_file_backend sevenzip_backend;
 
@@ -51,10 +51,21 @@ int rpng_process_image(rpng_t *rpng,
 
 bool rpng_start(rpng_t *rpng);
 
+enum rpng_save_flags
+{
+   /* Lowest zlib level and a fixed filter: several times
+    * faster to encode, for somewhat larger files */
+   RPNG_SAVE_FLAG_FAST = (1 << 0)
+};
+
 bool rpng_save_image_argb(const char *path, const uint32_t *data,
       unsigned width, unsigned height, unsigned pitch);
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch);
+bool rpng_save_image_argb_flags(const char *path, const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned flags);
+bool rpng_save_image_bgr24_flags(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned flags);
 
 uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
       unsigned width, unsigned height, signed pitch, uint64_t *bytes);
@@ -101,6 +101,14 @@ struct scaler_ctx
    int out_height;
    int out_stride;
 
+   /* Number of row bands each scale is split into, run on the
+    * shared thread pool (see scaler_thread_pool_init()).
+    * 0 or 1 scales on the calling thread only. Clamped to the
+    * pool size plus the calling thread. Set before
+    * scaler_ctx_gen_filter(). */
+   unsigned threads;
+   void *thread_data;
+
    enum scaler_pix_fmt in_fmt;
    enum scaler_pix_fmt out_fmt;
    enum scaler_type scaler_type;
@@ -112,6 +120,28 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx);
 
 void scaler_ctx_gen_reset(struct scaler_ctx *ctx);
 
+/**
+ * scaler_thread_pool_init:
+ * @threads      : number of worker threads, not counting
+ *                 the threads that call scaler_ctx_scale().
+ *
+ * Creates the thread pool shared by every scaler context
+ * with @threads set above 1. Call it once, before any such
+ * context is generated; without it (or without HAVE_THREADS)
+ * scaling stays single-threaded.
+ *
+ * Returns: true if the pool exists afterwards.
+ **/
+bool scaler_thread_pool_init(unsigned threads);
+
+/**
+ * scaler_thread_pool_deinit:
+ *
+ * Destroys the shared thread pool. No context may be
+ * scaling while this runs.
+ **/
+void scaler_thread_pool_deinit(void);
+
 /**
  * scaler_ctx_scale:
  * @ctx          : pointer to scaler context object.
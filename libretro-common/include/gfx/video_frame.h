@@ -35,7 +35,7 @@ RETRO_BEGIN_DECLS
 
 #define scaler_ctx_scale_direct(ctx, output, input) \
 { \
-   if (ctx && ctx->unscaled && ctx->direct_pixconv) \
+   if (ctx && ctx->unscaled && ctx->direct_pixconv && !ctx->thread_data) \
       /* Just perform straight pixel conversion. */ \
       ctx->direct_pixconv(output, input, \
             ctx->out_width,  ctx->out_height, \
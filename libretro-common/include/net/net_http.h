@@ -34,6 +34,11 @@ RETRO_BEGIN_DECLS
 struct http_t;
 struct http_connection_t;
 
+/* Receives the body of a response piece by piece.
+ * Returning false aborts the transfer. */
+typedef bool (*net_http_sink_t)(void *userdata,
+      const uint8_t *data, size_t len);
+
 struct http_connection_t *net_http_connection_new(const char *url, const char *method, const char *data);
 
 /**
@@ -58,6 +63,22 @@ const char *net_http_connection_url(struct http_connection_t *conn);
 
 const char* net_http_connection_method(struct http_connection_t* conn);
 
+/**
+ * net_http_connection_ready:
+ *
+ * Leaf function.
+ *
+ * Transfers reuse kept-alive connections to the same host, and
+ * the number of transfers in flight to one host is capped.
+ * Callers starting many transfers should wait for this to return
+ * true before calling net_http_new().
+ *
+ * @return false while the host of @conn already has the maximum
+ * number of transfers in flight. Only valid after
+ * net_http_connection_done() succeeded.
+ **/
+bool net_http_connection_ready(struct http_connection_t *conn);
+
 struct http_t *net_http_new(struct http_connection_t *conn);
 
 /**
@@ -78,6 +99,21 @@ int net_http_fd(struct http_t *state);
  **/
 bool net_http_update(struct http_t *state, size_t* progress, size_t* total);
 
+/**
+ * net_http_set_sink:
+ *
+ * Leaf function.
+ *
+ * Passes the body of a successful (20x) response to @sink
+ * piece by piece as it arrives, instead of collecting it in
+ * memory, so memory use stays bounded however large the
+ * response. net_http_data() then returns no data. Other
+ * responses are still collected in memory. Call before the
+ * first net_http_update().
+ **/
+void net_http_set_sink(struct http_t *state, net_http_sink_t sink,
+      void *userdata);
+
 /**
  * net_http_status:
  *
@@ -121,10 +157,28 @@ uint8_t* net_http_data(struct http_t *state, size_t* len, bool accept_error);
 /**
  * net_http_delete:
  *
- * Cleans up all memory.
+ * Cleans up all memory. The connection goes back to the
+ * keep-alive pool if the response was read completely.
  **/
 void net_http_delete(struct http_t *state);
 
+/**
+ * net_http_pool_init:
+ *
+ * Creates the lock guarding the keep-alive pool and the DNS cache.
+ * Must be called once before connections are made from more than
+ * one thread.
+ **/
+void net_http_pool_init(void);
+
+/**
+ * net_http_pool_free:
+ *
+ * Closes all idle kept-alive connections, drops the DNS cache
+ * and frees the lock created by net_http_pool_init().
+ **/
+void net_http_pool_free(void);
+
 /**
  * net_http_urlencode:
  *
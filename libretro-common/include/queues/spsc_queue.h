@@ -0,0 +1,121 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_SPSC_QUEUE_H
+#define __LIBRETRO_SDK_SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+#include <boolean.h>
+
+RETRO_BEGIN_DECLS
+
+/* Byte queue for exactly one producer thread and one
+ * consumer thread, which never block each other: neither
+ * side takes a lock, and the write and read positions live
+ * on separate cache lines. Threads that need to wait for
+ * space or data still do so with their own condition
+ * variable, as they would with a fifo_buffer_t.
+ *
+ * spsc_queue_write() and spsc_queue_write_avail() may only
+ * be called by the producer, spsc_queue_read() and
+ * spsc_queue_read_avail() only by the consumer. */
+
+#define SPSC_QUEUE_CACHE_LINE 64
+
+typedef struct spsc_queue
+{
+   /* Producer side */
+   size_t write_pos;
+   size_t read_cache;   /* Last read_pos seen by the producer */
+   uint8_t pad0[SPSC_QUEUE_CACHE_LINE - 2 * sizeof(size_t)];
+
+   /* Consumer side */
+   size_t read_pos;
+   size_t write_cache;  /* Last write_pos seen by the consumer */
+   uint8_t pad1[SPSC_QUEUE_CACHE_LINE - 2 * sizeof(size_t)];
+
+   /* Positions run over [0, 2 * size), so that a full queue
+    * can be told from an empty one without a spare byte */
+   uint8_t *buffer;
+   size_t size;
+} spsc_queue_t;
+
+/**
+ * spsc_queue_new:
+ * @size  : Capacity in bytes.
+ *
+ * @return New empty queue, or NULL on allocation failure.
+ **/
+spsc_queue_t *spsc_queue_new(size_t size);
+
+void spsc_queue_free(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_clear:
+ *
+ * Empties the queue. Neither the producer nor the
+ * consumer may be using it at the same time.
+ **/
+void spsc_queue_clear(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_write_avail:
+ *
+ * @return Number of bytes the producer can write now.
+ **/
+size_t spsc_queue_write_avail(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_read_avail:
+ *
+ * @return Number of bytes the consumer can read now.
+ **/
+size_t spsc_queue_read_avail(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_write:
+ * @in_buf : Data to append.
+ * @size   : Number of bytes in @in_buf.
+ *
+ * Appends as much of @in_buf as fits.
+ *
+ * @return Number of bytes written.
+ **/
+size_t spsc_queue_write(spsc_queue_t *queue, const void *in_buf, size_t size);
+
+/**
+ * spsc_queue_read:
+ * @out_buf : Buffer to fill.
+ * @size    : Size of @out_buf in bytes.
+ *
+ * Takes up to @size bytes from the front of the queue.
+ *
+ * @return Number of bytes read.
+ **/
+size_t spsc_queue_read(spsc_queue_t *queue, void *out_buf, size_t size);
+
+RETRO_END_DECLS
+
+#endif
@@ -0,0 +1,118 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (retro_atomic.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_ATOMIC_H
+#define __LIBRETRO_SDK_ATOMIC_H
+
+#include <stddef.h>
+
+#include <retro_inline.h>
+
+/* Acquire loads and release stores of single words, for
+ * lock-free structures with one writer per word: the writer
+ * fills in data and then publishes it with a release store,
+ * and a reader that sees the new value with an acquire load
+ * also sees the data written before it. */
+
+#if defined(__clang__) || (defined(__GNUC__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define RETRO_ATOMIC_BUILTINS
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+      && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define RETRO_ATOMIC_ACQUIRE_FENCE() atomic_thread_fence(memory_order_acquire)
+#define RETRO_ATOMIC_RELEASE_FENCE() atomic_thread_fence(memory_order_release)
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+#include <intrin.h>
+#define RETRO_ATOMIC_ACQUIRE_FENCE() __dmb(_ARM64_BARRIER_ISH)
+#define RETRO_ATOMIC_RELEASE_FENCE() __dmb(_ARM64_BARRIER_ISH)
+#elif defined(_MSC_VER) && defined(_M_ARM)
+#include <intrin.h>
+#define RETRO_ATOMIC_ACQUIRE_FENCE() __dmb(_ARM_BARRIER_ISH)
+#define RETRO_ATOMIC_RELEASE_FENCE() __dmb(_ARM_BARRIER_ISH)
+#elif defined(_MSC_VER) && defined(_M_PPC)
+#include <ppcintrinsics.h>
+#define RETRO_ATOMIC_ACQUIRE_FENCE() __lwsync()
+#define RETRO_ATOMIC_RELEASE_FENCE() __lwsync()
+#elif defined(_MSC_VER)
+#include <intrin.h>
+/* x86 does not reorder loads with older loads or stores
+ * with older stores, so only the compiler needs fencing */
+#define RETRO_ATOMIC_ACQUIRE_FENCE() _ReadWriteBarrier()
+#define RETRO_ATOMIC_RELEASE_FENCE() _ReadWriteBarrier()
+#elif defined(__GNUC__)
+/* GCC before 4.7 only has full barriers */
+#define RETRO_ATOMIC_ACQUIRE_FENCE() __sync_synchronize()
+#define RETRO_ATOMIC_RELEASE_FENCE() __sync_synchronize()
+#else
+/* Unknown compiler; only correct on single core targets */
+#define RETRO_ATOMIC_ACQUIRE_FENCE()
+#define RETRO_ATOMIC_RELEASE_FENCE()
+#endif
+
+static INLINE unsigned retro_atomic_load_acquire_uint(
+      const volatile unsigned *p)
+{
+#ifdef RETRO_ATOMIC_BUILTINS
+   return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#else
+   unsigned v = *p;
+   RETRO_ATOMIC_ACQUIRE_FENCE();
+   return v;
+#endif
+}
+
+static INLINE void retro_atomic_store_release_uint(
+      volatile unsigned *p, unsigned v)
+{
+#ifdef RETRO_ATOMIC_BUILTINS
+   __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#else
+   RETRO_ATOMIC_RELEASE_FENCE();
+   *p = v;
+#endif
+}
+
+static INLINE size_t retro_atomic_load_acquire_size(
+      const volatile size_t *p)
+{
+#ifdef RETRO_ATOMIC_BUILTINS
+   return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#else
+   size_t v = *p;
+   RETRO_ATOMIC_ACQUIRE_FENCE();
+   return v;
+#endif
+}
+
+static INLINE void retro_atomic_store_release_size(
+      volatile size_t *p, size_t v)
+{
+#ifdef RETRO_ATOMIC_BUILTINS
+   __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#else
+   RETRO_ATOMIC_RELEASE_FENCE();
+   *p = v;
+#endif
+}
+
+#endif
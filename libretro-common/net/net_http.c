@@ -36,6 +36,26 @@
 #include <lists/string_list.h>
 #include <retro_common_api.h>
 #include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Transfers to one host beyond this wait for a free
+ * connection (see net_http_connection_ready), and at
+ * most this many idle connections are kept per host. */
+#define NET_HTTP_MAX_CONNECTIONS_PER_HOST 4
+
+/* Idle connections older than this are not reused,
+ * servers commonly drop them after 5-15 seconds. */
+#define NET_HTTP_KEEPALIVE_TIMEOUT_USEC   (10 * 1000000)
+
+/* getaddrinfo() does not report the record TTL,
+ * so lookups are cached for a fixed time. */
+#define NET_HTTP_DNS_TTL_USEC             (300 * 1000000)
+
+/* Receive buffer size for transfers with a sink */
+#define NET_HTTP_SINK_BUFFER_SIZE         (64 * 1024)
 
 enum
 {
@@ -61,18 +81,61 @@ struct http_socket_state_t
    bool ssl;
 };
 
+struct http_dns_entry
+{
+   struct addrinfo *addr;
+   retro_time_t resolved;
+   unsigned refs;
+};
+
+struct http_pool_conn
+{
+   struct http_pool_conn *next;
+   struct http_socket_state_t sock_state; /* ptr alignment */
+   retro_time_t idle_since;
+};
+
+/* State shared by all transfers to one domain, port and scheme */
+struct http_pool_host
+{
+   struct http_pool_host *next;
+   struct http_pool_conn *idle;
+   struct http_dns_entry *dns;
+   char *domain;
+   int port;
+   unsigned active;
+   unsigned num_idle;
+   bool ssl;
+};
+
 struct http_t
 {
    char *data;
+   char *request;
    struct string_list *headers;
+   struct http_pool_host *host;
+   net_http_sink_t sink;
+   void *sink_data;
    struct http_socket_state_t sock_state; /* ptr alignment */
    size_t pos;
    size_t len;
    size_t buflen;
+   size_t request_len;
+   size_t flushed;
    int status;
    char part;
    char bodytype;
    bool error;
+   bool head;
+   bool keep_alive;
+};
+
+struct http_request_buf
+{
+   char *data;
+   size_t len;
+   size_t cap;
+   bool error;
 };
 
 struct http_connection_t
@@ -425,18 +488,302 @@ void net_http_urlencode_full(char *dest,
    free(tmp);
 }
 
-static int net_http_new_socket(struct http_connection_t *conn)
+static struct http_pool_host *http_pool_hosts = NULL;
+#ifdef HAVE_THREADS
+static slock_t *http_pool_lock                = NULL;
+#endif
+
+static void net_http_pool_lock(void)
+{
+#ifdef HAVE_THREADS
+   slock_lock(http_pool_lock);
+#endif
+}
+
+static void net_http_pool_unlock(void)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(http_pool_lock);
+#endif
+}
+
+static void net_http_socket_close(struct http_socket_state_t *sock_state)
 {
-   struct addrinfo *addr = NULL, *next_addr = NULL;
-   int fd                = socket_init(
-         (void**)&addr, conn->port, conn->domain, SOCKET_TYPE_STREAM, 0);
 #ifdef HAVE_SSL
-   if (conn->sock_state.ssl)
+   if (sock_state->ssl && sock_state->ssl_ctx)
+   {
+      ssl_socket_close(sock_state->ssl_ctx);
+      ssl_socket_free(sock_state->ssl_ctx);
+      sock_state->ssl_ctx = NULL;
+   }
+   else
+#endif
+   socket_close(sock_state->fd);
+   sock_state->fd = -1;
+}
+
+/* Pool lock must be held */
+static struct http_pool_host *net_http_pool_host(
+      const char *domain, int port, bool ssl)
+{
+   struct http_pool_host *host;
+
+   for (host = http_pool_hosts; host; host = host->next)
+      if (     host->port == port
+            && host->ssl  == ssl
+            && string_is_equal_case_insensitive(host->domain, domain))
+         return host;
+
+   if (!(host = (struct http_pool_host*)calloc(1, sizeof(*host))))
+      return NULL;
+
+   if (!(host->domain = strdup(domain)))
+   {
+      free(host);
+      return NULL;
+   }
+
+   host->port      = port;
+   host->ssl       = ssl;
+   host->next      = http_pool_hosts;
+   http_pool_hosts = host;
+
+   return host;
+}
+
+/* Pool lock must be held */
+static void net_http_dns_release_locked(struct http_dns_entry *entry)
+{
+   if (--entry->refs)
+      return;
+   freeaddrinfo_retro(entry->addr);
+   free(entry);
+}
+
+static void net_http_dns_release(struct http_dns_entry *entry)
+{
+   net_http_pool_lock();
+   net_http_dns_release_locked(entry);
+   net_http_pool_unlock();
+}
+
+/**
+ * net_http_dns_acquire:
+ * @host                : Host to resolve.
+ *
+ * Resolves the domain of @host, returning the cached result if it
+ * is recent enough. The cache holds one reference to its entry and
+ * every caller another, so an entry replaced by a fresh lookup stays
+ * valid until the last connection attempt using it is done.
+ *
+ * Returns: a referenced entry to release with net_http_dns_release(),
+ * or NULL if the lookup failed.
+ **/
+static struct http_dns_entry *net_http_dns_acquire(
+      struct http_pool_host *host)
+{
+   char port_buf[6];
+   struct addrinfo hints        = {0};
+   struct addrinfo *addr        = NULL;
+   struct http_dns_entry *entry = NULL;
+   retro_time_t now             = cpu_features_get_time_usec();
+
+   net_http_pool_lock();
+   if (host->dns && now - host->dns->resolved < NET_HTTP_DNS_TTL_USEC)
+   {
+      entry = host->dns;
+      entry->refs++;
+   }
+   net_http_pool_unlock();
+
+   if (entry)
+      return entry;
+
+   if (!network_init())
+      return NULL;
+
+#if defined(HAVE_SOCKET_LEGACY) || defined(WIIU)
+   hints.ai_family   = AF_INET;
+#else
+   hints.ai_family   = AF_UNSPEC;
+#endif
+   hints.ai_socktype = SOCK_STREAM;
+   hints.ai_flags    = AI_NUMERICSERV;
+   snprintf(port_buf, sizeof(port_buf), "%hu", (unsigned short)host->port);
+
+   /* Resolve outside the lock, lookups can take seconds */
+   if (getaddrinfo_retro(host->domain, port_buf, &hints, &addr) || !addr)
+      return NULL;
+
+   if (!(entry = (struct http_dns_entry*)malloc(sizeof(*entry))))
+   {
+      freeaddrinfo_retro(addr);
+      return NULL;
+   }
+
+   entry->addr     = addr;
+   entry->resolved = now;
+   entry->refs     = 2;
+
+   net_http_pool_lock();
+   if (host->dns)
+      net_http_dns_release_locked(host->dns);
+   host->dns       = entry;
+   net_http_pool_unlock();
+
+   return entry;
+}
+
+/**
+ * net_http_pool_take:
+ * @host                : Host to connect to.
+ * @sock_state          : Filled in with the connection.
+ *
+ * Takes an idle kept-alive connection to @host out of the pool.
+ * Connections that have been idle for too long, or that became
+ * readable while idle (the server closed them or sent something
+ * unsolicited), are closed instead.
+ *
+ * Returns: true if a connection was taken.
+ **/
+static bool net_http_pool_take(struct http_pool_host *host,
+      struct http_socket_state_t *sock_state)
+{
+   struct http_pool_conn *conn;
+   bool found       = false;
+   retro_time_t now = cpu_features_get_time_usec();
+
+   net_http_pool_lock();
+   while (!found && (conn = host->idle))
+   {
+      bool readable = true;
+
+      host->idle    = conn->next;
+      host->num_idle--;
+
+      if (     now - conn->idle_since < NET_HTTP_KEEPALIVE_TIMEOUT_USEC
+            && socket_wait(conn->sock_state.fd, &readable, NULL, 0)
+            && !readable)
+      {
+         *sock_state = conn->sock_state;
+         found       = true;
+      }
+      else
+         net_http_socket_close(&conn->sock_state);
+
+      free(conn);
+   }
+   net_http_pool_unlock();
+
+   return found;
+}
+
+static void net_http_pool_put(struct http_pool_host *host,
+      struct http_socket_state_t *sock_state)
+{
+   struct http_pool_conn *conn = NULL;
+
+   net_http_pool_lock();
+   if (     host->num_idle < NET_HTTP_MAX_CONNECTIONS_PER_HOST
+         && (conn = (struct http_pool_conn*)malloc(sizeof(*conn))))
+   {
+      conn->sock_state = *sock_state;
+      conn->idle_since = cpu_features_get_time_usec();
+      conn->next       = host->idle;
+      host->idle       = conn;
+      host->num_idle++;
+   }
+   net_http_pool_unlock();
+
+   if (!conn)
+      net_http_socket_close(sock_state);
+}
+
+/**
+ * net_http_pool_init:
+ *
+ * Creates the lock guarding the keep-alive pool and the DNS cache.
+ * Must be called once before connections are made from more than
+ * one thread.
+ **/
+void net_http_pool_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!http_pool_lock)
+      http_pool_lock = slock_new();
+#endif
+}
+
+/**
+ * net_http_pool_free:
+ *
+ * Closes all idle kept-alive connections, drops the DNS cache
+ * and frees the lock created by net_http_pool_init().
+ **/
+void net_http_pool_free(void)
+{
+   struct http_pool_host **prev;
+   struct http_pool_host *host;
+
+   net_http_pool_lock();
+   for (prev = &http_pool_hosts; (host = *prev); )
+   {
+      struct http_pool_conn *conn;
+
+      while ((conn = host->idle))
+      {
+         host->idle = conn->next;
+         net_http_socket_close(&conn->sock_state);
+         free(conn);
+      }
+      host->num_idle = 0;
+
+      if (host->dns)
+         net_http_dns_release_locked(host->dns);
+      host->dns = NULL;
+
+      /* Transfers in flight still point at their host */
+      if (host->active)
+      {
+         prev = &host->next;
+         continue;
+      }
+
+      *prev = host->next;
+      free(host->domain);
+      free(host);
+   }
+   net_http_pool_unlock();
+
+#ifdef HAVE_THREADS
+   if (http_pool_lock)
+      slock_free(http_pool_lock);
+   http_pool_lock = NULL;
+#endif
+}
+
+static int net_http_new_socket(struct http_pool_host *host,
+      struct http_socket_state_t *sock_state)
+{
+   struct addrinfo *addr, *next_addr;
+   int fd                       = -1;
+   struct http_dns_entry *entry = net_http_dns_acquire(host);
+
+   sock_state->fd               = -1;
+   sock_state->ssl_ctx          = NULL;
+
+   if (!entry)
+      return -1;
+
+   addr = entry->addr;
+   fd   = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+#ifdef HAVE_SSL
+   if (host->ssl)
    {
       if (fd < 0)
          goto done;
 
-      if (!(conn->sock_state.ssl_ctx = ssl_socket_init(fd, conn->domain)))
+      if (!(sock_state->ssl_ctx = ssl_socket_init(fd, host->domain)))
       {
          socket_close(fd);
          fd = -1;
@@ -450,13 +797,16 @@ static int net_http_new_socket(struct http_connection_t *conn)
       /* Temp fix, don't use new timeout/poll code for cheevos http requests */
          bool timeout = true;
 #ifdef __WIN32
-      if (!strcmp(conn->domain, "retroachievements.org"))
+      if (!strcmp(host->domain, "retroachievements.org"))
          timeout = false;
 #endif
 
-      if (ssl_socket_connect(conn->sock_state.ssl_ctx, addr, timeout, true)
+      if (ssl_socket_connect(sock_state->ssl_ctx, addr, timeout, true)
             < 0)
       {
+         ssl_socket_close(sock_state->ssl_ctx);
+         ssl_socket_free(sock_state->ssl_ctx);
+         sock_state->ssl_ctx = NULL;
          fd = -1;
          goto done;
       }
@@ -474,10 +824,9 @@ static int net_http_new_socket(struct http_connection_t *conn)
 #ifdef HAVE_SSL
 done:
 #endif
-   if (addr)
-      freeaddrinfo_retro(addr);
+   net_http_dns_release(entry);
 
-   conn->sock_state.fd = fd;
+   sock_state->fd = fd;
 
    return fd;
 }
@@ -524,6 +873,7 @@ struct http_connection_t *net_http_connection_new(const char *url,
    conn->postdatacopy      = NULL;
    conn->useragentcopy     = NULL;
    conn->headerscopy       = NULL;
+   conn->contentlength     = 0;
    conn->port              = 0;
    conn->sock_state.fd     = 0;
    conn->sock_state.ssl    = false;
@@ -738,40 +1088,112 @@ const char* net_http_connection_method(struct http_connection_t* conn)
    return conn->methodcopy;
 }
 
+static void net_http_request_append(struct http_request_buf *req,
+      const void *data, size_t len)
+{
+   if (req->error)
+      return;
+
+   if (req->len + len > req->cap)
+   {
+      size_t cap = req->cap * 2;
+      char *buf  = NULL;
+
+      if (cap < req->len + len)
+         cap = req->len + len;
+
+      if (!(buf = (char*)realloc(req->data, cap)))
+      {
+         req->error = true;
+         return;
+      }
+
+      req->data = buf;
+      req->cap  = cap;
+   }
+
+   memcpy(req->data + req->len, data, len);
+   req->len += len;
+}
+
+/**
+ * net_http_connection_ready:
+ *
+ * Leaf function.
+ *
+ * @return false while the host of @conn already has the maximum
+ * number of transfers in flight.
+ **/
+bool net_http_connection_ready(struct http_connection_t *conn)
+{
+   struct http_pool_host *host;
+   bool ready = true;
+
+   if (!conn || !conn->domain)
+      return true;
+
+   net_http_pool_lock();
+   if ((host = net_http_pool_host(conn->domain, conn->port,
+         conn->sock_state.ssl)))
+      ready = host->active < NET_HTTP_MAX_CONNECTIONS_PER_HOST;
+   net_http_pool_unlock();
+
+   return ready;
+}
+
 struct http_t *net_http_new(struct http_connection_t *conn)
 {
-   bool error            = false;
-#ifdef HAVE_SSL
-   if (!conn || (net_http_new_socket(conn)) < 0)
+   struct http_request_buf request;
+   struct http_socket_state_t sock_state;
+   struct http_pool_host *host = NULL;
+   bool error                  = false;
+   bool reused                 = false;
+
+   if (!conn)
       return NULL;
-#else
-   int fd                = -1;
-   if (!conn || (fd = net_http_new_socket(conn)) < 0)
+
+   net_http_pool_lock();
+   host = net_http_pool_host(conn->domain, conn->port, conn->sock_state.ssl);
+   net_http_pool_unlock();
+
+   if (!host)
+      return NULL;
+
+   sock_state.fd      = -1;
+   sock_state.ssl     = conn->sock_state.ssl;
+   sock_state.ssl_ctx = NULL;
+
+   /* The request is built up front and sent with a single
+    * call, rather than as one TCP segment (or TLS record)
+    * per header. */
+   request.len        = 0;
+   request.cap        = 512 + conn->contentlength;
+   request.error      = false;
+   if (!(request.data = (char*)malloc(request.cap)))
       return NULL;
-#endif
 
    /* This is a bit lazy, but it works. */
    if (conn->methodcopy)
    {
-      net_http_send_str(&conn->sock_state, &error, conn->methodcopy,
+      net_http_request_append(&request, conn->methodcopy,
             strlen(conn->methodcopy));
-      net_http_send_str(&conn->sock_state, &error, " /",
+      net_http_request_append(&request, " /",
             STRLEN_CONST(" /"));
    }
    else
    {
-      net_http_send_str(&conn->sock_state, &error, "GET /",
+      net_http_request_append(&request, "GET /",
             STRLEN_CONST("GET /"));
    }
 
-   net_http_send_str(&conn->sock_state, &error, conn->location,
+   net_http_request_append(&request, conn->location,
          strlen(conn->location));
-   net_http_send_str(&conn->sock_state, &error, " HTTP/1.1\r\n",
+   net_http_request_append(&request, " HTTP/1.1\r\n",
          STRLEN_CONST(" HTTP/1.1\r\n"));
 
-   net_http_send_str(&conn->sock_state, &error, "Host: ",
+   net_http_request_append(&request, "Host: ",
          STRLEN_CONST("Host: "));
-   net_http_send_str(&conn->sock_state, &error, conn->domain,
+   net_http_request_append(&request, conn->domain,
          strlen(conn->domain));
 
    if (conn->port)
@@ -782,23 +1204,23 @@ struct http_t *net_http_new(struct http_connection_t *conn)
       portstr[++_len] = '\0';
       _len           += snprintf(portstr + _len, sizeof(portstr) - _len,
             "%i", conn->port);
-      net_http_send_str(&conn->sock_state, &error, portstr, _len);
+      net_http_request_append(&request, portstr, _len);
    }
 
-   net_http_send_str(&conn->sock_state, &error, "\r\n",
+   net_http_request_append(&request, "\r\n",
          STRLEN_CONST("\r\n"));
 
    /* Pre-formatted headers */
    if (conn->headerscopy)
-      net_http_send_str(&conn->sock_state, &error, conn->headerscopy,
+      net_http_request_append(&request, conn->headerscopy,
             strlen(conn->headerscopy));
    if (conn->contenttypecopy)
    {
-      net_http_send_str(&conn->sock_state, &error, "Content-Type: ",
+      net_http_request_append(&request, "Content-Type: ",
             STRLEN_CONST("Content-Type: "));
-      net_http_send_str(&conn->sock_state, &error,
+      net_http_request_append(&request,
             conn->contenttypecopy, strlen(conn->contenttypecopy));
-      net_http_send_str(&conn->sock_state, &error, "\r\n",
+      net_http_request_append(&request, "\r\n",
             STRLEN_CONST("\r\n"));
    }
 
@@ -813,14 +1235,14 @@ struct http_t *net_http_new(struct http_connection_t *conn)
       if (!conn->headerscopy)
       {
          if (!conn->contenttypecopy)
-            net_http_send_str(&conn->sock_state, &error,
+            net_http_request_append(&request,
                   "Content-Type: application/x-www-form-urlencoded\r\n",
                   STRLEN_CONST(
                      "Content-Type: application/x-www-form-urlencoded\r\n"
                      ));
       }
 
-      net_http_send_str(&conn->sock_state, &error, "Content-Length: ",
+      net_http_request_append(&request, "Content-Length: ",
             STRLEN_CONST("Content-Length: "));
 
       post_len = conn->contentlength;
@@ -836,58 +1258,107 @@ struct http_t *net_http_new(struct http_connection_t *conn)
 
       len_str[len] = '\0';
 
-      net_http_send_str(&conn->sock_state, &error, len_str,
+      net_http_request_append(&request, len_str,
             strlen(len_str));
-      net_http_send_str(&conn->sock_state, &error, "\r\n",
+      net_http_request_append(&request, "\r\n",
             STRLEN_CONST("\r\n"));
 
       free(len_str);
    }
 
-   net_http_send_str(&conn->sock_state, &error, "User-Agent: ",
+   net_http_request_append(&request, "User-Agent: ",
          STRLEN_CONST("User-Agent: "));
    if (conn->useragentcopy)
-      net_http_send_str(&conn->sock_state, &error,
+      net_http_request_append(&request,
             conn->useragentcopy, strlen(conn->useragentcopy));
    else
-      net_http_send_str(&conn->sock_state, &error, "libretro",
+      net_http_request_append(&request, "libretro",
             STRLEN_CONST("libretro"));
-   net_http_send_str(&conn->sock_state, &error, "\r\n",
+   net_http_request_append(&request, "\r\n",
          STRLEN_CONST("\r\n"));
 
-   net_http_send_str(&conn->sock_state, &error,
-         "Connection: close\r\n", STRLEN_CONST("Connection: close\r\n"));
-   net_http_send_str(&conn->sock_state, &error, "\r\n",
+   net_http_request_append(&request,
+         "Connection: keep-alive\r\n",
+         STRLEN_CONST("Connection: keep-alive\r\n"));
+   net_http_request_append(&request, "\r\n",
          STRLEN_CONST("\r\n"));
 
    if (conn->postdatacopy && conn->contentlength)
-      net_http_send_str(&conn->sock_state, &error, conn->postdatacopy,
+      net_http_request_append(&request, conn->postdatacopy,
             conn->contentlength);
 
+   if (request.error)
+      goto err;
+
+   /* Reuse a kept-alive connection if there is one, falling
+    * back to a new connection if the server dropped it */
+   if (net_http_pool_take(host, &sock_state))
+   {
+      net_http_send_str(&sock_state, &error, request.data, request.len);
+      if (error)
+         net_http_socket_close(&sock_state);
+      else
+         reused = true;
+   }
+
+   if (!reused)
+   {
+      error = false;
+      if (net_http_new_socket(host, &sock_state) < 0)
+         goto err;
+      net_http_send_str(&sock_state, &error, request.data, request.len);
+   }
+
    if (!error)
    {
       struct http_t *state = (struct http_t*)malloc(sizeof(struct http_t));
-      state->sock_state    = conn->sock_state;
+      state->sock_state    = sock_state;
+      state->host          = host;
+      state->request       = NULL;
+      state->request_len   = 0;
+      state->sink          = NULL;
+      state->sink_data     = NULL;
+      state->flushed       = 0;
       state->status        = -1;
       state->data          = NULL;
       state->part          = P_HEADER_TOP;
       state->bodytype      = T_FULL;
       state->error         = false;
+      state->head          = conn->methodcopy
+         && string_is_equal(conn->methodcopy, "HEAD");
+      state->keep_alive    = true;
       state->pos           = 0;
       state->len           = 0;
       state->buflen        = 512;
 
       if ((state->data = (char*)malloc(state->buflen)))
       {
-         if ((state->headers = string_list_new()) &&
-             string_list_initialize(state->headers))
+         if ((state->headers = string_list_new()))
+         {
+            /* Kept for sending again should the server
+             * have closed the reused connection meanwhile */
+            if (reused)
+            {
+               state->request     = request.data;
+               state->request_len = request.len;
+            }
+            else
+               free(request.data);
+
+            net_http_pool_lock();
+            host->active++;
+            net_http_pool_unlock();
             return state;
+         }
          string_list_free(state->headers);
+         free(state->data);
       }
       free(state);
    }
 
 err:
+   free(request.data);
+
    if (conn)
    {
       if (conn->methodcopy)
@@ -899,23 +1370,46 @@ err:
       conn->methodcopy           = NULL;
       conn->contenttypecopy      = NULL;
       conn->postdatacopy         = NULL;
-
-#ifdef HAVE_SSL
-      if (conn->sock_state.ssl_ctx)
-      {
-         ssl_socket_close(conn->sock_state.ssl_ctx);
-         ssl_socket_free(conn->sock_state.ssl_ctx);
-         conn->sock_state.ssl_ctx = NULL;
-      }
-#endif
    }
 
-#ifndef HAVE_SSL
-   socket_close(fd);
-#endif
+   if (sock_state.fd >= 0)
+      net_http_socket_close(&sock_state);
    return NULL;
 }
 
+/**
+ * net_http_resend:
+ *
+ * A kept-alive connection may be closed by the server at any time
+ * while idle. If that happened before any of the response arrived,
+ * sends the request again on a new connection.
+ *
+ * @return true if the request was sent again.
+ **/
+static bool net_http_resend(struct http_t *state)
+{
+   bool error = false;
+
+   if (!state->request || state->part != P_HEADER_TOP || state->pos)
+      return false;
+
+   net_http_socket_close(&state->sock_state);
+   if (net_http_new_socket(state->host, &state->sock_state) < 0)
+      error = true;
+   else
+      net_http_send_str(&state->sock_state, &error,
+            state->request, state->request_len);
+
+   free(state->request);
+   state->request = NULL;
+
+   if (error)
+      return false;
+
+   state->error   = false;
+   return true;
+}
+
 /**
  * net_http_fd:
  *
@@ -931,6 +1425,11 @@ int net_http_fd(struct http_t *state)
    return state->sock_state.fd;
 }
 
+static bool net_http_sink_active(struct http_t *state)
+{
+   return state->sink && state->status >= 200 && state->status <= 299;
+}
+
 /**
  * net_http_update:
  *
@@ -963,6 +1462,8 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
 
          if (newlen < 0)
          {
+            if (net_http_resend(state))
+               return false;
             state->error  = true;
             goto error;
          }
@@ -997,6 +1498,11 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
                state->status    = (int)strtoul(state->data 
                      + STRLEN_CONST("HTTP/1.1 "), NULL, 10);
                state->part      = P_HEADER;
+               /* HTTP/1.0 servers close the connection */
+               if (state->data[STRLEN_CONST("HTTP/1.")] == '0')
+                  state->keep_alive = false;
+               free(state->request);
+               state->request   = NULL;
             }
             else
             {
@@ -1011,6 +1517,15 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
                }
                if (string_is_equal_case_insensitive(state->data, "Transfer-Encoding: chunked"))
                   state->bodytype = T_CHUNK;
+               if (string_starts_with_case_insensitive(state->data, "Connection:"))
+               {
+                  char* ptr = state->data + STRLEN_CONST("Connection:");
+                  while (ISSPACE(*ptr))
+                     ++ptr;
+
+                  if (string_starts_with_case_insensitive(ptr, "close"))
+                     state->keep_alive = false;
+               }
 
                if (state->data[0]=='\0')
                {
@@ -1020,6 +1535,16 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
                   }
                   else
                   {
+                     /* These never have a body, whatever
+                      * the headers say */
+                     if (     state->head
+                           || state->status == 204
+                           || state->status == 304)
+                     {
+                        state->bodytype = T_LEN;
+                        state->len      = 0;
+                     }
+
                      state->part = P_BODY;
                      if (state->bodytype == T_CHUNK)
                         state->part = P_BODY_CHUNKLEN;
@@ -1050,7 +1575,9 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
          {
             if (state->error)
                newlen = -1;
-            else if (state->len)
+            /* A chunked body may not have started
+             * arriving together with the headers */
+            else if (state->len || state->bodytype == T_CHUNK)
             {
 #ifdef HAVE_SSL
                if (state->sock_state.ssl && state->sock_state.ssl_ctx)
@@ -1080,7 +1607,9 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
                newlen           = 0;
             }
 
-            if (state->pos + newlen >= state->buflen - 64)
+            /* With a sink the buffer is emptied below */
+            if (     !net_http_sink_active(state)
+                  && state->pos + newlen >= state->buflen - 64)
             {
                state->buflen   *= 2;
                state->data      = (char*)realloc(state->data, state->buflen);
@@ -1125,6 +1654,12 @@ parse_again:
                      state->part = P_BODY;
                      if (state->len == 0)
                      {
+                        /* Only reuse the connection if the final
+                         * CRLF arrived and there are no trailers */
+                        if (     newlen != 2
+                              || state->data[state->pos]     != '\r'
+                              || state->data[state->pos + 1] != '\n')
+                           state->keep_alive = false;
                         state->part = P_DONE;
                         state->len  = state->pos;
                         state->data = (char*)realloc(state->data, state->len);
@@ -1164,13 +1699,53 @@ parse_again:
          }
       }
 
+      /* Hand the body over as it arrives, only what
+       * has not been parsed yet stays in memory */
+      if (     state->part >= P_BODY
+            && state->part <= P_DONE
+            && net_http_sink_active(state))
+      {
+         /* Between chunks, the decoded data ends
+          * where the next chunk header starts */
+         size_t decoded = (state->part == P_BODY_CHUNKLEN)
+            ? state->len : state->pos;
+
+         if (decoded)
+         {
+            if (!state->sink(state->sink_data,
+                     (const uint8_t*)state->data, decoded))
+            {
+               state->error  = true;
+               goto error;
+            }
+
+            state->flushed  += decoded;
+
+            if (state->part == P_BODY_CHUNKLEN)
+            {
+               memmove(state->data, state->data + decoded,
+                     state->pos - decoded);
+               state->len    = 0;
+               state->pos   -= decoded;
+            }
+            else
+            {
+               if (state->part == P_DONE)
+                  state->len  = 0;
+               else if (state->bodytype == T_LEN)
+                  state->len -= decoded;
+               state->pos    = 0;
+            }
+         }
+      }
+
       if (progress)
-         *progress = state->pos;
+         *progress = state->flushed + state->pos;
 
       if (total)
       {
          if (state->bodytype == T_LEN)
-            *total = state->len;
+            *total = state->flushed + state->len;
          else
             *total = 0;
       }
@@ -1185,6 +1760,35 @@ error:
    return true;
 }
 
+/**
+ * net_http_set_sink:
+ *
+ * Leaf function.
+ *
+ * Passes the body of a successful (20x) response to @sink
+ * piece by piece as it arrives, instead of collecting it in
+ * memory. net_http_data() then returns no data.
+ **/
+void net_http_set_sink(struct http_t *state, net_http_sink_t sink,
+      void *userdata)
+{
+   if (!state)
+      return;
+
+   state->sink      = sink;
+   state->sink_data = userdata;
+
+   if (state->buflen < NET_HTTP_SINK_BUFFER_SIZE)
+   {
+      char *data = (char*)realloc(state->data, NET_HTTP_SINK_BUFFER_SIZE);
+      if (data)
+      {
+         state->data   = data;
+         state->buflen = NET_HTTP_SINK_BUFFER_SIZE;
+      }
+   }
+}
+
 /**
  * net_http_status:
  *
@@ -1251,7 +1855,8 @@ uint8_t* net_http_data(struct http_t *state, size_t* len, bool accept_error)
 /**
  * net_http_delete:
  *
- * Cleans up all memory.
+ * Cleans up all memory. The connection goes back to the
+ * keep-alive pool if the response was read completely.
  **/
 void net_http_delete(struct http_t *state)
 {
@@ -1260,17 +1865,21 @@ void net_http_delete(struct http_t *state)
 
    if (state->sock_state.fd >= 0)
    {
-#ifdef HAVE_SSL
-      if (state->sock_state.ssl && state->sock_state.ssl_ctx)
-      {
-         ssl_socket_close(state->sock_state.ssl_ctx);
-         ssl_socket_free(state->sock_state.ssl_ctx);
-         state->sock_state.ssl_ctx = NULL;
-      }
+      /* A complete response with a known length leaves the
+       * connection ready for the next request to the host */
+      if (     state->part == P_DONE
+            && state->bodytype != T_FULL
+            && state->keep_alive)
+         net_http_pool_put(state->host, &state->sock_state);
       else
-#endif
-      socket_close(state->sock_state.fd);
+         net_http_socket_close(&state->sock_state);
    }
+
+   net_http_pool_lock();
+   state->host->active--;
+   net_http_pool_unlock();
+
+   free(state->request);
    free(state);
 }
 
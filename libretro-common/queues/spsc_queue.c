@@ -0,0 +1,170 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_atomic.h>
+#include <retro_inline.h>
+#include <memalign.h>
+
+#include <queues/spsc_queue.h>
+
+/* The producer publishes data by storing write_pos after
+ * copying it in, and the consumer frees space by storing
+ * read_pos after copying it out. The other side has to
+ * load these with acquire ordering to see the copies. */
+#define SPSC_QUEUE_LOAD(p)     retro_atomic_load_acquire_size(p)
+#define SPSC_QUEUE_STORE(p, v) retro_atomic_store_release_size(p, v)
+
+static INLINE size_t spsc_queue_count(const spsc_queue_t *queue,
+      size_t write_pos, size_t read_pos)
+{
+   if (write_pos >= read_pos)
+      return write_pos - read_pos;
+   return write_pos + 2 * queue->size - read_pos;
+}
+
+static INLINE size_t spsc_queue_advance(const spsc_queue_t *queue,
+      size_t pos, size_t len)
+{
+   pos += len;
+   if (pos >= 2 * queue->size)
+      pos -= 2 * queue->size;
+   return pos;
+}
+
+spsc_queue_t *spsc_queue_new(size_t size)
+{
+   spsc_queue_t *queue = NULL;
+
+   if (!size || size > ((size_t)-1) / 4)
+      return NULL;
+
+   if (!(queue = (spsc_queue_t*)memalign_alloc(
+               SPSC_QUEUE_CACHE_LINE, sizeof(*queue))))
+      return NULL;
+
+   memset(queue, 0, sizeof(*queue));
+
+   if (!(queue->buffer = (uint8_t*)calloc(1, size)))
+   {
+      memalign_free(queue);
+      return NULL;
+   }
+
+   queue->size = size;
+
+   return queue;
+}
+
+void spsc_queue_free(spsc_queue_t *queue)
+{
+   if (!queue)
+      return;
+
+   free(queue->buffer);
+   memalign_free(queue);
+}
+
+void spsc_queue_clear(spsc_queue_t *queue)
+{
+   queue->write_pos   = 0;
+   queue->read_cache  = 0;
+   queue->read_pos    = 0;
+   queue->write_cache = 0;
+}
+
+size_t spsc_queue_write_avail(spsc_queue_t *queue)
+{
+   queue->read_cache = SPSC_QUEUE_LOAD(&queue->read_pos);
+   return queue->size - spsc_queue_count(queue,
+         queue->write_pos, queue->read_cache);
+}
+
+size_t spsc_queue_read_avail(spsc_queue_t *queue)
+{
+   queue->write_cache = SPSC_QUEUE_LOAD(&queue->write_pos);
+   return spsc_queue_count(queue, queue->write_cache, queue->read_pos);
+}
+
+size_t spsc_queue_write(spsc_queue_t *queue, const void *in_buf, size_t size)
+{
+   size_t offset, first_write;
+   size_t write_pos = queue->write_pos;
+   size_t avail     = queue->size - spsc_queue_count(queue,
+         write_pos, queue->read_cache);
+
+   /* Only look at the consumer's cache line when the space
+    * known from the last look is not enough */
+   if (avail < size)
+      avail         = spsc_queue_write_avail(queue);
+   if (size > avail)
+      size          = avail;
+   if (!size)
+      return 0;
+
+   offset           = (write_pos >= queue->size)
+      ? write_pos - queue->size : write_pos;
+   first_write      = queue->size - offset;
+   if (first_write > size)
+      first_write   = size;
+
+   memcpy(queue->buffer + offset, in_buf, first_write);
+   memcpy(queue->buffer, (const uint8_t*)in_buf + first_write,
+         size - first_write);
+
+   SPSC_QUEUE_STORE(&queue->write_pos,
+         spsc_queue_advance(queue, write_pos, size));
+
+   return size;
+}
+
+size_t spsc_queue_read(spsc_queue_t *queue, void *out_buf, size_t size)
+{
+   size_t offset, first_read;
+   size_t read_pos = queue->read_pos;
+   size_t avail    = spsc_queue_count(queue,
+         queue->write_cache, read_pos);
+
+   if (avail < size)
+      avail        = spsc_queue_read_avail(queue);
+   if (size > avail)
+      size         = avail;
+   if (!size)
+      return 0;
+
+   offset          = (read_pos >= queue->size)
+      ? read_pos - queue->size : read_pos;
+   first_read      = queue->size - offset;
+   if (first_read > size)
+      first_read   = size;
+
+   memcpy(out_buf, queue->buffer + offset, first_read);
+   memcpy((uint8_t*)out_buf + first_read, queue->buffer,
+         size - first_read);
+
+   SPSC_QUEUE_STORE(&queue->read_pos,
+         spsc_queue_advance(queue, read_pos, size));
+
+   return size;
+}
@@ -27,6 +27,7 @@
 #include <queues/task_queue.h>
 
 #include <features/features_cpu.h>
+#include <features/features_trace.h>
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
@@ -226,8 +227,12 @@ static void retro_task_regular_gather(void)
 
       if (!task->when || task->when < cpu_features_get_time_usec())
       {
+         retro_time_t trace_start = TRACE_EVENT_BEGIN();
+
          task->handler(task);
 
+         TRACE_EVENT_END("task_handler", trace_start);
+
          task_queue_push_progress(task);
       }
 
@@ -476,10 +481,13 @@ static void retro_task_threaded_retrieve(task_retriever_data_t *data)
 
 static void threaded_worker(void *userdata)
 {
+   bool trace_named = false;
+
    for (;;)
    {
-      retro_task_t *task  = NULL;
-      bool       finished = false;
+      retro_task_t *task       = NULL;
+      bool       finished      = false;
+      retro_time_t trace_start = 0;
 
       if (!worker_continue)
          break; /* should we keep running until all tasks finished? */
@@ -508,8 +516,18 @@ static void threaded_worker(void *userdata)
 
       slock_unlock(running_lock);
 
+      if (trace_event_enabled)
+      {
+         if (!trace_named)
+            trace_event_set_thread_name("Task worker");
+         trace_named = true;
+         trace_start = TRACE_EVENT_BEGIN();
+      }
+
       task->handler(task);
 
+      TRACE_EVENT_END("task_handler", trace_start);
+
       slock_lock(property_lock);
       finished = task->finished;
       slock_unlock(property_lock);
@@ -0,0 +1,235 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (crc32_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Checks every CRC32 implementation this CPU can run
+ * against zlib's crc32() over all short lengths, random
+ * lengths, alignments and split points, then reports the
+ * throughput of each over a large buffer:
+ *
+ *    crc32_bench -n 20 -s 64
+ *
+ * Exits with a non-zero status on any mismatch. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zlib.h>
+
+/* Built into this file so the implementations that
+ * encoding_crc32() would not pick here can be run too */
+#include "../../../encodings/encoding_crc32.c"
+
+/* Only used for timing */
+#include <features/features_cpu.h>
+
+struct bench_impl
+{
+   const char *name;
+   uint32_t (*update)(uint32_t crc, const uint8_t *buf, size_t len);
+};
+
+static uint32_t bench_crc32_bytewise(uint32_t crc,
+      const uint8_t *buf, size_t len)
+{
+#if __ARM_FEATURE_CRC32
+   return ~encoding_crc32(~crc, buf, len);
+#else
+   while (len--)
+      crc = crc32_table[0][(crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
+   return crc;
+#endif
+}
+
+static uint32_t bench_crc32_zlib(uint32_t crc,
+      const uint8_t *buf, size_t len)
+{
+   return ~(uint32_t)crc32(~crc, buf, (uInt)len);
+}
+
+static uint32_t bench_crc32_dispatch(uint32_t crc,
+      const uint8_t *buf, size_t len)
+{
+   return ~encoding_crc32(~crc, buf, len);
+}
+
+static uint32_t bench_rand_state = 1;
+
+static uint32_t bench_rand(void)
+{
+   bench_rand_state = bench_rand_state * 1103515245 + 12345;
+   return bench_rand_state >> 8;
+}
+
+static size_t bench_get_impls(struct bench_impl *impls)
+{
+   size_t count = 0;
+#ifdef HAVE_CRC32_CLMUL
+   unsigned features = crc32_cpu_features();
+#endif
+
+   impls[count].name   = "bytewise";
+   impls[count].update = bench_crc32_bytewise;
+   count++;
+#if !__ARM_FEATURE_CRC32
+   impls[count].name   = "slice16";
+   impls[count].update = crc32_slice16;
+   count++;
+#endif
+#ifdef HAVE_CRC32_CLMUL
+   if (features & CRC32_CPU_CLMUL)
+   {
+      impls[count].name   = "pclmul";
+      impls[count].update = crc32_update_clmul;
+      count++;
+   }
+#ifdef HAVE_CRC32_VCLMUL
+   if (features & CRC32_CPU_VCLMUL)
+   {
+      impls[count].name   = "vpclmul";
+      impls[count].update = crc32_update_vclmul;
+      count++;
+   }
+#endif
+#endif
+   impls[count].name   = "encoding_crc32";
+   impls[count].update = bench_crc32_dispatch;
+   count++;
+
+   return count;
+}
+
+static unsigned bench_check(const struct bench_impl *impl,
+      const uint8_t *data, size_t size)
+{
+   size_t i;
+   unsigned errors = 0;
+
+   /* Every length up to a few folding blocks, at every
+    * alignment within a cache line */
+   for (i = 0; i <= 1024 && i + 64 <= size; i++)
+   {
+      size_t align;
+      for (align = 0; align < 64; align++)
+      {
+         uint32_t ref = (uint32_t)crc32(0, data + align, (uInt)i);
+         if (~impl->update(~0U, data + align, i) != ref)
+         {
+            if (errors++ < 8)
+               printf("   %s: mismatch at length %u, offset %u\n",
+                     impl->name, (unsigned)i, (unsigned)align);
+         }
+      }
+   }
+
+   /* Random spans, hashed in one go and in two parts */
+   for (i = 0; i < 2000; i++)
+   {
+      size_t len   = bench_rand() % (size < 1048576 ? size : 1048576);
+      size_t start = bench_rand() % (size - len + 1);
+      size_t split = len ? bench_rand() % len : 0;
+      uint32_t ref = (uint32_t)crc32(0, data + start, (uInt)len);
+      uint32_t crc = impl->update(~0U, data + start, split);
+      crc          = impl->update(crc, data + start + split, len - split);
+
+      if (     ~impl->update(~0U, data + start, len) != ref
+            || ~crc != ref)
+      {
+         if (errors++ < 8)
+            printf("   %s: mismatch at length %u, offset %u, split %u\n",
+                  impl->name, (unsigned)len, (unsigned)start,
+                  (unsigned)split);
+      }
+   }
+
+   return errors;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   size_t j;
+   size_t num_impls;
+   struct bench_impl impls[8];
+   uint8_t *data       = NULL;
+   size_t size         = 0;
+   int iterations      = 10;
+   unsigned size_mb    = 64;
+   unsigned errors     = 0;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+         size_mb    = (unsigned)atoi(argv[++i]);
+      else
+      {
+         fprintf(stderr, "Usage: %s [-n iterations] [-s buffer MB]\n",
+               argv[0]);
+         return 1;
+      }
+   }
+
+   if (iterations < 1 || size_mb < 1)
+      return 1;
+
+   size = (size_t)size_mb << 20;
+   if (!(data = (uint8_t*)malloc(size)))
+      return 1;
+
+   for (j = 0; j < size; j++)
+      data[j] = (uint8_t)(bench_rand() >> 4);
+
+   num_impls = bench_get_impls(impls);
+
+   impls[num_impls].name   = "zlib";
+   impls[num_impls].update = bench_crc32_zlib;
+
+   for (j = 0; j <= num_impls; j++)
+   {
+      int k;
+      retro_time_t start, elapsed;
+      uint32_t crc         = 0;
+      unsigned impl_errors = (j < num_impls)
+         ? bench_check(&impls[j], data, size) : 0;
+
+      start = cpu_features_get_time_usec();
+      for (k = 0; k < iterations; k++)
+         crc = ~impls[j].update(~0U, data, size);
+      elapsed = cpu_features_get_time_usec() - start;
+
+      if (elapsed < 1)
+         elapsed = 1;
+
+      printf("%-16s %08x %9.1f MB/s %s\n", impls[j].name, crc,
+            (double)size * iterations / elapsed,
+            impl_errors ? "FAILED" : "ok");
+
+      errors += impl_errors;
+   }
+
+   free(data);
+
+   return errors ? 1 : 0;
+}
@@ -62,8 +62,52 @@ static void nbio_read_test(void)
    nbio_free(read);
 }
 
+/* Several loads in flight at once, the way a burst
+ * of thumbnail tasks drives the backend */
+static void nbio_concurrent_read_test(void)
+{
+   int i;
+   bool done;
+   struct nbio_t* reads[8];
+
+   for (i = 0; i < 8; i++)
+   {
+      if (!(reads[i] = nbio_open("test.bin", NBIO_READ)))
+         puts("[ERROR]: nbio_open failed (3)");
+      else
+         nbio_begin_read(reads[i]);
+   }
+
+   do
+   {
+      done = true;
+      for (i = 0; i < 8; i++)
+         if (reads[i] && !nbio_iterate(reads[i]))
+            done = false;
+   } while (!done);
+
+   for (i = 0; i < 8; i++)
+   {
+      size_t size;
+      char *ptr = NULL;
+
+      if (!reads[i])
+         continue;
+
+      ptr = (char*)nbio_get_ptr(reads[i], &size);
+      if (!ptr || size != 1024*1024 || *ptr != 0x42
+            || memcmp(ptr, ptr+1, 1024*1024-1))
+         puts("[ERROR]: wrong data (concurrent)");
+
+      nbio_free(reads[i]);
+   }
+
+   puts("[SUCCESS]: Concurrent reads finished.");
+}
+
 int main(void)
 {
    nbio_write_test();
    nbio_read_test();
+   nbio_concurrent_read_test();
 }
@@ -0,0 +1,285 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rpng_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Decodes a corpus of PNG files (e.g. a thumbnail directory)
+ * repeatedly and reports throughput, so changes to inflate,
+ * unfiltering or pixel conversion in rpng can be measured:
+ *
+ *    cd Named_Boxarts && rpng_bench -n 10 *.png
+ *
+ * With -c a CRC32 of every decoded image is printed instead,
+ * which allows comparing the output of two builds.
+ *
+ * With -e the decoded images are encoded again instead (-f for
+ * the fast encoder), timing only the encoder and checking that
+ * every encoded file decodes back to the same pixels. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <formats/rpng.h>
+#include <formats/image.h>
+#include <streams/file_stream.h>
+
+struct bench_file
+{
+   const char *path;
+   void *buf;
+   int64_t len;
+};
+
+static bool bench_decode(const struct bench_file *file,
+      uint32_t **data, unsigned *width, unsigned *height)
+{
+   int retval;
+   bool ret     = false;
+   rpng_t *rpng = rpng_alloc();
+
+   *data        = NULL;
+
+   if (!rpng)
+      return false;
+
+   if (     !rpng_set_buf_ptr(rpng, (uint8_t*)file->buf, (size_t)file->len)
+         || !rpng_start(rpng))
+      goto end;
+
+   while (rpng_iterate_image(rpng));
+
+   if (!rpng_is_valid(rpng))
+      goto end;
+
+   do
+   {
+      retval = rpng_process_image(rpng,
+            (void**)data, (size_t)file->len, width, height);
+   } while (retval == IMAGE_PROCESS_NEXT);
+
+   ret = (retval != IMAGE_PROCESS_ERROR
+         && retval != IMAGE_PROCESS_ERROR_END);
+
+end:
+   rpng_free(rpng);
+   if (!ret)
+   {
+      free(*data);
+      *data = NULL;
+   }
+   return ret;
+}
+
+static bool bench_encode(const char *out_path,
+      const uint32_t *data, unsigned width, unsigned height,
+      unsigned flags, retro_time_t *elapsed, int64_t *out_len)
+{
+   struct bench_file encoded;
+   uint32_t *round_trip = NULL;
+   unsigned rt_width    = 0;
+   unsigned rt_height   = 0;
+   bool ret             = false;
+   retro_time_t start   = cpu_features_get_time_usec();
+
+   if (!rpng_save_image_argb_flags(out_path, data, width, height,
+            width * sizeof(uint32_t), flags))
+      return false;
+
+   *elapsed        += cpu_features_get_time_usec() - start;
+
+   encoded.path     = out_path;
+   encoded.buf      = NULL;
+   if (!filestream_read_file(out_path, &encoded.buf, &encoded.len))
+      return false;
+   *out_len        += encoded.len;
+
+   if (     bench_decode(&encoded, &round_trip, &rt_width, &rt_height)
+         && rt_width  == width
+         && rt_height == height)
+      ret = !memcmp(round_trip, data, width * height * sizeof(uint32_t));
+
+   free(round_trip);
+   free(encoded.buf);
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   int i, j;
+   retro_time_t start, elapsed;
+   struct bench_file *files = NULL;
+   int num_files            = 0;
+   int iterations           = 5;
+   bool checksum            = false;
+   bool encode              = false;
+   unsigned encode_flags    = 0;
+   const char *out_path     = "rpng_bench_out.png";
+   uint64_t in_bytes        = 0;
+   uint64_t out_bytes       = 0;
+   unsigned failures        = 0;
+
+   for (i = 1; i < argc && argv[i][0] == '-'; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-c"))
+         checksum     = true;
+      else if (!strcmp(argv[i], "-e"))
+         encode       = true;
+      else if (!strcmp(argv[i], "-f"))
+      {
+         encode       = true;
+         encode_flags = RPNG_SAVE_FLAG_FAST;
+      }
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+         out_path     = argv[++i];
+      else
+         break;
+   }
+
+   if (i >= argc || iterations < 1)
+   {
+      fprintf(stderr, "Usage: %s [-n iterations] [-c | -e | -f] "
+            "[-o out.png] <png files...>\n", argv[0]);
+      return 1;
+   }
+
+   if (!(files = (struct bench_file*)calloc(argc - i, sizeof(*files))))
+      return 1;
+
+   /* Load everything up front so only decoding is timed */
+   for (; i < argc; i++)
+   {
+      struct bench_file *file = &files[num_files];
+
+      file->path = argv[i];
+      if (!filestream_read_file(file->path, &file->buf, &file->len)
+            || file->len <= 0)
+      {
+         fprintf(stderr, "Could not read %s, skipping.\n", file->path);
+         continue;
+      }
+      num_files++;
+   }
+
+   if (checksum)
+   {
+      for (i = 0; i < num_files; i++)
+      {
+         uint32_t *data = NULL;
+         unsigned width = 0, height = 0;
+
+         if (bench_decode(&files[i], &data, &width, &height))
+            printf("%08x %ux%u %s\n",
+                  encoding_crc32(0, (const uint8_t*)data,
+                     width * height * sizeof(uint32_t)),
+                  width, height, files[i].path);
+         else
+            printf("-------- failed %s\n", files[i].path);
+         free(data);
+      }
+      goto end;
+   }
+
+   if (encode)
+   {
+      int64_t out_len = 0;
+
+      elapsed         = 0;
+
+      for (i = 0; i < num_files; i++)
+      {
+         uint32_t *data = NULL;
+         unsigned width = 0, height = 0;
+
+         if (!bench_decode(&files[i], &data, &width, &height))
+            continue;
+
+         for (j = 0; j < iterations; j++)
+         {
+            if (!bench_encode(out_path, data, width, height,
+                     encode_flags, &elapsed, &out_len))
+            {
+               fprintf(stderr, "Round trip failed: %s\n", files[i].path);
+               failures++;
+               break;
+            }
+            in_bytes  += files[i].len;
+            out_bytes += (uint64_t)width * height * sizeof(uint32_t);
+         }
+         free(data);
+      }
+
+      if (elapsed < 1)
+         elapsed = 1;
+
+      printf("%d files x %d iterations encoded in %.3f s (%u failed)\n",
+            num_files, iterations, elapsed / 1000000.0, failures);
+      printf("  %.1f MB/s ARGB in, output %.1f%% of the original files\n",
+            out_bytes / (double)elapsed,
+            in_bytes ? 100.0 * out_len / in_bytes : 0.0);
+      goto end;
+   }
+
+   start = cpu_features_get_time_usec();
+
+   for (j = 0; j < iterations; j++)
+   {
+      for (i = 0; i < num_files; i++)
+      {
+         uint32_t *data = NULL;
+         unsigned width = 0, height = 0;
+
+         if (!bench_decode(&files[i], &data, &width, &height))
+         {
+            failures++;
+            continue;
+         }
+
+         in_bytes  += files[i].len;
+         out_bytes += (uint64_t)width * height * sizeof(uint32_t);
+         free(data);
+      }
+   }
+
+   elapsed = cpu_features_get_time_usec() - start;
+   if (elapsed < 1)
+      elapsed = 1;
+
+   printf("%d files x %d iterations in %.3f s (%u failed)\n",
+         num_files, iterations, elapsed / 1000000.0, failures);
+   printf("  %.1f images/s\n",
+         (double)(num_files * iterations - (int)failures)
+         * 1000000.0 / elapsed);
+   printf("  %.1f MB/s compressed in, %.1f MB/s ARGB out\n",
+         in_bytes  / (double)elapsed,
+         out_bytes / (double)elapsed);
+
+end:
+   for (i = 0; i < num_files; i++)
+      free(files[i].buf);
+   free(files);
+
+   return failures ? 1 : 0;
+}
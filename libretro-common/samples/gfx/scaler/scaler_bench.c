@@ -0,0 +1,284 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (scaler_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Runs every pixel format pair and filter type the software
+ * scaler supports over a synthetic frame and reports the
+ * throughput of each, so SIMD and threading changes in
+ * gfx/scaler can be measured:
+ *
+ *    scaler_bench -n 50 -s 1280x720 -t 4
+ *
+ * With -c every case runs once and a CRC32 of its output is
+ * printed instead, which allows comparing the output of two
+ * builds (or of -t 1 against -t N). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <gfx/scaler/scaler.h>
+
+struct bench_case
+{
+   enum scaler_pix_fmt in_fmt;
+   enum scaler_pix_fmt out_fmt;
+   enum scaler_type type;
+   int out_num;   /* Output size is input size * out_num / out_den */
+   int out_den;
+};
+
+static const char *bench_fmt_names[] = {
+   "ARGB8888", "ABGR8888", "0RGB1555", "RGB565",
+   "BGR24", "YUYV", "RGBA4444"
+};
+
+static const char *bench_type_names[] = {
+   "none", "point", "bilinear", "sinc"
+};
+
+static const int bench_fmt_bpp[] = { 4, 4, 2, 2, 3, 2, 2 };
+
+/* Conversions scaler_ctx_gen_filter() accepts
+ * when input and output sizes are equal. */
+static const enum scaler_pix_fmt bench_direct_pairs[][2] = {
+   { SCALER_FMT_0RGB1555, SCALER_FMT_ARGB8888 },
+   { SCALER_FMT_0RGB1555, SCALER_FMT_RGB565   },
+   { SCALER_FMT_0RGB1555, SCALER_FMT_BGR24    },
+   { SCALER_FMT_RGB565,   SCALER_FMT_ARGB8888 },
+   { SCALER_FMT_RGB565,   SCALER_FMT_ABGR8888 },
+   { SCALER_FMT_RGB565,   SCALER_FMT_BGR24    },
+   { SCALER_FMT_RGB565,   SCALER_FMT_0RGB1555 },
+   { SCALER_FMT_BGR24,    SCALER_FMT_ARGB8888 },
+   { SCALER_FMT_ARGB8888, SCALER_FMT_0RGB1555 },
+   { SCALER_FMT_ARGB8888, SCALER_FMT_BGR24    },
+   { SCALER_FMT_ARGB8888, SCALER_FMT_ABGR8888 },
+   { SCALER_FMT_ARGB8888, SCALER_FMT_RGBA4444 },
+   { SCALER_FMT_ARGB8888, SCALER_FMT_ARGB8888 },
+   { SCALER_FMT_YUYV,     SCALER_FMT_ARGB8888 },
+   { SCALER_FMT_RGBA4444, SCALER_FMT_ARGB8888 },
+   { SCALER_FMT_RGBA4444, SCALER_FMT_RGB565   },
+   { SCALER_FMT_ABGR8888, SCALER_FMT_BGR24    }
+};
+
+/* Formats the filtered path converts from and to */
+static const enum scaler_pix_fmt bench_scaled_in[] = {
+   SCALER_FMT_ARGB8888, SCALER_FMT_0RGB1555, SCALER_FMT_RGB565,
+   SCALER_FMT_BGR24, SCALER_FMT_RGBA4444
+};
+
+static const enum scaler_pix_fmt bench_scaled_out[] = {
+   SCALER_FMT_ARGB8888, SCALER_FMT_ABGR8888, SCALER_FMT_0RGB1555,
+   SCALER_FMT_BGR24, SCALER_FMT_RGBA4444
+};
+
+static uint32_t bench_rand(uint32_t *state)
+{
+   *state = *state * 1664525u + 1013904223u;
+   return *state >> 8;
+}
+
+/* Smooth gradients with some noise on top, so both the
+ * filters and the saturating paths get exercised. */
+static void bench_fill(uint8_t *buf, int width, int height, int pitch)
+{
+   int x, y;
+   uint32_t seed = 0x5ca1e;
+
+   for (y = 0; y < height; y++)
+   {
+      uint8_t *row = buf + y * pitch;
+      for (x = 0; x < pitch; x++)
+      {
+         uint32_t noise = bench_rand(&seed);
+         row[x] = (uint8_t)(((x * 3 + y * 2) & 0xff) ^ (noise & 0x1f)
+               ^ ((noise & 0x3f00) == 0 ? 0xff : 0));
+      }
+   }
+}
+
+static bool bench_run(const struct bench_case *bc,
+      const uint8_t *input, int in_width, int in_height,
+      unsigned threads, int iterations, bool checksum)
+{
+   int i, y;
+   retro_time_t start, elapsed;
+   struct scaler_ctx ctx;
+   uint8_t *output  = NULL;
+   int out_width    = in_width  * bc->out_num / bc->out_den;
+   int out_height   = in_height * bc->out_num / bc->out_den;
+   int out_pitch    = out_width * bench_fmt_bpp[bc->out_fmt];
+   bool ret         = false;
+
+   memset(&ctx, 0, sizeof(ctx));
+   ctx.in_width     = in_width;
+   ctx.in_height    = in_height;
+   ctx.in_stride    = in_width * bench_fmt_bpp[bc->in_fmt];
+   ctx.out_width    = out_width;
+   ctx.out_height   = out_height;
+   ctx.out_stride   = out_pitch;
+   ctx.in_fmt       = bc->in_fmt;
+   ctx.out_fmt      = bc->out_fmt;
+   ctx.scaler_type  = bc->type == SCALER_TYPE_UNKNOWN
+      ? SCALER_TYPE_POINT : bc->type;
+   ctx.threads      = threads;
+
+   if (!scaler_ctx_gen_filter(&ctx))
+   {
+      printf("%-8s -> %-8s %-8s  not supported\n",
+            bench_fmt_names[bc->in_fmt], bench_fmt_names[bc->out_fmt],
+            bench_type_names[bc->type]);
+      goto end;
+   }
+
+   if (!(output = (uint8_t*)calloc(out_height, out_pitch)))
+      goto end;
+
+   if (checksum)
+      iterations = 1;
+
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < iterations; i++)
+      scaler_ctx_scale(&ctx, output, input);
+   elapsed = cpu_features_get_time_usec() - start;
+   if (elapsed < 1)
+      elapsed = 1;
+
+   if (checksum)
+   {
+      uint32_t crc = 0;
+      for (y = 0; y < out_height; y++)
+         crc = encoding_crc32(crc, output + y * out_pitch, out_pitch);
+      printf("%08x %-8s -> %-8s %-8s %dx%d\n", crc,
+            bench_fmt_names[bc->in_fmt], bench_fmt_names[bc->out_fmt],
+            bench_type_names[bc->type], out_width, out_height);
+   }
+   else
+      printf("%-8s -> %-8s %-8s %4dx%-4d %8.1f Mpix/s\n",
+            bench_fmt_names[bc->in_fmt], bench_fmt_names[bc->out_fmt],
+            bench_type_names[bc->type], out_width, out_height,
+            (double)out_width * out_height * iterations / elapsed);
+
+   ret = true;
+
+end:
+   scaler_ctx_gen_reset(&ctx);
+   free(output);
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   int i, j, k;
+   struct bench_case bc;
+   uint8_t *input        = NULL;
+   int width             = 1280;
+   int height            = 720;
+   int iterations        = 20;
+   unsigned threads      = 1;
+   bool checksum         = false;
+   unsigned failures     = 0;
+   /* Upscale by 3/2 and downscale by 1/2 */
+   static const int ratios[][2] = { { 3, 2 }, { 1, 2 } };
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+         threads    = (unsigned)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+      {
+         if (sscanf(argv[++i], "%dx%d", &width, &height) != 2)
+            width = 0;
+      }
+      else if (!strcmp(argv[i], "-c"))
+         checksum   = true;
+      else
+         width      = 0;
+   }
+
+   if (width < 2 || height < 2 || iterations < 1 || threads < 1)
+   {
+      fprintf(stderr, "Usage: %s [-n iterations] [-s WxH] "
+            "[-t threads] [-c]\n", argv[0]);
+      return 1;
+   }
+
+   /* YUYV works on pixel pairs */
+   width &= ~1;
+
+   if (threads > 1 && !scaler_thread_pool_init(threads - 1))
+      fprintf(stderr, "Could not create the scaler thread pool, "
+            "running single-threaded.\n");
+
+   /* Large enough for the widest input format */
+   if (!(input = (uint8_t*)malloc((size_t)width * height * 4)))
+      return 1;
+
+   bench_fill(input, width, height, width * 4);
+
+   bc.type    = SCALER_TYPE_UNKNOWN;
+   bc.out_num = 1;
+   bc.out_den = 1;
+   for (i = 0; i < (int)(sizeof(bench_direct_pairs)
+            / sizeof(bench_direct_pairs[0])); i++)
+   {
+      bc.in_fmt  = bench_direct_pairs[i][0];
+      bc.out_fmt = bench_direct_pairs[i][1];
+      if (!bench_run(&bc, input, width, height,
+               threads, iterations, checksum))
+         failures++;
+   }
+
+   for (k = SCALER_TYPE_POINT; k <= SCALER_TYPE_SINC; k++)
+   {
+      for (j = 0; j < (int)(sizeof(ratios) / sizeof(ratios[0])); j++)
+      {
+         bc.type    = (enum scaler_type)k;
+         bc.out_num = ratios[j][0];
+         bc.out_den = ratios[j][1];
+
+         for (i = 0; i < (int)(sizeof(bench_scaled_in)
+                  / sizeof(bench_scaled_in[0])); i++)
+         {
+            int l;
+            bc.in_fmt = bench_scaled_in[i];
+            for (l = 0; l < (int)(sizeof(bench_scaled_out)
+                     / sizeof(bench_scaled_out[0])); l++)
+            {
+               bc.out_fmt = bench_scaled_out[l];
+               if (!bench_run(&bc, input, width, height,
+                        threads, iterations, checksum))
+                  failures++;
+            }
+         }
+      }
+   }
+
+   free(input);
+   scaler_thread_pool_deinit();
+
+   return failures ? 1 : 0;
+}
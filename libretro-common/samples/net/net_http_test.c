@@ -20,7 +20,20 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+/* Fetches every URL given on the command line, -n times over,
+ * and prints the status, size and time of each request. Run
+ * against a local server to see kept-alive connections being
+ * reused (only the first request per host connects):
+ *
+ *    python3 -m http.server --protocol HTTP/1.1 8000 &
+ *    http_test -n 5 http://127.0.0.1:8000/ */
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+#include <lists/string_list.h>
 #include <net/net_http.h>
 #include <net/net_compat.h>
 
@@ -28,29 +41,74 @@
 #include <winsock2.h>
 #endif
 
-int main(void)
+static bool http_test_fetch(const char *url)
 {
-   char   *data;
-   struct http_t *http1, *http3;
-   size_t len, pos = 0, tot = 0;
+   size_t len                     = 0;
+   uint8_t *data                  = NULL;
+   struct http_t *http            = NULL;
+   retro_time_t start             = cpu_features_get_time_usec();
+   struct http_connection_t *conn = net_http_connection_new(url, "GET", NULL);
 
-   if (!network_init())
-      return -1;
+   if (!conn)
+      return false;
 
-   http1 = net_http_new("http://buildbot.libretro.com/nightly/windows/x86_64/latest/mednafen_psx_libretro.dll.zip");
+   while (!net_http_connection_iterate(conn)) {}
 
-   while (!net_http_update(http1, &pos, &tot))
-      printf("%.9lu / %.9lu        \r",pos,tot);
+   if (!net_http_connection_done(conn) || !(http = net_http_new(conn)))
+   {
+      printf("%s: could not connect\n", url);
+      net_http_connection_free(conn);
+      return false;
+   }
 
-   http3 = net_http_new("http://www.wikipedia.org/");
-   while (!net_http_update(http3, NULL, NULL)) {}
+   while (!net_http_update(http, NULL, NULL)) {}
+
+   data = net_http_data(http, &len, true);
+   printf("%3d %8u bytes %8.3f ms %s\n", net_http_status(http),
+         (unsigned)len,
+         (cpu_features_get_time_usec() - start) / 1000.0, url);
+
+   free(data);
+   string_list_free(net_http_headers(http));
+   net_http_delete(http);
+   net_http_connection_free(conn);
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   int i, j;
+   int count         = 1;
+   unsigned failures = 0;
+
+   for (i = 1; i < argc && argv[i][0] == '-'; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         count = atoi(argv[++i]);
+      else
+         break;
+   }
+
+   if (i >= argc || count < 1)
+   {
+      fprintf(stderr, "Usage: %s [-n count] <urls...>\n", argv[0]);
+      return 1;
+   }
+
+   if (!network_init())
+      return 1;
 
-   data  = (char*)net_http_data(http3, &len, false);
+   net_http_pool_init();
 
-   printf("%.*s\n", (int)256, data);
+   for (j = 0; j < count; j++)
+   {
+      int k;
+      for (k = i; k < argc; k++)
+         if (!http_test_fetch(argv[k]))
+            failures++;
+   }
 
-   net_http_delete(http1);
-   net_http_delete(http3);
+   net_http_pool_free();
 
-   return 0;
+   return failures ? 1 : 0;
 }
@@ -0,0 +1,305 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue_test.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Streams a byte sequence from the main thread to a second
+ * thread through spsc_queue_t, in randomly sized writes and
+ * reads, and checks it arrives intact. Both sides block on a
+ * condition variable when the queue is full or empty, the
+ * same way the threaded audio drivers do. The same run is
+ * then made through a fifo_buffer_t guarded by a mutex for
+ * comparison, reporting throughput and how long single
+ * writes and reads took:
+ *
+ *    spsc_queue_test -s 256 -q 4096 -c 512
+ *
+ * Exits with a non-zero status if any byte is wrong. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rthreads/rthreads.h>
+#include <queues/fifo_queue.h>
+#include <queues/spsc_queue.h>
+#include <features/features_cpu.h>
+
+typedef struct test_ctx
+{
+   spsc_queue_t *spsc;
+   fifo_buffer_t *fifo;
+   slock_t *fifo_lock;
+   slock_t *cond_lock;
+   scond_t *cond;
+   uint64_t total;
+   size_t max_chunk;
+   unsigned errors;
+
+   /* Time spent in single writes and reads, in usec */
+   retro_time_t write_max;
+   retro_time_t read_max;
+   uint64_t writes;
+   uint64_t reads;
+} test_ctx_t;
+
+static uint8_t test_byte(uint64_t pos)
+{
+   return (uint8_t)(pos * 131 + (pos >> 9));
+}
+
+static size_t test_rand(uint32_t *state, size_t max)
+{
+   *state = *state * 1103515245 + 12345;
+   return 1 + (*state >> 8) % max;
+}
+
+static size_t test_write(test_ctx_t *ctx, const uint8_t *buf, size_t size)
+{
+   size_t written;
+
+   if (ctx->spsc)
+      return spsc_queue_write(ctx->spsc, buf, size);
+
+   slock_lock(ctx->fifo_lock);
+   written = FIFO_WRITE_AVAIL(ctx->fifo);
+   if (written > size)
+      written = size;
+   fifo_write(ctx->fifo, buf, written);
+   slock_unlock(ctx->fifo_lock);
+
+   return written;
+}
+
+static size_t test_read(test_ctx_t *ctx, uint8_t *buf, size_t size)
+{
+   size_t read;
+
+   if (ctx->spsc)
+      return spsc_queue_read(ctx->spsc, buf, size);
+
+   slock_lock(ctx->fifo_lock);
+   read = FIFO_READ_AVAIL(ctx->fifo);
+   if (read > size)
+      read = size;
+   fifo_read(ctx->fifo, buf, read);
+   slock_unlock(ctx->fifo_lock);
+
+   return read;
+}
+
+static bool test_is_full(test_ctx_t *ctx)
+{
+   bool full;
+
+   if (ctx->spsc)
+      return !spsc_queue_write_avail(ctx->spsc);
+
+   slock_lock(ctx->fifo_lock);
+   full = !FIFO_WRITE_AVAIL(ctx->fifo);
+   slock_unlock(ctx->fifo_lock);
+
+   return full;
+}
+
+static bool test_is_empty(test_ctx_t *ctx)
+{
+   bool empty;
+
+   if (ctx->spsc)
+      return !spsc_queue_read_avail(ctx->spsc);
+
+   slock_lock(ctx->fifo_lock);
+   empty = !FIFO_READ_AVAIL(ctx->fifo);
+   slock_unlock(ctx->fifo_lock);
+
+   return empty;
+}
+
+static void test_signal(test_ctx_t *ctx)
+{
+   slock_lock(ctx->cond_lock);
+   scond_signal(ctx->cond);
+   slock_unlock(ctx->cond_lock);
+}
+
+static void test_consumer(void *data)
+{
+   test_ctx_t *ctx = (test_ctx_t*)data;
+   uint8_t *buf    = (uint8_t*)malloc(ctx->max_chunk);
+   uint32_t seed   = 2;
+   uint64_t pos    = 0;
+
+   if (!buf)
+   {
+      ctx->errors++;
+      return;
+   }
+
+   while (pos < ctx->total)
+   {
+      size_t i;
+      retro_time_t start = cpu_features_get_time_usec();
+      size_t read        = test_read(ctx, buf,
+            test_rand(&seed, ctx->max_chunk));
+      retro_time_t time  = cpu_features_get_time_usec() - start;
+
+      if (time > ctx->read_max)
+         ctx->read_max = time;
+      ctx->reads++;
+
+      if (!read)
+      {
+         slock_lock(ctx->cond_lock);
+         if (test_is_empty(ctx))
+            scond_wait(ctx->cond, ctx->cond_lock);
+         slock_unlock(ctx->cond_lock);
+         continue;
+      }
+
+      for (i = 0; i < read; i++, pos++)
+      {
+         if (buf[i] != test_byte(pos) && ctx->errors++ < 8)
+            printf("   mismatch at byte %llu\n", (unsigned long long)pos);
+      }
+
+      test_signal(ctx);
+   }
+
+   free(buf);
+}
+
+static unsigned test_run(const char *name, test_ctx_t *ctx)
+{
+   sthread_t *thread;
+   retro_time_t start, elapsed;
+   uint8_t *buf  = (uint8_t*)malloc(ctx->max_chunk);
+   uint32_t seed = 1;
+   uint64_t pos  = 0;
+
+   if (     !buf
+         || !(ctx->cond_lock = slock_new())
+         || !(ctx->cond      = scond_new())
+         || !(thread         = sthread_create(test_consumer, ctx)))
+      return 1;
+
+   start = cpu_features_get_time_usec();
+
+   while (pos < ctx->total)
+   {
+      size_t i;
+      retro_time_t write_start, time;
+      size_t size = test_rand(&seed, ctx->max_chunk);
+      size_t written;
+
+      if (size > ctx->total - pos)
+         size = (size_t)(ctx->total - pos);
+      for (i = 0; i < size; i++)
+         buf[i] = test_byte(pos + i);
+
+      write_start = cpu_features_get_time_usec();
+      written     = test_write(ctx, buf, size);
+      time        = cpu_features_get_time_usec() - write_start;
+
+      if (time > ctx->write_max)
+         ctx->write_max = time;
+      ctx->writes++;
+
+      /* Written bytes are regenerated for the next write */
+      pos += written;
+
+      if (written)
+         test_signal(ctx);
+      else
+      {
+         slock_lock(ctx->cond_lock);
+         if (test_is_full(ctx))
+            scond_wait(ctx->cond, ctx->cond_lock);
+         slock_unlock(ctx->cond_lock);
+      }
+   }
+
+   sthread_join(thread);
+   elapsed = cpu_features_get_time_usec() - start;
+   if (elapsed < 1)
+      elapsed = 1;
+
+   printf("%-12s %8.1f MB/s, %9llu writes (max %5lld usec), "
+         "%9llu reads (max %5lld usec) %s\n",
+         name, (double)ctx->total / elapsed,
+         (unsigned long long)ctx->writes, (long long)ctx->write_max,
+         (unsigned long long)ctx->reads, (long long)ctx->read_max,
+         ctx->errors ? "FAILED" : "ok");
+
+   scond_free(ctx->cond);
+   slock_free(ctx->cond_lock);
+   free(buf);
+
+   return ctx->errors;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   test_ctx_t ctx;
+   unsigned errors     = 0;
+   unsigned size_mb    = 256;
+   size_t queue_size   = 4096;
+   size_t max_chunk    = 512;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-s") && i + 1 < argc)
+         size_mb    = (unsigned)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-q") && i + 1 < argc)
+         queue_size = (size_t)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+         max_chunk  = (size_t)atoi(argv[++i]);
+      else
+      {
+         fprintf(stderr, "Usage: %s [-s total MB] [-q queue bytes] "
+               "[-c max chunk bytes]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   if (!size_mb || !queue_size || !max_chunk)
+      return 1;
+
+   memset(&ctx, 0, sizeof(ctx));
+   ctx.total     = (uint64_t)size_mb << 20;
+   ctx.max_chunk = max_chunk;
+   if (!(ctx.spsc = spsc_queue_new(queue_size)))
+      return 1;
+   errors       += test_run("spsc_queue", &ctx);
+   spsc_queue_free(ctx.spsc);
+
+   memset(&ctx, 0, sizeof(ctx));
+   ctx.total     = (uint64_t)size_mb << 20;
+   ctx.max_chunk = max_chunk;
+   if (     !(ctx.fifo      = fifo_new(queue_size))
+         || !(ctx.fifo_lock = slock_new()))
+      return 1;
+   errors       += test_run("fifo + lock", &ctx);
+   slock_free(ctx.fifo_lock);
+   fifo_free(ctx.fifo);
+
+   return errors ? 1 : 0;
+}
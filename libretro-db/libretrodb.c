@@ -32,8 +32,15 @@
 
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
+#include <memmap.h>
+#ifdef HAVE_MMAN
+#include <fcntl.h>
+#endif
 #include <string/stdstring.h>
 #include <compat/strl.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "libretrodb.h"
 #include "rmsgpack_dom.h"
@@ -44,28 +51,72 @@
 
 #define MAGIC_NUMBER "RARCHDB"
 
+#define LIBRETRODB_INDEX_MAX_FIELDS 8
+#define LIBRETRODB_INDEX_MAX_KEY    64
+
+/* FNV-1a */
+#define LIBRETRODB_HASH_SEED        UINT64_C(0xcbf29ce484222325)
+#define LIBRETRODB_HASH_PRIME       UINT64_C(0x100000001b3)
+
+enum libretrodb_index_kind
+{
+   /* Fixed-size binary key with one entry per record (crc, md5...).
+    * Headers of these indexes carry no 'kind' so older readers
+    * still understand them. */
+   LIBRETRODB_INDEX_UNIQUE = 0,
+   /* Big-endian unsigned integer key, answers ranges too */
+   LIBRETRODB_INDEX_ORDERED,
+   /* 64-bit hash over one or more fields, equality only */
+   LIBRETRODB_INDEX_HASHED
+};
+
 struct node_iter_ctx
 {
    libretrodb_t *db;
    libretrodb_index_t *idx;
 };
 
+struct libretrodb_index
+{
+   uint64_t key_size;
+   uint64_t next;
+   uint64_t count;
+   uint64_t offset; /* Start of the entries in the file */
+   unsigned kind;
+   char name[50];
+   char fields[128];
+};
+
+/* Read-only mapping of a whole rdb file. Handles and cursors of
+ * the process opening the same, unchanged file share one mapping. */
+struct libretrodb_mapping
+{
+   struct libretrodb_mapping *next;
+   char *path;
+   const uint8_t *data;
+   int64_t mtime;
+   size_t size;
+   unsigned refs;
+};
+
 struct libretrodb
 {
-   RFILE *fd;
+   RFILE *fd;                 /* NULL when opened read-only and mapped */
    char *path;
-   bool can_write;
+   struct libretrodb_mapping *map;
+   libretrodb_index_t *indexes;
    uint64_t root;
    uint64_t count;
    uint64_t first_index_offset;
+   unsigned index_count;
+   bool can_write;
 };
 
-struct libretrodb_index
+/* One record of a secondary index while it is being built */
+struct libretrodb_index_item
 {
-   char name[50];
-   uint64_t key_size;
-   uint64_t next;
-   uint64_t count;
+   uint64_t key;
+   uint64_t offset;
 };
 
 typedef struct libretrodb_metadata
@@ -81,11 +132,23 @@ typedef struct libretrodb_header
 
 struct libretrodb_cursor
 {
-   RFILE *fd;
+   RFILE *fd;                 /* NULL when the file is mapped */
    libretrodb_query_t *query;
    libretrodb_t *db;
+   struct libretrodb_mapping *mapping;
+   const uint8_t *map;        /* Whole file, if it could be mapped */
+   uint8_t *raw;              /* Encoded bytes of the current record */
+   uint64_t *candidates;      /* Record offsets found through an index */
+   struct rmsgpack_dom_arena arena;
+   uint64_t pos;              /* Offset of the next record */
+   uint64_t item_offset;      /* Offset of the record last returned */
+   size_t map_size;
+   size_t raw_cap;
+   size_t candidate_count;
+   size_t candidate_pos;
    int is_valid;
    int eof;
+   int indexed;
 };
 
 static int libretrodb_validate_document(const struct rmsgpack_dom_value *doc)
@@ -171,31 +234,426 @@ clean:
    return rv;
 }
 
+#ifdef HAVE_MMAN
+static struct libretrodb_mapping *libretrodb_mappings = NULL;
+#ifdef HAVE_THREADS
+static slock_t *libretrodb_mappings_lock              = NULL;
+#endif
+#endif
+
+/**
+ * libretrodb_mappings_init:
+ *
+ * Creates the lock guarding the shared database mappings. Must
+ * be called once, before databases are opened from more than
+ * one thread; single-threaded users can skip it.
+ **/
+void libretrodb_mappings_init(void)
+{
+#if defined(HAVE_MMAN) && defined(HAVE_THREADS)
+   if (!libretrodb_mappings_lock)
+      libretrodb_mappings_lock = slock_new();
+#endif
+}
+
+/**
+ * libretrodb_mappings_deinit:
+ *
+ * Frees the lock created by libretrodb_mappings_init(), once no
+ * database is open anymore.
+ **/
+void libretrodb_mappings_deinit(void)
+{
+#if defined(HAVE_MMAN) && defined(HAVE_THREADS)
+   if (libretrodb_mappings_lock)
+      slock_free(libretrodb_mappings_lock);
+   libretrodb_mappings_lock = NULL;
+#endif
+}
+
+/**
+ * libretrodb_mapping_acquire:
+ * @path                : Path of the database file.
+ *
+ * Returns a reference to a read-only mapping of @path, reusing an
+ * existing one when the file has not changed on disk since it was
+ * mapped. A replaced file (e.g. by the database updater) gets a new
+ * mapping, the old one lives on until its last user releases it.
+ *
+ * Returns: the mapping, or NULL where mmap is unavailable or the path
+ * is not a plain file, callers then read through RFILE.
+ **/
+static struct libretrodb_mapping *libretrodb_mapping_acquire(
+      const char *path)
+{
+#ifdef HAVE_MMAN
+   struct stat st;
+   void *data;
+   int fd;
+   struct libretrodb_mapping *m = NULL;
+
+#ifdef HAVE_THREADS
+   slock_lock(libretrodb_mappings_lock);
+#endif
+
+   if (stat(path, &st) == 0 && st.st_size > 0)
+   {
+      for (m = libretrodb_mappings; m; m = m->next)
+      {
+         if (     m->size  == (size_t)st.st_size
+               && m->mtime == (int64_t)st.st_mtime
+               && string_is_equal(m->path, path))
+         {
+            m->refs++;
+            goto end;
+         }
+      }
+   }
+
+   if ((fd = open(path, O_RDONLY)) < 0)
+      goto end;
+
+   if (fstat(fd, &st) != 0 || st.st_size <= 0)
+   {
+      close(fd);
+      goto end;
+   }
+
+   data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+
+   if (data == MAP_FAILED)
+      goto end;
+
+   if (!(m = (struct libretrodb_mapping*)malloc(sizeof(*m))))
+   {
+      munmap(data, (size_t)st.st_size);
+      goto end;
+   }
+
+   m->path             = strdup(path);
+   m->data             = (const uint8_t*)data;
+   m->size             = (size_t)st.st_size;
+   m->mtime            = (int64_t)st.st_mtime;
+   m->refs             = 1;
+   m->next             = libretrodb_mappings;
+   libretrodb_mappings = m;
+
+end:
+#ifdef HAVE_THREADS
+   slock_unlock(libretrodb_mappings_lock);
+#endif
+   return m;
+#else
+   return NULL;
+#endif
+}
+
+static void libretrodb_mapping_release(struct libretrodb_mapping *m)
+{
+#ifdef HAVE_MMAN
+   struct libretrodb_mapping **prev;
+
+#ifdef HAVE_THREADS
+   slock_lock(libretrodb_mappings_lock);
+#endif
+
+   if (--m->refs == 0)
+   {
+      for (prev = &libretrodb_mappings; *prev; prev = &(*prev)->next)
+      {
+         if (*prev == m)
+         {
+            *prev = m->next;
+            break;
+         }
+      }
+      munmap((void*)m->data, m->size);
+      free(m->path);
+      free(m);
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(libretrodb_mappings_lock);
+#endif
+#endif
+}
+
+static void libretrodb_mapping_ref(struct libretrodb_mapping *m)
+{
+#if defined(HAVE_MMAN) && defined(HAVE_THREADS)
+   slock_lock(libretrodb_mappings_lock);
+   m->refs++;
+   slock_unlock(libretrodb_mappings_lock);
+#else
+   m->refs++;
+#endif
+}
+
 void libretrodb_close(libretrodb_t *db)
 {
    if (db->fd)
       filestream_close(db->fd);
+   if (db->map)
+      libretrodb_mapping_release(db->map);
    if (!string_is_empty(db->path))
       free(db->path);
-   db->path = NULL;
-   db->fd   = NULL;
+   if (db->indexes)
+      free(db->indexes);
+   db->path        = NULL;
+   db->fd          = NULL;
+   db->map         = NULL;
+   db->indexes     = NULL;
+   db->index_count = 0;
+}
+
+static struct rmsgpack_dom_value *libretrodb_map_value(
+      const struct rmsgpack_dom_value *map, const char *name)
+{
+   struct rmsgpack_dom_value key;
+   key.type            = RDT_STRING;
+   key.val.string.len  = (uint32_t)strlen(name);
+   key.val.string.buff = (char*)name;
+   return rmsgpack_dom_value_map_value(map, &key);
+}
+
+static int libretrodb_map_uint(const struct rmsgpack_dom_value *map,
+      const char *name, uint64_t *out)
+{
+   struct rmsgpack_dom_value *value = libretrodb_map_value(map, name);
+
+   if (!value)
+      return -1;
+   if (value->type == RDT_UINT)
+      *out = value->val.uint_;
+   else if (value->type == RDT_INT && value->val.int_ >= 0)
+      *out = (uint64_t)value->val.int_;
+   else
+      return -1;
+   return 0;
+}
+
+static int libretrodb_parse_index_header(
+      const struct rmsgpack_dom_value *map, libretrodb_index_t *idx)
+{
+   uint64_t kind;
+   struct rmsgpack_dom_value *value;
+
+   if (map->type != RDT_MAP)
+      return -1;
+
+   if (     !(value = libretrodb_map_value(map, "name"))
+         || value->type != RDT_STRING)
+      return -1;
+   strlcpy(idx->name, value->val.string.buff, sizeof(idx->name));
+
+   if (     libretrodb_map_uint(map, "key_size", &idx->key_size) < 0
+         || libretrodb_map_uint(map, "next",     &idx->next)     < 0
+         || libretrodb_map_uint(map, "count",    &idx->count)    < 0)
+      return -1;
+
+   /* Unique indexes predate these keys and are named after their field */
+   if (     (value = libretrodb_map_value(map, "fields"))
+         && value->type == RDT_STRING)
+      strlcpy(idx->fields, value->val.string.buff, sizeof(idx->fields));
+   else
+      strlcpy(idx->fields, idx->name, sizeof(idx->fields));
+
+   idx->kind   = LIBRETRODB_INDEX_UNIQUE;
+   if (libretrodb_map_uint(map, "kind", &kind) == 0)
+      idx->kind = (unsigned)kind;
+
+   return 0;
+}
+
+static int libretrodb_read_index_header(RFILE *fd, libretrodb_index_t *idx)
+{
+   struct rmsgpack_dom_value map;
+   int rv;
+
+   if (rmsgpack_dom_read(fd, &map) < 0)
+      return -1;
+
+   if ((rv = libretrodb_parse_index_header(&map, idx)) == 0)
+      idx->offset = filestream_tell(fd);
+
+   rmsgpack_dom_value_free(&map);
+   return rv;
+}
+
+static void libretrodb_write_index_header(RFILE *fd,
+      const libretrodb_index_t *idx)
+{
+   bool secondary = (idx->kind != LIBRETRODB_INDEX_UNIQUE);
+
+   rmsgpack_write_map_header(fd, secondary ? 6 : 4);
+   rmsgpack_write_string(fd, "name", STRLEN_CONST("name"));
+   rmsgpack_write_string(fd, idx->name, (uint32_t)strlen(idx->name));
+   rmsgpack_write_string(fd, "key_size", (uint32_t)STRLEN_CONST("key_size"));
+   rmsgpack_write_uint  (fd, idx->key_size);
+   rmsgpack_write_string(fd, "next", STRLEN_CONST("next"));
+   rmsgpack_write_uint  (fd, idx->next);
+   rmsgpack_write_string(fd, "count", STRLEN_CONST("count"));
+   rmsgpack_write_uint  (fd, idx->count);
+
+   if (secondary)
+   {
+      rmsgpack_write_string(fd, "fields", STRLEN_CONST("fields"));
+      rmsgpack_write_string(fd, idx->fields, (uint32_t)strlen(idx->fields));
+      rmsgpack_write_string(fd, "kind", STRLEN_CONST("kind"));
+      rmsgpack_write_uint  (fd, idx->kind);
+   }
 }
 
+static int libretrodb_add_index(libretrodb_t *db,
+      const libretrodb_index_t *idx)
+{
+   libretrodb_index_t *indexes = (libretrodb_index_t*)realloc(db->indexes,
+         (db->index_count + 1) * sizeof(*indexes));
+
+   if (!indexes)
+      return -1;
+
+   indexes[db->index_count++] = *idx;
+   db->indexes                = indexes;
+   return 0;
+}
+
+/* Reads all index headers once, so cursors can plan without I/O */
+static void libretrodb_load_indexes(libretrodb_t *db)
+{
+   if (db->map)
+   {
+      struct rmsgpack_dom_arena arena;
+      const uint8_t *data = db->map->data;
+      uint64_t size       = db->map->size;
+      uint64_t pos        = db->first_index_offset;
+
+      arena.buff          = NULL;
+      arena.size          = 0;
+      arena.used          = 0;
+
+      while (pos < size)
+      {
+         libretrodb_index_t idx;
+         struct rmsgpack_dom_value map;
+         int64_t len = rmsgpack_dom_view_tree(data + pos, data + size,
+               &arena, &map);
+
+         if (len < 0 || libretrodb_parse_index_header(&map, &idx) < 0)
+            break;
+
+         /* Entries must lie within the mapping, lookups rely on it */
+         idx.offset  = pos + (uint64_t)len;
+         if (     idx.next > size - idx.offset
+               || idx.count * (idx.key_size + sizeof(uint64_t)) > idx.next)
+            break;
+         if (libretrodb_add_index(db, &idx) < 0)
+            break;
+         pos         = idx.offset + idx.next;
+      }
+
+      rmsgpack_dom_arena_free(&arena);
+      return;
+   }
+
+   filestream_seek(db->fd, (int64_t)db->first_index_offset,
+         RETRO_VFS_SEEK_POSITION_START);
+
+   for (;;)
+   {
+      libretrodb_index_t idx;
+
+      if (libretrodb_read_index_header(db->fd, &idx) < 0)
+         break;
+      if (libretrodb_add_index(db, &idx) < 0)
+         break;
+      if (filestream_seek(db->fd, (int64_t)(idx.offset + idx.next),
+               RETRO_VFS_SEEK_POSITION_START) < 0)
+         break;
+   }
+}
+
+/* Reads the header and metadata of a mapped database */
+static int libretrodb_open_mapped(libretrodb_t *db,
+      const struct libretrodb_mapping *map)
+{
+   libretrodb_header_t header;
+   struct rmsgpack_dom_value key, count;
+   const uint8_t *metadata, *next;
+   const uint8_t *end = map->data + map->size;
+
+   if (map->size < sizeof(header))
+      return -1;
+
+   memcpy(&header, map->data, sizeof(header));
+   if (strncmp(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)) != 0)
+      return -1;
+
+   header.metadata_offset = swap_if_little64(header.metadata_offset);
+   if (header.metadata_offset >= map->size)
+      return -1;
+
+   metadata            = map->data + header.metadata_offset;
+   key.type            = RDT_STRING;
+   key.val.string.len  = STRLEN_CONST("count");
+   key.val.string.buff = (char*)"count";
+
+   if (!rmsgpack_dom_view_map_value(metadata, end, &key, &count))
+      return -1;
+   if (count.type == RDT_UINT)
+      db->count = count.val.uint_;
+   else if (count.type == RDT_INT && count.val.int_ >= 0)
+      db->count = (uint64_t)count.val.int_;
+   else
+      return -1;
+
+   if (!(next = rmsgpack_skip(metadata, end)))
+      return -1;
+
+   db->root               = 0;
+   db->first_index_offset = (uint64_t)(next - map->data);
+   return 0;
+}
+
+/**
+ * libretrodb_open:
+ * @path                : Path of the database file.
+ * @db                  : Handle to database.
+ * @write               : Open for libretrodb_create_index().
+ *
+ * Read-only handles are served from a memory mapping of the file
+ * that is shared with every other handle and cursor on the same
+ * file, index lookups then never touch the file. Where mapping is
+ * not possible, and for writable handles, the file is read through
+ * RFILE instead.
+ *
+ * Returns: 0 if successful, otherwise -1.
+ **/
 int libretrodb_open(const char *path, libretrodb_t *db, bool write)
 {
    libretrodb_header_t header;
    libretrodb_metadata_t md;
-   RFILE *fd = filestream_open(path,
-         write ? RETRO_VFS_FILE_ACCESS_READ_WRITE | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING : RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   RFILE *fd                      = NULL;
+   struct libretrodb_mapping *map = NULL;
+
    db->can_write = write;
-   if (!fd)
-     return -1;
 
-   if (!string_is_empty(db->path))
-      free(db->path);
+   if (!write && (map = libretrodb_mapping_acquire(path)))
+   {
+      if (libretrodb_open_mapped(db, map) < 0)
+      {
+         libretrodb_mapping_release(map);
+         return -1;
+      }
+      goto success;
+   }
+
+   if (!(fd = filestream_open(path,
+         write ? RETRO_VFS_FILE_ACCESS_READ_WRITE | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING : RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+     return -1;
 
-   db->path  = strdup(path);
    db->root  = filestream_tell(fd);
 
    if ((int)filestream_read(fd, &header, sizeof(header)) == -1)
@@ -213,7 +671,20 @@ int libretrodb_open(const char *path, libretrodb_t *db, bool write)
 
    db->count              = md.count;
    db->first_index_offset = filestream_tell(fd);
+
+success:
+   if (!string_is_empty(db->path))
+      free(db->path);
+
+   db->path               = strdup(path);
    db->fd                 = fd;
+   db->map                = map;
+
+   if (db->indexes)
+      free(db->indexes);
+   db->indexes            = NULL;
+   db->index_count        = 0;
+   libretrodb_load_indexes(db);
    return 0;
 
 error:
@@ -225,97 +696,129 @@ error:
 static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
       libretrodb_index_t *idx)
 {
-   filestream_seek(db->fd,
-                   (ssize_t)db->first_index_offset,
-                   RETRO_VFS_SEEK_POSITION_START);
+   unsigned i;
 
-   while (!filestream_eof(db->fd))
+   for (i = 0; i < db->index_count; i++)
    {
-      uint64_t name_len = 50;
-      /* Read index header */
-      if (rmsgpack_dom_read_into(db->fd,
-            "name",     idx->name, &name_len,
-            "key_size", &idx->key_size,
-            "next",     &idx->next,
-            "count",    &idx->count,
-                                 NULL) < 0) {
-        printf("Invalid index header\n");
-        break;
-      }
-
-      if (strncmp(index_name, idx->name, strlen(idx->name)) == 0)
+      if (strncmp(index_name, db->indexes[i].name,
+               strlen(db->indexes[i].name)) == 0)
+      {
+         *idx = db->indexes[i];
          return 0;
-
-      filestream_seek(db->fd, (ssize_t)idx->next,
-            RETRO_VFS_SEEK_POSITION_CURRENT);
+      }
    }
 
    return -1;
 }
 
-static int binsearch(const void *buff, const void *item,
-      uint64_t count, uint8_t field_size, uint64_t *offset)
+/**
+ * libretrodb_index_entry:
+ *
+ * Locates entry @i of @idx. With a mapping this is plain pointer
+ * arithmetic into the index section, otherwise the entry is read
+ * into @scratch.
+ *
+ * Returns: the entry (key followed by the record offset), NULL on error.
+ **/
+static const uint8_t *libretrodb_index_entry(const uint8_t *map,
+      size_t map_size, RFILE *fd, const libretrodb_index_t *idx,
+      uint64_t i, uint8_t *scratch)
 {
-   int mid            = (int)(count / 2);
-   int item_size      = field_size + sizeof(uint64_t);
-   uint8_t *current   = ((uint8_t *)buff + (mid * item_size));
-   int rv             = memcmp(current, item, field_size);
+   int64_t entry_size = (int64_t)(idx->key_size + sizeof(uint64_t));
+   uint64_t offset    = idx->offset + i * (uint64_t)entry_size;
 
-   if (rv == 0)
+   if (map)
    {
-      *offset         = *(uint64_t *)(current + field_size);
-      return 0;
+      if (offset + entry_size > map_size)
+         return NULL;
+      return map + offset;
    }
 
-   if (count == 0)
+   if (filestream_seek(fd, (int64_t)offset,
+            RETRO_VFS_SEEK_POSITION_START) < 0)
+      return NULL;
+   if (filestream_read(fd, scratch, entry_size) != entry_size)
+      return NULL;
+   return scratch;
+}
+
+/* Binary search for the first entry of @idx whose key is not
+ * below @key. Returns idx->count if there is none, -1 on error. */
+static int64_t libretrodb_index_lower_bound(const uint8_t *map,
+      size_t map_size, RFILE *fd, const libretrodb_index_t *idx,
+      const void *key)
+{
+   uint8_t scratch[LIBRETRODB_INDEX_MAX_KEY + sizeof(uint64_t)];
+   uint64_t lower = 0;
+   uint64_t upper = idx->count;
+
+   if (idx->key_size > LIBRETRODB_INDEX_MAX_KEY)
       return -1;
 
-   if (rv > 0)
-      return binsearch(buff, item, mid, field_size, offset);
+   while (lower < upper)
+   {
+      uint64_t mid         = lower + (upper - lower) / 2;
+      const uint8_t *entry = libretrodb_index_entry(map, map_size, fd,
+            idx, mid, scratch);
+      if (!entry)
+         return -1;
+      if (memcmp(entry, key, (size_t)idx->key_size) < 0)
+         lower = mid + 1;
+      else
+         upper = mid;
+   }
 
-   return binsearch(current + item_size, item,
-         count - mid, field_size, offset);
+   return (int64_t)lower;
 }
 
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
       const void *key, struct rmsgpack_dom_value *out)
 {
-   libretrodb_index_t idx;
    int rv;
-   uint8_t *buff;
+   int64_t pos;
    uint64_t offset;
-   ssize_t bufflen, nread = 0;
+   libretrodb_index_t idx;
+   const uint8_t *entry;
+   uint8_t scratch[LIBRETRODB_INDEX_MAX_KEY + sizeof(uint64_t)];
+   const uint8_t *map = db->map ? db->map->data : NULL;
+   size_t map_size    = db->map ? db->map->size : 0;
 
    if (libretrodb_find_index(db, index_name, &idx) < 0)
       return -1;
 
-   bufflen        = idx.next;
-   if (!(buff = malloc(bufflen)))
+   if ((pos = libretrodb_index_lower_bound(map, map_size, db->fd,
+               &idx, key)) < 0 || (uint64_t)pos >= idx.count)
+      return -1;
+
+   if (     !(entry = libretrodb_index_entry(map, map_size, db->fd,
+               &idx, (uint64_t)pos, scratch))
+         || memcmp(entry, key, (size_t)idx.key_size) != 0)
       return -1;
 
-   while (nread < bufflen)
+   memcpy(&offset, entry + idx.key_size, sizeof(offset));
+
+   if (map)
    {
-      void *buff_ = (buff + nread);
-      rv          = (int)filestream_read(db->fd, buff_, bufflen - nread);
+      struct rmsgpack_dom_arena arena;
+      struct rmsgpack_dom_value view;
 
-      if (rv <= 0)
-      {
-         free(buff);
+      if (offset >= map_size)
          return -1;
-      }
-      nread += rv;
-   }
-
-   rv = binsearch(buff, key, idx.count, (ssize_t)idx.key_size, &offset);
-   free(buff);
 
-   if (rv == 0) {
-      filestream_seek(db->fd, (ssize_t)offset, RETRO_VFS_SEEK_POSITION_START);
-      rmsgpack_dom_read(db->fd, out);
-      return 0;
-   } else {
-     return -1;
+      arena.buff = NULL;
+      arena.size = 0;
+      arena.used = 0;
+      rv         = -1;
+      if (rmsgpack_dom_view_tree(map + offset, map + map_size,
+               &arena, &view) >= 0)
+         rv      = rmsgpack_dom_value_copy(&view, out);
+      rmsgpack_dom_arena_free(&arena);
+      return rv < 0 ? -1 : 0;
    }
+
+   filestream_seek(db->fd, (ssize_t)offset, RETRO_VFS_SEEK_POSITION_START);
+   rmsgpack_dom_read(db->fd, out);
+   return 0;
 }
 
 /**
@@ -328,13 +831,82 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
-   return (int)filestream_seek(cursor->fd,
-         (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
+   cursor->eof           = 0;
+   cursor->candidate_pos = 0;
+   cursor->pos           = cursor->db->root + sizeof(libretrodb_header_t);
+   if (!cursor->fd)
+      return 0;
+   return (int)filestream_seek(cursor->fd, (int64_t)cursor->pos,
          RETRO_VFS_SEEK_POSITION_START);
 }
 
-int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
+/**
+ * libretrodb_cursor_fetch:
+ *
+ * Locates the encoded bytes of the next record, either in the
+ * mapping or read into the cursor buffer.
+ *
+ * Returns: 0 on success, EOF past the last record, -1 on error.
+ **/
+static int libretrodb_cursor_fetch(libretrodb_cursor_t *cursor,
+      const uint8_t **buff, size_t *len)
+{
+   struct rmsgpack_dom_value head;
+
+   if (cursor->indexed)
+   {
+      if (cursor->candidate_pos >= cursor->candidate_count)
+         return EOF;
+      cursor->pos = cursor->candidates[cursor->candidate_pos++];
+      if (cursor->fd)
+         filestream_seek(cursor->fd, (int64_t)cursor->pos,
+               RETRO_VFS_SEEK_POSITION_START);
+   }
+
+   if (cursor->map)
+   {
+      const uint8_t *next;
+
+      if (cursor->pos >= cursor->map_size)
+         return -1;
+
+      *buff = cursor->map + cursor->pos;
+      if (!(next = rmsgpack_skip(*buff, cursor->map + cursor->map_size)))
+         return -1;
+      *len  = (size_t)(next - *buff);
+   }
+   else
+   {
+      if (rmsgpack_read_raw(cursor->fd,
+               &cursor->raw, &cursor->raw_cap, len) < 0)
+         return -1;
+      *buff = cursor->raw;
+   }
+
+   cursor->item_offset = cursor->pos;
+   cursor->pos        += *len;
+
+   /* The record list ends with a nil sentinel */
+   if (     !rmsgpack_dom_view(*buff, *buff + *len, &head)
+         || head.type == RDT_NULL)
+      return EOF;
+
+   return 0;
+}
+
+/**
+ * libretrodb_cursor_read_item_view:
+ * @cursor              : Handle to database cursor.
+ * @out                 : Next record matching the cursor query.
+ *
+ * Like libretrodb_cursor_read_item(), but @out is backed by the
+ * cursor arena: nothing is allocated per record, binaries point into
+ * the mapped file. @out stays valid until the next read or until the
+ * cursor is closed, and must not be freed.
+ *
+ * Returns: 0 if a record was read, EOF at the end, negative on error.
+ **/
+int libretrodb_cursor_read_item_view(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out)
 {
    int rv;
@@ -342,26 +914,47 @@ int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
    if (cursor->eof)
       return EOF;
 
-retry:
-   if ((rv = rmsgpack_dom_read(cursor->fd, out)) < 0)
-      return rv;
-
-   if (out->type == RDT_NULL)
+   for (;;)
    {
-      cursor->eof = 1;
-      return EOF;
-   }
+      size_t len;
+      const uint8_t *buff;
+      int matched = -1;
 
-   if (cursor->query)
-   {
-      if (!libretrodb_query_filter(cursor->query, out))
+      if ((rv = libretrodb_cursor_fetch(cursor, &buff, &len)) != 0)
       {
-         rmsgpack_dom_value_free(out);
-         goto retry;
+         if (rv == EOF)
+            cursor->eof = 1;
+         return rv;
       }
+
+      /* Filter on the encoded record first, only matches get decoded */
+      if (     cursor->query
+            && (matched = libretrodb_query_filter_raw(
+                  cursor->query, buff, len)) == 0)
+         continue;
+
+      if (rmsgpack_dom_view_tree(buff, buff + len, &cursor->arena, out) < 0)
+         return -1;
+
+      if (     matched < 0
+            && cursor->query
+            && !libretrodb_query_filter(cursor->query, out))
+         continue;
+
+      return 0;
    }
+}
 
-   return 0;
+int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   int rv;
+   struct rmsgpack_dom_value view;
+
+   if ((rv = libretrodb_cursor_read_item_view(cursor, &view)) != 0)
+      return rv;
+
+   return rmsgpack_dom_value_copy(&view, out);
 }
 
 /**
@@ -378,14 +971,292 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->fd)
       filestream_close(cursor->fd);
 
+   if (cursor->mapping)
+      libretrodb_mapping_release(cursor->mapping);
+
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
-   cursor->is_valid = 0;
-   cursor->eof      = 1;
-   cursor->fd       = NULL;
-   cursor->db       = NULL;
-   cursor->query    = NULL;
+   if (cursor->raw)
+      free(cursor->raw);
+
+   if (cursor->candidates)
+      free(cursor->candidates);
+
+   rmsgpack_dom_arena_free(&cursor->arena);
+
+   cursor->is_valid        = 0;
+   cursor->eof             = 1;
+   cursor->indexed         = 0;
+   cursor->fd              = NULL;
+   cursor->db              = NULL;
+   cursor->query           = NULL;
+   cursor->mapping         = NULL;
+   cursor->map             = NULL;
+   cursor->map_size        = 0;
+   cursor->raw             = NULL;
+   cursor->raw_cap         = 0;
+   cursor->candidates      = NULL;
+   cursor->candidate_count = 0;
+   cursor->candidate_pos   = 0;
+}
+
+static uint64_t libretrodb_hash_bytes(uint64_t h,
+      const void *data, size_t len)
+{
+   size_t i;
+   const uint8_t *p = (const uint8_t*)data;
+   for (i = 0; i < len; i++)
+      h = (h ^ p[i]) * LIBRETRODB_HASH_PRIME;
+   return h;
+}
+
+/* Hashes @v so that values the query engine considers equal
+ * (a positive int and the same uint) hash the same. */
+static uint64_t libretrodb_hash_value(uint64_t h,
+      const struct rmsgpack_dom_value *v)
+{
+   uint8_t tag;
+   uint32_t len;
+   uint64_t num;
+
+   switch (v->type)
+   {
+      case RDT_NULL:
+         tag = 0;
+         return libretrodb_hash_bytes(h, &tag, 1);
+      case RDT_BOOL:
+         tag = v->val.bool_ ? 2 : 1;
+         return libretrodb_hash_bytes(h, &tag, 1);
+      case RDT_INT:
+         if (v->val.int_ < 0)
+         {
+            tag = 4;
+            num = swap_if_little64((uint64_t)v->val.int_);
+            h   = libretrodb_hash_bytes(h, &tag, 1);
+            return libretrodb_hash_bytes(h, &num, sizeof(num));
+         }
+         /* fall-through */
+      case RDT_UINT:
+         tag = 3;
+         num = swap_if_little64((v->type == RDT_INT)
+               ? (uint64_t)v->val.int_ : v->val.uint_);
+         h   = libretrodb_hash_bytes(h, &tag, 1);
+         return libretrodb_hash_bytes(h, &num, sizeof(num));
+      case RDT_STRING:
+      case RDT_BINARY:
+         tag = (v->type == RDT_STRING) ? 5 : 6;
+         len = swap_if_little32(v->val.string.len);
+         h   = libretrodb_hash_bytes(h, &tag, 1);
+         h   = libretrodb_hash_bytes(h, &len, sizeof(len));
+         return libretrodb_hash_bytes(h,
+               v->val.string.buff, v->val.string.len);
+      default:
+         break;
+   }
+
+   tag = 7;
+   return libretrodb_hash_bytes(h, &tag, 1);
+}
+
+static void libretrodb_key_from_uint(uint8_t *key, uint64_t value)
+{
+   value = swap_if_little64(value);
+   memcpy(key, &value, sizeof(value));
+}
+
+/* Splits a comma separated field list, returns the number of fields */
+static unsigned libretrodb_split_fields(const char *fields,
+      const char **names, size_t *lens)
+{
+   unsigned n = 0;
+
+   while (*fields && n < LIBRETRODB_INDEX_MAX_FIELDS)
+   {
+      const char *sep = strchr(fields, ',');
+      size_t len      = sep ? (size_t)(sep - fields) : strlen(fields);
+
+      names[n]        = fields;
+      lens[n++]       = len;
+
+      if (!sep)
+         break;
+      fields          = sep + 1;
+   }
+
+   return n;
+}
+
+/**
+ * libretrodb_index_bounds:
+ *
+ * Works out the key range of @idx that can hold records matching
+ * @q. Returns a score for how selective the lookup is, 0 if the
+ * index cannot serve the query.
+ **/
+static unsigned libretrodb_index_bounds(libretrodb_query_t *q,
+      const libretrodb_index_t *idx, uint8_t *lo, uint8_t *hi)
+{
+   unsigned i;
+   size_t lens[LIBRETRODB_INDEX_MAX_FIELDS];
+   const char *names[LIBRETRODB_INDEX_MAX_FIELDS];
+   struct rmsgpack_dom_value min, max;
+   uint64_t h         = LIBRETRODB_HASH_SEED;
+   unsigned n         = libretrodb_split_fields(idx->fields, names, lens);
+   enum libretrodb_query_bound bound;
+
+   if (n == 0 || idx->key_size > LIBRETRODB_INDEX_MAX_KEY)
+      return 0;
+
+   switch (idx->kind)
+   {
+      case LIBRETRODB_INDEX_UNIQUE:
+         if (libretrodb_query_field_bound(q, names[0], lens[0],
+                  &min, &max) != LIBRETRODB_QUERY_BOUND_EQUALS)
+            return 0;
+         if (     min.type           != RDT_BINARY
+               || min.val.binary.len != idx->key_size)
+            return 0;
+         memcpy(lo, min.val.binary.buff, (size_t)idx->key_size);
+         memcpy(hi, min.val.binary.buff, (size_t)idx->key_size);
+         /* At most one record, nothing beats it */
+         return ~0u;
+      case LIBRETRODB_INDEX_ORDERED:
+         if (idx->key_size != sizeof(uint64_t))
+            return 0;
+         bound = libretrodb_query_field_bound(q, names[0], lens[0],
+               &min, &max);
+         if (bound == LIBRETRODB_QUERY_BOUND_EQUALS)
+         {
+            if (min.type == RDT_INT && min.val.int_ >= 0)
+               min.val.uint_ = (uint64_t)min.val.int_;
+            else if (min.type != RDT_UINT)
+               return 0;
+            libretrodb_key_from_uint(lo, min.val.uint_);
+            libretrodb_key_from_uint(hi, min.val.uint_);
+            return 2;
+         }
+         if (bound == LIBRETRODB_QUERY_BOUND_RANGE)
+         {
+            if (max.val.int_ < 0 || min.val.int_ > max.val.int_)
+               return 0;
+            libretrodb_key_from_uint(lo,
+                  (min.val.int_ < 0) ? 0 : (uint64_t)min.val.int_);
+            libretrodb_key_from_uint(hi, (uint64_t)max.val.int_);
+            return 1;
+         }
+         return 0;
+      case LIBRETRODB_INDEX_HASHED:
+         if (idx->key_size != sizeof(uint64_t))
+            return 0;
+         for (i = 0; i < n; i++)
+         {
+            if (libretrodb_query_field_bound(q, names[i], lens[i],
+                     &min, &max) != LIBRETRODB_QUERY_BOUND_EQUALS)
+               return 0;
+            h = libretrodb_hash_value(h, &min);
+         }
+         libretrodb_key_from_uint(lo, h);
+         libretrodb_key_from_uint(hi, h);
+         return 2 * n;
+      default:
+         break;
+   }
+
+   return 0;
+}
+
+static int libretrodb_offset_compare(const void *a, const void *b)
+{
+   uint64_t x = *(const uint64_t*)a;
+   uint64_t y = *(const uint64_t*)b;
+   return (x > y) - (x < y);
+}
+
+/**
+ * libretrodb_cursor_plan:
+ *
+ * Picks the most selective index for the cursor query and collects
+ * the offsets of all records in its key range. Candidates are still
+ * run through the query filter, since hashed keys can collide.
+ * Leaves the cursor scanning the whole file if no index applies.
+ **/
+static void libretrodb_cursor_plan(libretrodb_cursor_t *cursor)
+{
+   unsigned i;
+   uint64_t pos;
+   int64_t lower;
+   uint8_t lo[LIBRETRODB_INDEX_MAX_KEY];
+   uint8_t hi[LIBRETRODB_INDEX_MAX_KEY];
+   uint8_t scratch[LIBRETRODB_INDEX_MAX_KEY + sizeof(uint64_t)];
+   libretrodb_t *db               = cursor->db;
+   const libretrodb_index_t *best = NULL;
+   unsigned best_score            = 0;
+   size_t cap                     = 0;
+
+   for (i = 0; i < db->index_count; i++)
+   {
+      uint8_t tmp_lo[LIBRETRODB_INDEX_MAX_KEY];
+      uint8_t tmp_hi[LIBRETRODB_INDEX_MAX_KEY];
+      unsigned score = libretrodb_index_bounds(cursor->query,
+            &db->indexes[i], tmp_lo, tmp_hi);
+
+      if (score > best_score)
+      {
+         best       = &db->indexes[i];
+         best_score = score;
+         memcpy(lo, tmp_lo, sizeof(lo));
+         memcpy(hi, tmp_hi, sizeof(hi));
+      }
+   }
+
+   if (!best)
+      return;
+
+   if ((lower = libretrodb_index_lower_bound(cursor->map, cursor->map_size,
+               cursor->fd, best, lo)) < 0)
+      goto error;
+
+   for (pos = (uint64_t)lower; pos < best->count; pos++)
+   {
+      uint64_t offset;
+      const uint8_t *entry = libretrodb_index_entry(cursor->map,
+            cursor->map_size, cursor->fd, best, pos, scratch);
+
+      if (!entry)
+         goto error;
+      if (memcmp(entry, hi, (size_t)best->key_size) > 0)
+         break;
+
+      if (cursor->candidate_count == cap)
+      {
+         size_t new_cap   = cap ? cap * 2 : 16;
+         uint64_t *tmp    = (uint64_t*)realloc(cursor->candidates,
+               new_cap * sizeof(uint64_t));
+         if (!tmp)
+            goto error;
+         cursor->candidates = tmp;
+         cap                = new_cap;
+      }
+
+      memcpy(&offset, entry + best->key_size, sizeof(offset));
+      cursor->candidates[cursor->candidate_count++] = offset;
+   }
+
+   /* Visit records in file order */
+   if (cursor->candidate_count > 1)
+      qsort(cursor->candidates, cursor->candidate_count,
+            sizeof(uint64_t), libretrodb_offset_compare);
+
+   cursor->indexed = 1;
+   return;
+
+error:
+   if (cursor->candidates)
+      free(cursor->candidates);
+   cursor->candidates      = NULL;
+   cursor->candidate_count = 0;
+   libretrodb_cursor_reset(cursor);
 }
 
 /**
@@ -402,23 +1273,46 @@ int libretrodb_cursor_open(libretrodb_t *db,
       libretrodb_cursor_t *cursor,
       libretrodb_query_t *q)
 {
-   RFILE *fd = NULL;
+   RFILE *fd                          = NULL;
+   struct libretrodb_mapping *mapping = NULL;
+
    if (!db || string_is_empty(db->path))
       return -1;
 
-   if (!(fd = filestream_open(db->path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   /* Read-only handles lend their mapping. Writable ones map the
+    * file as it is now, since indexes get appended to it. */
+   if (db->map)
+      libretrodb_mapping_ref(mapping = db->map);
+   else if (     !(mapping = libretrodb_mapping_acquire(db->path))
+              && !(fd = filestream_open(db->path,
+                    RETRO_VFS_FILE_ACCESS_READ,
+                    RETRO_VFS_FILE_ACCESS_HINT_NONE)))
       return -1;
 
-   cursor->fd       = fd;
-   cursor->db       = db;
-   cursor->is_valid = 1;
+   cursor->fd              = fd;
+   cursor->db              = db;
+   cursor->mapping         = mapping;
+   cursor->map             = mapping ? mapping->data : NULL;
+   cursor->map_size        = mapping ? mapping->size : 0;
+   cursor->is_valid        = 1;
+   cursor->indexed         = 0;
+   cursor->raw             = NULL;
+   cursor->raw_cap         = 0;
+   cursor->candidates      = NULL;
+   cursor->candidate_count = 0;
+   cursor->candidate_pos   = 0;
+   cursor->item_offset     = 0;
+   cursor->arena.buff      = NULL;
+   cursor->arena.size      = 0;
+   cursor->arena.used      = 0;
    libretrodb_cursor_reset(cursor);
-   cursor->query    = q;
+   cursor->query           = q;
 
    if (q)
+   {
       libretrodb_query_inc_ref(q);
+      libretrodb_cursor_plan(cursor);
+   }
 
    return 0;
 }
@@ -439,7 +1333,9 @@ static int node_compare(const void *a, const void *b, void *ctx)
    return memcmp(a, b, *(uint8_t *)ctx);
 }
 
-int libretrodb_create_index(libretrodb_t *db,
+/* Returns -2 if the field is not a unique fixed-size binary,
+ * in which case a secondary index is built instead */
+static int libretrodb_create_unique_index(libretrodb_t *db,
       const char *name, const char *field_name)
 {
    struct node_iter_ctx nictx;
@@ -451,20 +1347,11 @@ int libretrodb_create_index(libretrodb_t *db,
    void *buff                       = NULL;
    uint64_t *buff_u64               = NULL;
    uint8_t field_size               = 0;
-   uint64_t item_loc                = filestream_tell(db->fd);
+   uint64_t item_loc                = 0;
    bintree_t *tree;
    uint64_t item_count              = 0;
    int rval                         = -1;
 
-   if (libretrodb_find_index(db, name, &idx) >= 0)
-   {
-     return 1;
-   }
-   if (!db->can_write)
-   {
-     return -1;
-   }
-
    tree = bintree_new(node_compare, &field_size);
 
    item.type                        = RDT_NULL;
@@ -476,15 +1363,19 @@ int libretrodb_create_index(libretrodb_t *db,
    key.val.string.len               = (uint32_t)strlen(field_name);
    key.val.string.buff              = (char *)field_name;   /* We know we aren't going to change it */
 
-   while (libretrodb_cursor_read_item(&cur, &item) == 0)
+   while (libretrodb_cursor_read_item_view(&cur, &item) == 0)
    {
+      item_loc = cur.item_offset;
+
       /* Only map keys are supported */
       if (item.type != RDT_MAP)
          goto clean;
 
       /* Field not found in item? */
       if (!(field = rmsgpack_dom_value_map_value(&item, &key)))
-        continue;
+         continue;
+
+      rval = -2;
 
       /* Field is not binary? */
       if (field->type != RDT_BINARY)
@@ -500,6 +1391,8 @@ int libretrodb_create_index(libretrodb_t *db,
       else if (field->val.binary.len != field_size)
          goto clean;
 
+      rval = -1;
+
       if (!(buff = malloc(field_size + sizeof(uint64_t))))
          goto clean;
 
@@ -512,41 +1405,42 @@ int libretrodb_create_index(libretrodb_t *db,
       /* Value is not unique? */
       if (bintree_insert(tree, tree->root, buff) != 0)
       {
-         rmsgpack_dom_value_print(field);
+         rval = -2;
          goto clean;
       }
       item_count++;
       buff     = NULL;
-      rmsgpack_dom_value_free(&item);
-      item_loc = filestream_tell(cur.fd);
    }
+
+   /* Nothing to key on */
+   if (item_count == 0)
+   {
+      rval = -2;
+      goto clean;
+   }
+
    rval = 0;
 
    filestream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
 
    strlcpy(idx.name, name, sizeof(idx.name));
+   strlcpy(idx.fields, field_name, sizeof(idx.fields));
 
+   idx.kind     = LIBRETRODB_INDEX_UNIQUE;
    idx.key_size = field_size;
    idx.next     = item_count * (field_size + sizeof(uint64_t));
    idx.count    = item_count;
    /* Write index header */
-   rmsgpack_write_map_header(db->fd, 4);
-   rmsgpack_write_string(db->fd, "name", STRLEN_CONST("name"));
-   rmsgpack_write_string(db->fd, idx.name, (uint32_t)strlen(idx.name));
-   rmsgpack_write_string(db->fd, "key_size", (uint32_t)STRLEN_CONST("key_size"));
-   rmsgpack_write_uint  (db->fd, idx.key_size);
-   rmsgpack_write_string(db->fd, "next", STRLEN_CONST("next"));
-   rmsgpack_write_uint  (db->fd, idx.next);
-   rmsgpack_write_string(db->fd, "count", STRLEN_CONST("count"));
-   rmsgpack_write_uint  (db->fd, idx.count);
+   libretrodb_write_index_header(db->fd, &idx);
+   idx.offset   = filestream_tell(db->fd);
 
    nictx.db     = db;
    nictx.idx    = &idx;
    bintree_iterate(tree->root, node_iter, &nictx);
 
    filestream_flush(db->fd);
+   libretrodb_add_index(db, &idx);
 clean:
-   rmsgpack_dom_value_free(&item);
    if (buff)
       free(buff);
    if (cur.is_valid)
@@ -557,6 +1451,193 @@ clean:
    return rval;
 }
 
+static int libretrodb_index_item_compare(const void *a, const void *b)
+{
+   const struct libretrodb_index_item *x = (const struct libretrodb_index_item*)a;
+   const struct libretrodb_index_item *y = (const struct libretrodb_index_item*)b;
+
+   if (x->key != y->key)
+      return (x->key > y->key) ? 1 : -1;
+   return (x->offset > y->offset) - (x->offset < y->offset);
+}
+
+/**
+ * libretrodb_create_secondary_index:
+ *
+ * Builds a non-unique index over one or more comma separated fields.
+ * A single field holding only non-negative integers gets an ordered
+ * index (usable for between()), anything else is keyed on a hash of
+ * all field values, with missing fields hashed as nil.
+ **/
+static int libretrodb_create_secondary_index(libretrodb_t *db,
+      const char *name, const char *fields)
+{
+   unsigned i;
+   uint64_t j;
+   libretrodb_index_t idx;
+   struct rmsgpack_dom_value item;
+   size_t lens[LIBRETRODB_INDEX_MAX_FIELDS];
+   const char *names[LIBRETRODB_INDEX_MAX_FIELDS];
+   struct rmsgpack_dom_value keys[LIBRETRODB_INDEX_MAX_FIELDS];
+   libretrodb_cursor_t cur                 = {0};
+   struct libretrodb_index_item *hashed    = NULL;
+   struct libretrodb_index_item *ordered   = NULL;
+   uint64_t hashed_count                   = 0;
+   uint64_t ordered_count                  = 0;
+   size_t cap                              = 0;
+   unsigned n                              = libretrodb_split_fields(
+         fields, names, lens);
+   bool can_order                          = (n == 1);
+   int rval                                = -1;
+
+   item.type = RDT_NULL;
+
+   if (n == 0)
+      return -1;
+
+   for (i = 0; i < n; i++)
+   {
+      keys[i].type            = RDT_STRING;
+      keys[i].val.string.len  = (uint32_t)lens[i];
+      keys[i].val.string.buff = (char*)names[i];
+   }
+
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
+      goto clean;
+
+   for (;;)
+   {
+      uint64_t item_loc;
+      uint64_t h        = LIBRETRODB_HASH_SEED;
+
+      if (libretrodb_cursor_read_item_view(&cur, &item) != 0)
+         break;
+      item_loc          = cur.item_offset;
+
+      if (hashed_count == cap)
+      {
+         size_t new_cap = cap ? cap * 2 : 1024;
+         struct libretrodb_index_item *tmp;
+
+         if (!(tmp = (struct libretrodb_index_item*)realloc(hashed,
+                     new_cap * sizeof(*tmp))))
+            goto clean;
+         hashed = tmp;
+
+         if (!(tmp = (struct libretrodb_index_item*)realloc(ordered,
+                     new_cap * sizeof(*tmp))))
+            goto clean;
+         ordered = tmp;
+         cap     = new_cap;
+      }
+
+      for (i = 0; i < n; i++)
+      {
+         static struct rmsgpack_dom_value nil_value;
+         struct rmsgpack_dom_value *value =
+            rmsgpack_dom_value_map_value(&item, &keys[i]);
+
+         if (can_order && value)
+         {
+            if (value->type == RDT_UINT)
+               ordered[ordered_count].key = value->val.uint_;
+            else if (value->type == RDT_INT && value->val.int_ >= 0)
+               ordered[ordered_count].key = (uint64_t)value->val.int_;
+            else
+               can_order = false;
+            ordered[ordered_count++].offset = item_loc;
+         }
+
+         /* All missing fields are nil */
+         h = libretrodb_hash_value(h, value ? value : &nil_value);
+      }
+
+      hashed[hashed_count].key      = h;
+      hashed[hashed_count++].offset = item_loc;
+   }
+
+   if (can_order && ordered_count > 0)
+   {
+      idx.kind  = LIBRETRODB_INDEX_ORDERED;
+      idx.count = ordered_count;
+   }
+   else
+   {
+      struct libretrodb_index_item *tmp = ordered;
+      ordered   = hashed;
+      hashed    = tmp;
+      idx.kind  = LIBRETRODB_INDEX_HASHED;
+      idx.count = hashed_count;
+   }
+
+   /* 'ordered' now holds the entries to write */
+   qsort(ordered, (size_t)idx.count, sizeof(*ordered),
+         libretrodb_index_item_compare);
+
+   strlcpy(idx.name, name, sizeof(idx.name));
+   strlcpy(idx.fields, fields, sizeof(idx.fields));
+   idx.key_size = sizeof(uint64_t);
+   idx.next     = idx.count * (idx.key_size + sizeof(uint64_t));
+
+   filestream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
+   libretrodb_write_index_header(db->fd, &idx);
+   idx.offset   = filestream_tell(db->fd);
+
+   for (j = 0; j < idx.count; j++)
+   {
+      uint8_t entry[sizeof(uint64_t) * 2];
+      libretrodb_key_from_uint(entry, ordered[j].key);
+      memcpy(entry + sizeof(uint64_t), &ordered[j].offset, sizeof(uint64_t));
+      if (filestream_write(db->fd, entry, sizeof(entry)) != sizeof(entry))
+         goto clean;
+   }
+
+   filestream_flush(db->fd);
+   libretrodb_add_index(db, &idx);
+   rval = 0;
+
+clean:
+   if (hashed)
+      free(hashed);
+   if (ordered)
+      free(ordered);
+   if (cur.is_valid)
+      libretrodb_cursor_close(&cur);
+   return rval;
+}
+
+/**
+ * libretrodb_create_index:
+ * @db                  : Handle to database, opened for writing.
+ * @name                : Name of the new index.
+ * @field_name          : Field to index, or a comma separated list
+ *                        of fields for a compound index.
+ *
+ * A single field holding unique fixed-size binaries (crc, md5...)
+ * gets a unique index usable by libretrodb_find_entry(). Everything
+ * else gets a secondary index that cursors use to answer table
+ * queries without scanning the whole database.
+ *
+ * Returns: 0 on success, 1 if the index already exists, otherwise -1.
+ **/
+int libretrodb_create_index(libretrodb_t *db,
+      const char *name, const char *field_name)
+{
+   int rv;
+   libretrodb_index_t idx;
+
+   if (libretrodb_find_index(db, name, &idx) >= 0)
+      return 1;
+   if (!db->can_write)
+      return -1;
+
+   if (     !strchr(field_name, ',')
+         && (rv = libretrodb_create_unique_index(db, name, field_name)) != -2)
+      return rv;
+
+   return libretrodb_create_secondary_index(db, name, field_name);
+}
+
 libretrodb_cursor_t *libretrodb_cursor_new(void)
 {
    libretrodb_cursor_t *dbc = (libretrodb_cursor_t*)
@@ -568,8 +1649,22 @@ libretrodb_cursor_t *libretrodb_cursor_new(void)
    dbc->is_valid            = 0;
    dbc->fd                  = NULL;
    dbc->eof                 = 0;
+   dbc->indexed             = 0;
    dbc->query               = NULL;
    dbc->db                  = NULL;
+   dbc->raw                 = NULL;
+   dbc->raw_cap             = 0;
+   dbc->candidates          = NULL;
+   dbc->candidate_count     = 0;
+   dbc->candidate_pos       = 0;
+   dbc->mapping             = NULL;
+   dbc->map                 = NULL;
+   dbc->map_size            = 0;
+   dbc->pos                 = 0;
+   dbc->item_offset         = 0;
+   dbc->arena.buff          = NULL;
+   dbc->arena.size          = 0;
+   dbc->arena.used          = 0;
 
    return dbc;
 }
@@ -588,10 +1683,13 @@ libretrodb_t *libretrodb_new(void)
       return NULL;
 
    db->fd                 = NULL;
+   db->map                = NULL;
    db->root               = 0;
    db->count              = 0;
    db->first_index_offset = 0;
    db->path               = NULL;
+   db->indexes            = NULL;
+   db->index_count        = 0;
 
    return db;
 }
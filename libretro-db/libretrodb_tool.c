@@ -45,7 +45,7 @@ int main(int argc, char ** argv)
       printf("Usage: %s <db file> <command> [extra args...]\n", argv[0]);
       printf("Available Commands:\n");
       printf("\tlist\n");
-      printf("\tcreate-index <index name> <field name>\n");
+      printf("\tcreate-index <index name> <field name>[,<field name>...]\n");
       printf("\tfind <query expression>\n");
       printf("\tget-names <query expression>\n");
       return 1;
@@ -60,7 +60,9 @@ int main(int argc, char ** argv)
    if (!db || !cur)
       goto error;
 
-   if ((rv = libretrodb_open(path, db, true)) != 0)
+   /* Only index creation writes, everything else can share a mapping */
+   if ((rv = libretrodb_open(path, db,
+               memcmp(command, "create-index", 12) == 0)) != 0)
    {
       printf("Could not open db file '%s'\n", path);
       goto error;
@@ -79,11 +81,10 @@ int main(int argc, char ** argv)
          goto error;
       }
 
-      while (libretrodb_cursor_read_item(cur, &item) == 0)
+      while (libretrodb_cursor_read_item_view(cur, &item) == 0)
       {
          rmsgpack_dom_value_print(&item);
          printf("\n");
-         rmsgpack_dom_value_free(&item);
       }
    }
    else if (memcmp(command, "find", 4) == 0)
@@ -110,11 +111,10 @@ int main(int argc, char ** argv)
          goto error;
       }
 
-      while (libretrodb_cursor_read_item(cur, &item) == 0)
+      while (libretrodb_cursor_read_item_view(cur, &item) == 0)
       {
          rmsgpack_dom_value_print(&item);
          printf("\n");
-         rmsgpack_dom_value_free(&item);
       }
    }
    else if (memcmp(command, "get-names", 9) == 0)
@@ -141,7 +141,7 @@ int main(int argc, char ** argv)
          goto error;
       }
 
-      while (libretrodb_cursor_read_item(cur, &item) == 0)
+      while (libretrodb_cursor_read_item_view(cur, &item) == 0)
       {
          if (item.type == RDT_MAP) //should always be true, but if false the program would segfault
          {
@@ -155,8 +155,6 @@ int main(int argc, char ** argv)
                }
             }
          }
-
-         rmsgpack_dom_value_free(&item);
       }
    }
    else if (memcmp(command, "create-index", 12) == 0)
@@ -165,7 +163,7 @@ int main(int argc, char ** argv)
 
       if (argc != 5)
       {
-         printf("Usage: %s <db file> create-index <index name> <field name>\n", argv[0]);
+         printf("Usage: %s <db file> create-index <index name> <field name>[,<field name>...]\n", argv[0]);
          goto error;
       }
 
@@ -80,10 +80,18 @@ struct argument
    enum argument_type type;
 };
 
+enum query_flags
+{
+   /* Root is a table of plain field names, so it can be evaluated
+    * against raw msgpack records without building a DOM */
+   QUERY_FLAG_RAW = (1 << 0)
+};
+
 struct query
 {
    struct invocation root; /* ptr alignment */
    unsigned ref_count;
+   uint8_t flags;
 };
 
 struct registered_func
@@ -929,6 +937,7 @@ void *libretrodb_query_compile(libretrodb_t *db,
       return NULL;
 
    q->ref_count          = 1;
+   q->flags              = 0;
    q->root.argc          = 0;
    q->root.func          = NULL;
    q->root.argv          = NULL;
@@ -969,6 +978,18 @@ void *libretrodb_query_compile(libretrodb_t *db,
       goto error;
    }
 
+   if (q->root.func == query_func_all_map && (q->root.argc % 2) == 0)
+   {
+      unsigned i;
+      q->flags |= QUERY_FLAG_RAW;
+      for (i = 0; i < q->root.argc; i += 2)
+      {
+         if (     q->root.argv[i].type         != AT_VALUE
+               || q->root.argv[i].a.value.type != RDT_STRING)
+            q->flags &= ~QUERY_FLAG_RAW;
+      }
+   }
+
    return q;
 
 error:
@@ -991,3 +1012,132 @@ int libretrodb_query_filter(libretrodb_query_t *q,
    struct rmsgpack_dom_value res = inv.func(*v, inv.argc, inv.argv);
    return (res.type == RDT_BOOL && res.val.bool_);
 }
+
+/**
+ * libretrodb_query_filter_raw:
+ * @q                   : Compiled query.
+ * @buff                : Encoded record.
+ * @len                 : Size of @buff.
+ *
+ * Evaluates @q directly against the msgpack bytes of a record.
+ * Only the fields named by the query are decoded, as views into
+ * @buff, so nothing is allocated for the common case.
+ *
+ * Returns: 1 if the record matches, 0 if it does not, -1 if the
+ * query needs a decoded record (use libretrodb_query_filter).
+ **/
+int libretrodb_query_filter_raw(libretrodb_query_t *q,
+      const uint8_t *buff, size_t len)
+{
+   unsigned i;
+   struct query *rq   = (struct query*)q;
+   const uint8_t *end = buff + len;
+
+   if (!(rq->flags & QUERY_FLAG_RAW))
+      return -1;
+
+   for (i = 0; i < rq->root.argc; i += 2)
+   {
+      struct rmsgpack_dom_value value;
+      struct rmsgpack_dom_value res;
+      const struct argument *arg = &rq->root.argv[i + 1];
+
+      /* All missing fields are nil */
+      if (!rmsgpack_dom_view_map_value(buff, end,
+               &rq->root.argv[i].a.value, &value))
+         value.type = RDT_NULL;
+
+      if (value.type == RDT_MAP || value.type == RDT_ARRAY)
+         return -1;
+
+      if (arg->type == AT_VALUE)
+         res = func_equals(value, 1, arg);
+      else
+      {
+         char tmp[256];
+         char *str = NULL;
+
+         /* Query functions expect NUL-terminated strings */
+         if (value.type == RDT_STRING)
+         {
+            if (value.val.string.len < sizeof(tmp))
+               str = tmp;
+            else if (!(str = (char*)malloc(value.val.string.len + 1)))
+               return -1;
+            memcpy(str, value.val.string.buff, value.val.string.len);
+            str[value.val.string.len] = '\0';
+            value.val.string.buff     = str;
+         }
+
+         res = query_func_is_true(arg->a.invocation.func(value,
+                  arg->a.invocation.argc,
+                  arg->a.invocation.argv
+                  ), 0, NULL);
+
+         if (str && str != tmp)
+            free(str);
+      }
+
+      if (!res.val.bool_)
+         return 0;
+   }
+
+   return 1;
+}
+
+/**
+ * libretrodb_query_field_bound:
+ * @q                   : Compiled query.
+ * @field               : Field name.
+ * @field_len           : Length of @field.
+ * @min                 : Receives the lowest accepted value.
+ * @max                 : Receives the highest accepted value.
+ *
+ * Reports what a table query requires of @field, so the cursor can
+ * pick an index. @min and @max are shallow copies owned by @q.
+ *
+ * Returns: LIBRETRODB_QUERY_BOUND_EQUALS if @field must equal @min,
+ * LIBRETRODB_QUERY_BOUND_RANGE if it must be an integer in
+ * [@min, @max], otherwise LIBRETRODB_QUERY_BOUND_NONE.
+ **/
+enum libretrodb_query_bound libretrodb_query_field_bound(
+      libretrodb_query_t *q, const char *field, size_t field_len,
+      struct rmsgpack_dom_value *min, struct rmsgpack_dom_value *max)
+{
+   unsigned i;
+   struct query *rq = (struct query*)q;
+
+   if (!(rq->flags & QUERY_FLAG_RAW))
+      return LIBRETRODB_QUERY_BOUND_NONE;
+
+   for (i = 0; i < rq->root.argc; i += 2)
+   {
+      const struct rmsgpack_dom_value *key = &rq->root.argv[i].a.value;
+      const struct argument *arg           = &rq->root.argv[i + 1];
+
+      if (     key->val.string.len != field_len
+            || strncmp(key->val.string.buff, field, field_len) != 0)
+         continue;
+
+      if (arg->type == AT_VALUE)
+      {
+         *min = arg->a.value;
+         *max = arg->a.value;
+         return LIBRETRODB_QUERY_BOUND_EQUALS;
+      }
+
+      if (     arg->a.invocation.func == query_func_between
+            && arg->a.invocation.argc == 2
+            && arg->a.invocation.argv[0].type         == AT_VALUE
+            && arg->a.invocation.argv[1].type         == AT_VALUE
+            && arg->a.invocation.argv[0].a.value.type == RDT_INT
+            && arg->a.invocation.argv[1].a.value.type == RDT_INT)
+      {
+         *min = arg->a.invocation.argv[0].a.value;
+         *max = arg->a.invocation.argv[1].a.value;
+         return LIBRETRODB_QUERY_BOUND_RANGE;
+      }
+   }
+
+   return LIBRETRODB_QUERY_BOUND_NONE;
+}
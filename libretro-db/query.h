@@ -23,6 +23,8 @@
 #ifndef __LIBRETRODB_QUERY_H__
 #define __LIBRETRODB_QUERY_H__
 
+#include <stddef.h>
+
 #include <retro_common_api.h>
 
 #include "libretrodb.h"
@@ -32,12 +34,26 @@ RETRO_BEGIN_DECLS
 
 typedef struct libretrodb_query libretrodb_query_t;
 
+enum libretrodb_query_bound
+{
+   LIBRETRODB_QUERY_BOUND_NONE = 0,
+   LIBRETRODB_QUERY_BOUND_EQUALS,
+   LIBRETRODB_QUERY_BOUND_RANGE
+};
+
 void libretrodb_query_inc_ref(libretrodb_query_t *q);
 
 void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+int libretrodb_query_filter_raw(libretrodb_query_t *q,
+      const uint8_t *buff, size_t len);
+
+enum libretrodb_query_bound libretrodb_query_field_bound(
+      libretrodb_query_t *q, const char *field, size_t field_len,
+      struct rmsgpack_dom_value *min, struct rmsgpack_dom_value *max);
+
 RETRO_END_DECLS
 
 #endif
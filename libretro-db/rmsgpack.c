@@ -593,3 +593,223 @@ end:
       free(buff);
    return 0;
 }
+
+/* Number of big-endian length bytes that follow the type byte,
+ * or -1 for types rmsgpack never writes (floats, extensions). */
+static int rmsgpack_raw_len_size(uint8_t type)
+{
+   if (type < MPF_NIL || type > MPF_MAP32)
+      return 0;
+
+   switch (type)
+   {
+      case _MPF_NIL:
+      case _MPF_FALSE:
+      case _MPF_TRUE:
+      case _MPF_UINT8:
+      case _MPF_UINT16:
+      case _MPF_UINT32:
+      case _MPF_UINT64:
+      case _MPF_INT8:
+      case _MPF_INT16:
+      case _MPF_INT32:
+      case _MPF_INT64:
+         return 0;
+      case _MPF_BIN8:
+      case _MPF_STR8:
+         return 1;
+      case _MPF_BIN16:
+      case _MPF_STR16:
+      case _MPF_ARRAY16:
+      case _MPF_MAP16:
+         return 2;
+      case _MPF_BIN32:
+      case _MPF_STR32:
+      case _MPF_ARRAY32:
+      case _MPF_MAP32:
+         return 4;
+   }
+
+   return -1;
+}
+
+/**
+ * rmsgpack_raw_header:
+ * @p                   : Start of an encoded value.
+ * @end                 : End of the readable buffer.
+ * @header_len          : Size of the type byte and length prefix.
+ * @payload_len         : Size of the data that follows the header.
+ * @children            : Number of nested values that follow the
+ *                        payload (two per map pair).
+ *
+ * Decodes the header of the value at @p without touching its payload.
+ *
+ * Returns: 0 on success, -1 if the header is truncated or unsupported.
+ **/
+int rmsgpack_raw_header(const uint8_t *p, const uint8_t *end,
+      size_t *header_len, uint64_t *payload_len, uint64_t *children)
+{
+   int i;
+   int len_size;
+   uint8_t type;
+   uint64_t n = 0;
+
+   if (p >= end)
+      return -1;
+
+   type = *p;
+   if ((len_size = rmsgpack_raw_len_size(type)) < 0)
+      return -1;
+   if ((size_t)(end - p) < (size_t)(1 + len_size))
+      return -1;
+
+   for (i = 1; i <= len_size; i++)
+      n = (n << 8) | p[i];
+
+   *header_len  = 1 + len_size;
+   *payload_len = 0;
+   *children    = 0;
+
+   if (type < MPF_FIXMAP || type > MPF_MAP32)
+      return 0;
+   else if (type < MPF_FIXARRAY)
+      *children    = 2 * (uint64_t)(type - MPF_FIXMAP);
+   else if (type < MPF_FIXSTR)
+      *children    = type - MPF_FIXARRAY;
+   else if (type < MPF_NIL)
+      *payload_len = type - MPF_FIXSTR;
+   else
+   {
+      switch (type)
+      {
+         case _MPF_UINT8:
+         case _MPF_UINT16:
+         case _MPF_UINT32:
+         case _MPF_UINT64:
+            *payload_len = UINT64_C(1) << (type - _MPF_UINT8);
+            break;
+         case _MPF_INT8:
+         case _MPF_INT16:
+         case _MPF_INT32:
+         case _MPF_INT64:
+            *payload_len = UINT64_C(1) << (type - _MPF_INT8);
+            break;
+         case _MPF_BIN8:
+         case _MPF_BIN16:
+         case _MPF_BIN32:
+         case _MPF_STR8:
+         case _MPF_STR16:
+         case _MPF_STR32:
+            *payload_len = n;
+            break;
+         case _MPF_ARRAY16:
+         case _MPF_ARRAY32:
+            *children    = n;
+            break;
+         case _MPF_MAP16:
+         case _MPF_MAP32:
+            *children    = 2 * n;
+            break;
+      }
+   }
+
+   return 0;
+}
+
+/**
+ * rmsgpack_skip:
+ * @p                   : Start of an encoded value.
+ * @end                 : End of the readable buffer.
+ *
+ * Walks over one complete value, including everything nested in it.
+ *
+ * Returns: pointer just past the value, or NULL if it is malformed.
+ **/
+const uint8_t *rmsgpack_skip(const uint8_t *p, const uint8_t *end)
+{
+   uint64_t remaining = 1;
+
+   while (remaining > 0)
+   {
+      size_t header_len;
+      uint64_t payload_len, children;
+
+      if (rmsgpack_raw_header(p, end,
+               &header_len, &payload_len, &children) < 0)
+         return NULL;
+      if ((uint64_t)(end - p) < header_len + payload_len)
+         return NULL;
+
+      p         += header_len + payload_len;
+      remaining += children;
+      remaining--;
+   }
+
+   return p;
+}
+
+/**
+ * rmsgpack_read_raw:
+ * @fd                  : File to read from.
+ * @buff                : Growable buffer receiving the encoded bytes.
+ * @cap                 : Allocated size of @buff.
+ * @len                 : Number of bytes stored in @buff.
+ *
+ * Copies one complete encoded value from @fd into @buff without
+ * decoding it, so it can be inspected in place.
+ *
+ * Returns: 0 on success, -1 on read error or malformed input.
+ **/
+int rmsgpack_read_raw(RFILE *fd, uint8_t **buff, size_t *cap, size_t *len)
+{
+   size_t pos         = 0;
+   uint64_t remaining = 1;
+
+   while (remaining > 0)
+   {
+      uint8_t header[5];
+      size_t header_len;
+      uint64_t payload_len, children;
+      int len_size;
+
+      if (filestream_read(fd, header, 1) != 1)
+         return -1;
+      if ((len_size = rmsgpack_raw_len_size(header[0])) < 0)
+         return -1;
+      if (len_size > 0 && filestream_read(fd, header + 1, len_size)
+            != len_size)
+         return -1;
+      if (rmsgpack_raw_header(header, header + 1 + len_size,
+               &header_len, &payload_len, &children) < 0)
+         return -1;
+
+      if (pos + header_len + payload_len > *cap)
+      {
+         size_t new_cap = *cap ? *cap : 256;
+         uint8_t *tmp;
+         while (new_cap < pos + header_len + payload_len)
+            new_cap *= 2;
+         if (!(tmp = (uint8_t*)realloc(*buff, new_cap)))
+            return -1;
+         *buff = tmp;
+         *cap  = new_cap;
+      }
+
+      memcpy(*buff + pos, header, header_len);
+      pos += header_len;
+
+      if (payload_len > 0)
+      {
+         if (filestream_read(fd, *buff + pos, (int64_t)payload_len)
+               != (int64_t)payload_len)
+            return -1;
+         pos += (size_t)payload_len;
+      }
+
+      remaining += children;
+      remaining--;
+   }
+
+   *len = pos;
+   return 0;
+}
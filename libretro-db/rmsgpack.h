@@ -24,6 +24,7 @@
 #define __LIBRETRODB_MSGPACK_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
 #include <streams/file_stream.h>
 
@@ -57,4 +58,11 @@ int rmsgpack_write_uint(RFILE *fd, uint64_t value );
 
 int rmsgpack_read(RFILE *fd, struct rmsgpack_read_callbacks *callbacks, void *data);
 
+int rmsgpack_raw_header(const uint8_t *p, const uint8_t *end,
+      size_t *header_len, uint64_t *payload_len, uint64_t *children);
+
+const uint8_t *rmsgpack_skip(const uint8_t *p, const uint8_t *end);
+
+int rmsgpack_read_raw(RFILE *fd, uint8_t **buff, size_t *cap, size_t *len);
+
 #endif
@@ -32,6 +32,8 @@
 
 #define MAX_DEPTH 128
 
+#define RMSGPACK_DOM_ARENA_ALIGN(x) (((x) + 7) & ~(size_t)7)
+
 struct dom_reader_state
 {
    int i;
@@ -496,3 +498,415 @@ clean:
    rmsgpack_dom_value_free(&map);
    return 0;
 }
+
+/**
+ * rmsgpack_dom_view:
+ * @p                   : Start of an encoded value.
+ * @end                 : End of the readable buffer.
+ * @out                 : Value to fill in.
+ *
+ * Decodes the value at @p without allocating. Strings and binaries
+ * point straight into the encoded buffer and are not NUL-terminated.
+ * Maps and arrays only report their type and length, their items
+ * pointer is left NULL.
+ *
+ * Returns: pointer just past the value, or NULL if it is malformed.
+ **/
+const uint8_t *rmsgpack_dom_view(const uint8_t *p, const uint8_t *end,
+      struct rmsgpack_dom_value *out)
+{
+   size_t i;
+   size_t header_len;
+   uint64_t payload_len, children;
+   uint64_t n = 0;
+   uint8_t type;
+
+   if (rmsgpack_raw_header(p, end, &header_len, &payload_len, &children) < 0)
+      return NULL;
+   if ((uint64_t)(end - p) < header_len + payload_len)
+      return NULL;
+
+   type = *p;
+
+   if (type < 0x80)
+   {
+      out->type     = RDT_INT;
+      out->val.int_ = type;
+      return p + 1;
+   }
+   else if (type >= 0xe0)
+   {
+      out->type     = RDT_INT;
+      out->val.int_ = (int8_t)type;
+      return p + 1;
+   }
+   else if (type < 0x90 || type == 0xde || type == 0xdf)
+   {
+      out->type          = RDT_MAP;
+      out->val.map.len   = (uint32_t)(children / 2);
+      out->val.map.items = NULL;
+      return rmsgpack_skip(p, end);
+   }
+   else if (type < 0xa0 || type == 0xdc || type == 0xdd)
+   {
+      out->type            = RDT_ARRAY;
+      out->val.array.len   = (uint32_t)children;
+      out->val.array.items = NULL;
+      return rmsgpack_skip(p, end);
+   }
+   else if (type < 0xc0 || type == 0xd9 || type == 0xda || type == 0xdb)
+   {
+      out->type            = RDT_STRING;
+      out->val.string.len  = (uint32_t)payload_len;
+      out->val.string.buff = (char*)(p + header_len);
+      return p + header_len + payload_len;
+   }
+
+   switch (type)
+   {
+      case 0xc0:
+         out->type = RDT_NULL;
+         break;
+      case 0xc2:
+      case 0xc3:
+         out->type      = RDT_BOOL;
+         out->val.bool_ = (type == 0xc3);
+         break;
+      case 0xc4:
+      case 0xc5:
+      case 0xc6:
+         out->type            = RDT_BINARY;
+         out->val.binary.len  = (uint32_t)payload_len;
+         out->val.binary.buff = (char*)(p + header_len);
+         break;
+      case 0xcc:
+      case 0xcd:
+      case 0xce:
+      case 0xcf:
+         for (i = 0; i < payload_len; i++)
+            n = (n << 8) | p[1 + i];
+         out->type      = RDT_UINT;
+         out->val.uint_ = n;
+         break;
+      case 0xd0:
+      case 0xd1:
+      case 0xd2:
+      case 0xd3:
+         for (i = 0; i < payload_len; i++)
+            n = (n << 8) | p[1 + i];
+         /* Sign-extend from the encoded width */
+         if (payload_len < 8 && (n >> (payload_len * 8 - 1)) & 1)
+            n |= ~UINT64_C(0) << (payload_len * 8);
+         out->type     = RDT_INT;
+         out->val.int_ = (int64_t)n;
+         break;
+      default:
+         return NULL;
+   }
+
+   return p + header_len + payload_len;
+}
+
+/**
+ * rmsgpack_dom_view_map_value:
+ * @p                   : Start of an encoded map.
+ * @end                 : End of the readable buffer.
+ * @key                 : Key to look up.
+ * @out                 : Receives a view of the value (see rmsgpack_dom_view).
+ *
+ * Looks up @key in the encoded map at @p without decoding the
+ * other entries.
+ *
+ * Returns: pointer to the encoded value, or NULL if @p is not a map,
+ * the key is missing or the map is malformed.
+ **/
+const uint8_t *rmsgpack_dom_view_map_value(const uint8_t *p,
+      const uint8_t *end, const struct rmsgpack_dom_value *key,
+      struct rmsgpack_dom_value *out)
+{
+   uint64_t i;
+   size_t header_len;
+   uint64_t payload_len, children;
+
+   if (p >= end || !((*p >= 0x80 && *p < 0x90) || *p == 0xde || *p == 0xdf))
+      return NULL;
+   if (rmsgpack_raw_header(p, end, &header_len, &payload_len, &children) < 0)
+      return NULL;
+
+   /* Step over the map header to the first key */
+   p += header_len;
+
+   for (i = 0; i < children; i += 2)
+   {
+      struct rmsgpack_dom_value k;
+      const uint8_t *value;
+
+      memset(&k, 0, sizeof(k));
+      if (!(value = rmsgpack_dom_view(p, end, &k)))
+         return NULL;
+
+      if (rmsgpack_dom_value_cmp(key, &k) == 0)
+         return rmsgpack_dom_view(value, end, out) ? value : NULL;
+
+      if (!(p = rmsgpack_skip(value, end)))
+         return NULL;
+   }
+
+   return NULL;
+}
+
+/* Type of the encoded value starting with @type, containers included */
+static enum rmsgpack_dom_type rmsgpack_dom_raw_type(uint8_t type)
+{
+   if (type < 0x80 || type >= 0xe0)
+      return RDT_INT;
+   else if (type < 0x90 || type == 0xde || type == 0xdf)
+      return RDT_MAP;
+   else if (type < 0xa0 || type == 0xdc || type == 0xdd)
+      return RDT_ARRAY;
+   else if (type < 0xc0 || type == 0xd9 || type == 0xda || type == 0xdb)
+      return RDT_STRING;
+   /* Scalars are told apart by rmsgpack_dom_view() */
+   return RDT_NULL;
+}
+
+/* Arena bytes needed to decode the value at @p, or -1 if malformed */
+static int64_t rmsgpack_dom_view_tree_size(const uint8_t *p,
+      const uint8_t *end)
+{
+   size_t need        = 0;
+   uint64_t remaining = 1;
+
+   while (remaining > 0)
+   {
+      size_t header_len;
+      uint64_t payload_len, children;
+
+      if (rmsgpack_raw_header(p, end,
+               &header_len, &payload_len, &children) < 0)
+         return -1;
+      if ((uint64_t)(end - p) < header_len + payload_len)
+         return -1;
+
+      switch (rmsgpack_dom_raw_type(*p))
+      {
+         case RDT_MAP:
+            need += RMSGPACK_DOM_ARENA_ALIGN((size_t)(children / 2)
+                  * sizeof(struct rmsgpack_dom_pair));
+            break;
+         case RDT_ARRAY:
+            need += RMSGPACK_DOM_ARENA_ALIGN((size_t)children
+                  * sizeof(struct rmsgpack_dom_value));
+            break;
+         case RDT_STRING:
+            need += RMSGPACK_DOM_ARENA_ALIGN((size_t)payload_len + 1);
+            break;
+         default:
+            break;
+      }
+
+      p         += header_len + payload_len;
+      remaining += children;
+      remaining--;
+   }
+
+   return (int64_t)need;
+}
+
+static void *rmsgpack_dom_arena_alloc(struct rmsgpack_dom_arena *arena,
+      size_t len)
+{
+   void *ptr    = arena->buff + arena->used;
+   arena->used += RMSGPACK_DOM_ARENA_ALIGN(len);
+   return ptr;
+}
+
+static const uint8_t *rmsgpack_dom_view_fill(const uint8_t *p,
+      const uint8_t *end, struct rmsgpack_dom_arena *arena,
+      struct rmsgpack_dom_value *out, int depth)
+{
+   uint32_t i;
+   size_t header_len;
+   uint64_t payload_len, children;
+
+   if (depth >= MAX_DEPTH)
+      return NULL;
+
+   switch (rmsgpack_dom_raw_type(*p))
+   {
+      case RDT_MAP:
+         rmsgpack_raw_header(p, end, &header_len, &payload_len, &children);
+         p                  = p + header_len;
+         out->type          = RDT_MAP;
+         out->val.map.len   = (uint32_t)(children / 2);
+         out->val.map.items = (out->val.map.len == 0) ? NULL
+            : (struct rmsgpack_dom_pair*)rmsgpack_dom_arena_alloc(arena,
+                  out->val.map.len * sizeof(struct rmsgpack_dom_pair));
+         /* Items are stored last to first, like rmsgpack_dom_read() */
+         for (i = out->val.map.len; i > 0 && p; i--)
+         {
+            if ((p = rmsgpack_dom_view_fill(p, end, arena,
+                        &out->val.map.items[i - 1].key, depth + 1)))
+               p = rmsgpack_dom_view_fill(p, end, arena,
+                     &out->val.map.items[i - 1].value, depth + 1);
+         }
+         return p;
+      case RDT_ARRAY:
+         rmsgpack_raw_header(p, end, &header_len, &payload_len, &children);
+         p                    = p + header_len;
+         out->type            = RDT_ARRAY;
+         out->val.array.len   = (uint32_t)children;
+         out->val.array.items = (out->val.array.len == 0) ? NULL
+            : (struct rmsgpack_dom_value*)rmsgpack_dom_arena_alloc(arena,
+                  out->val.array.len * sizeof(struct rmsgpack_dom_value));
+         for (i = out->val.array.len; i > 0 && p; i--)
+            p = rmsgpack_dom_view_fill(p, end, arena,
+                  &out->val.array.items[i - 1], depth + 1);
+         return p;
+      case RDT_STRING:
+         {
+            /* Callers treat strings as C strings, so these are
+             * terminated copies rather than views */
+            char *str;
+            const uint8_t *next = rmsgpack_dom_view(p, end, out);
+            if (!next)
+               return NULL;
+            str = (char*)rmsgpack_dom_arena_alloc(arena,
+                  out->val.string.len + 1);
+            memcpy(str, out->val.string.buff, out->val.string.len);
+            str[out->val.string.len] = '\0';
+            out->val.string.buff     = str;
+            return next;
+         }
+      default:
+         break;
+   }
+
+   return rmsgpack_dom_view(p, end, out);
+}
+
+/**
+ * rmsgpack_dom_view_tree:
+ * @p                   : Start of an encoded value.
+ * @end                 : End of the readable buffer.
+ * @arena               : Arena holding maps, arrays and strings.
+ * @out                 : Decoded value.
+ *
+ * Decodes a complete value without a heap allocation per node.
+ * Map and array items and NUL-terminated copies of strings live in
+ * @arena, binaries point straight into the encoded buffer. The
+ * result stays valid until the next decode into @arena and must not
+ * be passed to rmsgpack_dom_value_free().
+ *
+ * Returns: number of bytes consumed, or -1 on malformed input.
+ **/
+int64_t rmsgpack_dom_view_tree(const uint8_t *p, const uint8_t *end,
+      struct rmsgpack_dom_arena *arena, struct rmsgpack_dom_value *out)
+{
+   const uint8_t *next;
+   int64_t need = rmsgpack_dom_view_tree_size(p, end);
+
+   if (need < 0)
+      return -1;
+
+   if ((size_t)need > arena->size)
+   {
+      size_t new_size = arena->size ? arena->size : 4096;
+      uint8_t *tmp;
+      while (new_size < (size_t)need)
+         new_size *= 2;
+      if (!(tmp = (uint8_t*)realloc(arena->buff, new_size)))
+         return -1;
+      arena->buff = tmp;
+      arena->size = new_size;
+   }
+
+   arena->used = 0;
+
+   if (!(next = rmsgpack_dom_view_fill(p, end, arena, out, 0)))
+   {
+      out->type = RDT_NULL;
+      return -1;
+   }
+
+   return (int64_t)(next - p);
+}
+
+void rmsgpack_dom_arena_free(struct rmsgpack_dom_arena *arena)
+{
+   if (arena->buff)
+      free(arena->buff);
+   arena->buff = NULL;
+   arena->size = 0;
+   arena->used = 0;
+}
+
+/**
+ * rmsgpack_dom_value_copy:
+ * @src                 : Value to copy, views included.
+ * @out                 : Heap allocated copy, free with
+ *                        rmsgpack_dom_value_free().
+ *
+ * Returns: 0 on success, -1 if out of memory.
+ **/
+int rmsgpack_dom_value_copy(const struct rmsgpack_dom_value *src,
+      struct rmsgpack_dom_value *out)
+{
+   uint32_t i;
+
+   *out = *src;
+
+   switch (src->type)
+   {
+      case RDT_STRING:
+      case RDT_BINARY:
+         if (!(out->val.string.buff = (char*)malloc(src->val.string.len + 1)))
+            break;
+         memcpy(out->val.string.buff, src->val.string.buff,
+               src->val.string.len);
+         out->val.string.buff[src->val.string.len] = '\0';
+         return 0;
+      case RDT_MAP:
+         out->val.map.len   = 0;
+         if (!(out->val.map.items = (struct rmsgpack_dom_pair*)calloc(
+                     src->val.map.len + 1, sizeof(struct rmsgpack_dom_pair))))
+            break;
+         for (i = 0; i < src->val.map.len; i++)
+         {
+            if (rmsgpack_dom_value_copy(&src->val.map.items[i].key,
+                     &out->val.map.items[i].key) < 0)
+               goto error;
+            if (rmsgpack_dom_value_copy(&src->val.map.items[i].value,
+                     &out->val.map.items[i].value) < 0)
+            {
+               rmsgpack_dom_value_free(&out->val.map.items[i].key);
+               goto error;
+            }
+            out->val.map.len++;
+         }
+         return 0;
+      case RDT_ARRAY:
+         out->val.array.len   = 0;
+         if (!(out->val.array.items = (struct rmsgpack_dom_value*)calloc(
+                     src->val.array.len + 1, sizeof(struct rmsgpack_dom_value))))
+            break;
+         for (i = 0; i < src->val.array.len; i++)
+         {
+            if (rmsgpack_dom_value_copy(&src->val.array.items[i],
+                     &out->val.array.items[i]) < 0)
+               goto error;
+            out->val.array.len++;
+         }
+         return 0;
+      default:
+         return 0;
+   }
+
+   out->type = RDT_NULL;
+   return -1;
+
+error:
+   rmsgpack_dom_value_free(out);
+   out->type = RDT_NULL;
+   return -1;
+}
@@ -24,6 +24,7 @@
 #define __LIBRETRODB_MSGPACK_DOM_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
 #include <retro_common_api.h>
 #include <streams/file_stream.h>
@@ -79,6 +80,16 @@ struct rmsgpack_dom_pair
 	struct rmsgpack_dom_value value; /* uint64_t alignment */
 };
 
+/* Reusable backing store for values decoded with
+ * rmsgpack_dom_view_tree(). Each decode starts over at the
+ * beginning, the buffer only grows. */
+struct rmsgpack_dom_arena
+{
+   uint8_t *buff;
+   size_t size;
+   size_t used;
+};
+
 void rmsgpack_dom_value_print(struct rmsgpack_dom_value *obj);
 void rmsgpack_dom_value_free(struct rmsgpack_dom_value *v);
 
@@ -95,6 +106,21 @@ int rmsgpack_dom_write(RFILE *fd, const struct rmsgpack_dom_value *obj);
 
 int rmsgpack_dom_read_into(RFILE *fd, ...);
 
+const uint8_t *rmsgpack_dom_view(const uint8_t *p, const uint8_t *end,
+      struct rmsgpack_dom_value *out);
+
+int64_t rmsgpack_dom_view_tree(const uint8_t *p, const uint8_t *end,
+      struct rmsgpack_dom_arena *arena, struct rmsgpack_dom_value *out);
+
+int rmsgpack_dom_value_copy(const struct rmsgpack_dom_value *src,
+      struct rmsgpack_dom_value *out);
+
+void rmsgpack_dom_arena_free(struct rmsgpack_dom_arena *arena);
+
+const uint8_t *rmsgpack_dom_view_map_value(const uint8_t *p,
+      const uint8_t *end, const struct rmsgpack_dom_value *key,
+      struct rmsgpack_dom_value *out);
+
 RETRO_END_DECLS
 
 #endif
@@ -2159,7 +2159,7 @@ static int generic_action_ok(const char *path,
                   action_path);
 
             task_push_image_load(action_path,
-                  video_driver_supports_rgba(), 0,
+                  video_driver_supports_rgba(), 0, 0,
                   menu_display_handle_wallpaper_upload, NULL);
          }
          break;
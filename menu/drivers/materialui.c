@@ -7044,6 +7044,8 @@ static void materialui_frame(void *data, video_frame_info_t *video_info)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, true, false);
 
+   gfx_display_batch_begin(p_disp);
+
    /* Clear text */
    font_bind(&mui->font_data.title);
    font_bind(&mui->font_data.list);
@@ -7283,6 +7285,8 @@ static void materialui_frame(void *data, video_frame_info_t *video_info)
    font_unbind(&mui->font_data.list);
    font_unbind(&mui->font_data.hint);
 
+   gfx_display_batch_end(p_disp);
+
    if (video_st->current_video && video_st->current_video->set_viewport)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, false, true);
@@ -8822,7 +8826,7 @@ static void materialui_context_reset(void *data, bool is_threaded)
 
    if (path_is_valid(path_menu_wallpaper))
       task_push_image_load(path_menu_wallpaper,
-            video_driver_supports_rgba(), 0,
+            video_driver_supports_rgba(), 0, 0,
             menu_display_handle_wallpaper_upload, NULL);
 
    video_driver_monitor_reset();
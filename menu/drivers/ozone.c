@@ -11409,6 +11409,8 @@ static void ozone_frame(void *data, video_frame_info_t *video_info)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, true, false);
 
+   gfx_display_batch_begin(p_disp);
+
    /* Clear text */
    font_bind(&ozone->fonts.footer);
    font_bind(&ozone->fonts.title);
@@ -11680,6 +11682,8 @@ static void ozone_frame(void *data, video_frame_info_t *video_info)
    font_unbind(&ozone->fonts.entries_sublabel);
    font_unbind(&ozone->fonts.sidebar);
 
+   gfx_display_batch_end(p_disp);
+
    if (video_st->current_video && video_st->current_video->set_viewport)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, false, true);
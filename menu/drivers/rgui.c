@@ -2359,6 +2359,7 @@ static bool rgui_request_thumbnail(
          if (task_push_image_load(thumbnail->path,
                video_driver_supports_rgba(),
                0,
+               0,
                (thumbnail_id == GFX_THUMBNAIL_LEFT)
                      ? rgui_handle_left_thumbnail_upload
                      : rgui_handle_thumbnail_upload,
@@ -3182,6 +3183,7 @@ end:
             task_push_image_load(wallpaper_path,
                   video_driver_supports_rgba(),
                   0,
+                  0,
                   menu_display_handle_wallpaper_upload,
                   NULL);
       }
@@ -1175,7 +1175,7 @@ static void xmb_update_dynamic_wallpaper(xmb_handle_t *xmb, bool reset)
       if (path_is_valid(path))
       {
          task_push_image_load(path,
-               video_driver_supports_rgba(), 0,
+               video_driver_supports_rgba(), 0, 0,
                menu_display_handle_wallpaper_upload, NULL);
 
          if (xmb->bg_file_path)
@@ -5700,6 +5700,8 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, true, false);
 
+   gfx_display_batch_begin(p_disp);
+
    pseudo_font_length                      = xmb->icon_spacing_horizontal * 4 - xmb->icon_size / 4.0f;
    left_thumbnail_margin_width             = xmb->icon_size * 3.4f;
    right_thumbnail_margin_width            =
@@ -6383,6 +6385,7 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
             video_width, video_height, xmb->font);
    }
 
+   gfx_display_batch_flush();
    if (xmb->font && xmb->font->renderer && xmb->font->renderer->flush)
       xmb->font->renderer->flush(video_width, video_height, xmb->font->renderer_data);
    if (xmb->font2 && xmb->font2->renderer && xmb->font2->renderer->flush)
@@ -6457,6 +6460,8 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
                video_height);
    }
 
+   gfx_display_batch_end(p_disp);
+
    if (video_st->current_video && video_st->current_video->set_viewport)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, false, true);
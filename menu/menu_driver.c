@@ -65,6 +65,7 @@
 #endif
 
 #include "../gfx/gfx_animation.h"
+#include "../gfx/gfx_thumbnail.h"
 #include "../input/input_driver.h"
 #include "../input/input_remapping.h"
 #include "../performance_counters.h"
@@ -4629,6 +4630,7 @@ static bool menu_driver_init_internal(
       return false;
 
    gfx_display_init();
+   menu_driver_set_thumbnail_cache(settings);
 
    /* TODO/FIXME - can we get rid of this? Is this needed? */
    configuration_set_string(settings,
@@ -6670,6 +6672,7 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
             if (menu_st->thumbnail_path_data)
                free(menu_st->thumbnail_path_data);
             menu_st->thumbnail_path_data    = NULL;
+            gfx_thumbnail_cache_free();
 
             if (menu_st->driver_data->core_buf)
                free(menu_st->driver_data->core_buf);
@@ -8061,6 +8064,25 @@ void menu_driver_set_thumbnail_system(void *data, char *s, size_t len)
          menu_st->thumbnail_path_data, s, playlist_get_cached());
 }
 
+/* Hands the thumbnail cache settings over to
+ * gfx_thumbnail */
+void menu_driver_set_thumbnail_cache(settings_t *settings)
+{
+   char disk_cache_dir[PATH_MAX_LENGTH];
+
+   disk_cache_dir[0] = '\0';
+   if (     settings->bools.gfx_thumbnail_disk_cache
+         && !string_is_empty(settings->paths.directory_cache))
+      fill_pathname_join_special(disk_cache_dir,
+            settings->paths.directory_cache, "thumbnails",
+            sizeof(disk_cache_dir));
+
+   gfx_thumbnail_set_cache(
+         (size_t)settings->uints.gfx_thumbnail_cache_size * 1024 * 1024,
+         settings->uints.gfx_thumbnail_downscale_threshold,
+         disk_cache_dir);
+}
+
 size_t menu_driver_get_thumbnail_system(void *data, char *s, size_t len)
 {
    const char *system         = NULL;
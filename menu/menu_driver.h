@@ -747,6 +747,8 @@ void menu_driver_set_thumbnail_system(void *data, char *s, size_t len);
 
 size_t menu_driver_get_thumbnail_system(void *data, char *s, size_t len);
 
+void menu_driver_set_thumbnail_cache(settings_t *settings);
+
 extern const menu_ctx_driver_t *menu_ctx_drivers[];
 
 extern menu_ctx_driver_t menu_ctx_ozone;
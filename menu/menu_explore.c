@@ -631,10 +631,11 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
       bool more                = 
          (
           libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
-          && libretrodb_cursor_read_item(cur, &item) == 0);
+          && libretrodb_cursor_read_item_view(cur, &item) == 0);
 
-      for (; more; more = (rmsgpack_dom_value_free(&item),
-               libretrodb_cursor_read_item(cur, &item) == 0))
+      /* Items are backed by the cursor and only valid until the next
+       * read, strings that are kept get copied below */
+      for (; more; more = (libretrodb_cursor_read_item_view(cur, &item) == 0))
       {
          unsigned k, l, cat;
          explore_entry_t* e;
@@ -665,16 +666,20 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
             key_str                         = key->val.string.buff;
             if (string_is_equal(key_str, "crc"))
             {
+               /* Binaries point into the mapped file, may be unaligned */
+               uint16_t crc16;
                switch (val->val.binary.len)
                {
                   case 1:
                      crc32 = *(uint8_t*)val->val.binary.buff;
                      break;
                   case 2:
-                     crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
+                     memcpy(&crc16, val->val.binary.buff, sizeof(crc16));
+                     crc32 = swap_if_little16(crc16);
                      break;
                   case 4:
-                     crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
+                     memcpy(&crc32, val->val.binary.buff, sizeof(crc32));
+                     crc32 = swap_if_little32(crc32);
                      break;
                   default:
                      crc32 = 0;
@@ -790,10 +795,7 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
 
          /* if all entries have found connections, we can leave early */
          if (--rdb->count == 0)
-         {
-            rmsgpack_dom_value_free(&item);
             break;
-         }
       }
 
       libretrodb_cursor_close(cur);
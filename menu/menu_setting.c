@@ -8128,6 +8128,12 @@ static void general_write_handler(rarch_setting_t *setting)
          video_shader_toggle(settings);
 #endif
          break;
+      case MENU_ENUM_LABEL_MENU_THUMBNAIL_DOWNSCALE_THRESHOLD:
+      case MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE:
+      case MENU_ENUM_LABEL_MENU_THUMBNAIL_DISK_CACHE:
+      case MENU_ENUM_LABEL_CACHE_DIRECTORY:
+         menu_driver_set_thumbnail_cache(settings);
+         break;
       case MENU_ENUM_LABEL_VIDEO_THREADED:
          if (*setting->value.target.boolean)
             task_queue_set_threaded();
@@ -11198,7 +11204,7 @@ static bool setting_append_list(
       case SETTINGS_LIST_SAVING:
          {
             uint8_t i, listing = 0;
-            struct bool_entry bool_entries[12];
+            struct bool_entry bool_entries[13];
 
             START_GROUP(list, list_info, &group_info, msg_hash_to_str(MENU_ENUM_LABEL_VALUE_SAVING_SETTINGS), parent_group);
             parent_group = msg_hash_to_str(MENU_ENUM_LABEL_SAVING_SETTINGS);
@@ -11290,6 +11296,13 @@ static bool setting_append_list(
             bool_entries[listing].flags          = SD_FLAG_ADVANCED;
             listing++;
 
+            bool_entries[listing].target         = &settings->bools.screenshot_fast_compression;
+            bool_entries[listing].name_enum_idx  = MENU_ENUM_LABEL_SCREENSHOT_FAST_COMPRESSION;
+            bool_entries[listing].SHORT_enum_idx = MENU_ENUM_LABEL_VALUE_SCREENSHOT_FAST_COMPRESSION;
+            bool_entries[listing].default_value  = DEFAULT_SCREENSHOT_FAST_COMPRESSION;
+            bool_entries[listing].flags          = SD_FLAG_ADVANCED;
+            listing++;
+
             for (i = 0; i < ARRAY_SIZE(bool_entries); i++)
             {
                CONFIG_BOOL(
@@ -14247,6 +14260,23 @@ static bool setting_append_list(
          MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_AUDIO_REINIT);
          SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_latency_adaptive,
+               MENU_ENUM_LABEL_AUDIO_LATENCY_ADAPTIVE,
+               MENU_ENUM_LABEL_VALUE_AUDIO_LATENCY_ADAPTIVE,
+               DEFAULT_AUDIO_LATENCY_ADAPTIVE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+         MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_AUDIO_REINIT);
+
          CONFIG_FLOAT(
                list, list_info,
                &settings->floats.audio_max_timing_skew,
@@ -15866,6 +15896,22 @@ static bool setting_append_list(
          MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_REINIT);
          SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_CMD_APPLY_AUTO);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.frame_limit_precise,
+               MENU_ENUM_LABEL_FRAME_LIMIT_PRECISE,
+               MENU_ENUM_LABEL_VALUE_FRAME_LIMIT_PRECISE,
+               DEFAULT_FRAME_LIMIT_PRECISE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.menu_throttle_framerate,
@@ -19252,6 +19298,50 @@ static bool setting_append_list(
                   general_read_handler);
             (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint_special;
             menu_settings_list_current_add_range(list, list_info, 0, 1024, 256, true, true);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.gfx_thumbnail_downscale_threshold,
+                  MENU_ENUM_LABEL_MENU_THUMBNAIL_DOWNSCALE_THRESHOLD,
+                  MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_DOWNSCALE_THRESHOLD,
+                  DEFAULT_GFX_THUMBNAIL_DOWNSCALE_THRESHOLD,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint_special;
+            menu_settings_list_current_add_range(list, list_info, 0, 2048, 128, true, true);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.gfx_thumbnail_cache_size,
+                  MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,
+                  MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_SIZE,
+                  DEFAULT_GFX_THUMBNAIL_CACHE_SIZE,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 512, 8, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.gfx_thumbnail_disk_cache,
+                  MENU_ENUM_LABEL_MENU_THUMBNAIL_DISK_CACHE,
+                  MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_DISK_CACHE,
+                  DEFAULT_GFX_THUMBNAIL_DISK_CACHE,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_ADVANCED);
          }
 
          if (string_is_equal(settings->arrays.menu_driver, "rgui"))
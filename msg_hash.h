@@ -1580,6 +1580,9 @@ enum msg_hash_enums
    MENU_LABEL(MENU_XMB_TITLE_MARGIN),
    MENU_LABEL(MENU_XMB_TITLE_MARGIN_HORIZONTAL_OFFSET),
    MENU_LABEL(MENU_THUMBNAIL_UPSCALE_THRESHOLD),
+   MENU_LABEL(MENU_THUMBNAIL_DOWNSCALE_THRESHOLD),
+   MENU_LABEL(MENU_THUMBNAIL_CACHE_SIZE),
+   MENU_LABEL(MENU_THUMBNAIL_DISK_CACHE),
    MENU_LABEL(MENU_RGUI_INLINE_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_SWAP_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_THUMBNAIL_DOWNSCALER),
@@ -2230,6 +2233,7 @@ enum msg_hash_enums
    MENU_LABEL(AUDIO_MIXER_VOLUME),
    MENU_LBL_H(AUDIO_RATE_CONTROL_DELTA),
    MENU_LABEL(AUDIO_LATENCY),
+   MENU_LABEL(AUDIO_LATENCY_ADAPTIVE),
    MENU_LABEL(AUDIO_RESAMPLER_QUALITY),
    MENU_LABEL(AUDIO_WASAPI_EXCLUSIVE_MODE),
    MENU_LABEL(AUDIO_WASAPI_FLOAT_FORMAT),
@@ -2466,6 +2470,7 @@ enum msg_hash_enums
    MENU_LABEL(SAVESTATES_IN_CONTENT_DIR_ENABLE),
    MENU_LABEL(SYSTEMFILES_IN_CONTENT_DIR_ENABLE),
    MENU_LABEL(SCREENSHOTS_IN_CONTENT_DIR_ENABLE),
+   MENU_LABEL(SCREENSHOT_FAST_COMPRESSION),
    MENU_LABEL(SORT_SCREENSHOTS_BY_CONTENT_ENABLE),
    MENU_LABEL(NETPLAY_IP_ADDRESS),
    MENU_LABEL(NETPLAY_PASSWORD),
@@ -2500,6 +2505,7 @@ enum msg_hash_enums
    MENU_LBL_H(FASTFORWARD_RATIO),
    MENU_LABEL(FASTFORWARD_FRAMESKIP),
    MENU_LBL_H(VRR_RUNLOOP_ENABLE),
+   MENU_LABEL(FRAME_LIMIT_PRECISE),
    MENU_LABEL(REWIND_ENABLE),
    MENU_LABEL(CHEAT_APPLY_AFTER_TOGGLE),
    MENU_LABEL(CHEAT_APPLY_AFTER_LOAD),
@@ -516,11 +516,19 @@ static void deinit_lan_ad_server_socket(void)
 static bool netplay_lan_ad_server(netplay_t *netplay)
 {
    uint32_t header;
+   ssize_t ret;
    struct sockaddr_storage their_addr = {0};
    socklen_t addr_size                = sizeof(their_addr);
+   uint32_t rom_crc                   = 0;
    net_driver_state_t *net_st         = &networking_driver_st;
+
+   /* Leave queries on the socket until the content CRC
+    * task has finished, rather than waiting for it */
+   if (!content_poll_crc(&rom_crc))
+      return true;
+
    /* Check for any ad queries */
-   ssize_t ret                        = recvfrom(net_st->lan_ad_server_fd,
+   ret                                = recvfrom(net_st->lan_ad_server_fd,
       (char*)&header, sizeof(header), 0,
       (struct sockaddr*)&their_addr, &addr_size);
 
@@ -617,7 +625,7 @@ static bool netplay_lan_ad_server(netplay_t *netplay)
          strlcpy(ad_packet_buffer.subsystem_name, "N/A",
             sizeof(ad_packet_buffer.subsystem_name));
 
-         ad_packet_buffer.content_crc = (int32_t)htonl(content_get_crc());
+         ad_packet_buffer.content_crc = (int32_t)htonl(rom_crc);
       }
 
       if (!string_is_empty(settings->paths.netplay_password))
@@ -8299,12 +8307,18 @@ static void netplay_announce(netplay_t *netplay)
    int mitm_custom_port             = 0;
    int is_mitm                      = 0;
    uint32_t content_crc             = 0;
+   uint32_t rom_crc                 = 0;
    net_driver_state_t *net_st       = &networking_driver_st;
    struct netplay_room *host_room   = &net_st->host_room;
    struct retro_system_info *system = &runloop_state_get_ptr()->system.info;
    struct string_list *subsystem    = path_get_subsystem_list();
    settings_t *settings             = config_get_ptr();
 
+   /* Retried on the next frame until the content CRC
+    * task has finished, rather than waiting for it */
+   if (!content_poll_crc(&rom_crc))
+      return;
+
    net_http_urlencode(&username, netplay->nick);
 
    strlcpy(buf, system->library_name, sizeof(host_room->corename));
@@ -8344,7 +8358,7 @@ static void netplay_announce(netplay_t *netplay)
 
       net_http_urlencode(&subsystemname, "N/A");
 
-      content_crc = content_get_crc();
+      content_crc = rom_crc;
    }
 
    frontend_drv =
@@ -24,7 +24,9 @@
 
 #include <boolean.h>
 #include <queues/fifo_queue.h>
+#include <queues/spsc_queue.h>
 #include <rthreads/rthreads.h>
+#include <features/features_cpu.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <file/config_file.h>
@@ -185,8 +187,8 @@ typedef struct ffmpeg
 
    scond_t *cond;
    slock_t *cond_lock;
-   slock_t *lock;
-   fifo_buffer_t *audio_fifo;
+   slock_t *lock;        /* Guards video_fifo and attr_fifo */
+   spsc_queue_t *audio_fifo;
    fifo_buffer_t *video_fifo;
    fifo_buffer_t *attr_fifo;
    sthread_t *thread;
@@ -427,6 +429,8 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
       video->scaler.out_fmt = SCALER_FMT_BGR24;
    }
 
+   video->scaler.threads    = cpu_features_get_core_amount();
+
    switch (param->pix_fmt)
    {
       case FFEMU_PIX_RGB565:
@@ -871,7 +875,7 @@ static bool init_thread(ffmpeg_t *handle)
    handle->lock       = slock_new();
    handle->cond_lock  = slock_new();
    handle->cond       = scond_new();
-   handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
+   handle->audio_fifo = spsc_queue_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
    handle->attr_fifo  = fifo_new(sizeof(struct record_video_data) * MAX_FRAMES);
    handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
@@ -908,7 +912,7 @@ static void deinit_thread_buf(ffmpeg_t *handle)
 {
    if (handle->audio_fifo)
    {
-      fifo_free(handle->audio_fifo);
+      spsc_queue_free(handle->audio_fifo);
       handle->audio_fifo = NULL;
    }
 
@@ -1129,11 +1133,7 @@ static bool ffmpeg_push_audio(void *data,
 
    for (;;)
    {
-      unsigned avail;
-
-      slock_lock(handle->lock);
-      avail = FIFO_WRITE_AVAIL(handle->audio_fifo);
-      slock_unlock(handle->lock);
+      size_t avail = spsc_queue_write_avail(handle->audio_fifo);
 
       if (!handle->alive)
          return false;
@@ -1155,10 +1155,8 @@ static bool ffmpeg_push_audio(void *data,
       slock_unlock(handle->cond_lock);
    }
 
-   slock_lock(handle->lock);
-   fifo_write(handle->audio_fifo, audio_data->data,
+   spsc_queue_write(handle->audio_fifo, audio_data->data,
          audio_data->frames * handle->params.channels * sizeof(int16_t));
-   slock_unlock(handle->lock);
    scond_signal(handle->cond);
 
    return true;
@@ -1533,13 +1531,13 @@ static bool ffmpeg_push_audio_thread(ffmpeg_t *handle,
 static void ffmpeg_flush_audio(ffmpeg_t *handle, void *audio_buf,
       size_t audio_buf_size)
 {
-   size_t avail = FIFO_READ_AVAIL(handle->audio_fifo);
+   size_t avail = spsc_queue_read_avail(handle->audio_fifo);
 
    if (avail)
    {
       struct record_audio_data aud = {0};
 
-      fifo_read(handle->audio_fifo, audio_buf, avail);
+      spsc_queue_read(handle->audio_fifo, audio_buf, avail);
 
       aud.frames = avail / (sizeof(int16_t) * handle->params.channels);
       aud.data = audio_buf;
@@ -1579,11 +1577,11 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
       if (handle->config.audio_enable)
       {
-         if (FIFO_READ_AVAIL(handle->audio_fifo) >= audio_buf_size)
+         if (spsc_queue_read_avail(handle->audio_fifo) >= audio_buf_size)
          {
             struct record_audio_data aud = {0};
 
-            fifo_read(handle->audio_fifo, audio_buf, audio_buf_size);
+            spsc_queue_read(handle->audio_fifo, audio_buf, audio_buf_size);
             aud.frames = handle->audio.codec->frame_size;
             aud.data   = audio_buf;
             ffmpeg_push_audio_thread(handle, &aud, true);
@@ -1657,11 +1655,11 @@ static void ffmpeg_thread(void *data)
       slock_lock(ff->lock);
       if (FIFO_READ_AVAIL(ff->attr_fifo) >= sizeof(attr_buf))
          avail_video = true;
+      slock_unlock(ff->lock);
 
       if (ff->config.audio_enable)
-         if (FIFO_READ_AVAIL(ff->audio_fifo) >= audio_buf_size)
+         if (spsc_queue_read_avail(ff->audio_fifo) >= audio_buf_size)
             avail_audio = true;
-      slock_unlock(ff->lock);
 
       if (!avail_video && !avail_audio)
       {
@@ -1695,9 +1693,7 @@ static void ffmpeg_thread(void *data)
       {
          struct record_audio_data aud = {0};
 
-         slock_lock(ff->lock);
-         fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
-         slock_unlock(ff->lock);
+         spsc_queue_read(ff->audio_fifo, audio_buf, audio_buf_size);
          scond_signal(ff->cond);
 
          aud.frames = ff->audio.codec->frame_size;
@@ -75,6 +75,8 @@
 #include <vfs/vfs_implementation.h>
 
 #include <features/features_cpu.h>
+#include <features/features_trace.h>
+#include <gfx/scaler/scaler.h>
 
 #include <compat/strl.h>
 #include <compat/strcasestr.h>
@@ -131,6 +133,7 @@
 
 #ifdef HAVE_NETWORKING
 #include <net/net_compat.h>
+#include <net/net_http.h>
 #include <net/net_socket.h>
 #endif
 
@@ -172,6 +175,10 @@
 #include <rthreads/rthreads.h>
 #endif
 
+#ifdef HAVE_LIBRETRODB
+#include "libretro-db/libretrodb.h"
+#endif
+
 #include "autosave.h"
 #include "config.features.h"
 #include "content.h"
@@ -283,6 +290,9 @@ enum
    RA_OPT_FEATURES,
    RA_OPT_VERSION,
    RA_OPT_EOF_EXIT,
+   RA_OPT_REPLAY_BENCHMARK,
+   RA_OPT_REPLAY_HASHES,
+   RA_OPT_REPLAY_REFERENCE,
    RA_OPT_LOG_FILE,
    RA_OPT_MAX_FRAMES,
    RA_OPT_MAX_FRAMES_SCREENSHOT,
@@ -5711,6 +5721,18 @@ void main_exit(void *args)
    frontend_driver_free();
 
    rtime_deinit();
+   scaler_thread_pool_deinit();
+#ifdef HAVE_NETWORKING
+   /* After task_queue_deinit(), no transfers are left */
+   net_http_pool_free();
+#endif
+#ifdef HAVE_LIBRETRODB
+   /* Explore and the scan tasks have closed their databases */
+   libretrodb_mappings_deinit();
+#endif
+   /* Completes a trace still being streamed; no other
+    * threads are left to record events */
+   trace_event_deinit();
 
 #if defined(ANDROID)
    play_feature_delivery_deinit();
@@ -5766,6 +5788,26 @@ int rarch_main(int argc, char *argv[], void *data)
 
    rtime_init();
 
+#ifdef HAVE_THREADS
+   {
+      /* Shared by the CPU-side frame conversions (recording,
+       * screenshots, readback), which split frames into row bands. */
+      unsigned cores = cpu_features_get_core_amount();
+      if (cores > 1)
+         scaler_thread_pool_init(cores - 1);
+   }
+#endif
+
+#ifdef HAVE_NETWORKING
+   /* Before the HTTP tasks share kept-alive connections */
+   net_http_pool_init();
+#endif
+
+#ifdef HAVE_LIBRETRODB
+   /* Before the scan tasks and Explore open databases */
+   libretrodb_mappings_init();
+#endif
+
 #if defined(ANDROID)
    play_feature_delivery_init();
 #endif
@@ -6265,6 +6307,14 @@ static void retroarch_print_help(const char *arg0)
          "Start recording a replay file from the beginning.\n"
          "      --eof-exit                 "
          "Exit upon reaching the end of the replay file.\n"
+         "      --replay-benchmark         "
+         "Play back the replay headless and unpaced, then print timings.\n"
+         "                                 "
+         "  Implies --eof-exit and the null video and audio drivers.\n"
+         "      --replay-hashes=FILE       "
+         "Write per-frame state hashes and timings to FILE.\n"
+         "      --replay-reference=FILE    "
+         "Report divergence from hashes written by --replay-hashes.\n"
          , sizeof(buf));
 #endif
 
@@ -6585,6 +6635,11 @@ static bool retroarch_parse_input_and_config(
       { "max-frames-ss",      0, NULL, RA_OPT_MAX_FRAMES_SCREENSHOT },
       { "max-frames-ss-path", 1, NULL, RA_OPT_MAX_FRAMES_SCREENSHOT_PATH },
       { "eof-exit",           0, NULL, RA_OPT_EOF_EXIT },
+#ifdef HAVE_BSV_MOVIE
+      { "replay-benchmark",   0, NULL, RA_OPT_REPLAY_BENCHMARK },
+      { "replay-hashes",      1, NULL, RA_OPT_REPLAY_HASHES },
+      { "replay-reference",   1, NULL, RA_OPT_REPLAY_REFERENCE },
+#endif
       { "version",            0, NULL, 'V' /* RA_OPT_VERSION */ },
       { "log-file",           1, NULL, RA_OPT_LOG_FILE },
       { "accessibility",      0, NULL, RA_OPT_ACCESSIBILITY},
@@ -7135,6 +7190,43 @@ static bool retroarch_parse_input_and_config(
 #endif
                break;
 
+#ifdef HAVE_BSV_MOVIE
+            case RA_OPT_REPLAY_BENCHMARK:
+            case RA_OPT_REPLAY_HASHES:
+            case RA_OPT_REPLAY_REFERENCE:
+               {
+                  input_driver_state_t *input_st   = input_state_get_ptr();
+                  bsv_benchmark_t *bench           = input_st->bsv_movie_benchmark;
+                  if (!bench)
+                  {
+                     if (!(bench = (bsv_benchmark_t*)calloc(1, sizeof(*bench))))
+                        break;
+                     input_st->bsv_movie_benchmark = bench;
+                  }
+                  input_st->bsv_movie_state.flags |= BSV_FLAG_MOVIE_BENCHMARK
+                                                   | BSV_FLAG_MOVIE_EOF_EXIT;
+                  if (c == RA_OPT_REPLAY_HASHES)
+                     strlcpy(bench->hash_path, optarg,
+                           sizeof(bench->hash_path));
+                  else if (c == RA_OPT_REPLAY_REFERENCE)
+                     strlcpy(bench->reference_path, optarg,
+                           sizeof(bench->reference_path));
+
+                  /* Run as fast as the core can: nothing may block
+                   * on vsync or audio. Not persisted to the config. */
+                  strlcpy(settings->arrays.video_driver, "null",
+                        sizeof(settings->arrays.video_driver));
+                  strlcpy(settings->arrays.audio_driver, "null",
+                        sizeof(settings->arrays.audio_driver));
+                  settings->bools.video_vsync         = false;
+                  settings->bools.audio_sync          = false;
+                  settings->bools.video_frame_rest    = false;
+                  settings->bools.config_save_on_exit = false;
+                  settings->uints.video_frame_delay   = 0;
+               }
+               break;
+#endif
+
             case 'h':
             case 'V':
             case RA_OPT_VERSION:
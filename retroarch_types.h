@@ -160,6 +160,7 @@ typedef struct rarch_memory_descriptor
 typedef struct rarch_memory_map
 {
    rarch_memory_descriptor_t *descriptors;
+   struct core_memory_map *pages;      /* Page table built from descriptors */
    unsigned num_descriptors;
 } rarch_memory_map_t;
 
@@ -332,6 +333,7 @@ typedef struct content_state
 
    content_file_override_t *content_override_list;
    content_file_list_t *content_list;
+   struct retro_task *rom_crc_task; /* Computes rom_crc while CONTENT_ST_FLAG_PENDING_ROM_CRC is set */
 
    int pending_subsystem_rom_num;
    int pending_subsystem_id;
@@ -341,7 +343,6 @@ typedef struct content_state
 
    char companion_ui_crc32[32];
    char pending_subsystem_ident[255];
-   char pending_rom_crc_path[PATH_MAX_LENGTH];
    char companion_ui_db_name[PATH_MAX_LENGTH];
 } content_state_t;
 
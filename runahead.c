@@ -26,6 +26,7 @@
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
 #include <time/rtime.h>
+#include <features/features_trace.h>
 
 #include "content.h"
 #include "core.h"
@@ -1051,6 +1052,8 @@ static bool runahead_create(runloop_state_t *runloop_st)
 
 static bool runahead_save_state(runloop_state_t *runloop_st)
 {
+   bool ret;
+   retro_time_t trace_start;
    retro_ctx_serialize_info_t *serialize_info;
 
    if (!runloop_st->runahead_save_state_list)
@@ -1059,7 +1062,11 @@ static bool runahead_save_state(runloop_state_t *runloop_st)
    serialize_info                  =
       (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[0];
 
-   if (core_serialize_special(serialize_info))
+   trace_start                     = TRACE_EVENT_BEGIN();
+   ret                             = core_serialize_special(serialize_info);
+   TRACE_EVENT_END("runahead_serialize", trace_start);
+
+   if (ret)
       return true;
 
    runahead_error(runloop_st);
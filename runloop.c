@@ -40,6 +40,12 @@
 #include <signal.h>
 #endif
 
+#if defined(__linux__)
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
 #if defined(_WIN32_WINNT) && _WIN32_WINNT < 0x0500 || defined(_XBOX)
 #ifndef LEGACY_WIN32
 #define LEGACY_WIN32
@@ -80,6 +86,7 @@
 #include <vfs/vfs_implementation.h>
 
 #include <features/features_cpu.h>
+#include <features/features_trace.h>
 
 #include <compat/strl.h>
 #include <compat/strcasestr.h>
@@ -186,6 +193,7 @@
 #include "cores/internal_cores.h"
 #include "content.h"
 #include "core_info.h"
+#include "core_memory_map.h"
 #include "dynamic.h"
 #include "defaults.h"
 #include "msg_hash.h"
@@ -967,6 +975,15 @@ static size_t mmap_highest_bit(size_t n)
    return n ^ (n >> 1);
 }
 
+static void runloop_memory_map_free(rarch_system_info_t *sys_info)
+{
+   if (!sys_info->mmaps.pages)
+      return;
+   core_memory_map_free(sys_info->mmaps.pages);
+   free(sys_info->mmaps.pages);
+   sys_info->mmaps.pages = NULL;
+}
+
 static bool mmap_preprocess_descriptors(
       rarch_memory_descriptor_t *first, unsigned count)
 {
@@ -2859,6 +2876,7 @@ bool runloop_environment_cb(unsigned cmd, void *data)
             free((void*)sys_info->mmaps.descriptors);
             sys_info->mmaps.descriptors     = 0;
             sys_info->mmaps.num_descriptors = 0;
+            runloop_memory_map_free(sys_info);
 
             if (!(descriptors = (rarch_memory_descriptor_t*)calloc(mmaps->num_descriptors,
                   sizeof(*descriptors))))
@@ -2872,6 +2890,18 @@ bool runloop_environment_cb(unsigned cmd, void *data)
 
             mmap_preprocess_descriptors(descriptors, mmaps->num_descriptors);
 
+            /* Resolve addresses through a page table from now on,
+             * instead of walking the descriptors for each access */
+            if (!(sys_info->mmaps.pages = (core_memory_map_t*)
+                     malloc(sizeof(*sys_info->mmaps.pages))))
+               return false;
+            if (!core_memory_map_init(sys_info->mmaps.pages,
+                     descriptors, mmaps->num_descriptors))
+            {
+               runloop_memory_map_free(sys_info);
+               return false;
+            }
+
 #ifdef HAVE_CHEEVOS
             rcheevos_refresh_memory();
 #endif
@@ -3782,6 +3812,7 @@ void runloop_system_info_free(void)
       free(sys_info->ports.data);
    if (sys_info->mmaps.descriptors)
       free((void *)sys_info->mmaps.descriptors);
+   runloop_memory_map_free(sys_info);
 
    sys_info->subsystem.data                           = NULL;
    sys_info->subsystem.size                           = 0;
@@ -4409,6 +4440,90 @@ void runloop_set_frame_limit(
                (av_info->timing.fps * fastforward_ratio));
 }
 
+void runloop_frame_limit_stats_reset(void)
+{
+   runloop_state_t *runloop_st = &runloop_state;
+   memset(&runloop_st->frame_limit_stats, 0,
+         sizeof(runloop_st->frame_limit_stats));
+}
+
+static void runloop_frame_limit_stats_add(
+      runloop_frame_limit_stats_t *stats, retro_time_t error)
+{
+   unsigned i;
+
+   if (error < 0)
+      error = -error;
+
+   for (i = 0; i < RUNLOOP_FRAME_LIMIT_HIST_SIZE - 1; i++)
+      if (error < RUNLOOP_FRAME_LIMIT_HIST_BOUND(i))
+         break;
+
+   stats->hist[i]++;
+   stats->count++;
+   stats->total += error;
+   if (error > stats->max)
+      stats->max = error;
+}
+
+/* Lower and upper bound for the time the precise frame
+ * limiter spins before a deadline, in microseconds. Sleeps
+ * that overshoot by more are scheduler hiccups, not worth
+ * spinning whole frames away to hide. */
+#define FRAME_LIMIT_MARGIN_MIN 50
+#define FRAME_LIMIT_MARGIN_MAX 2000
+
+/**
+ * runloop_frame_limit_wait:
+ * @runloop_st           : Runloop state.
+ * @deadline             : Time to wait for, in cpu_features_get_time_usec() time.
+ *
+ * Sleeps until the calibrated margin before @deadline,
+ * then spins until it is reached. The margin is a moving
+ * average of recent oversleeps that rises quickly and
+ * decays slowly, so the sleep rarely overshoots while the
+ * spin stays short.
+ **/
+static void runloop_frame_limit_wait(runloop_state_t *runloop_st,
+      retro_time_t deadline)
+{
+   retro_time_t now    = cpu_features_get_time_usec();
+   retro_time_t margin = runloop_st->frame_limit_margin;
+   retro_time_t wake   = deadline - margin;
+
+   if (wake > now)
+   {
+      retro_time_t late;
+#if defined(__linux__) && defined(_POSIX_MONOTONIC_CLOCK) && defined(TIMER_ABSTIME)
+      /* cpu_features_get_time_usec() is CLOCK_MONOTONIC here,
+       * so sleep to an absolute time on the same clock */
+      struct timespec ts;
+      ts.tv_sec  = (time_t)(wake / 1000000);
+      ts.tv_nsec = (long)(wake % 1000000) * 1000;
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+#else
+      if (wake - now >= 1000)
+         retro_sleep((unsigned)((wake - now) / 1000));
+#endif
+      now  = cpu_features_get_time_usec();
+      late = now - wake;
+
+      /* Follow oversleeps up quickly, and back down slowly */
+      if (late > FRAME_LIMIT_MARGIN_MAX)
+         late    = FRAME_LIMIT_MARGIN_MAX;
+      if (late > margin)
+         margin += (late - margin + 3) / 4;
+      else
+         margin -= (margin - late) / 64;
+
+      runloop_st->frame_limit_margin = MAX(FRAME_LIMIT_MARGIN_MIN,
+            MIN(margin, FRAME_LIMIT_MARGIN_MAX));
+   }
+
+   while (now < deadline)
+      now = cpu_features_get_time_usec();
+}
+
 float runloop_get_fastforward_ratio(
       settings_t *settings,
       struct retro_fastforwarding_override *fastmotion_override)
@@ -4780,6 +4895,8 @@ bool runloop_event_init_core(
 
    runloop_set_frame_limit(&video_st->av_info, fastforward_ratio);
    runloop_st->frame_limit_last_time    = cpu_features_get_time_usec();
+   runloop_st->frame_limit_margin       = FRAME_LIMIT_MARGIN_MIN;
+   runloop_frame_limit_stats_reset();
 
    runloop_runtime_log_init(runloop_st);
    return true;
@@ -7125,6 +7242,16 @@ int runloop_iterate(void)
       else if (runloop_st->preempt_data)
          preempt_run(runloop_st->preempt_data, runloop_st);
       else
+#endif
+#ifdef HAVE_BSV_MOVIE
+      if (input_st->bsv_movie_benchmark && BSV_MOVIE_IS_PLAYBACK_ON())
+      {
+         retro_time_t core_start = cpu_features_get_time_usec();
+         core_run();
+         movie_benchmark_frame(input_st,
+               cpu_features_get_time_usec() - core_start);
+      }
+      else
 #endif
          core_run();
    }
@@ -7169,6 +7296,10 @@ int runloop_iterate(void)
    bsv_movie_finish_rewind(input_st);
    if (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_END)
    {
+      /* The END flag is cleared by stopping playback,
+       * so BSV_MOVIE_IS_EOF() would never see it */
+      if (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_EOF_EXIT)
+         runloop_st->flags |= RUNLOOP_FLAG_SHUTDOWN_INITIATED;
       movie_stop_playback(input_st);
       command_event(CMD_EVENT_PAUSE, NULL);
    }
@@ -7190,6 +7321,11 @@ int runloop_iterate(void)
       video_frame_delay(video_st, settings, core_paused);
 
 end:
+   /* Stream this frame's trace events out before any
+    * frame limiting sleep */
+   if (trace_event_enabled)
+      trace_event_flush();
+
    if (vrr_runloop_enable)
    {
       /* Sync on video only, block audio later. */
@@ -7240,10 +7376,25 @@ end:
               || (runloop_st->flags & RUNLOOP_FLAG_PAUSED)))
    {
       const retro_time_t end_frame_time  = cpu_features_get_time_usec();
-      const retro_time_t to_sleep_ms     = (
-            (  runloop_st->frame_limit_last_time
-             + runloop_st->frame_limit_minimum_time)
-            - end_frame_time) / 1000;
+      const retro_time_t deadline        =
+              runloop_st->frame_limit_last_time
+            + runloop_st->frame_limit_minimum_time;
+      const retro_time_t to_sleep_ms     = (deadline - end_frame_time) / 1000;
+
+      if (     settings->bools.frame_limit_precise
+            && deadline > end_frame_time)
+      {
+         runloop_st->frame_limit_last_time = deadline;
+
+#if defined(HAVE_COCOATOUCH)
+         if (!(uico_state_get_ptr()->flags & UICO_ST_FLAG_IS_ON_FOREGROUND))
+#endif
+            runloop_frame_limit_wait(runloop_st, deadline);
+
+         runloop_frame_limit_stats_add(&runloop_st->frame_limit_stats,
+               cpu_features_get_time_usec() - deadline);
+         return 1;
+      }
 
       if (to_sleep_ms > 0)
       {
@@ -7261,9 +7412,14 @@ end:
                retro_sleep(sleep_ms);
          }
 
+         runloop_frame_limit_stats_add(&runloop_st->frame_limit_stats,
+               cpu_features_get_time_usec() - deadline);
          return 1;
       }
 
+      /* Frame overran its slot */
+      runloop_frame_limit_stats_add(&runloop_st->frame_limit_stats,
+            end_frame_time - deadline);
       runloop_st->frame_limit_last_time = end_frame_time;
    }
 
@@ -7801,6 +7957,7 @@ void core_run(void)
       : current_core->poll_type;
    bool early_polling          = new_poll_type == POLL_TYPE_EARLY;
    bool late_polling           = new_poll_type == POLL_TYPE_LATE;
+   retro_time_t trace_start;
 #ifdef HAVE_NETWORKING
    bool netplay_preframe       = netplay_driver_ctl(
          RARCH_NETPLAY_CTL_PRE_FRAME, NULL);
@@ -7820,7 +7977,9 @@ void core_run(void)
    else if (late_polling)
       current_core->flags &= ~RETRO_CORE_FLAG_INPUT_POLLED;
 
+   trace_start = TRACE_EVENT_BEGIN();
    current_core->retro_run();
+   TRACE_EVENT_END("core_run", trace_start);
 
    if (      late_polling
          && (!(current_core->flags & RETRO_CORE_FLAG_INPUT_POLLED)))
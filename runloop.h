@@ -161,6 +161,23 @@ typedef struct core_options_callbacks
    retro_core_options_update_display_callback_t update_display;
 } core_options_callbacks_t;
 
+/* Number of buckets in the frame limiter pacing error
+ * histogram. Bucket i counts errors below
+ * RUNLOOP_FRAME_LIMIT_HIST_BOUND(i) microseconds that
+ * did not fit a lower bucket; the last one counts the rest */
+#define RUNLOOP_FRAME_LIMIT_HIST_SIZE 8
+#define RUNLOOP_FRAME_LIMIT_HIST_BOUND(i) ((retro_time_t)50 << (i))
+
+/* How far from its deadline each frame paced by the
+ * frame limiter actually ended */
+typedef struct runloop_frame_limit_stats
+{
+   uint64_t hist[RUNLOOP_FRAME_LIMIT_HIST_SIZE];
+   uint64_t count;
+   retro_time_t total;                          /* Sum of errors, usec */
+   retro_time_t max;                            /* Largest error, usec */
+} runloop_frame_limit_stats_t;
+
 struct runloop
 {
 #if defined(HAVE_CG) || defined(HAVE_GLSL) || defined(HAVE_SLANG) || defined(HAVE_HLSL)
@@ -170,6 +187,8 @@ struct runloop
    retro_time_t core_runtime_usec;
    retro_time_t frame_limit_minimum_time;
    retro_time_t frame_limit_last_time;
+   retro_time_t frame_limit_margin;             /* Calibrated oversleep, usec */
+   runloop_frame_limit_stats_t frame_limit_stats; /* uint64_t alignment */
    retro_usec_t frame_time_last;                /* int64_t alignment */
 
    struct retro_core_t        current_core;     /* uint64_t alignment */
@@ -388,6 +407,8 @@ void runloop_set_frame_limit(
       const struct retro_system_av_info *av_info,
       float fastforward_ratio);
 
+void runloop_frame_limit_stats_reset(void);
+
 float runloop_get_fastforward_ratio(
       settings_t *settings,
       struct retro_fastforwarding_override *fastmotion_override);
@@ -0,0 +1,169 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Applies soft patches (IPS, BPS, UPS, xdelta) to a content
+ * file through patch_content(), the same path content loading
+ * takes, and reports the throughput:
+ *
+ *    patch_bench -n 10 game.sfc hack.bps
+ *
+ * With -c the patch is applied once and the CRC32 and size of
+ * the result are printed instead, which allows comparing the
+ * output of two builds. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "../../../configuration.h"
+#include "../../../msg_hash.h"
+#include "../../../runloop.h"
+#include "../../../verbosity.h"
+#include "../../../tasks/tasks_internal.h"
+
+static unsigned bench_errors = 0;
+
+/* Frontend functions task_patch.c reports through */
+
+settings_t *config_get_ptr(void) { return NULL; }
+
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return ""; }
+
+void runloop_msg_queue_push(const char *msg,
+      unsigned prio, unsigned duration,
+      bool flush, char *title,
+      enum message_queue_icon icon,
+      enum message_queue_category category) { }
+
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_DBG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   bench_errors++;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   retro_time_t start, elapsed;
+   const char *ext       = NULL;
+   const char *names[4]  = { "", "", "", "" };
+   bool prefs[4]         = { false, false, false, false };
+   void *content         = NULL;
+   int64_t content_len   = 0;
+   int iterations        = 5;
+   bool checksum         = false;
+   uint64_t out_bytes    = 0;
+   unsigned failures     = 0;
+
+   for (i = 1; i < argc && argv[i][0] == '-'; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-c"))
+         checksum   = true;
+      else
+         break;
+   }
+
+   if (argc - i != 2 || iterations < 1)
+   {
+      fprintf(stderr, "Usage: %s [-n iterations] [-c] "
+            "<content> <patch.ips|.bps|.ups|.xdelta>\n", argv[0]);
+      return 1;
+   }
+
+   ext = path_get_extension(argv[i + 1]);
+   if (string_is_equal_noncase(ext, "ips"))
+      names[0] = argv[i + 1];
+   else if (string_is_equal_noncase(ext, "bps"))
+      names[1] = argv[i + 1];
+   else if (string_is_equal_noncase(ext, "ups"))
+      names[2] = argv[i + 1];
+   else if (string_is_equal_noncase(ext, "xdelta"))
+      names[3] = argv[i + 1];
+   else
+   {
+      fprintf(stderr, "Unknown patch type: %s\n", argv[i + 1]);
+      return 1;
+   }
+
+   /* Only try the given patch format */
+   prefs[names[0][0] ? 0 : names[1][0] ? 1 : names[2][0] ? 2 : 3] = true;
+
+   if (     !filestream_read_file(argv[i], &content, &content_len)
+         || content_len <= 0)
+   {
+      fprintf(stderr, "Could not read %s.\n", argv[i]);
+      return 1;
+   }
+
+   if (checksum)
+      iterations = 1;
+
+   elapsed = 0;
+
+   for (; iterations > 0; iterations--)
+   {
+      ssize_t size    = (ssize_t)content_len;
+      uint8_t *buf    = (uint8_t*)malloc((size_t)content_len);
+      unsigned errors = bench_errors;
+
+      if (!buf)
+         return 1;
+      memcpy(buf, content, (size_t)content_len);
+
+      /* Only the patching is timed, not the copy
+       * of the original content */
+      start = cpu_features_get_time_usec();
+      if (     !patch_content(prefs[0], prefs[1], prefs[2], prefs[3],
+                  names[0], names[1], names[2], names[3], &buf, &size)
+            || bench_errors != errors)
+         failures++;
+      elapsed += cpu_features_get_time_usec() - start;
+
+      if (checksum)
+         printf("%08x %lld %s\n",
+               encoding_crc32(0, buf, (size_t)size),
+               (long long)size, argv[i + 1]);
+
+      out_bytes += (uint64_t)size;
+      free(buf);
+   }
+
+   if (!checksum)
+   {
+      if (elapsed < 1)
+         elapsed = 1;
+      printf("%.3f s, %.1f MB/s patched output (%u failed)\n",
+            elapsed / 1000000.0, out_bytes / (double)elapsed, failures);
+   }
+
+   free(content);
+
+   return failures ? 1 : 0;
+}
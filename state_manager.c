@@ -26,6 +26,7 @@
 #include <retro_inline.h>
 #include <compat/strl.h>
 #include <compat/intrinsics.h>
+#include <features/features_trace.h>
 
 #include "state_manager.h"
 #include "msg_hash.h"
@@ -803,12 +804,16 @@ bool state_manager_check_rewind(
       if (     !is_paused
             && ((cnt == 0) || retroarch_ctl(RARCH_CTL_BSV_MOVIE_IS_INITED, NULL)))
       {
-         void *state = NULL;
+         void *state              = NULL;
+         retro_time_t trace_start = TRACE_EVENT_BEGIN();
+
          state_manager_push_where(rewind_st->state, &state);
 
          content_serialize_state_rewind(state, rewind_st->size);
 
          state_manager_push_do(rewind_st->state);
+
+         TRACE_EVENT_END("rewind_push", trace_start);
       }
    }
 
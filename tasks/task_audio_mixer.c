@@ -44,6 +44,8 @@ struct audio_mixer_userdata
 struct audio_mixer_handle
 {
    nbio_buf_t *buffer;
+   /* Sound loaded and predecoded by the task handler */
+   audio_mixer_sound_t *sound;
    retro_task_callback_t cb;
    enum audio_mixer_type type;
    char path[4095];
@@ -65,6 +67,9 @@ static void task_audio_mixer_load_free(retro_task_t *task)
          free(mixer->buffer);
       }
 
+      /* Not taken by the callback */
+      audio_mixer_destroy(mixer->sound);
+
       if (mixer->cb)
          mixer->cb(task, NULL, NULL, NULL);
    }
@@ -96,6 +101,16 @@ static int cb_nbio_audio_mixer_load(void *data, size_t len)
    return 0;
 }
 
+static audio_mixer_sound_t *task_audio_mixer_take_sound(retro_task_t *task)
+{
+   nbio_handle_t             *nbio  = (nbio_handle_t*)task->state;
+   struct audio_mixer_handle *mixer = (struct audio_mixer_handle*)nbio->data;
+   audio_mixer_sound_t *sound       = mixer->sound;
+
+   mixer->sound                     = NULL;
+   return sound;
+}
+
 static void task_audio_mixer_handle_upload_ogg(retro_task_t *task,
       void *task_data,
       void *user_data, const char *err)
@@ -114,10 +129,12 @@ static void task_audio_mixer_handle_upload_ogg(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.handle               = task_audio_mixer_take_sound(task);
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename_nocompression(img->path)) : NULL;
 
-   audio_driver_mixer_add_stream(&params);
+   if (!audio_driver_mixer_add_stream(&params))
+      audio_mixer_destroy(params.handle);
 
    if (img->path)
       free(img->path);
@@ -146,10 +163,12 @@ static void task_audio_mixer_handle_upload_ogg_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.handle               = task_audio_mixer_take_sound(task);
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename_nocompression(img->path)) : NULL;
 
-   audio_driver_mixer_add_stream(&params);
+   if (!audio_driver_mixer_add_stream(&params))
+      audio_mixer_destroy(params.handle);
 
    if (img->path)
       free(img->path);
@@ -178,10 +197,12 @@ static void task_audio_mixer_handle_upload_flac(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.handle               = task_audio_mixer_take_sound(task);
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename_nocompression(img->path)) : NULL;
 
-   audio_driver_mixer_add_stream(&params);
+   if (!audio_driver_mixer_add_stream(&params))
+      audio_mixer_destroy(params.handle);
 
    if (img->path)
       free(img->path);
@@ -210,10 +231,12 @@ static void task_audio_mixer_handle_upload_flac_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.handle               = task_audio_mixer_take_sound(task);
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename_nocompression(img->path)) : NULL;
 
-   audio_driver_mixer_add_stream(&params);
+   if (!audio_driver_mixer_add_stream(&params))
+      audio_mixer_destroy(params.handle);
 
    if (img->path)
       free(img->path);
@@ -242,10 +265,12 @@ static void task_audio_mixer_handle_upload_mp3(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.handle               = task_audio_mixer_take_sound(task);
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename_nocompression(img->path)) : NULL;
 
-   audio_driver_mixer_add_stream(&params);
+   if (!audio_driver_mixer_add_stream(&params))
+      audio_mixer_destroy(params.handle);
 
    if (img->path)
       free(img->path);
@@ -274,10 +299,12 @@ static void task_audio_mixer_handle_upload_mp3_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.handle               = task_audio_mixer_take_sound(task);
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename_nocompression(img->path)) : NULL;
 
-   audio_driver_mixer_add_stream(&params);
+   if (!audio_driver_mixer_add_stream(&params))
+      audio_mixer_destroy(params.handle);
 
    if (img->path)
       free(img->path);
@@ -306,6 +333,7 @@ static void task_audio_mixer_handle_upload_mod(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.handle               = NULL;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename_nocompression(img->path)) : NULL;
 
@@ -338,6 +366,7 @@ static void task_audio_mixer_handle_upload_mod_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.handle               = NULL;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename_nocompression(img->path)) : NULL;
 
@@ -371,6 +400,7 @@ static void task_audio_mixer_handle_upload_wav(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.handle               = NULL;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename_nocompression(img->path)) : NULL;
 
@@ -403,6 +433,7 @@ static void task_audio_mixer_handle_upload_wav_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.handle               = NULL;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename_nocompression(img->path)) : NULL;
 
@@ -428,6 +459,7 @@ bool task_audio_mixer_load_handler(retro_task_t *task)
          && (mixer->copy_data_over)
          && (!task_get_cancelled(task)))
    {
+      void *buf       = NULL;
       nbio_buf_t *img = (nbio_buf_t*)malloc(sizeof(*img));
 
       if (img)
@@ -439,6 +471,36 @@ bool task_audio_mixer_load_handler(retro_task_t *task)
 
       task_set_data(task, img);
 
+      /* Decoding short sounds takes milliseconds,
+       * better here than in the callback */
+      switch (mixer->type)
+      {
+         case AUDIO_MIXER_TYPE_OGG:
+         case AUDIO_MIXER_TYPE_FLAC:
+         case AUDIO_MIXER_TYPE_MP3:
+            if (img && (buf = malloc(img->bufsize)))
+            {
+               memcpy(buf, img->buf, img->bufsize);
+               if (mixer->type == AUDIO_MIXER_TYPE_OGG)
+                  mixer->sound = audio_mixer_load_ogg(buf,
+                        (int32_t)img->bufsize);
+               else if (mixer->type == AUDIO_MIXER_TYPE_FLAC)
+                  mixer->sound = audio_mixer_load_flac(buf,
+                        (int32_t)img->bufsize);
+               else
+                  mixer->sound = audio_mixer_load_mp3(buf,
+                        (int32_t)img->bufsize);
+
+               if (mixer->sound)
+                  audio_mixer_predecode(mixer->sound);
+               else
+                  free(buf);
+            }
+            break;
+         default:
+            break;
+      }
+
       mixer->copy_data_over = false;
       mixer->is_finished    = true;
 
@@ -647,6 +647,223 @@ static bool content_file_list_set_info(
 /* Content file info functions END */
 /***********************************/
 
+/*******************************/
+/* Content CRC functions START */
+/*******************************/
+
+#ifndef CRC32_BUFFER_SIZE
+#define CRC32_BUFFER_SIZE 1048576
+#endif
+
+typedef struct content_crc_handle
+{
+   RFILE *file;
+   uint8_t *buf;
+   uint32_t crc;
+   char path[PATH_MAX_LENGTH];
+} content_crc_handle_t;
+
+/**
+ * content_file_read_crc:
+ * @path         : path of the content file.
+ * @data         : buffer the content file is read into.
+ * @size         : size of the content file.
+ * @crc          : CRC32 of the content file.
+ *
+ * Same as filestream_read_file(), but reads the file in
+ * CRC32_BUFFER_SIZE chunks and hashes each one while it
+ * is still in cache.
+ *
+ * Returns: true if successful, false on error.
+ **/
+static bool content_file_read_crc(const char *path,
+      uint8_t **data, int64_t *size, uint32_t *crc)
+{
+   int64_t file_size;
+   int64_t pos      = 0;
+   uint8_t *buf     = NULL;
+   RFILE *file      = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   *data            = NULL;
+   *size            = -1;
+   *crc             = 0;
+
+   if (!file)
+      return false;
+
+   if (     (file_size = filestream_get_size(file)) < 0
+         || (int64_t)(size_t)(file_size + 1) != file_size + 1
+         || !(buf = (uint8_t*)malloc((size_t)(file_size + 1))))
+   {
+      filestream_close(file);
+      return false;
+   }
+
+   while (pos < file_size)
+   {
+      int64_t chunk = file_size - pos;
+      int64_t nread;
+
+      if (chunk > CRC32_BUFFER_SIZE)
+         chunk = CRC32_BUFFER_SIZE;
+
+      if ((nread = filestream_read(file, buf + pos, chunk)) < 0)
+      {
+         free(buf);
+         filestream_close(file);
+         return false;
+      }
+      if (nread == 0)
+         break;
+
+      *crc = encoding_crc32(*crc, buf + pos, (size_t)nread);
+      pos += nread;
+   }
+
+   filestream_close(file);
+
+   /* Keep the terminator filestream_read_file() adds */
+   buf[pos] = '\0';
+   *data    = buf;
+   *size    = pos;
+
+   return true;
+}
+
+static void content_crc_handle_free(content_crc_handle_t *handle)
+{
+   if (!handle)
+      return;
+   if (handle->file)
+      filestream_close(handle->file);
+   if (handle->buf)
+      free(handle->buf);
+   free(handle);
+}
+
+/* Hashes one CRC32_BUFFER_SIZE chunk of the file per
+ * iteration, so the task also makes steady progress
+ * when the task queue is not threaded */
+static void task_content_crc_handler(retro_task_t *task)
+{
+   int64_t nread;
+   content_crc_handle_t *handle = (content_crc_handle_t*)task->state;
+
+   if (task_get_cancelled(task))
+   {
+      task_set_finished(task, true);
+      return;
+   }
+
+   if (!handle->file)
+   {
+      if (     !(handle->file = filestream_open(handle->path,
+                  RETRO_VFS_FILE_ACCESS_READ,
+                  RETRO_VFS_FILE_ACCESS_HINT_NONE))
+            || !(handle->buf  = (uint8_t*)malloc(CRC32_BUFFER_SIZE)))
+      {
+         task_set_error(task, strdup("Could not read content file"));
+         task_set_finished(task, true);
+         return;
+      }
+   }
+
+   if ((nread = filestream_read(handle->file,
+               handle->buf, CRC32_BUFFER_SIZE)) < 0)
+   {
+      task_set_error(task, strdup("Could not read content file"));
+      task_set_finished(task, true);
+      return;
+   }
+
+   handle->crc = encoding_crc32(handle->crc, handle->buf, (size_t)nread);
+
+   if (nread == 0 || filestream_eof(handle->file))
+      task_set_finished(task, true);
+}
+
+static void task_content_crc_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *error)
+{
+   content_crc_handle_t *handle = (content_crc_handle_t*)task->state;
+   content_state_t *p_content   = content_state_get_ptr();
+
+   /* Content may have been unloaded or replaced since */
+   if (task == p_content->rom_crc_task)
+   {
+      p_content->rom_crc_task = NULL;
+      p_content->flags       &= ~CONTENT_ST_FLAG_PENDING_ROM_CRC;
+      p_content->rom_crc      = error ? 0 : handle->crc;
+
+      if (error)
+         RARCH_ERR("[Content]: CRC32: %s: \"%s\".\n", error, handle->path);
+      else
+         RARCH_LOG("[Content]: CRC32: 0x%x.\n",
+               (unsigned)p_content->rom_crc);
+   }
+
+   content_crc_handle_free(handle);
+   task->state = NULL;
+}
+
+static void content_crc_cancel(content_state_t *p_content)
+{
+   if (p_content->rom_crc_task)
+      task_queue_cancel_task(p_content->rom_crc_task);
+   p_content->rom_crc_task = NULL;
+   p_content->flags       &= ~CONTENT_ST_FLAG_PENDING_ROM_CRC;
+}
+
+/**
+ * content_crc_start:
+ * @p_content    : content state.
+ * @path         : path of the content file.
+ *
+ * Computes the CRC32 of a content file the core loads
+ * itself on a background task. content_get_crc() only
+ * waits for it if it is asked for before it finishes.
+ **/
+static void content_crc_start(content_state_t *p_content, const char *path)
+{
+   retro_task_t *task           = NULL;
+   content_crc_handle_t *handle = NULL;
+
+   content_crc_cancel(p_content);
+   p_content->rom_crc           = 0;
+
+   if (     !(handle = (content_crc_handle_t*)calloc(1, sizeof(*handle)))
+         || !(task   = task_init()))
+   {
+      if (handle)
+         free(handle);
+      return;
+   }
+
+   strlcpy(handle->path, path, sizeof(handle->path));
+
+   task->handler           = task_content_crc_handler;
+   task->callback          = task_content_crc_cb;
+   task->state             = handle;
+   task->mute              = true;
+
+   p_content->rom_crc_task = task;
+   p_content->flags       |= CONTENT_ST_FLAG_PENDING_ROM_CRC;
+
+   task_queue_push(task);
+}
+
+static bool content_crc_in_progress(void *data)
+{
+   content_state_t *p_content = (content_state_t*)data;
+   return (p_content->flags & CONTENT_ST_FLAG_PENDING_ROM_CRC) != 0;
+}
+
+/*****************************/
+/* Content CRC functions END */
+/*****************************/
+
 /********************************/
 /* Content file functions START */
 /********************************/
@@ -687,6 +904,7 @@ static bool content_file_load_into_memory(
 {
    uint8_t *content_data = NULL;
    int64_t content_size  = 0;
+   uint32_t content_crc  = 0;
 
    *data                 = NULL;
    *data_size            = 0;
@@ -694,7 +912,9 @@ static bool content_file_load_into_memory(
    RARCH_LOG("[Content]: %s: \"%s\".\n",
          msg_hash_to_str(MSG_LOADING_CONTENT_FILE), content_path);
 
-   /* Read content from file into memory buffer */
+   /* Read content from file into memory buffer. The CRC
+    * of the first content file is needed, so hash it as it
+    * is read instead of reading the file a second time */
 #ifdef HAVE_COMPRESSION
    if (content_compressed)
    {
@@ -704,9 +924,15 @@ static bool content_file_load_into_memory(
    }
    else
 #endif
-      if (!filestream_read_file(content_path,
-            (void**)&content_data, &content_size))
+   if (idx == 0 && first_content_type == RARCH_CONTENT_NONE)
+   {
+      if (!content_file_read_crc(content_path,
+            &content_data, &content_size, &content_crc))
          return false;
+   }
+   else if (!filestream_read_file(content_path,
+            (void**)&content_data, &content_size))
+      return false;
 
    if (content_size < 0)
       return false;
@@ -736,32 +962,24 @@ static bool content_file_load_into_memory(
                   (uint8_t**)&content_data,
                   (void*)&content_size);
 #endif
+         content_crc_cancel(p_content);
+
          /* If content is compressed or a patch has been
-          * applied, must determine CRC value using the
-          * actual data buffer, since the content path
-          * cannot be used for this purpose...
-          * In all other cases, cache the content path
-          * and defer CRC calculation until the value is
-          * actually needed */
+          * applied, the CRC must be that of the final
+          * data buffer rather than of the file read */
          if (content_compressed || has_patch)
-         {
-            p_content->rom_crc = encoding_crc32(0, content_data,
+            content_crc = encoding_crc32(0, content_data,
                   (size_t)content_size);
-            RARCH_LOG("[Content]: CRC32: 0x%x.\n",
-                  (unsigned)p_content->rom_crc);
-         }
-         else
-         {
-            /* We don't have the content ready inside a memory buffer,
-               so we have to read it from file later (deferred)
-               and then encode the CRC32 hash */
-            strlcpy(p_content->pending_rom_crc_path, content_path,
-                  sizeof(p_content->pending_rom_crc_path));
-            p_content->flags |= CONTENT_ST_FLAG_PENDING_ROM_CRC;
-         }
+
+         p_content->rom_crc = content_crc;
+         RARCH_LOG("[Content]: CRC32: 0x%x.\n",
+               (unsigned)p_content->rom_crc);
       }
       else
+      {
+         content_crc_cancel(p_content);
          p_content->rom_crc = 0;
+      }
    }
 
    *data      = content_data;
@@ -1100,19 +1318,18 @@ static bool content_file_load(
                   MSG_CONTENT_LOADING_SKIPPED_IMPLEMENTATION_WILL_DO_IT));
 
             /* First content file is significant: need to
-             * perform CRC calculation, but defer this
-             * until value is used */
+             * perform CRC calculation, which is done in
+             * the background while the core loads it */
             if (i == 0)
             {
                /* If we have a media type, ignore CRC32 calculation. */
                if (first_content_type == RARCH_CONTENT_NONE)
-               {
-                  strlcpy(p_content->pending_rom_crc_path, content_path,
-                        sizeof(p_content->pending_rom_crc_path));
-                  p_content->flags |= CONTENT_ST_FLAG_PENDING_ROM_CRC;
-               }
+                  content_crc_start(p_content, content_path);
                else
+               {
+                  content_crc_cancel(p_content);
                   p_content->rom_crc = 0;
+               }
             }
          }
       }
@@ -2925,71 +3142,22 @@ void content_unset_does_not_need_content(void)
    p_content->flags &= ~CONTENT_ST_FLAG_CORE_DOES_NOT_NEED_CONTENT;
 }
 
-#ifndef CRC32_BUFFER_SIZE
-#define CRC32_BUFFER_SIZE 1048576
-#endif
-
-#ifndef CRC32_MAX_MB
-#define CRC32_MAX_MB 64
-#endif
-
-/**
- * Calculate a CRC32 from the first part of the given file.
- * "first part" being the first (CRC32_BUFFER_SIZE * CRC32_MAX_MB)
- * bytes.
- *
- * @return The calculated CRC32 hash, or 0 if there was an error.
- */
-static uint32_t file_crc32(uint32_t crc, const char *path)
+bool content_poll_crc(uint32_t *crc)
 {
-   unsigned i;
-   RFILE *file        = NULL;
-   unsigned char *buf = NULL;
-   if (!path)
-      return 0;
-
-   if (!(file = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ, 0)))
-      return 0;
-
-   if (!(buf = (unsigned char*)malloc(CRC32_BUFFER_SIZE)))
-   {
-      filestream_close(file);
-      return 0;
-   }
-
-   for (i = 0; i < CRC32_MAX_MB; i++)
-   {
-      int64_t nread = filestream_read(file, buf, CRC32_BUFFER_SIZE);
-      if (nread < 0)
-      {
-         free(buf);
-         filestream_close(file);
-         return 0;
-      }
-
-      crc = encoding_crc32(crc, buf, (size_t)nread);
-      if (filestream_eof(file))
-         break;
-   }
-   free(buf);
-   filestream_close(file);
-   return crc;
+   content_state_t *p_content = content_state_get_ptr();
+   if (p_content->flags & CONTENT_ST_FLAG_PENDING_ROM_CRC)
+      return false;
+   *crc = p_content->rom_crc;
+   return true;
 }
 
 uint32_t content_get_crc(void)
 {
    content_state_t *p_content = content_state_get_ptr();
+   /* The CRC task was started when the content was
+    * loaded, so by now it has usually finished */
    if (p_content->flags & CONTENT_ST_FLAG_PENDING_ROM_CRC)
-   {
-      p_content->flags &= ~CONTENT_ST_FLAG_PENDING_ROM_CRC;
-      /* TODO/FIXME - file_crc32 has a 64MB max limit -
-       * get rid of this function and find a better
-       * way to calculate CRC based on the file */
-      p_content->rom_crc           = file_crc32(0,
-            (const char*)p_content->pending_rom_crc_path);
-      RARCH_LOG("[Content]: CRC32: 0x%x.\n",
-            (unsigned)p_content->rom_crc);
-   }
+      task_queue_wait(content_crc_in_progress, p_content);
    return p_content->rom_crc;
 }
 
@@ -3009,6 +3177,7 @@ void content_deinit(void)
 {
    content_state_t *p_content = content_state_get_ptr();
 
+   content_crc_cancel(p_content);
    content_file_override_free(p_content);
    content_file_list_free(p_content->content_list);
 
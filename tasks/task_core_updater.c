@@ -21,6 +21,8 @@
 #include <string.h>
 #include <ctype.h>
 #include <boolean.h>
+#include <retro_common_api.h>
+#include <array/rhmap.h>
 
 #include <string/stdstring.h>
 #include <file/file_path.h>
@@ -37,9 +39,9 @@
 #include "../msg_hash.h"
 #include "../verbosity.h"
 #include "../core_updater_list.h"
+#include "../file_path_special.h"
 
 #if defined(ANDROID)
-#include "../file_path_special.h"
 #include "../play_feature_delivery/play_feature_delivery.h"
 #endif
 
@@ -107,6 +109,11 @@ typedef struct core_updater_download_handle
 } core_updater_download_handle_t;
 
 /* Update installed cores */
+
+/* Maximum number of core downloads the 'update
+ * installed cores' task keeps in flight */
+#define UPDATE_INSTALLED_CORES_MAX_DOWNLOADS 4
+
 enum update_installed_cores_status
 {
    UPDATE_INSTALLED_CORES_BEGIN = 0,
@@ -117,21 +124,36 @@ enum update_installed_cores_status
    UPDATE_INSTALLED_CORES_END
 };
 
+/* CRC of an installed core, valid for as long as
+ * the core file keeps the same size and mtime */
+typedef struct core_crc_cache_entry
+{
+   int64_t mtime;
+   uint32_t crc;
+   int32_t size;
+   bool used;
+} core_crc_cache_entry_t;
+
 typedef struct update_installed_cores_handle
 {
    char *path_dir_libretro;
    char *path_dir_core_assets;
+   char *crc_cache_path;
    core_updater_list_t* core_list;
+   core_crc_cache_entry_t *crc_cache; /* rhmap, keyed by core path */
    retro_task_t *list_task;
-   retro_task_t *download_task;
+   /* Remote filenames of the downloads in flight */
+   char *downloads[UPDATE_INSTALLED_CORES_MAX_DOWNLOADS];
    size_t auto_backup_history_size;
    size_t list_size;
    size_t list_index;
    size_t installed_index;
+   unsigned num_downloads;
    unsigned num_updated;
    unsigned num_locked;
    enum update_installed_cores_status status;
    bool auto_backup;
+   bool crc_cache_dirty;
 } update_installed_cores_handle_t;
 
 #if 0
@@ -576,7 +598,7 @@ void cb_http_task_core_updater_download(
 
    if (!data || !transf)
       goto finish;
-   if (!data->data || string_is_empty(transf->path))
+   if (string_is_empty(transf->path))
       goto finish;
 
    if (!(download_handle = (core_updater_download_handle_t*)transf->user_data))
@@ -585,6 +607,15 @@ void cb_http_task_core_updater_download(
    /* Update download_handle task status */
    download_handle->http_task_complete       = true;
 
+   /* The core file has been written to disk by the transfer */
+   if (!string_is_empty(err))
+      goto finish;
+   if (data->status < 200 || data->status > 299)
+   {
+      err = "Download failed.";
+      goto finish;
+   }
+
    /* Create output directory, if required */
    strlcpy(output_dir, transf->path, sizeof(output_dir));
    path_basedir_wrapper(output_dir);
@@ -595,6 +626,13 @@ void cb_http_task_core_updater_download(
       goto finish;
    }
 
+   /* Already extracted while downloading */
+   if (data->extracted)
+   {
+      filestream_delete(transf->path);
+      goto finish;
+   }
+
 #ifdef HAVE_COMPRESSION
    /* If core file is an archive, make sure it is
     * not being decompressed already (by another task) */
@@ -608,13 +646,6 @@ void cb_http_task_core_updater_download(
    }
 #endif
 
-   /* Write core file to disk */
-   if (!filestream_write_file(transf->path, data->data, data->len))
-   {
-      err = "Write failed.";
-      goto finish;
-   }
-
 #if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
    /* Decompress core file, if required
     * NOTE: If core is compressed and platform
@@ -643,13 +674,14 @@ finish:
    {
       RARCH_ERR("[core updater] Download of '%s' failed: %s\n",
             (transf ? transf->path: "unknown"), err);
-      download_handle->status = CORE_UPDATER_DOWNLOAD_ERROR;
+      if (download_handle)
+         download_handle->status = CORE_UPDATER_DOWNLOAD_ERROR;
    }
    if (transf)
       free(transf);
 
    /* if no decompress task was queued, mark it as completed */
-   if (!download_handle->decompress_task)
+   if (download_handle && !download_handle->decompress_task)
       download_handle->decompress_task_complete = true;
 }
 
@@ -812,6 +844,7 @@ static void task_core_updater_download_handler(retro_task_t *task)
             size_t _len;
             file_transfer_t *transf = NULL;
             char task_title[128];
+            char output_dir[PATH_MAX_LENGTH];
 
             /* Configure file transfer object */
             if (!(transf = (file_transfer_t*)calloc(1,
@@ -824,9 +857,13 @@ static void task_core_updater_download_handler(retro_task_t *task)
 
             transf->user_data = (void*)download_handle;
 
-            /* Push HTTP transfer task */
-            download_handle->http_task = (retro_task_t*)task_push_http_transfer_file(
-                  download_handle->remote_core_path, true, NULL,
+            /* Push HTTP transfer task, streaming the core to
+             * disk and extracting it while it downloads */
+            strlcpy(output_dir, transf->path, sizeof(output_dir));
+            path_basedir_wrapper(output_dir);
+
+            download_handle->http_task = (retro_task_t*)task_push_http_transfer_file_stream(
+                  download_handle->remote_core_path, true, NULL, output_dir,
                   cb_http_task_core_updater_download, transf);
 
             /* Update task title */
@@ -1148,15 +1185,172 @@ error:
 /* Update installed cores */
 /**************************/
 
+/* Loads the core CRC cache file. Each line has the
+ * form '<crc> <size> <mtime> <core path>' */
+static void task_core_updater_crc_cache_read(
+      update_installed_cores_handle_t *update_installed_handle)
+{
+   void *buf   = NULL;
+   int64_t len = 0;
+   char *line  = NULL;
+
+   if (!filestream_read_file(update_installed_handle->crc_cache_path,
+            &buf, &len))
+      return;
+
+   for (line = (char*)buf; line && *line; )
+   {
+      core_crc_cache_entry_t entry;
+      char *next = strchr(line, '\n');
+      char *pos  = line;
+
+      if (next)
+         *next++     = '\0';
+
+      entry.crc      = (uint32_t)strtoul(pos, &pos, 16);
+      entry.size     = (int32_t)strtol(pos, &pos, 10);
+      entry.mtime    = (int64_t)strtoull(pos, &pos, 10);
+      entry.used     = false;
+
+      if (*pos == ' ' && *(++pos) && entry.crc != 0 && entry.mtime != 0)
+         RHMAP_SET_STR(update_installed_handle->crc_cache, pos, entry);
+
+      line = next;
+   }
+
+   free(buf);
+}
+
+/* Writes back the core CRC cache, dropping entries
+ * of cores which were not checked this time */
+static void task_core_updater_crc_cache_write(
+      update_installed_cores_handle_t *update_installed_handle)
+{
+   size_t i, cap;
+   RFILE *file = NULL;
+
+   if (!update_installed_handle->crc_cache_dirty)
+   {
+      /* Nothing has been added - only write the
+       * file if something has to be dropped */
+      for (i = 0, cap = RHMAP_CAP(update_installed_handle->crc_cache); i != cap; i++)
+         if (     RHMAP_KEY(update_installed_handle->crc_cache, i)
+               && !update_installed_handle->crc_cache[i].used)
+            break;
+
+      if (i == cap)
+         return;
+   }
+
+   if (!(file = filestream_open(update_installed_handle->crc_cache_path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      RARCH_WARN("[core updater] Failed to write core CRC cache: %s\n",
+            update_installed_handle->crc_cache_path);
+      return;
+   }
+
+   for (i = 0, cap = RHMAP_CAP(update_installed_handle->crc_cache); i != cap; i++)
+   {
+      const core_crc_cache_entry_t *entry = &update_installed_handle->crc_cache[i];
+
+      if (!RHMAP_KEY(update_installed_handle->crc_cache, i) || !entry->used)
+         continue;
+
+      filestream_printf(file, "%08x %d " STRING_REP_UINT64 " %s\n",
+            (unsigned)entry->crc, (int)entry->size, (uint64_t)entry->mtime,
+            RHMAP_KEY_STR(update_installed_handle->crc_cache, i));
+   }
+
+   filestream_close(file);
+}
+
+/* Returns CRC32 of specified installed core,
+ * hashing the file only if its size or mtime
+ * changed since the value was cached */
+static uint32_t task_core_updater_get_cached_core_crc(
+      update_installed_cores_handle_t *update_installed_handle,
+      const char *core_path)
+{
+   core_crc_cache_entry_t entry;
+   int32_t size  = path_get_size(core_path);
+   int64_t mtime = path_get_mtime(core_path);
+   core_crc_cache_entry_t *cached = NULL;
+
+   /* Without a reliable mtime the cache cannot
+    * tell a rebuilt core of the same size apart */
+   if (mtime == 0 || size < 0)
+      return task_core_updater_get_core_crc(core_path);
+
+   if (RHMAP_HAS_STR(update_installed_handle->crc_cache, core_path))
+   {
+      cached = RHMAP_PTR_STR(update_installed_handle->crc_cache, core_path);
+
+      if (cached->size == size && cached->mtime == mtime)
+      {
+         cached->used = true;
+         return cached->crc;
+      }
+   }
+
+   if ((entry.crc = task_core_updater_get_core_crc(core_path)) == 0)
+      return 0;
+
+   entry.size  = size;
+   entry.mtime = mtime;
+   entry.used  = true;
+
+   RHMAP_SET_STR(update_installed_handle->crc_cache, core_path, entry);
+   update_installed_handle->crc_cache_dirty = true;
+
+   return entry.crc;
+}
+
+/* Drops finished downloads from the list of
+ * downloads in flight */
+static void task_update_installed_cores_check_downloads(
+      update_installed_cores_handle_t *update_installed_handle)
+{
+   unsigned i = 0;
+
+   while (i < update_installed_handle->num_downloads)
+   {
+      task_finder_data_t find_data;
+
+      find_data.func     = task_core_updater_download_finder;
+      find_data.userdata = (void*)update_installed_handle->downloads[i];
+
+      if (task_queue_find(&find_data))
+      {
+         i++;
+         continue;
+      }
+
+      free(update_installed_handle->downloads[i]);
+      update_installed_handle->downloads[i] = update_installed_handle->downloads[
+            --update_installed_handle->num_downloads];
+   }
+}
+
 static void free_update_installed_cores_handle(
       update_installed_cores_handle_t *update_installed_handle)
 {
+   unsigned i;
+
    if (update_installed_handle->path_dir_libretro)
       free(update_installed_handle->path_dir_libretro);
 
    if (update_installed_handle->path_dir_core_assets)
       free(update_installed_handle->path_dir_core_assets);
 
+   if (update_installed_handle->crc_cache_path)
+      free(update_installed_handle->crc_cache_path);
+
+   for (i = 0; i < update_installed_handle->num_downloads; i++)
+      free(update_installed_handle->downloads[i]);
+
+   RHMAP_FREE(update_installed_handle->crc_cache);
+
    core_updater_list_free(update_installed_handle->core_list);
 
    free(update_installed_handle);
@@ -1181,6 +1375,8 @@ static void task_update_installed_cores_handler(retro_task_t *task)
    switch (update_installed_handle->status)
    {
       case UPDATE_INSTALLED_CORES_BEGIN:
+         task_core_updater_crc_cache_read(update_installed_handle);
+
          /* Request buildbot core list */
          update_installed_handle->list_task = (retro_task_t*)
             task_push_get_core_updater_list(
@@ -1232,7 +1428,7 @@ static void task_update_installed_cores_handler(retro_task_t *task)
              * of the list */
             if (update_installed_handle->list_index >= update_installed_handle->list_size)
             {
-               update_installed_handle->status = UPDATE_INSTALLED_CORES_END;
+               update_installed_handle->status = UPDATE_INSTALLED_CORES_WAIT_DOWNLOAD;
                break;
             }
 
@@ -1281,6 +1477,15 @@ static void task_update_installed_cores_handler(retro_task_t *task)
          {
             const core_updater_list_entry_t *list_entry = NULL;
             uint32_t local_crc                          = 0;
+            retro_task_t *download_task                 = NULL;
+
+            /* Wait for a free download slot */
+            task_update_installed_cores_check_downloads(
+                  update_installed_handle);
+
+            if (update_installed_handle->num_downloads >=
+                  UPDATE_INSTALLED_CORES_MAX_DOWNLOADS)
+               break;
 
             /* Get list entry
              * > In the event of an error, just return
@@ -1319,8 +1524,8 @@ static void task_update_installed_cores_handler(retro_task_t *task)
                        !string_is_empty(local_core_path)
                      && path_is_valid  (local_core_path)
                   )
-                  local_crc = task_core_updater_get_core_crc(
-                        local_core_path);
+                  local_crc = task_core_updater_get_cached_core_crc(
+                        update_installed_handle, local_core_path);
             }
 
             /* Check whether existing core and remote core
@@ -1336,7 +1541,7 @@ static void task_update_installed_cores_handler(retro_task_t *task)
 
             /* Existing core is not the most recent version
              * > Request download */
-            update_installed_handle->download_task = (retro_task_t*)
+            download_task = (retro_task_t*)
                   task_push_core_updater_download(
                         update_installed_handle->core_list,
                         list_entry->remote_filename,
@@ -1348,9 +1553,7 @@ static void task_update_installed_cores_handler(retro_task_t *task)
 
             /* Again, if an error occurred, just return to
              * UPDATE_INSTALLED_CORES_ITERATE state */
-            if (!update_installed_handle->download_task)
-               update_installed_handle->status = UPDATE_INSTALLED_CORES_ITERATE;
-            else
+            if (download_task)
             {
                size_t _len;
                char task_title[128];
@@ -1368,32 +1571,23 @@ static void task_update_installed_cores_handler(retro_task_t *task)
                /* Increment 'updated cores' counter */
                update_installed_handle->num_updated++;
 
-               /* Wait for download to complete */
-               update_installed_handle->status = UPDATE_INSTALLED_CORES_WAIT_DOWNLOAD;
+               /* Download runs in its own task - keep track
+                * of it and move on to the next core */
+               update_installed_handle->downloads[
+                     update_installed_handle->num_downloads++] =
+                           strdup(list_entry->remote_filename);
             }
+
+            update_installed_handle->status = UPDATE_INSTALLED_CORES_ITERATE;
          }
          break;
       case UPDATE_INSTALLED_CORES_WAIT_DOWNLOAD:
-         {
-            bool download_complete = false;
-
-            /* > If task is running, check 'is finished'
-             *   status
-             * > If task is NULL, then it is finished
-             *   by definition */
-            if (update_installed_handle->download_task)
-               download_complete = task_get_finished(update_installed_handle->download_task);
-            else
-               download_complete = true;
+         /* Wait for all downloads in flight to complete */
+         task_update_installed_cores_check_downloads(
+               update_installed_handle);
 
-            /* If download is complete, return to
-             * UPDATE_INSTALLED_CORES_ITERATE state */
-            if (download_complete)
-            {
-               update_installed_handle->download_task = NULL;
-               update_installed_handle->status        = UPDATE_INSTALLED_CORES_ITERATE;
-            }
-         }
+         if (update_installed_handle->num_downloads == 0)
+            update_installed_handle->status = UPDATE_INSTALLED_CORES_END;
          break;
       case UPDATE_INSTALLED_CORES_END:
          {
@@ -1439,6 +1633,11 @@ static void task_update_installed_cores_handler(retro_task_t *task)
                         update_installed_handle->num_locked);
 
                task_set_title(task, strdup(task_title));
+
+               /* Cache is only written (and pruned) after a
+                * complete run - on failure no entry has been
+                * marked as used, and the file is left alone */
+               task_core_updater_crc_cache_write(update_installed_handle);
             }
             else
                task_set_title(task, strdup(msg_hash_to_str(MSG_CORE_LIST_FAILED)));
@@ -1607,10 +1806,12 @@ void task_push_update_installed_cores(
          NULL : strdup(path_dir_core_assets);
    update_installed_handle->core_list                = core_updater_list_init();
    update_installed_handle->list_task                = NULL;
-   update_installed_handle->download_task            = NULL;
+   update_installed_handle->crc_cache                = NULL;
+   update_installed_handle->crc_cache_dirty          = false;
    update_installed_handle->list_size                = 0;
    update_installed_handle->list_index               = 0;
    update_installed_handle->installed_index          = 0;
+   update_installed_handle->num_downloads            = 0;
    update_installed_handle->num_updated              = 0;
    update_installed_handle->num_locked               = 0;
    update_installed_handle->status                   = UPDATE_INSTALLED_CORES_BEGIN;
@@ -1618,6 +1819,15 @@ void task_push_update_installed_cores(
    if (!update_installed_handle->core_list)
       goto error;
 
+   /* Cached CRCs of installed cores live next
+    * to the cores themselves */
+   {
+      char crc_cache_path[PATH_MAX_LENGTH];
+      fill_pathname_join_special(crc_cache_path, path_dir_libretro,
+            FILE_PATH_CORE_CRC_CACHE, sizeof(crc_cache_path));
+      update_installed_handle->crc_cache_path = strdup(crc_cache_path);
+   }
+
    /* Only one instance of this task may run at a time */
    find_data.func     = task_update_installed_cores_finder;
    find_data.userdata = NULL;
@@ -81,6 +81,22 @@ typedef struct
 void* task_push_http_transfer_file(const char* url, bool mute, const char* type,
       retro_task_callback_t cb, file_transfer_t* transfer_data);
 
+/**
+ * task_push_http_transfer_file_stream:
+ *
+ * Like task_push_http_transfer_file(), but writes the body to
+ * transfer_data->path as it arrives instead of collecting it in
+ * memory. The file only replaces an existing one once complete.
+ * If @extract_dir is set and the file is a ZIP archive, it is
+ * also extracted to @extract_dir while downloading where the
+ * archive allows it. The http_transfer_data_t passed to @cb has
+ * no data, len is the file size and extracted tells whether the
+ * archive was extracted.
+ **/
+void* task_push_http_transfer_file_stream(const char* url, bool mute,
+      const char* type, const char *extract_dir,
+      retro_task_callback_t cb, file_transfer_t* transfer_data);
+
 RETRO_END_DECLS
 
 #endif
@@ -20,7 +20,11 @@
 #include <compat/strl.h>
 #include <file/file_path.h>
 #include <net/net_compat.h>
+#include <streams/file_stream.h>
 #include <retro_timers.h>
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+#include <file/archive_file.h>
+#endif
 
 #ifdef RARCH_INTERNAL
 #include "../gfx/video_display_server.h"
@@ -32,6 +36,7 @@ enum http_status_enum
 {
    HTTP_STATUS_CONNECTION_TRANSFER = 0,
    HTTP_STATUS_CONNECTION_TRANSFER_PARSE,
+   HTTP_STATUS_CONNECTION_WAIT,
    HTTP_STATUS_TRANSFER,
    HTTP_STATUS_TRANSFER_PARSE,
    HTTP_STATUS_TRANSFER_PARSE_FREE
@@ -43,9 +48,22 @@ struct http_transfer_info
    char url[255];
 };
 
+/* Writes the body to a file as it arrives */
+struct http_file_sink
+{
+   RFILE *file;
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   struct file_archive_stream *archive;
+#endif
+   size_t written;
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+};
+
 struct http_handle
 {
    struct http_t *handle;
+   struct http_file_sink *sink;
    transfer_cb_t  cb;
    struct
    {
@@ -72,10 +90,24 @@ static int task_http_conn_iterate_transfer_parse(
       http_handle_t *http)
 {
    if (net_http_connection_done(http->connection.handle))
-   {
-      if (http->connection.handle && http->connection.cb)
-         http->connection.cb(http, 0);
-   }
+      return 0;
+
+   net_http_connection_free(http->connection.handle);
+
+   http->connection.handle = NULL;
+
+   return -1;
+}
+
+static int task_http_conn_iterate_wait(http_handle_t *http)
+{
+   /* Wait for a transfer to the same host to finish
+    * if it already has the maximum number in flight */
+   if (!net_http_connection_ready(http->connection.handle))
+      return -1;
+
+   if (http->connection.cb)
+      http->connection.cb(http, 0);
 
    net_http_connection_free(http->connection.handle);
 
@@ -84,6 +116,92 @@ static int task_http_conn_iterate_transfer_parse(
    return 0;
 }
 
+static bool task_http_file_sink_open(struct http_file_sink *sink)
+{
+   char dir[PATH_MAX_LENGTH];
+
+   strlcpy(dir, sink->path, sizeof(dir));
+   path_basedir_wrapper(dir);
+
+   if (!path_mkdir(dir))
+      return false;
+
+   return (sink->file = filestream_open(sink->tmp_path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)) != NULL;
+}
+
+static bool task_http_file_sink_write(void *data,
+      const uint8_t *buf, size_t len)
+{
+   struct http_file_sink *sink = (struct http_file_sink*)data;
+
+   /* Opened on the first data, failed requests leave no file behind */
+   if (!sink->file && !task_http_file_sink_open(sink))
+      return false;
+
+   if (filestream_write(sink->file, buf, len) != (int64_t)len)
+      return false;
+
+   sink->written += len;
+
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   /* Archives that cannot be extracted sequentially
+    * are extracted from the complete file instead */
+   if (sink->archive && !file_archive_stream_write(sink->archive, buf, len))
+   {
+      file_archive_stream_free(sink->archive);
+      sink->archive = NULL;
+   }
+#endif
+
+   return true;
+}
+
+/**
+ * task_http_file_sink_finish:
+ *
+ * Moves the downloaded file in place if @success, otherwise
+ * deletes it, and frees @sink.
+ *
+ * Returns: true if the file was moved in place. @extracted is
+ * set if the archive was also extracted while downloading.
+ **/
+static bool task_http_file_sink_finish(struct http_file_sink *sink,
+      bool success, bool *extracted)
+{
+   *extracted = false;
+
+   if (success && !sink->file)
+      success = task_http_file_sink_open(sink);
+
+   if (sink->file)
+   {
+      filestream_close(sink->file);
+      sink->file = NULL;
+
+      if (success)
+      {
+         filestream_delete(sink->path);
+         success = filestream_rename(sink->tmp_path, sink->path) == 0;
+      }
+
+      if (!success)
+         filestream_delete(sink->tmp_path);
+   }
+
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   if (sink->archive)
+   {
+      *extracted = success && file_archive_stream_finish(sink->archive);
+      file_archive_stream_free(sink->archive);
+   }
+#endif
+
+   free(sink);
+   return success;
+}
+
 static int cb_http_conn_default(void *data_, size_t len)
 {
    http_handle_t *http = (http_handle_t*)data_;
@@ -100,6 +218,9 @@ static int cb_http_conn_default(void *data_, size_t len)
       return -1;
    }
 
+   if (http->sink)
+      net_http_set_sink(http->handle, task_http_file_sink_write, http->sink);
+
    http->cb     = NULL;
 
    return 0;
@@ -149,7 +270,19 @@ static void task_http_transfer_handler(retro_task_t *task)
    switch (http->status)
    {
       case HTTP_STATUS_CONNECTION_TRANSFER_PARSE:
-         task_http_conn_iterate_transfer_parse(http);
+         if (!task_http_conn_iterate_transfer_parse(http))
+            http->status = HTTP_STATUS_CONNECTION_WAIT;
+         else
+            http->status = HTTP_STATUS_TRANSFER;
+         break;
+      case HTTP_STATUS_CONNECTION_WAIT:
+         if (task_http_conn_iterate_wait(http))
+         {
+            /* FIXME: This wouldn't be needed if we could wait for a timeout */
+            if (task_queue_is_threaded())
+               retro_sleep(1);
+            break;
+         }
          http->status = HTTP_STATUS_TRANSFER;
          break;
       case HTTP_STATUS_CONNECTION_TRANSFER:
@@ -175,15 +308,38 @@ task_finished:
 
    if (http->handle)
    {
-      size_t len = 0;
-      char  *tmp = (char*)net_http_data(http->handle, &len, false);
+      size_t len     = 0;
+      bool extracted = false;
+      char  *tmp     = NULL;
       struct string_list *headers = net_http_headers(http->handle);
 
-      if (tmp && http->cb)
-         http->cb(tmp, len);
+      if (http->sink)
+      {
+         /* The body went to the file, report its size
+          * (whatever is buffered is at most an error page) */
+         free(net_http_data(http->handle, NULL, true));
+         len = http->sink->written;
+
+         if (!task_http_file_sink_finish(http->sink,
+                  !net_http_error(http->handle)
+                  && !task_get_cancelled(task),
+                  &extracted)
+               && !net_http_error(http->handle)
+               && !task_get_cancelled(task))
+            task_set_error(task, strldup("Write failed.",
+                  sizeof("Write failed.")));
+         http->sink = NULL;
+      }
+      else
+      {
+         tmp = (char*)net_http_data(http->handle, &len, false);
 
-      if (!tmp)
-         tmp = (char*)net_http_data(http->handle, &len, true);
+         if (tmp && http->cb)
+            http->cb(tmp, len);
+
+         if (!tmp)
+            tmp = (char*)net_http_data(http->handle, &len, true);
+      }
 
       if (task_get_cancelled(task))
       {
@@ -199,12 +355,13 @@ task_finished:
          data          = (http_transfer_data_t*)malloc(sizeof(*data));
          data->data    = tmp;
          data->headers = headers;
-         data->len     = len;
-         data->status  = net_http_status(http->handle);
+         data->len       = len;
+         data->status    = net_http_status(http->handle);
+         data->extracted = extracted;
 
          task_set_data(task, data);
 
-         if (!task->mute && net_http_error(http->handle))
+         if (!task->mute && net_http_error(http->handle) && !task_get_error(task))
             task_set_error(task, strldup("Download failed.",
                sizeof("Download failed.")));
       }
@@ -214,6 +371,15 @@ task_finished:
       task_set_error(task, strldup("Internal error.",
                sizeof("Internal error.")));
 
+   if (http->connection.handle)
+      net_http_connection_free(http->connection.handle);
+
+   if (http->sink)
+   {
+      bool extracted;
+      task_http_file_sink_finish(http->sink, false, &extracted);
+   }
+
    free(http);
 }
 
@@ -263,6 +429,7 @@ static void http_transfer_progress_cb(retro_task_t *task)
 static void *task_push_http_transfer_generic(
       struct http_connection_t *conn,
       const char *url, bool mute, const char *type,
+      struct http_file_sink *sink,
       retro_task_callback_t cb, void *user_data)
 {
    retro_task_t  *t        = NULL;
@@ -270,7 +437,7 @@ static void *task_push_http_transfer_generic(
    const char    *method   = NULL;
 
    if (!conn)
-      return NULL;
+      goto error;
 
    method = net_http_connection_method(conn);
    if (method && (method[0] == 'P' || method[0] == 'p'))
@@ -289,10 +456,7 @@ static void *task_push_http_transfer_generic(
 
       /* Concurrent download of the same file is not allowed */
       if (task_queue_find(&find_data))
-      {
-         net_http_connection_free(conn);
-         return NULL;
-      }
+         goto error;
    }
 
    if (!(http = (http_handle_t*)malloc(sizeof(*http))))
@@ -303,6 +467,7 @@ static void *task_push_http_transfer_generic(
    http->connection_elem[0] = '\0';
    http->connection_url[0]   = '\0';
    http->handle              = NULL;
+   http->sink                = sink;
    http->cb                  = NULL;
    http->status              = 0;
    http->error               = false;
@@ -335,6 +500,11 @@ error:
       net_http_connection_free(conn);
    if (http)
       free(http);
+   if (sink)
+   {
+      bool extracted;
+      task_http_file_sink_finish(sink, false, &extracted);
+   }
 
    return NULL;
 }
@@ -346,7 +516,7 @@ void* task_push_http_transfer(const char *url, bool mute,
    if (!string_is_empty(url))
       return task_push_http_transfer_generic(
             net_http_connection_new(url, "GET", NULL),
-            url, mute, type, cb, user_data);
+            url, mute, type, NULL, cb, user_data);
    return NULL;
 }
 
@@ -364,7 +534,7 @@ void *task_push_webdav_stat(const char *url, bool mute, const char *headers,
    if (headers)
       net_http_connection_set_headers(conn, headers);
 
-   return task_push_http_transfer_generic(conn, url, mute, NULL, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, mute, NULL, NULL, cb, user_data);
 }
 
 void* task_push_webdav_mkdir(const char *url, bool mute,
@@ -382,7 +552,7 @@ void* task_push_webdav_mkdir(const char *url, bool mute,
    if (headers)
       net_http_connection_set_headers(conn, headers);
 
-   return task_push_http_transfer_generic(conn, url, mute, NULL, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, mute, NULL, NULL, cb, user_data);
 }
 
 void* task_push_webdav_put(const char *url,
@@ -409,7 +579,7 @@ void* task_push_webdav_put(const char *url,
    if (put_data)
       net_http_connection_set_content(conn, NULL, len, put_data);
 
-   return task_push_http_transfer_generic(conn, url, mute, NULL, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, mute, NULL, NULL, cb, user_data);
 }
 
 void* task_push_webdav_delete(const char *url, bool mute,
@@ -427,7 +597,7 @@ void* task_push_webdav_delete(const char *url, bool mute,
    if (headers)
       net_http_connection_set_headers(conn, headers);
 
-   return task_push_http_transfer_generic(conn, url, mute, NULL, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, mute, NULL, NULL, cb, user_data);
 }
 
 void *task_push_webdav_move(const char *url,
@@ -453,11 +623,11 @@ void *task_push_webdav_move(const char *url,
 
    net_http_connection_set_headers(conn, dest_header);
 
-   return task_push_http_transfer_generic(conn, url, mute, NULL, cb, userdata);
+   return task_push_http_transfer_generic(conn, url, mute, NULL, NULL, cb, userdata);
 }
 
-void* task_push_http_transfer_file(const char* url, bool mute,
-      const char* type,
+static void *task_push_http_transfer_file_generic(const char* url,
+      bool mute, const char* type, struct http_file_sink *sink,
       retro_task_callback_t cb, file_transfer_t* transfer_data)
 {
    size_t len;
@@ -465,12 +635,9 @@ void* task_push_http_transfer_file(const char* url, bool mute,
    char tmp[255]   = "";
    retro_task_t *t = NULL;
 
-   if (string_is_empty(url))
-      return NULL;
-
    if (!(t = (retro_task_t*)task_push_http_transfer_generic(
          net_http_connection_new(url, "GET", NULL),
-         url, mute, type, cb, transfer_data)))
+         url, mute, type, sink, cb, transfer_data)))
       return NULL;
 
    if (transfer_data)
@@ -492,6 +659,47 @@ void* task_push_http_transfer_file(const char* url, bool mute,
    return t;
 }
 
+void* task_push_http_transfer_file(const char* url, bool mute,
+      const char* type,
+      retro_task_callback_t cb, file_transfer_t* transfer_data)
+{
+   if (string_is_empty(url))
+      return NULL;
+   return task_push_http_transfer_file_generic(url, mute, type, NULL,
+         cb, transfer_data);
+}
+
+void* task_push_http_transfer_file_stream(const char* url, bool mute,
+      const char* type, const char *extract_dir,
+      retro_task_callback_t cb, file_transfer_t* transfer_data)
+{
+   size_t _len;
+   struct http_file_sink *sink = NULL;
+
+   if (     string_is_empty(url)
+         || !transfer_data
+         || string_is_empty(transfer_data->path))
+      return NULL;
+
+   if (!(sink = (struct http_file_sink*)calloc(1, sizeof(*sink))))
+      return NULL;
+
+   strlcpy(sink->path, transfer_data->path, sizeof(sink->path));
+   _len = strlcpy(sink->tmp_path, transfer_data->path,
+         sizeof(sink->tmp_path));
+   strlcpy(sink->tmp_path + _len, ".part", sizeof(sink->tmp_path) - _len);
+
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   if (     !string_is_empty(extract_dir)
+         && string_is_equal_noncase(
+               path_get_extension(transfer_data->path), "zip"))
+      sink->archive = file_archive_stream_new(extract_dir);
+#endif
+
+   return task_push_http_transfer_file_generic(url, mute, type, sink,
+         cb, transfer_data);
+}
+
 void* task_push_http_transfer_with_user_agent(const char *url, bool mute,
    const char *type, const char *user_agent,
    retro_task_callback_t cb, void *user_data)
@@ -507,7 +715,7 @@ void* task_push_http_transfer_with_user_agent(const char *url, bool mute,
    if (user_agent)
       net_http_connection_set_user_agent(conn, user_agent);
 
-   return task_push_http_transfer_generic(conn, url, mute, type, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, mute, type, NULL, cb, user_data);
 }
 
 void* task_push_http_transfer_with_headers(const char *url, bool mute,
@@ -525,7 +733,7 @@ void* task_push_http_transfer_with_headers(const char *url, bool mute,
    if (headers)
       net_http_connection_set_headers(conn, headers);
 
-   return task_push_http_transfer_generic(conn, url, mute, type, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, mute, type, NULL, cb, user_data);
 }
 
 void* task_push_http_post_transfer(const char *url,
@@ -535,7 +743,7 @@ void* task_push_http_post_transfer(const char *url,
    if (!string_is_empty(url))
       return task_push_http_transfer_generic(
             net_http_connection_new(url, "POST", post_data),
-            url, mute, type, cb, user_data);
+            url, mute, type, NULL, cb, user_data);
    return NULL;
 }
 
@@ -555,7 +763,7 @@ void* task_push_http_post_transfer_with_user_agent(const char *url,
    if (user_agent)
       net_http_connection_set_user_agent(conn, user_agent);
 
-   return task_push_http_transfer_generic(conn, url, mute, type, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, mute, type, NULL, cb, user_data);
 }
 
 void* task_push_http_post_transfer_with_headers(const char *url,
@@ -574,7 +782,7 @@ void* task_push_http_post_transfer_with_headers(const char *url,
    if (headers)
       net_http_connection_set_headers(conn, headers);
 
-   return task_push_http_transfer_generic(conn, url, mute, type, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, mute, type, NULL, cb, user_data);
 }
 
 task_retriever_info_t *http_task_get_transfer_list(void)
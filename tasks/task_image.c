@@ -54,6 +54,7 @@ struct nbio_image_handle
    int processing_final_state;
    unsigned frame_duration;
    unsigned upscale_threshold;
+   unsigned downscale_threshold;
    enum image_type_enum type;
    enum image_status_enum status;
    uint8_t flags;
@@ -277,6 +278,93 @@ static bool upscale_image(
    return true;
 }
 
+/* Box filter: each output pixel is the average of the
+ * source pixels it covers */
+static bool downscale_image(
+      unsigned max_size,
+      struct texture_image *image_src,
+      struct texture_image *image_dst)
+{
+   unsigned y_dst;
+   unsigned src_w, src_h;
+
+   /* Sanity check */
+   if ((max_size < 1) || !image_src || !image_dst)
+      return false;
+
+   if (!image_src->pixels || (image_src->width < 1) || (image_src->height < 1))
+      return false;
+
+   src_w = image_src->width;
+   src_h = image_src->height;
+
+   /* Get output dimensions, longest side becomes 'max_size' */
+   if (src_w >= src_h)
+   {
+      image_dst->width  = max_size;
+      image_dst->height = (unsigned)(((uint64_t)src_h * max_size) / src_w);
+   }
+   else
+   {
+      image_dst->width  = (unsigned)(((uint64_t)src_w * max_size) / src_h);
+      image_dst->height = max_size;
+   }
+
+   if (image_dst->width  < 1)
+      image_dst->width  = 1;
+   if (image_dst->height < 1)
+      image_dst->height = 1;
+
+   /* Allocate pixel buffer */
+   if (!(image_dst->pixels = (uint32_t*)malloc(image_dst->width * image_dst->height * sizeof(uint32_t))))
+      return false;
+
+   for (y_dst = 0; y_dst < image_dst->height; y_dst++)
+   {
+      unsigned x_dst;
+      unsigned y0 = (unsigned)(((uint64_t)y_dst       * src_h) / image_dst->height);
+      unsigned y1 = (unsigned)(((uint64_t)(y_dst + 1) * src_h) / image_dst->height);
+
+      if (y1 <= y0)
+         y1 = y0 + 1;
+
+      for (x_dst = 0; x_dst < image_dst->width; x_dst++)
+      {
+         unsigned x, y;
+         uint32_t a = 0, r = 0, g = 0, b = 0;
+         unsigned x0 = (unsigned)(((uint64_t)x_dst       * src_w) / image_dst->width);
+         unsigned x1 = (unsigned)(((uint64_t)(x_dst + 1) * src_w) / image_dst->width);
+         uint32_t n;
+
+         if (x1 <= x0)
+            x1 = x0 + 1;
+
+         n = (x1 - x0) * (y1 - y0);
+
+         for (y = y0; y < y1; y++)
+         {
+            const uint32_t *src = image_src->pixels + (y * src_w);
+            for (x = x0; x < x1; x++)
+            {
+               uint32_t col = src[x];
+               a += (col >> 24) & 0xFF;
+               r += (col >> 16) & 0xFF;
+               g += (col >>  8) & 0xFF;
+               b +=  col        & 0xFF;
+            }
+         }
+
+         image_dst->pixels[(y_dst * image_dst->width) + x_dst] =
+                 ((a / n) << 24)
+               | ((r / n) << 16)
+               | ((g / n) <<  8)
+               |  (b / n);
+      }
+   }
+
+   return true;
+}
+
 bool task_image_load_handler(retro_task_t *task)
 {
    nbio_handle_t            *nbio  = (nbio_handle_t*)task->state;
@@ -338,8 +426,31 @@ bool task_image_load_handler(retro_task_t *task)
 
       if (img)
       {
+         /* Downscale image, if required */
+         if (     (image->downscale_threshold > 0)
+               && ((image->ti.width  > image->downscale_threshold) ||
+                   (image->ti.height > image->downscale_threshold)))
+         {
+            struct texture_image img_resampled = {
+               NULL,
+               0,
+               0,
+               false
+            };
+
+            if (downscale_image(image->downscale_threshold,
+                     &image->ti, &img_resampled))
+            {
+               image->ti.width  = img_resampled.width;
+               image->ti.height = img_resampled.height;
+
+               if (image->ti.pixels)
+                  free(image->ti.pixels);
+               image->ti.pixels = img_resampled.pixels;
+            }
+         }
          /* Upscale image, if required */
-         if (image->upscale_threshold > 0)
+         else if (image->upscale_threshold > 0)
          {
             if (((image->ti.width > 0) && (image->ti.height > 0)) &&
                 ((image->ti.width  < image->upscale_threshold) ||
@@ -388,6 +499,7 @@ bool task_image_load_handler(retro_task_t *task)
 
 bool task_push_image_load(const char *fullpath, 
       bool supports_rgba, unsigned upscale_threshold,
+      unsigned downscale_threshold,
       retro_task_callback_t cb, void *user_data)
 {
    nbio_handle_t             *nbio   = NULL;
@@ -430,6 +542,7 @@ bool task_push_image_load(const char *fullpath,
    image->frame_duration             = 0;
    image->size                       = 0;
    image->upscale_threshold          = upscale_threshold;
+   image->downscale_threshold        = downscale_threshold;
    image->handle                     = NULL;
 
    image->ti.width                   = 0;
@@ -22,8 +22,12 @@
 #include <time.h>
 #include <time/rtime.h>
 #include <compat/strl.h>
+#include <compat/posix_string.h>
 #include <file/file_path.h>
 #include <streams/file_stream.h>
+#include <encodings/crc32.h>
+#include <string/stdstring.h>
+#include <features/features_cpu.h>
 #include <retro_endianness.h>
 
 #ifdef _WIN32
@@ -52,7 +56,7 @@
 #define IDENTIFIER_INDEX   4
 #define HEADER_LEN         6
 
-#define REPLAY_FORMAT_VERSION 0
+#define REPLAY_FORMAT_VERSION 1
 #define REPLAY_MAGIC       0x42535632
 
 /* Forward declaration */
@@ -60,6 +64,78 @@ bool content_load_state_in_progress(void* data);
 
 /* Private functions */
 
+/* Loads the checkpoint seek index appended by
+ * bsv_movie_write_index, if the replay has one. */
+static bool bsv_movie_read_index(bsv_movie_t *handle)
+{
+   size_t i;
+   uint32_t trailer[2];
+   uint32_t count;
+   int64_t index_pos;
+   bsv_checkpoint_entry_t *entries = NULL;
+   int64_t size                    = intfstream_get_size(handle->file);
+
+   if (size < (int64_t)(handle->min_file_pos + sizeof(trailer)))
+      return false;
+
+   intfstream_seek(handle->file, size - (int64_t)sizeof(trailer), SEEK_SET);
+   if (     intfstream_read(handle->file, trailer, sizeof(trailer)) != sizeof(trailer)
+         || swap_if_big32(trailer[1]) != REPLAY_INDEX_MAGIC)
+      goto end;
+
+   count     = swap_if_big32(trailer[0]);
+   index_pos = size - (int64_t)sizeof(trailer)
+      - (int64_t)count * (int64_t)sizeof(*entries);
+
+   if (     index_pos < (int64_t)handle->min_file_pos
+         || !(entries = (bsv_checkpoint_entry_t*)malloc(
+               (count ? count : 1) * sizeof(*entries))))
+      goto end;
+
+   intfstream_seek(handle->file, index_pos, SEEK_SET);
+   if (intfstream_read(handle->file, entries,
+            count * sizeof(*entries)) != (int64_t)(count * sizeof(*entries)))
+   {
+      free(entries);
+      goto end;
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      entries[i].frame  = swap_if_big64(entries[i].frame);
+      entries[i].offset = swap_if_big64(entries[i].offset);
+   }
+
+   handle->checkpoints         = entries;
+   handle->checkpoint_count    = count;
+   handle->checkpoint_capacity = count;
+   handle->end_file_pos        = (size_t)index_pos;
+
+end:
+   intfstream_seek(handle->file, (int64_t)handle->min_file_pos, SEEK_SET);
+   return handle->checkpoints != NULL;
+}
+
+/* Appends the checkpoint seek index at the end of a recording,
+ * so playback can jump straight to the nearest checkpoint. */
+static void bsv_movie_write_index(bsv_movie_t *handle)
+{
+   size_t i;
+   uint32_t trailer[2];
+
+   for (i = 0; i < handle->checkpoint_count; i++)
+   {
+      bsv_checkpoint_entry_t entry;
+      entry.frame  = swap_if_big64(handle->checkpoints[i].frame);
+      entry.offset = swap_if_big64(handle->checkpoints[i].offset);
+      intfstream_write(handle->file, &entry, sizeof(entry));
+   }
+
+   trailer[0] = swap_if_big32((uint32_t)handle->checkpoint_count);
+   trailer[1] = swap_if_big32(REPLAY_INDEX_MAGIC);
+   intfstream_write(handle->file, trailer, sizeof(trailer));
+}
+
 static bool bsv_movie_init_playback(
       bsv_movie_t *handle, const char *path)
 {
@@ -138,6 +214,10 @@ static bool bsv_movie_init_playback(
 
    handle->min_file_pos = sizeof(header) + state_size;
 
+   if (bsv_movie_read_index(handle))
+      RARCH_LOG("[Replay] Loaded seek index with %u checkpoints.\n",
+            (unsigned)handle->checkpoint_count);
+
    return true;
 }
 
@@ -204,10 +284,14 @@ static bool bsv_movie_init_record(
 
 void bsv_movie_free(bsv_movie_t *handle)
 {
+   if (handle->file && !handle->playback)
+      bsv_movie_write_index(handle);
    intfstream_close(handle->file);
    free(handle->file);
 
    free(handle->state);
+   free(handle->last_checkpoint);
+   free(handle->checkpoints);
    free(handle->frame_pos);
    free(handle);
 }
@@ -292,6 +376,15 @@ static bool bsv_movie_start_playback(input_driver_state_t *input_st, char *path)
       return false;
    }
 
+   if (     input_st->bsv_movie_benchmark
+         && !input_st->bsv_movie_benchmark->frames
+         && !movie_benchmark_init(input_st))
+   {
+      movie_benchmark_deinit(input_st);
+      bsv_movie_free(state);
+      return false;
+   }
+
    bsv_movie_enqueue(input_st, state, BSV_FLAG_MOVIE_PLAYBACK);
    starting_movie_str                       =
       msg_hash_to_str(MSG_STARTING_MOVIE_PLAYBACK);
@@ -379,6 +472,7 @@ bool movie_stop_playback(input_driver_state_t *input_st)
    RARCH_LOG("%s\n", movie_playback_end_str);
 
    bsv_movie_deinit_full(input_st);
+   movie_benchmark_deinit(input_st);
 
    input_st->bsv_movie_state.flags &= ~(
          BSV_FLAG_MOVIE_END
@@ -414,6 +508,187 @@ bool movie_stop(input_driver_state_t *input_st)
    return true;
 }
 
+/* Loads a hash file written by a previous benchmark run,
+ * one "<frame> <crc32> <core usec> <serialize usec>" line
+ * per frame. */
+static bool movie_benchmark_load_reference(bsv_benchmark_t *bench)
+{
+   int64_t len   = 0;
+   void *buf     = NULL;
+   char *line    = NULL;
+   char *save    = NULL;
+   size_t cap    = 0;
+
+   if (!filestream_read_file(bench->reference_path, &buf, &len))
+      return false;
+
+   for (line = strtok_r((char*)buf, "\n", &save); line;
+         line = strtok_r(NULL, "\n", &save))
+   {
+      char *tok = NULL;
+      strtoul(line, &tok, 10);
+      if (!tok || tok == line)
+         continue;
+      if (bench->reference_count >= cap)
+      {
+         size_t new_cap  = cap ? cap * 2 : 4096;
+         uint32_t *hashes = (uint32_t*)realloc(bench->reference,
+               new_cap * sizeof(*hashes));
+         if (!hashes)
+            break;
+         bench->reference = hashes;
+         cap              = new_cap;
+      }
+      bench->reference[bench->reference_count++] =
+         (uint32_t)strtoul(tok, NULL, 16);
+   }
+
+   free(buf);
+   return true;
+}
+
+bool movie_benchmark_init(input_driver_state_t *input_st)
+{
+   bsv_benchmark_t *bench = input_st->bsv_movie_benchmark;
+
+   if (!bench)
+      return false;
+
+   if (     !string_is_empty(bench->reference_path)
+         && !movie_benchmark_load_reference(bench))
+   {
+      RARCH_ERR("[Replay] Could not read reference hashes \"%s\".\n",
+            bench->reference_path);
+      return false;
+   }
+
+   if (     !string_is_empty(bench->hash_path)
+         && !(bench->hash_file = intfstream_open_file(bench->hash_path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      RARCH_ERR("[Replay] Could not open hash output \"%s\".\n",
+            bench->hash_path);
+      return false;
+   }
+
+   return true;
+}
+
+/* Called after every core_run() during benchmark playback.
+ * Serializes the core to time it and to hash the state, which
+ * is what divergence is detected on. */
+void movie_benchmark_frame(input_driver_state_t *input_st,
+      retro_time_t core_time)
+{
+   retro_ctx_serialize_info_t serial_info;
+   retro_time_t start, serialize_time;
+   uint32_t crc           = 0;
+   bool serialized        = false;
+   bsv_benchmark_t *bench = input_st->bsv_movie_benchmark;
+   size_t size            = core_serialize_size();
+
+   if (!bench)
+      return;
+
+   if (bench->frames == 0)
+      bench->start_time = cpu_features_get_time_usec() - core_time;
+
+   if (size > bench->state_size)
+   {
+      uint8_t *state = (uint8_t*)realloc(bench->state, size);
+      if (!state)
+         return;
+      bench->state      = state;
+      bench->state_size = size;
+   }
+
+   start            = cpu_features_get_time_usec();
+   serial_info.data = bench->state;
+   serial_info.size = size;
+   serialized       = size && core_serialize(&serial_info);
+   serialize_time   = cpu_features_get_time_usec() - start;
+
+   /* Hashed outside the timed span, which is the cost
+    * of serializing alone */
+   if (serialized)
+      crc           = encoding_crc32(0, bench->state, size);
+
+   bench->core_time      += core_time;
+   bench->serialize_time += serialize_time;
+   if (core_time > bench->core_time_max)
+      bench->core_time_max = core_time;
+   if (serialize_time > bench->serialize_time_max)
+      bench->serialize_time_max = serialize_time;
+
+   if (     bench->frames < bench->reference_count
+         && bench->reference[bench->frames] != crc)
+   {
+      if (bench->divergences++ == 0)
+      {
+         bench->first_divergence = bench->frames;
+         RARCH_ERR("[Replay] Divergence at frame %llu: %08x, expected %08x.\n",
+               (unsigned long long)bench->frames, crc,
+               bench->reference[bench->frames]);
+      }
+   }
+
+   if (bench->hash_file)
+      intfstream_printf(bench->hash_file, "%llu %08x %lld %lld\n",
+            (unsigned long long)bench->frames, crc,
+            (long long)core_time, (long long)serialize_time);
+
+   bench->frames++;
+}
+
+void movie_benchmark_deinit(input_driver_state_t *input_st)
+{
+   bsv_benchmark_t *bench = input_st->bsv_movie_benchmark;
+
+   if (!bench)
+      return;
+
+   if (bench->frames)
+   {
+      retro_time_t total = cpu_features_get_time_usec() - bench->start_time;
+      double frames      = (double)bench->frames;
+
+      /* Printed unconditionally, this is the output CI parses */
+      printf("[Replay] Benchmark: %llu frames in %.3f s, %.2f FPS\n",
+            (unsigned long long)bench->frames, total / 1000000.0,
+            total > 0 ? frames * 1000000.0 / total : 0.0);
+      printf("[Replay] Core time: avg %.1f us, max %lld us\n",
+            bench->core_time / frames, (long long)bench->core_time_max);
+      printf("[Replay] Serialize time: avg %.1f us, max %lld us\n",
+            bench->serialize_time / frames,
+            (long long)bench->serialize_time_max);
+      if (bench->reference_count)
+      {
+         if (bench->divergences)
+            printf("[Replay] DIVERGED: %llu frames differ, first at frame %llu\n",
+                  (unsigned long long)bench->divergences,
+                  (unsigned long long)bench->first_divergence);
+         else if (bench->frames != bench->reference_count)
+            printf("[Replay] DIVERGED: %llu frames played, reference has %u\n",
+                  (unsigned long long)bench->frames,
+                  (unsigned)bench->reference_count);
+         else
+            printf("[Replay] Matches reference\n");
+      }
+      fflush(stdout);
+   }
+
+   if (bench->hash_file)
+   {
+      intfstream_close(bench->hash_file);
+      free(bench->hash_file);
+   }
+   free(bench->reference);
+   free(bench->state);
+   free(bench);
+   input_st->bsv_movie_benchmark = NULL;
+}
+
 bool movie_start_playback(input_driver_state_t *input_st, char *path)
 {
   retro_task_t       *task      = task_init();
@@ -30,6 +30,12 @@
 #include <string/stdstring.h>
 
 #include <encodings/crc32.h>
+#include <memmap.h>
+#ifdef HAVE_MMAN
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "../runloop.h"
 #include "../msg_hash.h"
@@ -76,39 +82,40 @@ struct bps_data
    size_t modify_offset;
    size_t source_offset;
    size_t target_offset;
-   size_t source_relative_offset;
-   size_t target_relative_offset;
    size_t output_offset;
-   uint32_t modify_checksum;
-   uint32_t source_checksum;
-   uint32_t target_checksum;
 };
 
 struct ups_data
 {
    const uint8_t *patch_data;
-   const uint8_t *source_data;
-   uint8_t *target_data;
-   unsigned patch_length;
-   unsigned source_length;
-   unsigned target_length;
-   unsigned patch_offset;
-   unsigned source_offset;
-   unsigned target_offset;
-   unsigned patch_checksum;
-   unsigned source_checksum;
-   unsigned target_checksum;
+   size_t patch_length;
+   size_t patch_offset;
+};
+
+/* A patch file, either memory mapped or read into memory */
+struct patch_file
+{
+   void *data;
+   int64_t size;
+   bool mapped;
 };
 
 typedef enum patch_error (*patch_func_t)(const uint8_t*, uint64_t,
       const uint8_t*, uint64_t, uint8_t**, uint64_t*);
 
+static uint32_t patch_read_le32(const uint8_t *data)
+{
+   return    (uint32_t)data[0]
+         | ((uint32_t)data[1] <<  8)
+         | ((uint32_t)data[2] << 16)
+         | ((uint32_t)data[3] << 24);
+}
+
 static uint8_t bps_read(struct bps_data *bps)
 {
-   uint8_t data         = bps->modify_data[bps->modify_offset++];
-   bps->modify_checksum = ~(encoding_crc32(
-         ~bps->modify_checksum, &data, 1));
-   return data;
+   if (bps->modify_offset < bps->modify_length)
+      return bps->modify_data[bps->modify_offset++];
+   return 0;
 }
 
 static uint64_t bps_decode(struct bps_data *bps)
@@ -121,6 +128,9 @@ static uint64_t bps_decode(struct bps_data *bps)
       data      += (x & 0x7f) * shift;
       if (x & 0x80)
          break;
+      /* Malformed patch, stop before the value overflows */
+      if (shift >= ((uint64_t)1 << 56))
+         break;
       shift    <<= 7;
       data      += shift;
    }
@@ -128,26 +138,19 @@ static uint64_t bps_decode(struct bps_data *bps)
    return data;
 }
 
-static void bps_write(struct bps_data *bps, uint8_t data)
-{
-   bps->target_data[bps->output_offset++] = data;
-   bps->target_checksum = ~(encoding_crc32(~bps->target_checksum, &data, 1));
-}
-
+/* Checksums are not updated per byte while patching;
+ * the patch, source and target are each hashed in one
+ * pass once all actions have been applied */
 static enum patch_error bps_apply_patch(
       const uint8_t *modify_data, uint64_t modify_length,
       const uint8_t *source_data, uint64_t source_length,
       uint8_t **target_data, uint64_t *target_length)
 {
-   size_t i;
    struct bps_data bps;
-   uint32_t checksum               = 0;
    size_t modify_source_size       = 0;
    size_t modify_target_size       = 0;
    size_t modify_markup_size       = 0;
-   uint32_t modify_source_checksum = 0;
-   uint32_t modify_target_checksum = 0;
-   uint32_t modify_modify_checksum = 0;
+   size_t actions_end              = 0;
 
    if (modify_length < 19)
       return PATCH_PATCH_TOO_SMALL;
@@ -161,11 +164,6 @@ static enum patch_error bps_apply_patch(
    bps.modify_offset          = 0;
    bps.source_offset          = 0;
    bps.target_offset          = 0;
-   bps.modify_checksum        = ~0;
-   bps.source_checksum        = 0;
-   bps.target_checksum        = ~0;
-   bps.source_relative_offset = 0;
-   bps.target_relative_offset = 0;
    bps.output_offset          = 0;
 
    if (  (bps_read(&bps) != 'B') ||
@@ -178,8 +176,11 @@ static enum patch_error bps_apply_patch(
    modify_target_size  = bps_decode(&bps);
    modify_markup_size  = bps_decode(&bps);
 
-   for (i = 0; i < modify_markup_size; i++)
-      bps_read(&bps);
+   actions_end         = bps.modify_length - 12;
+
+   if (modify_markup_size > actions_end - bps.modify_offset)
+      return PATCH_PATCH_INVALID;
+   bps.modify_offset  += modify_markup_size;
 
    if (modify_source_size > bps.source_length)
       return PATCH_SOURCE_TOO_SMALL;
@@ -197,74 +198,119 @@ static enum patch_error bps_apply_patch(
       bps.target_length = modify_target_size;
    }
 
-   while (bps.modify_offset < bps.modify_length - 12)
+   while (bps.modify_offset < actions_end)
    {
       size_t length = bps_decode(&bps);
       unsigned mode = length & 3;
 
       length = (length >> 2) + 1;
 
+      if (length > modify_target_size - bps.output_offset)
+         return PATCH_PATCH_INVALID;
+
       switch (mode)
       {
          case SOURCE_READ:
-            while (length--)
-               bps_write(&bps, bps.source_data[bps.output_offset]);
+            if (     bps.output_offset > bps.source_length
+                  || length > bps.source_length - bps.output_offset)
+               return PATCH_PATCH_INVALID;
+            memcpy(bps.target_data + bps.output_offset,
+                  bps.source_data  + bps.output_offset, length);
             break;
 
          case TARGET_READ:
-            while (length--)
-               bps_write(&bps, bps_read(&bps));
+            if (length > bps.modify_length - bps.modify_offset)
+               return PATCH_PATCH_INVALID;
+            memcpy(bps.target_data + bps.output_offset,
+                  bps.modify_data  + bps.modify_offset, length);
+            bps.modify_offset += length;
             break;
 
          case SOURCE_COPY:
          case TARGET_COPY:
          {
-            int    offset = (int)bps_decode(&bps);
-            bool negative = offset & 1;
+            uint64_t offset = bps_decode(&bps);
+            bool   negative = offset & 1;
 
             offset >>= 1;
 
-            if (negative)
-               offset = -offset;
-
             if (mode == SOURCE_COPY)
             {
-               bps.source_offset += offset;
-               while (length--)
-                  bps_write(&bps, bps.source_data[bps.source_offset++]);
+               if (negative
+                     ? offset > bps.source_offset
+                     : offset > bps.source_length - bps.source_offset)
+                  return PATCH_PATCH_INVALID;
+               bps.source_offset = negative
+                  ? bps.source_offset - (size_t)offset
+                  : bps.source_offset + (size_t)offset;
+               if (length > bps.source_length - bps.source_offset)
+                  return PATCH_PATCH_INVALID;
+
+               memcpy(bps.target_data + bps.output_offset,
+                     bps.source_data  + bps.source_offset, length);
+               bps.source_offset += length;
             }
             else
             {
-               bps.target_offset += offset;
-               while (length--)
-                  bps_write(&bps, bps.target_data[bps.target_offset++]);
-               break;
+               size_t src       = 0;
+               size_t out       = bps.output_offset;
+               size_t remaining = length;
+
+               if (negative
+                     ? offset > bps.target_offset
+                     : offset > out - bps.target_offset)
+                  return PATCH_PATCH_INVALID;
+               bps.target_offset = negative
+                  ? bps.target_offset - (size_t)offset
+                  : bps.target_offset + (size_t)offset;
+               /* Can only copy what has been written already */
+               if (bps.target_offset >= out)
+                  return PATCH_PATCH_INVALID;
+
+               /* The copy may overlap its own output, in which
+                * case it repeats the last (out - src) bytes;
+                * copy one period at a time so the result
+                * matches a byte by byte copy */
+               src = bps.target_offset;
+               if (out - src == 1)
+                  memset(bps.target_data + out,
+                        bps.target_data[src], remaining);
+               else
+               {
+                  while (remaining)
+                  {
+                     size_t chunk = out - src;
+                     if (chunk > remaining)
+                        chunk = remaining;
+                     memcpy(bps.target_data + out,
+                           bps.target_data + src, chunk);
+                     out       += chunk;
+                     src       += chunk;
+                     remaining -= chunk;
+                  }
+               }
+               bps.target_offset += length;
             }
             break;
          }
       }
-   }
 
-   for (i = 0; i < 32; i += 8)
-      modify_source_checksum |= bps_read(&bps) << i;
-   for (i = 0; i < 32; i += 8)
-      modify_target_checksum |= bps_read(&bps) << i;
-
-   checksum = ~bps.modify_checksum;
-   for (i = 0; i < 32; i += 8)
-      modify_modify_checksum |= bps_read(&bps) << i;
+      bps.output_offset += length;
+   }
 
-   bps.source_checksum = encoding_crc32(0,
-         bps.source_data, bps.source_length);
-   bps.target_checksum = ~bps.target_checksum;
+   if (bps.modify_offset != actions_end)
+      return PATCH_PATCH_INVALID;
 
-   if (bps.source_checksum != modify_source_checksum)
+   if (encoding_crc32(0, bps.source_data, bps.source_length)
+         != patch_read_le32(bps.modify_data + actions_end))
       return PATCH_SOURCE_CHECKSUM_INVALID;
 
-   if (bps.target_checksum != modify_target_checksum)
+   if (encoding_crc32(0, bps.target_data, bps.output_offset)
+         != patch_read_le32(bps.modify_data + actions_end + 4))
       return PATCH_TARGET_CHECKSUM_INVALID;
 
-   if (checksum != modify_modify_checksum)
+   if (encoding_crc32(0, bps.modify_data, bps.modify_length - 4)
+         != patch_read_le32(bps.modify_data + actions_end + 8))
       return PATCH_PATCH_CHECKSUM_INVALID;
 
    *target_length = modify_target_size;
@@ -274,42 +320,11 @@ static enum patch_error bps_apply_patch(
 
 static uint8_t ups_patch_read(struct ups_data *data)
 {
-   if (data && data->patch_offset < data->patch_length)
-   {
-      uint8_t n = data->patch_data[data->patch_offset++];
-      data->patch_checksum =
-         ~(encoding_crc32(~data->patch_checksum, &n, 1));
-      return n;
-   }
-   return 0x00;
-}
-
-static uint8_t ups_source_read(struct ups_data *data)
-{
-   if (data && data->source_offset < data->source_length)
-   {
-      uint8_t n = data->source_data[data->source_offset++];
-      data->source_checksum =
-         ~(encoding_crc32(~data->source_checksum, &n, 1));
-      return n;
-   }
+   if (data->patch_offset < data->patch_length)
+      return data->patch_data[data->patch_offset++];
    return 0x00;
 }
 
-static void ups_target_write(struct ups_data *data, uint8_t n)
-{
-
-   if (data && data->target_offset < data->target_length)
-   {
-      data->target_data[data->target_offset] = n;
-      data->target_checksum =
-         ~(encoding_crc32(~data->target_checksum, &n, 1));
-   }
-
-   if (data)
-      data->target_offset++;
-}
-
 static uint64_t ups_decode(struct ups_data *data)
 {
    uint64_t offset = 0, shift = 1;
@@ -321,38 +336,40 @@ static uint64_t ups_decode(struct ups_data *data)
 
       if (x & 0x80)
          break;
+      /* Malformed patch, stop before the value overflows */
+      if (shift >= ((uint64_t)1 << 56))
+         break;
       shift <<= 7;
       offset += shift;
    }
    return offset;
 }
 
+/* UPS stores the target as the source XORed with runs of
+ * patch bytes. The target starts out as a copy of the
+ * source (zero filled past its end) and only the XOR runs
+ * are applied byte by byte; checksums are computed over
+ * whole buffers at the end. */
 static enum patch_error ups_apply_patch(
       const uint8_t *patchdata, uint64_t patchlength,
       const uint8_t *sourcedata, uint64_t sourcelength,
       uint8_t **targetdata, uint64_t *targetlength)
 {
-   size_t i;
    struct ups_data data;
-   unsigned source_read_length;
-   unsigned target_read_length;
-   uint32_t patch_result_checksum = 0;
-   uint32_t patch_read_checksum   = 0;
-   uint32_t source_read_checksum  = 0;
-   uint32_t target_read_checksum  = 0;
+   uint64_t source_read_length;
+   uint64_t target_read_length;
+   uint32_t source_checksum;
+   uint32_t target_checksum;
+   uint32_t source_read_checksum;
+   uint32_t target_read_checksum;
+   size_t patch_end;
+   size_t target_length;
+   size_t target_offset = 0;
+   uint8_t *target      = NULL;
 
    data.patch_data      = patchdata;
-   data.source_data     = sourcedata;
-   data.target_data     = *targetdata;
-   data.patch_length    = (unsigned)patchlength;
-   data.source_length   = (unsigned)sourcelength;
-   data.target_length   = (unsigned)*targetlength;
+   data.patch_length    = (size_t)patchlength;
    data.patch_offset    = 0;
-   data.source_offset   = 0;
-   data.target_offset   = 0;
-   data.patch_checksum  = ~0;
-   data.source_checksum = ~0;
-   data.target_checksum = ~0;
 
    if (data.patch_length < 18)
       return PATCH_PATCH_INVALID;
@@ -365,76 +382,80 @@ static enum patch_error ups_apply_patch(
       )
       return PATCH_PATCH_INVALID;
 
-   source_read_length = (unsigned)ups_decode(&data);
-   target_read_length = (unsigned)ups_decode(&data);
+   source_read_length = ups_decode(&data);
+   target_read_length = ups_decode(&data);
 
-   if (     (data.source_length != source_read_length)
-         && (data.source_length != target_read_length))
+   if (     (sourcelength != source_read_length)
+         && (sourcelength != target_read_length))
       return PATCH_SOURCE_INVALID;
 
-   *targetlength = (data.source_length == source_read_length ?
+   *targetlength = (sourcelength == source_read_length ?
          target_read_length : source_read_length);
+   target_length = (size_t)*targetlength;
+
+   if (!(target = (uint8_t*)malloc(target_length ? target_length : 1)))
+      return PATCH_TARGET_ALLOC_FAILED;
+   free(*targetdata);
+   *targetdata = target;
 
-   if (data.target_length < *targetlength)
+   if (sourcelength >= target_length)
+      memcpy(target, sourcedata, target_length);
+   else
    {
-      uint8_t *prov=(uint8_t*)malloc((size_t)*targetlength);
-      if (!prov)
-         return PATCH_TARGET_ALLOC_FAILED;
-      free(*targetdata);
-      *targetdata      = prov;
-      data.target_data = prov;
+      memcpy(target, sourcedata, (size_t)sourcelength);
+      memset(target + sourcelength, 0,
+            target_length - (size_t)sourcelength);
    }
 
-   data.target_length = (unsigned)*targetlength;
+   patch_end = data.patch_length - 12;
 
-   while (data.patch_offset < data.patch_length - 12)
+   while (data.patch_offset < patch_end)
    {
-      unsigned length = (unsigned)ups_decode(&data);
-      while (length--)
-         ups_target_write(&data, ups_source_read(&data));
+      uint64_t length = ups_decode(&data);
+
+      if (length > target_length - target_offset)
+         target_offset = target_length;
+      else
+         target_offset += (size_t)length;
 
       for (;;)
       {
          uint8_t patch_xor = ups_patch_read(&data);
-         ups_target_write(&data, patch_xor ^ ups_source_read(&data));
+         if (target_offset < target_length)
+            target[target_offset++] ^= patch_xor;
+         else
+            target_offset = target_length;
          if (patch_xor == 0)
             break;
       }
    }
 
-   while (data.source_offset < data.source_length)
-      ups_target_write(&data, ups_source_read(&data));
-   while (data.target_offset < data.target_length)
-      ups_target_write(&data, ups_source_read(&data));
-
-   for (i = 0; i < 4; i++)
-      source_read_checksum |= ups_patch_read(&data) << (i * 8);
-   for (i = 0; i < 4; i++)
-      target_read_checksum |= ups_patch_read(&data) << (i * 8);
-
-   patch_result_checksum = ~data.patch_checksum;
-   data.source_checksum  = ~data.source_checksum;
-   data.target_checksum  = ~data.target_checksum;
+   if (data.patch_offset != patch_end)
+      return PATCH_PATCH_INVALID;
 
-   for (i = 0; i < 4; i++)
-      patch_read_checksum |= ups_patch_read(&data) << (i * 8);
+   source_read_checksum = patch_read_le32(data.patch_data + patch_end);
+   target_read_checksum = patch_read_le32(data.patch_data + patch_end + 4);
 
-   if (patch_result_checksum != patch_read_checksum)
+   if (encoding_crc32(0, data.patch_data, data.patch_length - 4)
+         != patch_read_le32(data.patch_data + patch_end + 8))
       return PATCH_PATCH_INVALID;
 
-   if (     data.source_checksum == source_read_checksum
-         && data.source_length   == source_read_length)
+   source_checksum = encoding_crc32(0, sourcedata, (size_t)sourcelength);
+   target_checksum = encoding_crc32(0, target, target_length);
+
+   if (     source_checksum == source_read_checksum
+         && sourcelength    == source_read_length)
    {
-      if (     data.target_checksum == target_read_checksum
-            && data.target_length   == target_read_length)
+      if (     target_checksum == target_read_checksum
+            && target_length   == target_read_length)
          return PATCH_SUCCESS;
       return PATCH_TARGET_INVALID;
    }
-   else if (data.source_checksum == target_read_checksum
-         && data.source_length   == target_read_length)
+   else if (source_checksum == target_read_checksum
+         && sourcelength    == target_read_length)
    {
-      if (     data.target_checksum == source_read_checksum
-            && data.target_length   == source_read_length)
+      if (     target_checksum == source_read_checksum
+            && target_length   == source_read_length)
          return PATCH_SUCCESS;
       return PATCH_TARGET_INVALID;
    }
@@ -501,11 +522,8 @@ static enum patch_error ips_alloc_targetdata(
          if (offset > patchlen - length)
             break;
 
-         while (length--)
-         {
-            address++;
-            offset++;
-         }
+         address += length;
+         offset  += length;
       }
       else /* RLE */
       {
@@ -518,8 +536,7 @@ static enum patch_error ips_alloc_targetdata(
          if (length == 0) /* Illegal */
             break;
 
-         while (length--)
-            address++;
+         address += length;
 
          offset++;
       }
@@ -551,7 +568,16 @@ static enum patch_error ips_apply_patch(
                targetdata, targetlength)) != PATCH_SUCCESS)
       return error_patch;
 
-   memcpy(*targetdata, sourcedata, (size_t)sourcelength);
+   /* The EOF record may truncate the target,
+    * and records may extend it past the source */
+   if (sourcelength < *targetlength)
+   {
+      memcpy(*targetdata, sourcedata, (size_t)sourcelength);
+      memset(*targetdata + sourcelength, 0,
+            (size_t)(*targetlength - sourcelength));
+   }
+   else
+      memcpy(*targetdata, sourcedata, (size_t)*targetlength);
 
    for (;;)
    {
@@ -592,8 +618,12 @@ static enum patch_error ips_apply_patch(
          if (offset > patchlen - length)
             break;
 
-         while (length--)
-            (*targetdata)[address++] = patchdata[offset++];
+         if (address < *targetlength)
+            memcpy(*targetdata + address, patchdata + offset,
+                  (size_t)(length < *targetlength - address
+                     ? length : *targetlength - address));
+         address += length;
+         offset  += length;
       }
       else /* RLE */
       {
@@ -606,8 +636,11 @@ static enum patch_error ips_apply_patch(
          if (length == 0) /* Illegal */
             break;
 
-         while (length--)
-            (*targetdata)[address++] = patchdata[offset];
+         if (address < *targetlength)
+            memset(*targetdata + address, patchdata[offset],
+                  (size_t)(length < *targetlength - address
+                     ? length : *targetlength - address));
+         address += length;
 
          offset++;
       }
@@ -699,10 +732,12 @@ static enum patch_error xdelta_apply_patch(
       case ENOSPC:
          error_patch = PATCH_TARGET_ALLOC_FAILED;
          free(*targetdata);
+         *targetdata = NULL;
          goto cleanup_stream;
       default:
          error_patch = PATCH_UNKNOWN;
          free(*targetdata);
+         *targetdata = NULL;
          goto cleanup_stream;
    }
 
@@ -713,6 +748,67 @@ cleanup_stream:
 }
 #endif
 
+/**
+ * patch_file_open:
+ * @file         : patch file to fill in.
+ * @path         : path of the patch.
+ *
+ * Maps @path read-only where mmap is available, so a
+ * large patch is paged in as it is applied instead of
+ * being copied up front. Falls back to reading the
+ * whole file (archives, VFS paths, other platforms).
+ *
+ * Returns: true on success.
+ **/
+static bool patch_file_open(struct patch_file *file, const char *path)
+{
+#ifdef HAVE_MMAN
+   struct stat st;
+   int fd;
+#endif
+
+   file->data   = NULL;
+   file->size   = 0;
+   file->mapped = false;
+
+#ifdef HAVE_MMAN
+   if ((fd = open(path, O_RDONLY)) >= 0)
+   {
+      if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+      {
+         void *data = mmap(NULL, (size_t)st.st_size,
+               PROT_READ, MAP_PRIVATE, fd, 0);
+
+         if (data != MAP_FAILED)
+         {
+            close(fd);
+            file->data   = data;
+            file->size   = (int64_t)st.st_size;
+            file->mapped = true;
+            return true;
+         }
+      }
+      close(fd);
+   }
+#endif
+
+   return filestream_read_file(path, &file->data, &file->size) != 0;
+}
+
+static void patch_file_close(struct patch_file *file)
+{
+#ifdef HAVE_MMAN
+   if (file->mapped)
+      munmap(file->data, (size_t)file->size);
+   else
+#endif
+   if (file->data)
+      free(file->data);
+
+   file->data = NULL;
+   file->size = 0;
+}
+
 static bool apply_patch_content(uint8_t **buf,
       ssize_t *size, const char *patch_desc, const char *patch_path,
       patch_func_t func, void *patch_data, int64_t patch_size)
@@ -752,11 +848,14 @@ static bool apply_patch_content(uint8_t **buf,
       }
    }
    else
+   {
+      free(patched_content);
       RARCH_ERR("%s %s: %s #%u\n",
             msg_hash_to_str(MSG_FAILED_TO_PATCH),
             patch_desc,
             msg_hash_to_str(MSG_ERROR),
             (unsigned)err);
+   }
 
    return true;
 }
@@ -769,19 +868,17 @@ static bool try_bps_patch(bool allow_bps, const char *name_bps,
          && path_is_valid(name_bps)
       )
    {
-      int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
+      struct patch_file patch;
+      bool ret = false;
 
-      if (!filestream_read_file(name_bps, &patch_data, &patch_size))
+      if (!patch_file_open(&patch, name_bps))
          return false;
 
-      if (patch_size >= 0)
+      if (patch.size >= 0)
          ret = apply_patch_content(buf, size, "BPS", name_bps,
-               bps_apply_patch, patch_data, patch_size);
+               bps_apply_patch, patch.data, patch.size);
 
-      if (patch_data)
-         free(patch_data);
+      patch_file_close(&patch);
       return ret;
    }
 
@@ -796,19 +893,17 @@ static bool try_ups_patch(bool allow_ups, const char *name_ups,
          && path_is_valid(name_ups)
       )
    {
-      int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
+      struct patch_file patch;
+      bool ret = false;
 
-      if (!filestream_read_file(name_ups, &patch_data, &patch_size))
+      if (!patch_file_open(&patch, name_ups))
          return false;
 
-      if (patch_size >= 0)
+      if (patch.size >= 0)
          ret = apply_patch_content(buf, size, "UPS", name_ups,
-               ups_apply_patch, patch_data, patch_size);
+               ups_apply_patch, patch.data, patch.size);
 
-      if (patch_data)
-         free(patch_data);
+      patch_file_close(&patch);
       return ret;
    }
    return false;
@@ -822,19 +917,17 @@ static bool try_ips_patch(bool allow_ips,
          && path_is_valid(name_ips)
       )
    {
-      int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
+      struct patch_file patch;
+      bool ret = false;
 
-      if (!filestream_read_file(name_ips, &patch_data, &patch_size))
+      if (!patch_file_open(&patch, name_ips))
          return false;
 
-      if (patch_size >= 0)
+      if (patch.size >= 0)
          ret = apply_patch_content(buf, size, "IPS", name_ips,
-               ips_apply_patch, patch_data, patch_size);
+               ips_apply_patch, patch.data, patch.size);
 
-      if (patch_data)
-         free(patch_data);
+      patch_file_close(&patch);
       return ret;
    }
    return false;
@@ -849,19 +942,17 @@ static bool try_xdelta_patch(bool allow_xdelta,
             && path_is_valid(name_xdelta)
            )
    {
-      int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
+      struct patch_file patch;
+      bool ret = false;
 
-      if (!filestream_read_file(name_xdelta, &patch_data, &patch_size))
+      if (!patch_file_open(&patch, name_xdelta))
          return false;
 
-      if (patch_size >= 0)
+      if (patch.size >= 0)
          ret = apply_patch_content(buf, size, "Xdelta", name_xdelta,
-                                   xdelta_apply_patch, patch_data, patch_size);
+                                   xdelta_apply_patch, patch.data, patch.size);
 
-      if (patch_data)
-         free(patch_data);
+      patch_file_close(&patch);
       return ret;
     }
 #endif
@@ -21,11 +21,17 @@
 #include <string.h>
 #include <ctype.h>
 
+#include <array/rhmap.h>
 #include <string/stdstring.h>
 #include <file/file_path.h>
 #include <net/net_http.h>
+#include <retro_dirent.h>
 #include <streams/file_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "tasks_internal.h"
 #include "task_file_transfer.h"
 
@@ -42,6 +48,16 @@
 #endif
 #endif
 
+/* Maximum number of thumbnail transfers a task
+ * keeps in flight at the same time */
+#define PL_THUMB_MAX_DOWNLOADS 4
+
+/* Maximum number of state machine steps taken per
+ * handler invocation, so that runs of thumbnails
+ * which already exist are skipped quickly without
+ * starving other tasks */
+#define PL_THUMB_MAX_STEPS     64
+
 enum pl_thumb_status
 {
    PL_THUMB_BEGIN = 0,
@@ -55,7 +71,7 @@ enum pl_thumb_flags
    PL_THUMB_FLAG_OVERWRITE          = (1 << 0),
    PL_THUMB_FLAG_RIGHT_THUMB_EXISTS = (1 << 1),
    PL_THUMB_FLAG_LEFT_THUMB_EXISTS  = (1 << 2),
-   PL_THUMB_FLAG_HTTP_TASK_COMPLETE = (1 << 3)
+   PL_THUMB_FLAG_SCAN_DIRECTORIES   = (1 << 3)
 };
 
 typedef struct pl_thumb_handle
@@ -65,13 +81,20 @@ typedef struct pl_thumb_handle
    char *dir_thumbnails;
    playlist_t *playlist;
    gfx_thumbnail_path_data_t *thumbnail_path_data;
-   retro_task_t *http_task;
+   /* Thumbnail directories listed so far, and the
+    * paths of all files found in them */
+   uint8_t *scanned_dirs;
+   uint8_t *existing_files;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
 
    playlist_config_t playlist_config; /* size_t alignment */
 
    size_t list_size;
    size_t list_index;
    unsigned type_idx;
+   unsigned downloads; /* Transfers in flight */
 
    enum pl_thumb_status status;
    enum playlist_thumbnail_name_flags name_flags;
@@ -218,6 +241,96 @@ static bool get_thumbnail_paths(
    return !string_is_empty(url);
 }
 
+/* Returns the number of thumbnail transfers
+ * currently in flight */
+static unsigned pl_thumb_get_downloads(pl_thumb_handle_t *pl_thumb)
+{
+   unsigned downloads;
+#ifdef HAVE_THREADS
+   slock_lock(pl_thumb->lock);
+#endif
+   downloads = pl_thumb->downloads;
+#ifdef HAVE_THREADS
+   slock_unlock(pl_thumb->lock);
+#endif
+   return downloads;
+}
+
+/* Adds 'delta' (+1/-1) to the number of thumbnail
+ * transfers in flight. Transfer callbacks run on the
+ * main thread, while the task handler may not */
+static void pl_thumb_update_downloads(pl_thumb_handle_t *pl_thumb, int delta)
+{
+#ifdef HAVE_THREADS
+   slock_lock(pl_thumb->lock);
+#endif
+   pl_thumb->downloads += delta;
+#ifdef HAVE_THREADS
+   slock_unlock(pl_thumb->lock);
+#endif
+}
+
+/* Records every file in thumbnail directory 'dir'
+ * (including trailing slash) as existing */
+static void pl_thumb_scan_directory(pl_thumb_handle_t *pl_thumb,
+      const char *dir)
+{
+   char file_path[PATH_MAX_LENGTH];
+   size_t _len        = strlcpy(file_path, dir, sizeof(file_path));
+   struct RDIR *entry = NULL;
+
+   RHMAP_SET_STR(pl_thumb->scanned_dirs, dir, 1);
+
+   if (_len >= sizeof(file_path))
+      return;
+
+   if (!(entry = retro_opendir(dir)))
+      return;
+
+   if (!retro_dirent_error(entry))
+   {
+      while (retro_readdir(entry))
+      {
+         const char *name = retro_dirent_get_name(entry);
+
+         if (     string_is_empty(name)
+               || retro_dirent_is_dir(entry, NULL))
+            continue;
+
+         strlcpy(file_path + _len, name, sizeof(file_path) - _len);
+         RHMAP_SET_STR(pl_thumb->existing_files, file_path, 1);
+      }
+   }
+
+   retro_closedir(entry);
+}
+
+/* Returns true if thumbnail file 'path' exists.
+ * When downloading a whole playlist, each thumbnail
+ * directory is listed once instead of checking every
+ * file individually */
+static bool pl_thumb_file_exists(pl_thumb_handle_t *pl_thumb,
+      const char *path)
+{
+   if (pl_thumb->flags & PL_THUMB_FLAG_SCAN_DIRECTORIES)
+   {
+      char dir[PATH_MAX_LENGTH];
+
+      strlcpy(dir, path, sizeof(dir));
+      path_basedir_wrapper(dir);
+
+      if (!RHMAP_HAS_STR(pl_thumb->scanned_dirs, dir))
+         pl_thumb_scan_directory(pl_thumb, dir);
+
+      if (RHMAP_HAS_STR(pl_thumb->existing_files, path))
+         return true;
+   }
+
+   /* Not listed - this also catches names differing
+    * only in case on case-insensitive file systems */
+   return path_is_valid(path);
+}
+
 /* Thumbnail download http task callback function
  * > Writes thumbnail file to disk */
 void cb_http_task_download_pl_thumbnail(
@@ -229,16 +342,12 @@ void cb_http_task_download_pl_thumbnail(
    file_transfer_t *transf     = (file_transfer_t*)user_data;
    pl_thumb_handle_t *pl_thumb = NULL;
 
-   /* Update pl_thumb task status
-    * > Do this first, to minimise the risk of hanging
-    *   the parent task in the event of an http error */
    if (!transf)
       goto finish;
 
-   if (!(pl_thumb = (pl_thumb_handle_t*)transf->user_data))
-      goto finish;
-
-   pl_thumb->flags |= PL_THUMB_FLAG_HTTP_TASK_COMPLETE;
+   /* Every path below must reach 'finish', where the
+    * transfer is removed from the pl_thumb task */
+   pl_thumb = (pl_thumb_handle_t*)transf->user_data;
 
    /* Remaining sanity checks... */
    if (!data || !data->data || string_is_empty(transf->path))
@@ -279,6 +388,11 @@ finish:
 
    if (transf)
       free(transf);
+
+   /* Parent task may free pl_thumb as soon as
+    * this is done - must not be accessed after */
+   if (pl_thumb)
+      pl_thumb_update_downloads(pl_thumb, -1);
 }
 
 /* Download thumbnail of the current type for the current
@@ -295,14 +409,16 @@ static void download_pl_thumbnail(pl_thumb_handle_t *pl_thumb)
    if (get_thumbnail_paths(pl_thumb, path, sizeof(path), url, sizeof(url)))
    {
       /* Only download missing thumbnails */
-      if (!path_is_valid(path) || (pl_thumb->flags & PL_THUMB_FLAG_OVERWRITE))
+      if (     (pl_thumb->flags & PL_THUMB_FLAG_OVERWRITE)
+            || !pl_thumb_file_exists(pl_thumb, path))
       {
          file_transfer_t *transf = (file_transfer_t*)malloc(sizeof(file_transfer_t));
          if (!transf)
             return; /* If this happens then everything is broken anyway... */
 
-         /* Initialise http task status */
-         pl_thumb->flags             &= ~PL_THUMB_FLAG_HTTP_TASK_COMPLETE;
+         /* Count the transfer before it can possibly
+          * complete */
+         pl_thumb_update_downloads(pl_thumb, 1);
 
          transf->enum_idx             = MSG_UNKNOWN;
          transf->path[0]              = '\0';
@@ -314,11 +430,14 @@ static void download_pl_thumbnail(pl_thumb_handle_t *pl_thumb)
           * just means the file is missing from the server, so it's
           * not something we can handle here... */
 
-         /* ...if it does fail, however, we can immediately
-          * signal that the task is 'complete' */
-         if (!(pl_thumb->http_task = (retro_task_t*)task_push_http_transfer_file(
-               url, true, NULL, cb_http_task_download_pl_thumbnail, transf)))
-            pl_thumb->flags             |= PL_THUMB_FLAG_HTTP_TASK_COMPLETE;
+         /* ...if it does fail, however, the callback will
+          * never trigger */
+         if (!task_push_http_transfer_file(
+               url, true, NULL, cb_http_task_download_pl_thumbnail, transf))
+         {
+            pl_thumb_update_downloads(pl_thumb, -1);
+            free(transf);
+         }
       }
    }
 }
@@ -355,6 +474,14 @@ static void free_pl_thumb_handle(pl_thumb_handle_t *pl_thumb)
       pl_thumb->thumbnail_path_data = NULL;
    }
 
+   RHMAP_FREE(pl_thumb->scanned_dirs);
+   RHMAP_FREE(pl_thumb->existing_files);
+
+#ifdef HAVE_THREADS
+   if (pl_thumb->lock)
+      slock_free(pl_thumb->lock);
+#endif
+
    free(pl_thumb);
    pl_thumb = NULL;
 }
@@ -365,6 +492,7 @@ static void free_pl_thumb_handle(pl_thumb_handle_t *pl_thumb)
 
 static void task_pl_thumbnail_download_handler(retro_task_t *task)
 {
+   unsigned steps;
    pl_thumb_handle_t *pl_thumb = NULL;
    enum playlist_thumbnail_name_flags next_flag = PLAYLIST_THUMBNAIL_FLAG_INVALID;
 
@@ -374,117 +502,113 @@ static void task_pl_thumbnail_download_handler(retro_task_t *task)
    if (!(pl_thumb = (pl_thumb_handle_t*)task->state))
       goto task_finished;
    
+   /* Stop enqueuing transfers, but let the ones in
+    * flight complete before the handle is freed */
    if (task_get_cancelled(task))
-      goto task_finished;
+      pl_thumb->status = PL_THUMB_END;
    
-   switch (pl_thumb->status)
+   for (steps = 0; steps < PL_THUMB_MAX_STEPS; steps++)
    {
-      case PL_THUMB_BEGIN:
-         /* Load playlist */
-         if (!path_is_valid(pl_thumb->playlist_config.path))
-            goto task_finished;
-
-         if (!(pl_thumb->playlist = playlist_init(&pl_thumb->playlist_config)))
-            goto task_finished;
+      switch (pl_thumb->status)
+      {
+         case PL_THUMB_BEGIN:
+            /* Load playlist */
+            if (!path_is_valid(pl_thumb->playlist_config.path))
+               goto task_finished;
 
-         pl_thumb->list_size = playlist_size(pl_thumb->playlist);
+            if (!(pl_thumb->playlist = playlist_init(&pl_thumb->playlist_config)))
+               goto task_finished;
 
-         if (pl_thumb->list_size < 1)
-            goto task_finished;
+            pl_thumb->list_size = playlist_size(pl_thumb->playlist);
 
-         /* Initialise thumbnail path data */
-         if (!(pl_thumb->thumbnail_path_data = gfx_thumbnail_path_init()))
-            goto task_finished;
+            if (pl_thumb->list_size < 1)
+               goto task_finished;
 
-         if (!gfx_thumbnail_set_system(
-                  pl_thumb->thumbnail_path_data,
-                  pl_thumb->system, pl_thumb->playlist))
-            goto task_finished;
+            /* Initialise thumbnail path data */
+            if (!(pl_thumb->thumbnail_path_data = gfx_thumbnail_path_init()))
+               goto task_finished;
 
-         /* All good - can start iterating */
-         pl_thumb->status = PL_THUMB_ITERATE_ENTRY;
-         break;
-      case PL_THUMB_ITERATE_ENTRY:
-         /* Set current thumbnail content */
-         if (gfx_thumbnail_set_content_playlist(
-                  pl_thumb->thumbnail_path_data, pl_thumb->playlist, pl_thumb->list_index))
-         {
-            const char *label = NULL;
+            if (!gfx_thumbnail_set_system(
+                     pl_thumb->thumbnail_path_data,
+                     pl_thumb->system, pl_thumb->playlist))
+               goto task_finished;
 
-            /* Update progress display */
-            task_free_title(task);
-            if (gfx_thumbnail_get_label(pl_thumb->thumbnail_path_data, &label))
-               task_set_title(task, strdup(label));
-            else
-               task_set_title(task, strdup(""));
-            task_set_progress(task, (pl_thumb->list_index * 100) / pl_thumb->list_size);
-
-            /* Start iterating over thumbnail type */
-            pl_thumb->type_idx  = 1;
-            pl_thumb->status    = PL_THUMB_ITERATE_TYPE;
-            playlist_update_thumbnail_name_flag(pl_thumb->playlist, pl_thumb->list_index, PLAYLIST_THUMBNAIL_FLAG_FULL_NAME);
-            pl_thumb->name_flags = PLAYLIST_THUMBNAIL_FLAG_FULL_NAME;
-         }
-         else
-         {
-            /* Current playlist entry is broken - advance to
-             * the next one */
-            pl_thumb->list_index++;
-            if (pl_thumb->list_index >= pl_thumb->list_size)
-               pl_thumb->status = PL_THUMB_END;
-         }
-         break;
-      case PL_THUMB_ITERATE_TYPE:
-         /* Ensure that we only enqueue one transfer
-          * at a time... */
-
-         /* > If HTTP task is NULL, then it either finished
-          *   or an error occurred - in either case,
-          *   current task is 'complete' */
-         if (!pl_thumb->http_task)
-            pl_thumb->flags             |= PL_THUMB_FLAG_HTTP_TASK_COMPLETE;
-         /* > Wait for task_push_http_transfer_file()
-          *   callback to trigger */
-         else if (!(pl_thumb->flags & PL_THUMB_FLAG_HTTP_TASK_COMPLETE))
+            /* All good - can start iterating */
+            pl_thumb->status = PL_THUMB_ITERATE_ENTRY;
             break;
+         case PL_THUMB_ITERATE_ENTRY:
+            /* Set current thumbnail content */
+            if (gfx_thumbnail_set_content_playlist(
+                     pl_thumb->thumbnail_path_data, pl_thumb->playlist, pl_thumb->list_index))
+            {
+               const char *label = NULL;
 
-         pl_thumb->http_task = NULL;
-
-         /* Check whether all thumbnail types have been processed */
-         if (pl_thumb->type_idx > 3)
-         {
-            next_flag = playlist_get_next_thumbnail_name_flag(pl_thumb->playlist,pl_thumb->list_index);
-            if (next_flag == PLAYLIST_THUMBNAIL_FLAG_NONE) {
-               if (pl_thumb->playlist )
-               /* Time to move on to the next entry */
-               pl_thumb->list_index++;
-               if (pl_thumb->list_index < pl_thumb->list_size)
-                  pl_thumb->status = PL_THUMB_ITERATE_ENTRY;
+               /* Update progress display */
+               task_free_title(task);
+               if (gfx_thumbnail_get_label(pl_thumb->thumbnail_path_data, &label))
+                  task_set_title(task, strdup(label));
                else
+                  task_set_title(task, strdup(""));
+               task_set_progress(task, (pl_thumb->list_index * 100) / pl_thumb->list_size);
+
+               /* Start iterating over thumbnail type */
+               pl_thumb->type_idx  = 1;
+               pl_thumb->status    = PL_THUMB_ITERATE_TYPE;
+               playlist_update_thumbnail_name_flag(pl_thumb->playlist, pl_thumb->list_index, PLAYLIST_THUMBNAIL_FLAG_FULL_NAME);
+               pl_thumb->name_flags = PLAYLIST_THUMBNAIL_FLAG_FULL_NAME;
+            }
+            else
+            {
+               /* Current playlist entry is broken - advance to
+                * the next one */
+               pl_thumb->list_index++;
+               if (pl_thumb->list_index >= pl_thumb->list_size)
                   pl_thumb->status = PL_THUMB_END;
-               break;
-            } else {
-               /* Increment the name flag to cover the 3 supported naming conventions. 
-                * Side-effect: all combinations will be tried (3x3 requests for 1 playlist entry)
-                * even if some files were already downloaded, but that may be useful if later on
-                * different view priorities are implemented. */
-               pl_thumb->type_idx = 1;
-               playlist_update_thumbnail_name_flag(pl_thumb->playlist, pl_thumb->list_index, next_flag);
-               pl_thumb->name_flags = next_flag;
             }
-         }
+            break;
+         case PL_THUMB_ITERATE_TYPE:
+            /* Only keep a limited number of transfers
+             * in flight - wait for one to complete */
+            if (pl_thumb_get_downloads(pl_thumb) >= PL_THUMB_MAX_DOWNLOADS)
+               return;
+
+            /* Check whether all thumbnail types have been processed */
+            if (pl_thumb->type_idx > 3)
+            {
+               next_flag = playlist_get_next_thumbnail_name_flag(pl_thumb->playlist,pl_thumb->list_index);
+               if (next_flag == PLAYLIST_THUMBNAIL_FLAG_NONE) {
+                  /* Time to move on to the next entry */
+                  pl_thumb->list_index++;
+                  if (pl_thumb->list_index < pl_thumb->list_size)
+                     pl_thumb->status = PL_THUMB_ITERATE_ENTRY;
+                  else
+                     pl_thumb->status = PL_THUMB_END;
+                  break;
+               } else {
+                  /* Increment the name flag to cover the 3 supported naming conventions. 
+                   * Side-effect: all combinations will be tried (3x3 requests for 1 playlist entry)
+                   * even if some files were already downloaded, but that may be useful if later on
+                   * different view priorities are implemented. */
+                  pl_thumb->type_idx = 1;
+                  playlist_update_thumbnail_name_flag(pl_thumb->playlist, pl_thumb->list_index, next_flag);
+                  pl_thumb->name_flags = next_flag;
+               }
+            }
 
-         /* Download current thumbnail */
-         if (pl_thumb)
+            /* Download current thumbnail */
             download_pl_thumbnail(pl_thumb);
 
-         /* Increment thumbnail type */
-         pl_thumb->type_idx++;
-         break;
-      case PL_THUMB_END:
-      default:
-         task_set_progress(task, 100);
-         goto task_finished;
+            /* Increment thumbnail type */
+            pl_thumb->type_idx++;
+            break;
+         case PL_THUMB_END:
+         default:
+            /* Wait for remaining transfers */
+            if (pl_thumb_get_downloads(pl_thumb) > 0)
+               return;
+            task_set_progress(task, 100);
+            goto task_finished;
+      }
    }
    
    return;
@@ -556,16 +680,21 @@ bool task_push_pl_thumbnail_download(
    if (!playlist_config_copy(playlist_config, &pl_thumb->playlist_config))
       goto error;
    
+#ifdef HAVE_THREADS
+   if (!(pl_thumb->lock = slock_new()))
+      goto error;
+#endif
+
    pl_thumb->system              = strdup(system);
    pl_thumb->playlist_path       = NULL;
    pl_thumb->dir_thumbnails      = strdup(dir_thumbnails);
    pl_thumb->playlist            = NULL;
    pl_thumb->thumbnail_path_data = NULL;
-   pl_thumb->http_task           = NULL;
    pl_thumb->list_size           = 0;
    pl_thumb->list_index          = 0;
    pl_thumb->type_idx            = 1;
    pl_thumb->status              = PL_THUMB_BEGIN;
+   pl_thumb->flags               = PL_THUMB_FLAG_SCAN_DIRECTORIES;
    
    /* Configure task */
    task->handler                 = task_pl_thumbnail_download_handler;
@@ -587,6 +716,10 @@ error:
    
    if (pl_thumb)
    {
+#ifdef HAVE_THREADS
+      if (pl_thumb->lock)
+         slock_free(pl_thumb->lock);
+#endif
       free(pl_thumb);
       pl_thumb = NULL;
    }
@@ -698,8 +831,10 @@ static void task_pl_entry_thumbnail_download_handler(retro_task_t *task)
    if (!(pl_thumb = (pl_thumb_handle_t*)task->state))
       goto task_finished;
    
+   /* Let transfers in flight complete before the
+    * handle is freed */
    if (task_get_cancelled(task))
-      goto task_finished;
+      pl_thumb->status = PL_THUMB_END;
    
    switch (pl_thumb->status)
    {
@@ -752,42 +887,26 @@ static void task_pl_entry_thumbnail_download_handler(retro_task_t *task)
          }
          break;
       case PL_THUMB_ITERATE_TYPE:
+         /* All thumbnail types are requested at once,
+          * which stays within PL_THUMB_MAX_DOWNLOADS */
+         while (pl_thumb->type_idx <= 3)
          {
-            /* Ensure that we only enqueue one transfer
-             * at a time... */
-            
-            /* > If HTTP task is NULL, then it either finished
-             *   or an error occurred - in either case,
-             *   current task is 'complete' */
-            if (!pl_thumb->http_task)
-               pl_thumb->flags |= PL_THUMB_FLAG_HTTP_TASK_COMPLETE;
-            /* > Wait for task_push_http_transfer_file()
-             *   callback to trigger */
-            else if (!(pl_thumb->flags & PL_THUMB_FLAG_HTTP_TASK_COMPLETE))
-               break;
-
-            pl_thumb->http_task = NULL;
-            
-            /* Check whether all thumbnail types have been processed */
-            if (pl_thumb->type_idx > 3)
-            {
-               pl_thumb->status = PL_THUMB_END;
-               break;
-            }
-            
-            /* Update progress */
-            task_set_progress(task, ((pl_thumb->type_idx - 1) * 100) / 3);
-            
-            /* Download current thumbnail */
-            if (pl_thumb)
-               download_pl_thumbnail(pl_thumb);
-            
-            /* Increment thumbnail type */
+            download_pl_thumbnail(pl_thumb);
             pl_thumb->type_idx++;
          }
+         pl_thumb->status = PL_THUMB_END;
          break;
       case PL_THUMB_END:
       default:
+         {
+            /* Wait for remaining transfers */
+            unsigned downloads = pl_thumb_get_downloads(pl_thumb);
+            if (downloads > 0)
+            {
+               task_set_progress(task, ((3 - downloads) * 100) / 3);
+               break;
+            }
+         }
          task_set_progress(task, 100);
          goto task_finished;
    }
@@ -908,7 +1027,6 @@ bool task_push_pl_entry_thumbnail_download(
    pl_thumb->dir_thumbnails      = strdup(dir_thumbnails);
    pl_thumb->playlist            = NULL;
    pl_thumb->thumbnail_path_data = thumbnail_path_data;
-   pl_thumb->http_task           = NULL;
    pl_thumb->list_size           = playlist_size(playlist);
    pl_thumb->list_index          = idx;
    pl_thumb->type_idx            = 1;
@@ -917,6 +1035,11 @@ bool task_push_pl_entry_thumbnail_download(
 
    if (overwrite)
       pl_thumb->flags            = PL_THUMB_FLAG_OVERWRITE;
+
+#ifdef HAVE_THREADS
+   if (!(pl_thumb->lock = slock_new()))
+      goto error;
+#endif
    
    /* Configure task */
    task->handler                 = task_pl_entry_thumbnail_download_handler;
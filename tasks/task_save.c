@@ -887,7 +887,7 @@ static bool content_load_rastate1(unsigned char* input, size_t size)
 #else
          bool frame_is_reversed         = false;
 #endif
-         if (frame_is_reversed || replay_set_serialized_data((void*)input))
+         if (frame_is_reversed || replay_set_serialized_data((void*)input, block_size))
             seen_replay = true;
          else
             return false;
@@ -916,7 +916,7 @@ static bool content_load_rastate1(unsigned char* input, size_t size)
       bool frame_is_reversed = false;
 #endif
       if (!seen_replay && !frame_is_reversed)
-         replay_set_serialized_data(NULL);
+         replay_set_serialized_data(NULL, 0);
    }
 #endif
 
@@ -946,7 +946,7 @@ bool content_deserialize_state(
          bool frame_is_reversed = false;
 #endif
          if (!frame_is_reversed)
-            replay_set_serialized_data(NULL);
+            replay_set_serialized_data(NULL, 0);
       }
 #endif
    }
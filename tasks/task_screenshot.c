@@ -29,6 +29,7 @@
 #include <file/file_path.h>
 #include <compat/strl.h>
 #include <string/stdstring.h>
+#include <features/features_cpu.h>
 #include <gfx/video_frame.h>
 
 #ifdef HAVE_RBMP
@@ -69,6 +70,7 @@ static bool screenshot_dump_direct(screenshot_task_state_t *state)
       scaler->in_fmt             = SCALER_FMT_ARGB8888;
    else
       scaler->in_fmt             = SCALER_FMT_RGB565;
+   scaler->threads               = cpu_features_get_core_amount();
 
    video_frame_convert_to_bgr24(
          scaler,
@@ -80,12 +82,14 @@ static bool screenshot_dump_direct(screenshot_task_state_t *state)
 
    scaler_ctx_gen_reset(&state->scaler);
 
-   ret = rpng_save_image_bgr24(
+   ret = rpng_save_image_bgr24_flags(
          state->filename,
          state->out_buffer,
          state->width,
          state->height,
-         state->width * 3
+         state->width * 3,
+         (state->flags & SS_TASK_FLAG_FAST_COMPRESSION)
+         ? RPNG_SAVE_FLAG_FAST : 0
          );
 
    free(state->out_buffer);
@@ -264,6 +268,8 @@ static bool screenshot_dump(
    
    if (history_list_enable)
       state->flags              |= SS_TASK_FLAG_HISTORY_LIST_ENABLE;
+   if (settings->bools.screenshot_fast_compression)
+      state->flags              |= SS_TASK_FLAG_FAST_COMPRESSION;
    state->pixel_format_type      = pixel_format_type;
 
    if (!fullpath)
@@ -1054,6 +1054,7 @@ static void translation_response_sound(access_response_t *response)
       params.state                = AUDIO_STREAM_STATE_PLAYING;
       params.buf                  = response->sound;
       params.bufsize              = response->sound_size;
+      params.handle               = NULL;
       params.cb                   = NULL;
       params.basename             = NULL;
 
@@ -52,7 +52,8 @@ enum screenshot_task_flags
    SS_TASK_FLAG_IS_IDLE             = (1 << 2),
    SS_TASK_FLAG_IS_PAUSED           = (1 << 3),
    SS_TASK_FLAG_HISTORY_LIST_ENABLE = (1 << 4),
-   SS_TASK_FLAG_WIDGETS_READY       = (1 << 5)
+   SS_TASK_FLAG_WIDGETS_READY       = (1 << 5),
+   SS_TASK_FLAG_FAST_COMPRESSION    = (1 << 6)
 };
 
 typedef struct nbio_buf
@@ -89,6 +90,7 @@ typedef struct
    struct string_list *headers;
    size_t len;
    int status;
+   bool extracted; /* See task_push_http_transfer_file_stream() */
 } http_transfer_data_t;
 
 void *task_push_http_transfer(const char *url, bool mute, const char *type,
@@ -213,6 +215,7 @@ bool task_push_pl_manager_clean_playlist(const playlist_config_t *playlist_confi
 
 bool task_push_image_load(const char *fullpath,
       bool supports_rgba, unsigned upscale_threshold,
+      unsigned downscale_threshold,
       retro_task_callback_t cb, void *userdata);
 
 #ifdef HAVE_LIBRETRODB